@@ -24,7 +24,9 @@ DESTDIR  = lib
 contains( QXT_MODULES, core ){
     message( building core module )
     sub_core.subdir = src/core
-    SUBDIRS += sub_core
+    sub_logdecode.subdir = tools/qxtlogdecode
+    sub_logdecode.depends = sub_core
+    SUBDIRS += sub_core sub_logdecode
 }
 
 contains( QXT_MODULES, widgets ){
@@ -263,6 +263,31 @@ solution "LibQxt"
             flags { "Optimize" }
     end
 
+    project "qxtlogdecode"
+        targetdir (buildbase .. "/bin")
+        language "C++"
+        files { projectbase .. "/tools/qxtlogdecode/main.cpp" }
+
+        -- -reduce-relocations is part of the qt5 default flags :(
+        buildoptions { "-fPIE" }
+
+        includedirs {
+                projectbase .. "/src/core",
+                projectbase .. "/include/QxtCore"
+        }
+        uses "QtCore"
+        uses "QxtCore"
+
+        configuration "DebugShared"
+            kind "ConsoleApp"
+            defines { "DEBUG" }
+            flags { "Symbols" }
+
+        configuration "ReleaseShared"
+            kind "ConsoleApp"
+            defines { "NDEBUG" }
+            flags { "Optimize" }
+
     project "qxtjsonrpc"
         targetdir (buildbase .. "/bin")
         language "C++"
@@ -3,9 +3,12 @@ DEPENDPATH += $$PWD
 
 HEADERS += qxtberkeley.h
 HEADERS += qxtbdb.h
+HEADERS += qxtbdbcodec.h
+HEADERS += qxtbdbenvironment.h
 HEADERS += qxtbdbhash.h
 HEADERS += qxtbdbtree.h
 
 SOURCES += qxtbdb.cpp
+SOURCES += qxtbdbenvironment.cpp
 SOURCES += qxtbdbhash.cpp
 SOURCES += qxtbdbtree.cpp
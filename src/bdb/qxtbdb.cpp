@@ -29,10 +29,17 @@
 ** <http://libqxt.org>  <foundation@libqxt.org>
 *****************************************************************************/
 
+#include "qxtbdbcodec.h"
+#include "qxtbdbenvironment.h"
 #include <QFileInfo>
 #include <QBuffer>
 #include <QDataStream>
 #include <QVariant>
+#include <QtAlgorithms>
+#include <QHash>
+#include <QMutex>
+#include <QThreadStorage>
+#include <cstring>
 
 
 
@@ -44,9 +51,124 @@ static void qxtBDBDatabaseErrorHandler(const  BerkeleyDB::DB_ENV*, const char* a
 }
 
 
+/*
+    the transaction and the cached read cursor of one thread.
+    a DB_THREAD handle may be shared, but transactions and cursors must stay in the thread that made them.
+    the state belongs to its thread; a database that goes away first only detaches it by clearing cache.
+*/
+class QxtBdbThreadState
+{
+public:
+    QxtBdbThreadState(QxtBdbThreadCache * cache) : txn(0), cursor(0), snapshot(false), cache(cache) {}
+    ~QxtBdbThreadState();
+
+    void closeCursor()
+    {
+        if (cursor)
+            cursor->c_close(cursor);
+        cursor = 0;
+    }
+
+    BerkeleyDB::DB_TXN * txn;
+    BerkeleyDB::DBC * cursor;
+    bool snapshot;
+    QxtBdbThreadCache * cache;
+};
+
+/*
+    all thread states of one database, so it can close their cursors before the handle goes away.
+    the serial identifies the database in the per thread tables and is never reused.
+*/
+class QxtBdbThreadCache
+{
+public:
+    QxtBdbThreadCache();
+
+    quint64 serial;
+    QList<QxtBdbThreadState *> states;
+};
+
+/*
+    the states of all databases used by one thread, deleted by QThreadStorage when the thread finishes.
+*/
+class QxtBdbThreadStates : public QHash<quint64, QxtBdbThreadState *>
+{
+public:
+    ~QxtBdbThreadStates()
+    {
+        qDeleteAll(*this);
+    }
+};
+
+// guards QxtBdbThreadCache::states and QxtBdbThreadState::cache of every database
+Q_GLOBAL_STATIC(QMutex, qxt_bdbThreadMutex)
+Q_GLOBAL_STATIC(QThreadStorage<QxtBdbThreadStates *>, qxt_bdbThreadStates)
+
+QxtBdbThreadCache::QxtBdbThreadCache()
+{
+    static quint64 nextSerial = 0;
+    QMutexLocker locker(qxt_bdbThreadMutex());
+    serial = ++nextSerial;
+}
+
+QxtBdbThreadState::~QxtBdbThreadState()
+{
+    QMutexLocker locker(qxt_bdbThreadMutex());
+    if (!cache)
+        return;
+    closeCursor();
+    if (txn)
+        txn->abort(txn);
+    cache->states.removeAll(this);
+}
+
+static QxtBdbThreadState * qxt_bdbThreadState(QxtBdbThreadCache * cache, bool create)
+{
+    QThreadStorage<QxtBdbThreadStates *> * storage = qxt_bdbThreadStates();
+    QxtBdbThreadStates * states = storage->hasLocalData() ? storage->localData() : 0;
+    if (states)
+    {
+        QxtBdbThreadState * state = states->value(cache->serial);
+        if (state)
+            return state;
+    }
+    if (!create)
+        return 0;
+    if (!states)
+    {
+        states = new QxtBdbThreadStates;
+        storage->setLocalData(states);
+    }
+
+    QxtBdbThreadState * state = new QxtBdbThreadState(cache);
+    QList<QxtBdbThreadState *> stale;
+    {
+        QMutexLocker locker(qxt_bdbThreadMutex());
+        cache->states.append(state);
+        // drop the states left behind by databases destroyed since
+        QxtBdbThreadStates::iterator it = states->begin();
+        while (it != states->end())
+        {
+            if (it.value()->cache)
+            {
+                ++it;
+                continue;
+            }
+            stale.append(it.value());
+            it = states->erase(it);
+        }
+    }
+    qDeleteAll(stale);
+    states->insert(cache->serial, state);
+    return state;
+}
+
+
 QxtBdb::QxtBdb()
 {
     isOpen = false;
+    environment = 0;
+    threads = new QxtBdbThreadCache;
     if (db_create(&db, NULL, 0) != 0)
         qFatal("db_create failed");
     db->set_errcall(db, qxtBDBDatabaseErrorHandler);
@@ -54,7 +176,43 @@ QxtBdb::QxtBdb()
 }
 QxtBdb::~QxtBdb()
 {
+    // the states belong to their threads, which delete them when they finish or use a database again
+    {
+        QMutexLocker locker(qxt_bdbThreadMutex());
+        foreach (QxtBdbThreadState * state, threads->states)
+        {
+            state->closeCursor();
+            if (state->txn)
+                state->txn->abort(state->txn);
+            state->txn = 0;
+            state->cache = 0;
+        }
+    }
+    delete threads;
+
+    db->close(db, 0);
+    // the environment must outlive its databases
+    delete environment;
+}
+
+/*!
+moves the database into \a env. must be called before open() and before any flags are set,
+the handle is recreated. file names passed to open() are relative to the environment's home then.
+*/
+bool QxtBdb::setEnvironment(const QxtBdbEnvironment & env)
+{
+    Q_ASSERT(!isOpen);
+    if (!env.isOpen())
+        return false;
+
     db->close(db, 0);
+    if (db_create(&db, env.env(), 0) != 0)
+        qFatal("db_create failed");
+    db->set_errcall(db, qxtBDBDatabaseErrorHandler);
+
+    delete environment;
+    environment = new QxtBdbEnvironment(env);
+    return true;
 }
 
 
@@ -64,7 +222,7 @@ bool QxtBdb::open(QString path, OpenFlags f)
 {
     Q_ASSERT(!isOpen);
 
-    if (QFileInfo(path).exists())
+    if (!environment && QFileInfo(path).exists())
     {
 
         BerkeleyDB::DB * tdb;
@@ -87,6 +245,8 @@ bool QxtBdb::open(QString path, OpenFlags f)
     if (f&LockFree)
         flags |= DB_THREAD;
 
+    if (environment && (environment->openFlags() & QxtBdbEnvironment::Transactions))
+        flags |= DB_AUTO_COMMIT;
 
 
 
@@ -194,7 +354,7 @@ bool QxtBdb::get(void* key, int keytype, void* value, int valuetype, BerkeleyDB:
     if (cursor)
         ret = cursor->c_get(cursor, &dbkey, &dbvalue, flags);
     else
-        ret = db->get(db, NULL, &dbkey, &dbvalue, flags);
+        ret = db->get(db, transaction(), &dbkey, &dbvalue, flags);
 
     if (ret != DB_BUFFER_SMALL)
     {
@@ -211,7 +371,7 @@ bool QxtBdb::get(void* key, int keytype, void* value, int valuetype, BerkeleyDB:
     if (cursor)
         ret = cursor->c_get(cursor, &dbkey, &dbvalue, flags);
     else
-        ret = db->get(db, NULL, &dbkey, &dbvalue, flags);
+        ret = db->get(db, transaction(), &dbkey, &dbvalue, flags);
 
     QByteArray  d_value = QByteArray::fromRawData((const char*) dbvalue.data, dbvalue.size);
     QByteArray  d_key = QByteArray::fromRawData((const char*) dbkey.data,  dbkey.size);
@@ -314,7 +474,7 @@ bool QxtBdb::get(const void* key, int keytype, void* value, int valuetype, Berke
     if (cursor)
         ret = cursor->c_get(cursor, &dbkey, &dbvalue, flags);
     else
-        ret = db->get(db, NULL, &dbkey, &dbvalue, flags);
+        ret = db->get(db, transaction(), &dbkey, &dbvalue, flags);
 
     if (ret != DB_BUFFER_SMALL)
     {
@@ -329,7 +489,7 @@ bool QxtBdb::get(const void* key, int keytype, void* value, int valuetype, Berke
     if (cursor)
         ret = cursor->c_get(cursor, &dbkey, &dbvalue, flags);
     else
-        ret = db->get(db, NULL, &dbkey, &dbvalue, flags);
+        ret = db->get(db, transaction(), &dbkey, &dbvalue, flags);
 
     QByteArray  d_value((const char*) dbvalue.data, dbvalue.size);
     QByteArray  d_key((const char*) dbkey.data,  dbkey.size);
@@ -363,7 +523,472 @@ bool QxtBdb::get(const void* key, int keytype, void* value, int valuetype, Berke
     return true;
 }
 
+/*!
+starts a transaction that all following reads and writes of the calling thread through this handle belong to.
+other threads are not affected. only possible in an environment opened with QxtBdbEnvironment::Transactions.
+with \a snapshot the transaction is read only and sees the database as it was when it started,
+without taking any read locks. that needs QxtBdbEnvironment::MultiVersion.
+*/
+bool QxtBdb::beginTransaction(bool snapshot)
+{
+    if (!environment || !(environment->openFlags() & QxtBdbEnvironment::Transactions))
+        return false;
+
+    BerkeleyDB::u_int32_t flags = 0;
+    if (snapshot)
+    {
+#ifdef DB_TXN_SNAPSHOT
+        if (!(environment->openFlags() & QxtBdbEnvironment::MultiVersion))
+            return false;
+        flags = DB_TXN_SNAPSHOT;
+#else
+        return false;
+#endif
+    }
+
+    QxtBdbThreadState * state = qxt_bdbThreadState(threads, true);
+    if (state->txn)
+        return false;
+    state->closeCursor();
+
+    BerkeleyDB::DB_ENV * env = environment->env();
+    if (env->txn_begin(env, NULL, &state->txn, flags) != 0)
+    {
+        state->txn = 0;
+        return false;
+    }
+    state->snapshot = snapshot;
+    return true;
+}
+
+bool QxtBdb::commitTransaction()
+{
+    QxtBdbThreadState * state = qxt_bdbThreadState(threads, false);
+    if (!state || !state->txn)
+        return false;
+    // cursors have to be closed before their transaction ends
+    state->closeCursor();
+    int ret = state->txn->commit(state->txn, 0);
+    state->txn = 0;
+    return (ret == 0);
+}
+
+bool QxtBdb::rollbackTransaction()
+{
+    QxtBdbThreadState * state = qxt_bdbThreadState(threads, false);
+    if (!state || !state->txn)
+        return false;
+    state->closeCursor();
+    int ret = state->txn->abort(state->txn);
+    state->txn = 0;
+    return (ret == 0);
+}
+
+/*!
+returns the transaction of the calling thread, or 0 if it has none.
+*/
+BerkeleyDB::DB_TXN * QxtBdb::transaction() const
+{
+    QxtBdbThreadState * state = qxt_bdbThreadState(threads, false);
+    return state ? state->txn : 0;
+}
+
+/*!
+returns true if the transaction of the calling thread is a read only snapshot.
+*/
+bool QxtBdb::isSnapshot() const
+{
+    QxtBdbThreadState * state = qxt_bdbThreadState(threads, false);
+    return state && state->txn && state->snapshot;
+}
+
+/*!
+returns a cursor of the calling thread for point lookups, opened once and reused by every lookup() after.
+a cursor keeps a read lock on its page while it stays open, so in a transactional environment
+a cursor is only cached inside a transaction, which holds its locks until it ends anyway.
+returns 0 if no cursor should be kept.
+*/
+BerkeleyDB::DBC * QxtBdb::readCursor() const
+{
+    if (!isOpen)
+        return 0;
+    const bool locking = environment && (environment->openFlags() & QxtBdbEnvironment::Transactions);
+    QxtBdbThreadState * state = qxt_bdbThreadState(threads, !locking);
+    if (!state || (locking && !state->txn))
+        return 0;
+    if (!state->cursor && db->cursor(db, state->txn, &state->cursor, 0) != 0)
+        state->cursor = 0;
+    return state->cursor;
+}
+
+/*!
+closes the cached read cursors of all threads. the database can not be truncated while they are open.
+no other thread may be reading at the same time.
+*/
+void QxtBdb::releaseCursors()
+{
+    QMutexLocker locker(qxt_bdbThreadMutex());
+    foreach (QxtBdbThreadState * state, threads->states)
+        state->closeCursor();
+}
+
+/*!
+looks up the record with the encoded \a key and reads its value into \a value,
+or only checks that it exists if \a value is 0.
+uses the read cursor of the calling thread where possible, which saves opening
+a new cursor inside bdb for every lookup.
+*/
+bool QxtBdb::lookup(QxtBdbData * key, QxtBdbData * value) const
+{
+    BerkeleyDB::DBC * cursor = readCursor();
+    if (cursor)
+        return fetch(cursor, key, value, DB_SET);
+    return fetch(0, key, value, 0);
+}
+
+static BerkeleyDB::DBT qxt_bdbDbt(const QByteArray & bytes)
+{
+    BerkeleyDB::DBT t;
+    ::memset(&t, 0, sizeof(BerkeleyDB::DBT));
+    t.data = const_cast<char *>(bytes.constData());
+    t.size = bytes.size();
+    return t;
+}
+
+static bool qxt_bdbRecordLessThan(const QPair<QByteArray, QByteArray> & a, const QPair<QByteArray, QByteArray> & b)
+{
+    const int c = ::memcmp(a.first.constData(), b.first.constData(), qMin(a.first.size(), b.first.size()));
+    return c < 0 || (c == 0 && a.first.size() < b.first.size());
+}
+
+#ifdef DB_DBT_BULK
+// The DB_MULTIPLE_KEY layout: key and value bytes grow from the front, their offsets and
+// sizes grow from the back, four words per pair, terminated by -1.
+class QxtBdbBulkBuffer
+{
+public:
+    QxtBdbBulkBuffer(int bytes) : words(bytes / sizeof(BerkeleyDB::u_int32_t))
+    {
+        clear();
+    }
+
+    void clear()
+    {
+        slot = words.data() + words.size() - 1;
+        *slot = BerkeleyDB::u_int32_t(-1);
+        used = 0;
+        count = 0;
+    }
+
+    bool add(const QByteArray & key, const QByteArray & value)
+    {
+        char * base = reinterpret_cast<char *>(words.data());
+        if (base + used + key.size() + value.size() > reinterpret_cast<char *>(slot - 4))
+            return false;
+
+        slot[0] = used;
+        slot[-1] = key.size();
+        ::memcpy(base + used, key.constData(), key.size());
+        used += key.size();
+        slot[-2] = used;
+        slot[-3] = value.size();
+        ::memcpy(base + used, value.constData(), value.size());
+        used += value.size();
+        slot -= 4;
+        *slot = BerkeleyDB::u_int32_t(-1);
+        count++;
+        return true;
+    }
+
+    BerkeleyDB::DBT dbt()
+    {
+        BerkeleyDB::DBT t;
+        ::memset(&t, 0, sizeof(BerkeleyDB::DBT));
+        t.data = words.data();
+        t.size = t.ulen = words.size() * sizeof(BerkeleyDB::u_int32_t);
+        t.flags = DB_DBT_USERMEM | DB_DBT_BULK;
+        return t;
+    }
+
+    QVector<BerkeleyDB::u_int32_t> words;
+    BerkeleyDB::u_int32_t * slot;
+    BerkeleyDB::u_int32_t used;
+    int count;
+};
+#endif
+
+/*!
+writes \a records of encoded keys and values at once.
+the records are sorted by key first, so the btree fills up from left to right instead of
+splitting pages all over the file, and then handed to bdb in large DB_MULTIPLE_KEY buffers.
+if no transaction is active and the environment is transactional, every buffer is committed
+on its own, otherwise everything goes into the running transaction.
+\a records is left sorted.
+*/
+bool QxtBdb::load(QVector<QPair<QByteArray, QByteArray> > & records)
+{
+    if (!isOpen)
+        return false;
+
+    qStableSort(records.begin(), records.end(), qxt_bdbRecordLessThan);
+
+    const bool ownTransactions = !transaction() && environment && (environment->openFlags() & QxtBdbEnvironment::Transactions);
+#ifdef DB_DBT_BULK
+    QxtBdbBulkBuffer bulk(4 * 1024 * 1024);
+#endif
+    int next = 0;
+    while (next < records.count())
+    {
+        if (ownTransactions && !beginTransaction())
+            return false;
+
+        int ret = 0;
+        int singles = 10000;
+#ifdef DB_DBT_BULK
+        bulk.clear();
+        while (next < records.count() && bulk.add(records.at(next).first, records.at(next).second))
+            next++;
+
+        if (bulk.count > 0)
+        {
+            BerkeleyDB::DBT keys = bulk.dbt();
+            BerkeleyDB::DBT unused;
+            ::memset(&unused, 0, sizeof(BerkeleyDB::DBT));
+            ret = db->put(db, transaction(), &keys, &unused, DB_MULTIPLE_KEY);
+            singles = 0;
+        }
+        else
+        {
+            // the record does not fit into an empty buffer
+            singles = 1;
+        }
+#endif
+        const int last = qMin(next + singles, records.count());
+        for (; ret == 0 && next < last; next++)
+        {
+            BerkeleyDB::DBT dbkey = qxt_bdbDbt(records.at(next).first);
+            BerkeleyDB::DBT dbvalue = qxt_bdbDbt(records.at(next).second);
+            ret = db->put(db, transaction(), &dbkey, &dbvalue, 0);
+        }
+
+        if (ret != 0)
+        {
+            qWarning("QxtBdb::load failed %s", qPrintable(dbErrorCodeToString(ret)));
+            if (ownTransactions)
+                rollbackTransaction();
+            return false;
+        }
+        if (ownTransactions && !commitTransaction())
+            return false;
+    }
+    return true;
+}
+
+static void qxt_bdbPrepare(BerkeleyDB::DBT* dbt, QxtBdbData* data)
+{
+    ::memset(dbt, 0, sizeof(BerkeleyDB::DBT));
+    dbt->flags = DB_DBT_USERMEM;
+    if (data)
+    {
+        dbt->data = data->data();
+        dbt->size = data->size();
+        dbt->ulen = data->capacity();
+    }
+    else
+    {
+        // nothing is wanted back, let bdb skip the copy entirely
+        dbt->flags |= DB_DBT_PARTIAL;
+    }
+}
+
+static void qxt_bdbGrow(BerkeleyDB::DBT* dbt, QxtBdbData* data)
+{
+    if (!data || dbt->size <= dbt->ulen)
+        return;
+    data->reserve(dbt->size);
+    dbt->data = data->data();
+    dbt->ulen = data->capacity();
+    // bdb reported the size it needs, put back the size of the key we search for
+    dbt->size = data->size();
+}
+
+/*!
+low level get function working on raw records.
+\a key and \a value are read from and written to the caller's buffers directly,
+which only grow when a record does not fit. Passing 0 for either of them skips
+copying that part of the record, so moving a cursor with move() costs no copies at all.
+*/
+bool QxtBdb::fetch(BerkeleyDB::DBC * cursor, QxtBdbData * key, QxtBdbData * value, BerkeleyDB::u_int32_t flags) const
+{
+    BerkeleyDB::DBT dbkey, dbvalue;
+    qxt_bdbPrepare(&dbkey, key);
+    qxt_bdbPrepare(&dbvalue, value);
+
+    int ret;
+    if (cursor)
+        ret = cursor->c_get(cursor, &dbkey, &dbvalue, flags);
+    else
+        ret = db->get(db, transaction(), &dbkey, &dbvalue, flags);
+
+    if (ret == DB_BUFFER_SMALL)
+    {
+        qxt_bdbGrow(&dbkey, key);
+        qxt_bdbGrow(&dbvalue, value);
+        if (cursor)
+            ret = cursor->c_get(cursor, &dbkey, &dbvalue, flags);
+        else
+            ret = db->get(db, transaction(), &dbkey, &dbvalue, flags);
+    }
+    if (ret != 0)
+        return false;
+
+    if (key)
+        key->resize(dbkey.size);
+    if (value)
+        value->resize(dbvalue.size);
+    return true;
+}
+
+/*!
+reads the first \a size bytes of the value at the current position of \a cursor into \a head.
+*/
+bool QxtBdb::fetchHead(BerkeleyDB::DBC * cursor, void * head, int size) const
+{
+    BerkeleyDB::DBT dbkey, dbvalue;
+    qxt_bdbPrepare(&dbkey, 0);
+    qxt_bdbPrepare(&dbvalue, 0);
+    dbvalue.data = head;
+    dbvalue.ulen = size;
+    dbvalue.dlen = size;
+
+    if (cursor->c_get(cursor, &dbkey, &dbvalue, DB_CURRENT) != 0)
+        return false;
+    return (dbvalue.size == BerkeleyDB::u_int32_t(size));
+}
+
+QxtBdbBulkReader::QxtBdbBulkReader(const QxtBdb * db, int bufferSize)
+    : key(0), keySize(0), value(0), valueSize(0), dbc(0), slot(0), hasUpper(false), started(false)
+{
+    // bulk buffers have to be a multiple of 1024 bytes
+    buffer.resize(((qMax(bufferSize, 1024) + 1023) / 1024) * 1024 / sizeof(BerkeleyDB::u_int32_t));
+    if (db->isOpen && db->db->cursor(db->db, db->transaction(), &dbc, 0) != 0)
+        dbc = 0;
+}
+
+QxtBdbBulkReader::~QxtBdbBulkReader()
+{
+    close();
+}
+
+void QxtBdbBulkReader::setLowerBound(const QByteArray & key)
+{
+    Q_ASSERT(!started);
+    lower = key;
+}
+
+void QxtBdbBulkReader::setUpperBound(const QByteArray & key)
+{
+    upper = key;
+    hasUpper = true;
+}
+
+void QxtBdbBulkReader::setPrefix(const QByteArray & key)
+{
+    Q_ASSERT(!started);
+    prefix = key;
+    lower = key;
+}
+
+void QxtBdbBulkReader::close()
+{
+    if (dbc)
+        dbc->c_close(dbc);
+    dbc = 0;
+    key = value = 0;
+    keySize = valueSize = 0;
+}
+
+bool QxtBdbBulkReader::fill()
+{
+    QxtBdbData start;
+    BerkeleyDB::DBT dbkey, dbvalue;
+    ::memset(&dbvalue, 0, sizeof(BerkeleyDB::DBT));
+    dbvalue.data = buffer.data();
+    dbvalue.ulen = buffer.size() * sizeof(BerkeleyDB::u_int32_t);
+    dbvalue.flags = DB_DBT_USERMEM;
+
+    BerkeleyDB::u_int32_t flags = DB_MULTIPLE_KEY | DB_NEXT;
+    if (!started && !lower.isEmpty())
+    {
+        flags = DB_MULTIPLE_KEY | DB_SET_RANGE;
+        start.append(lower.constData(), lower.size());
+    }
+    qxt_bdbPrepare(&dbkey, &start);
+
+    int ret = dbc->c_get(dbc, &dbkey, &dbvalue, flags);
+    if (ret == DB_BUFFER_SMALL)
+    {
+        // a single record is larger than the buffer
+        qxt_bdbGrow(&dbkey, &start);
+        if (dbvalue.size > dbvalue.ulen)
+        {
+            buffer.resize(((dbvalue.size + 1023) / 1024) * 1024 / sizeof(BerkeleyDB::u_int32_t));
+            dbvalue.data = buffer.data();
+            dbvalue.ulen = buffer.size() * sizeof(BerkeleyDB::u_int32_t);
+        }
+        ret = dbc->c_get(dbc, &dbkey, &dbvalue, flags);
+    }
+    started = true;
+    if (ret != 0)
+    {
+        if (ret != DB_NOTFOUND)
+            qWarning("QxtBdbBulkReader: %s", qPrintable(QxtBdb::dbErrorCodeToString(ret)));
+        return false;
+    }
+    slot = buffer.data() + buffer.size() - 1;
+    return true;
+}
+
+bool QxtBdbBulkReader::inRange() const
+{
+    if (!prefix.isEmpty())
+        return keySize >= prefix.size() && ::memcmp(key, prefix.constData(), prefix.size()) == 0;
+    if (hasUpper)
+    {
+        const int c = ::memcmp(key, upper.constData(), qMin(keySize, upper.size()));
+        return c < 0 || (c == 0 && keySize < upper.size());
+    }
+    return true;
+}
 
+/*!
+advances to the next record. returns false at the end of the database or the range.
+*/
+bool QxtBdbBulkReader::next()
+{
+    while (dbc)
+    {
+        if (!slot || *slot == BerkeleyDB::u_int32_t(-1))
+        {
+            if (!fill())
+                break;
+            continue;
+        }
+
+        const char * base = reinterpret_cast<const char *>(buffer.constData());
+        key = base + slot[0];
+        keySize = slot[-1];
+        value = base + slot[-2];
+        valueSize = slot[-3];
+        slot -= 4;
+
+        if (inRange())
+            return true;
+        break;
+    }
+    close();
+    return false;
+}
 
 QString QxtBdb::dbErrorCodeToString(int e)
 {
@@ -381,3 +1006,19 @@ QString QxtBdb::dbErrorCodeToString(int e)
     };
 }
 
+
+/*!
+    \class QxtBdbCodec
+    \inmodule QxtBerkeley
+    \brief The QxtBdbCodec class template converts keys and values of the berkeley containers to records
+
+    \c encode() appends the binary form of a value to a QxtBdbData buffer and \c decode()
+    reads it back. Integers and floating point numbers are stored big endian in a form
+    that sorts like their values, QString as UTF-8 and QByteArray as is. Types without
+    constructors or destructors are copied byte by byte. Everything else is streamed
+    through QMetaType and QDataStream, so it has to be a registered meta type.
+
+    Specialize QxtBdbCodec to store a type of your own in a cheaper or sortable form.
+
+    \sa QxtBdbHash, QxtBdbTree
+*/
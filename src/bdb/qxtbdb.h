@@ -43,6 +43,9 @@ This is private API. it might change at any time without warning.
 #include <QMetaType>
 
 #include <QString>
+#include <QVector>
+#include <QPair>
+#include <QSharedData>
 #include <qxtglobal.h>
 #include <cstdlib>
 #include <cstdio>
@@ -63,6 +66,10 @@ namespace BerkeleyDB
 
 }
 
+class QxtBdbData;
+class QxtBdbEnvironment;
+class QxtBdbThreadCache;
+
 class QXT_BERKELEY_EXPORT QxtBdb
 {
 public:
@@ -82,13 +89,34 @@ public:
     bool get(void* key, int keytype, void* value, int valuetype, BerkeleyDB::u_int32_t flags = NULL, BerkeleyDB::DBC * cursor = 0) const ;
     bool get(const void* key, int keytype, void* value, int valuetype, BerkeleyDB::u_int32_t flags = NULL, BerkeleyDB::DBC * cursor = 0) const ;
 
+    bool fetch(BerkeleyDB::DBC * cursor, QxtBdbData * key, QxtBdbData * value, BerkeleyDB::u_int32_t flags) const;
+    bool fetchHead(BerkeleyDB::DBC * cursor, void * head, int size) const;
+    bool move(BerkeleyDB::DBC * cursor, BerkeleyDB::u_int32_t flags) const
+    {
+        return fetch(cursor, 0, 0, flags);
+    }
+
 
+    bool setEnvironment(const QxtBdbEnvironment & env);
     bool open(QString path, OpenFlags f = 0);
     OpenFlags openFlags();
     bool flush();
     BerkeleyDB::DB * db;
     bool isOpen;
 
+    bool beginTransaction(bool snapshot = false);
+    bool commitTransaction();
+    bool rollbackTransaction();
+    BerkeleyDB::DB_TXN * transaction() const;
+    bool isSnapshot() const;
+    bool load(QVector<QPair<QByteArray, QByteArray> > & records);
+    QxtBdbEnvironment * environment;
+
+    bool lookup(QxtBdbData * key, QxtBdbData * value) const;
+    BerkeleyDB::DBC * readCursor() const;
+    void releaseCursors();
+    QxtBdbThreadCache * threads;
+
 
     static QString dbErrorCodeToString(int e);
 
@@ -171,6 +199,45 @@ public:
 Q_DECLARE_OPERATORS_FOR_FLAGS(QxtBdb::OpenFlags);
 
 
+/*
+    Walks a database front to back with DB_MULTIPLE_KEY, fetching many records per
+    call into one buffer. key and value point into that buffer until the next call
+    to next(). Optionally stops at an upper bound or at the end of a key prefix.
+*/
+class QXT_BERKELEY_EXPORT QxtBdbBulkReader : public QSharedData
+{
+public:
+    QxtBdbBulkReader(const QxtBdb * db, int bufferSize = 1024 * 1024);
+    ~QxtBdbBulkReader();
+
+    void setLowerBound(const QByteArray & key);
+    void setUpperBound(const QByteArray & key);
+    void setPrefix(const QByteArray & prefix);
+
+    bool next();
+    void close();
+
+    const char * key;
+    int keySize;
+    const char * value;
+    int valueSize;
+
+private:
+    Q_DISABLE_COPY(QxtBdbBulkReader)
+    bool fill();
+    bool inRange() const;
+
+    BerkeleyDB::DBC * dbc;
+    QVector<BerkeleyDB::u_int32_t> buffer;
+    BerkeleyDB::u_int32_t * slot;
+    QByteArray lower;
+    QByteArray upper;
+    QByteArray prefix;
+    bool hasUpper;
+    bool started;
+};
+
+
 
 
 
@@ -0,0 +1,314 @@
+/****************************************************************************
+** Copyright (c) 2006 - 2011, the LibQxt project.
+** See the Qxt AUTHORS file for a list of authors and copyright holders.
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**     * Redistributions of source code must retain the above copyright
+**       notice, this list of conditions and the following disclaimer.
+**     * Redistributions in binary form must reproduce the above copyright
+**       notice, this list of conditions and the following disclaimer in the
+**       documentation and/or other materials provided with the distribution.
+**     * Neither the name of the LibQxt project nor the
+**       names of its contributors may be used to endorse or promote products
+**       derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+** ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+** DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+** (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+** LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+** ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** <http://libqxt.org>  <foundation@libqxt.org>
+*****************************************************************************/
+
+#ifndef QXTBDBCODEC_H
+#define QXTBDBCODEC_H
+
+#include "qxtbdb.h"
+#include <QByteArray>
+#include <QString>
+#include <QDataStream>
+#include <QMetaType>
+#include <cstring>
+
+/*
+    A growable byte buffer that keeps small records inline, so encoding a key or
+    reading a record back does not touch the heap at all in the common case.
+    It is handed to BerkeleyDB as DB_DBT_USERMEM memory.
+*/
+class QxtBdbData
+{
+public:
+    enum { InlineSize = 128 };
+
+    QxtBdbData() : d(buffer), len(0), cap(InlineSize) {}
+
+    char* data()
+    {
+        return d;
+    }
+    const char* constData() const
+    {
+        return d;
+    }
+    int size() const
+    {
+        return len;
+    }
+    int capacity() const
+    {
+        return cap;
+    }
+    void clear()
+    {
+        len = 0;
+    }
+
+    void reserve(int size)
+    {
+        if (size <= cap)
+            return;
+        int grown = qMax(size, cap * 2);
+        QByteArray bigger;
+        bigger.resize(grown);
+        ::memcpy(bigger.data(), d, len);
+        heap = bigger;
+        d = heap.data();
+        cap = grown;
+    }
+    void resize(int size)
+    {
+        reserve(size);
+        len = size;
+    }
+    char* grow(int size)
+    {
+        reserve(len + size);
+        char* p = d + len;
+        len += size;
+        return p;
+    }
+    void append(const char* data, int size)
+    {
+        ::memcpy(grow(size), data, size);
+    }
+    // takes over the contents of bytes without copying them
+    void adopt(QByteArray& bytes)
+    {
+        heap = bytes;
+        bytes.clear();
+        d = heap.data();
+        len = cap = heap.size();
+    }
+
+    BerkeleyDB::DBT dbt() const
+    {
+        BerkeleyDB::DBT t;
+        ::memset(&t, 0, sizeof(BerkeleyDB::DBT));
+        t.data = d;
+        t.size = len;
+        return t;
+    }
+
+private:
+    Q_DISABLE_COPY(QxtBdbData)
+    char buffer[InlineSize];
+    QByteArray heap;
+    char* d;
+    int len;
+    int cap;
+};
+
+template<class U>
+inline void qxt_bdbStoreBigEndian(U value, uchar* out)
+{
+    for (int i = int(sizeof(U)) - 1; i >= 0; i--)
+    {
+        out[i] = uchar(value);
+        value = U(value >> 8);
+    }
+}
+
+template<class U>
+inline U qxt_bdbLoadBigEndian(const uchar* in)
+{
+    U value = 0;
+    for (int i = 0; i < int(sizeof(U)); i++)
+        value = U(U(value << 8) | in[i]);
+    return value;
+}
+
+// QDataStream through QMetaType, for everything that has no cheaper encoding.
+template<class T, bool complex>
+struct QxtBdbGenericCodec
+{
+    static void encode(const T& t, QxtBdbData& out)
+    {
+        QByteArray bytes;
+        {
+            QDataStream s(&bytes, QIODevice::WriteOnly);
+            if (!QMetaType::save(s, qMetaTypeId<T>(), &t))
+                qCritical("QMetaType::save failed. is your type registered with the QMetaType?");
+        }
+        if (out.size() == 0)
+            out.adopt(bytes);
+        else
+            out.append(bytes.constData(), bytes.size());
+    }
+    static bool decode(const char* data, int size, T& t)
+    {
+        const QByteArray bytes = QByteArray::fromRawData(data, size);
+        QDataStream s(bytes);
+        if (!QMetaType::load(s, qMetaTypeId<T>(), &t))
+        {
+            qCritical("QMetaType::load failed. is your type registered with the QMetaType?");
+            return false;
+        }
+        return true;
+    }
+};
+
+// Types without constructors or destructors are stored as their bytes.
+template<class T>
+struct QxtBdbGenericCodec<T, false>
+{
+    static void encode(const T& t, QxtBdbData& out)
+    {
+        out.append(reinterpret_cast<const char*>(&t), sizeof(T));
+    }
+    static bool decode(const char* data, int size, T& t)
+    {
+        if (size != int(sizeof(T)))
+            return false;
+        ::memcpy(&t, data, sizeof(T));
+        return true;
+    }
+};
+
+template<class T>
+struct QxtBdbCodec : public QxtBdbGenericCodec<T, QTypeInfo<T>::isComplex>
+{
+};
+
+// Integers are stored big endian with the sign bit flipped, so memcmp order is numeric order.
+#define QXT_BDB_INTEGER_CODEC(T, U, SIGNED) \
+template<> \
+struct QxtBdbCodec<T> \
+{ \
+    static inline U bias() \
+    { \
+        return SIGNED ? U(U(1) << (sizeof(U) * 8 - 1)) : U(0); \
+    } \
+    static void encode(const T& t, QxtBdbData& out) \
+    { \
+        qxt_bdbStoreBigEndian<U>(U(U(t) ^ bias()), reinterpret_cast<uchar*>(out.grow(sizeof(U)))); \
+    } \
+    static bool decode(const char* data, int size, T& t) \
+    { \
+        if (size != int(sizeof(U))) \
+            return false; \
+        t = T(qxt_bdbLoadBigEndian<U>(reinterpret_cast<const uchar*>(data)) ^ bias()); \
+        return true; \
+    } \
+};
+
+QXT_BDB_INTEGER_CODEC(signed char, uchar, true)
+QXT_BDB_INTEGER_CODEC(uchar, uchar, false)
+QXT_BDB_INTEGER_CODEC(short, ushort, true)
+QXT_BDB_INTEGER_CODEC(ushort, ushort, false)
+QXT_BDB_INTEGER_CODEC(int, uint, true)
+QXT_BDB_INTEGER_CODEC(uint, uint, false)
+QXT_BDB_INTEGER_CODEC(long, ulong, true)
+QXT_BDB_INTEGER_CODEC(ulong, ulong, false)
+QXT_BDB_INTEGER_CODEC(qlonglong, qulonglong, true)
+QXT_BDB_INTEGER_CODEC(qulonglong, qulonglong, false)
+
+#undef QXT_BDB_INTEGER_CODEC
+
+/*
+    IEEE floats sort like sign-magnitude integers: flipping the sign bit of positive
+    values and all bits of negative ones turns that into plain unsigned order.
+    -0.0 and 0.0 remain distinct keys.
+*/
+#define QXT_BDB_FLOAT_CODEC(T, U) \
+template<> \
+struct QxtBdbCodec<T> \
+{ \
+    static void encode(const T& t, QxtBdbData& out) \
+    { \
+        const U sign = U(U(1) << (sizeof(U) * 8 - 1)); \
+        U bits; \
+        ::memcpy(&bits, &t, sizeof(U)); \
+        bits = (bits & sign) ? U(~bits) : U(bits | sign); \
+        qxt_bdbStoreBigEndian<U>(bits, reinterpret_cast<uchar*>(out.grow(sizeof(U)))); \
+    } \
+    static bool decode(const char* data, int size, T& t) \
+    { \
+        if (size != int(sizeof(U))) \
+            return false; \
+        const U sign = U(U(1) << (sizeof(U) * 8 - 1)); \
+        U bits = qxt_bdbLoadBigEndian<U>(reinterpret_cast<const uchar*>(data)); \
+        bits = (bits & sign) ? U(bits & ~sign) : U(~bits); \
+        ::memcpy(&t, &bits, sizeof(U)); \
+        return true; \
+    } \
+};
+
+QXT_BDB_FLOAT_CODEC(float, quint32)
+QXT_BDB_FLOAT_CODEC(double, quint64)
+
+#undef QXT_BDB_FLOAT_CODEC
+
+// Byte arrays and strings need no length prefix: every record carries its own size,
+// and leaving the prefix out keeps memcmp order equal to lexicographical order.
+template<>
+struct QxtBdbCodec<QByteArray>
+{
+    static void encode(const QByteArray& t, QxtBdbData& out)
+    {
+        out.append(t.constData(), t.size());
+    }
+    static bool decode(const char* data, int size, QByteArray& t)
+    {
+        t = QByteArray(data, size);
+        return true;
+    }
+};
+
+// UTF-8 compares byte-wise in code point order.
+template<>
+struct QxtBdbCodec<QString>
+{
+    static void encode(const QString& t, QxtBdbData& out)
+    {
+        // ASCII only strings, the common case for keys, skip the temporary
+        const int length = t.length();
+        const ushort* in = t.utf16();
+        char* p = out.grow(length);
+        int i = 0;
+        while (i < length && in[i] < 0x80)
+        {
+            p[i] = char(in[i]);
+            i++;
+        }
+        if (i == length)
+            return;
+        out.resize(out.size() - length);
+        const QByteArray utf8 = t.toUtf8();
+        out.append(utf8.constData(), utf8.size());
+    }
+    static bool decode(const char* data, int size, QString& t)
+    {
+        t = QString::fromUtf8(data, size);
+        return true;
+    }
+};
+
+#endif // QXTBDBCODEC_H
@@ -0,0 +1,254 @@
+/****************************************************************************
+** Copyright (c) 2006 - 2011, the LibQxt project.
+** See the Qxt AUTHORS file for a list of authors and copyright holders.
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**     * Redistributions of source code must retain the above copyright
+**       notice, this list of conditions and the following disclaimer.
+**     * Redistributions in binary form must reproduce the above copyright
+**       notice, this list of conditions and the following disclaimer in the
+**       documentation and/or other materials provided with the distribution.
+**     * Neither the name of the LibQxt project nor the
+**       names of its contributors may be used to endorse or promote products
+**       derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+** ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+** DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+** (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+** LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+** ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** <http://libqxt.org>  <foundation@libqxt.org>
+*****************************************************************************/
+
+#include "qxtbdbenvironment.h"
+#include <QDir>
+#include <QFile>
+#include <QSharedData>
+
+/*!
+    \class QxtBdbEnvironment
+    \inmodule QxtBerkeley
+    \brief The QxtBdbEnvironment class shares a cache, a log and transactions between berkeley databases
+
+    A database opened without an environment gets a small private cache and
+    every write is on its own. Opening QxtBdbHash or QxtBdbTree files inside
+    an environment lets them share one memory pool of cacheSize() bytes and,
+    with the Transactions flag, makes writes recoverable after a crash and
+    allows grouping them with QxtBdbHash::transaction() and QxtBdbHash::commit().
+
+    \code
+    QxtBdbEnvironment env;
+    env.setCacheSize(256 * 1024 * 1024);
+    env.open("data");
+
+    QxtBdbHash<int, QString> hash(env, "names.db");
+    hash.transaction();
+    for (int i = 0; i < 100000; i++)
+        hash.insert(i, QString::number(i));
+    hash.commit();
+    \endcode
+
+    QxtBdbEnvironment is explicitly shared: all copies refer to the same
+    environment, which is closed when the last copy and the last database
+    using it are gone.
+
+    \sa QxtBdbHash
+*/
+
+/*!
+    \enum QxtBdbEnvironment::OpenFlag
+
+    \value Transactions     Enables write ahead logging, locking and transactions.
+    \value Recover          Runs normal recovery on the environment before opening it. Requires \c Transactions.
+    \value NoSyncOnCommit   Commits write the log but do not wait for it to reach the disk. A crash may lose the
+                            last transactions but never leaves a database inconsistent.
+    \value MultiVersion     Keeps older versions of changed pages so readers can work on a snapshot, see
+                            QxtBdbHash::snapshot(). Requires \c Transactions and costs extra cache for the copies.
+*/
+
+class QxtBdbEnvironmentPrivate : public QSharedData
+{
+public:
+    QxtBdbEnvironmentPrivate() : env(0), cacheSize(0), isOpen(false) {}
+    ~QxtBdbEnvironmentPrivate()
+    {
+        if (env)
+            env->close(env, 0);
+    }
+
+    BerkeleyDB::DB_ENV * env;
+    QString home;
+    qint64 cacheSize;
+    QxtBdbEnvironment::OpenFlags flags;
+    bool isOpen;
+};
+
+static void qxtBdbEnvironmentErrorHandler(const BerkeleyDB::DB_ENV*, const char* a, const char* b)
+{
+    qDebug("QxtBdbEnvironment: %s, %s", a, b);
+}
+
+/*!
+    Constructs a closed environment.
+*/
+QxtBdbEnvironment::QxtBdbEnvironment() : qxt_d(new QxtBdbEnvironmentPrivate)
+{
+}
+
+/*!
+    Constructs a copy of \a other. Both refer to the same environment.
+*/
+QxtBdbEnvironment::QxtBdbEnvironment(const QxtBdbEnvironment & other) : qxt_d(other.qxt_d)
+{
+}
+
+/*!
+    Destroys the handle. The environment itself is closed with its last reference.
+*/
+QxtBdbEnvironment::~QxtBdbEnvironment()
+{
+}
+
+/*!
+    Makes this handle refer to the same environment as \a other.
+*/
+QxtBdbEnvironment & QxtBdbEnvironment::operator=(const QxtBdbEnvironment & other)
+{
+    qxt_d = other.qxt_d;
+    return *this;
+}
+
+/*!
+    Returns the size of the shared memory pool in bytes, or 0 for the BerkeleyDB default.
+*/
+qint64 QxtBdbEnvironment::cacheSize() const
+{
+    return qxt_d->cacheSize;
+}
+
+/*!
+    Sets the size of the shared memory pool to \a bytes. Must be called before open().
+*/
+void QxtBdbEnvironment::setCacheSize(qint64 bytes)
+{
+    if (qxt_d->isOpen)
+    {
+        qWarning("QxtBdbEnvironment::setCacheSize: the environment is already open");
+        return;
+    }
+    qxt_d->cacheSize = bytes;
+}
+
+/*!
+    Opens the environment in the directory \a home with \a flags, creating it if needed.
+    Database files opened in the environment are relative to \a home.
+
+    Returns \c true on success.
+*/
+bool QxtBdbEnvironment::open(const QString & home, OpenFlags flags)
+{
+    Q_ASSERT(!qxt_d->isOpen);
+
+    if (!QDir().mkpath(home))
+        return false;
+
+    if (qxt_d->env)
+        qxt_d->env->close(qxt_d->env, 0);
+    if (db_env_create(&qxt_d->env, 0) != 0)
+    {
+        qxt_d->env = 0;
+        return false;
+    }
+    BerkeleyDB::DB_ENV * env = qxt_d->env;
+    env->set_errcall(env, qxtBdbEnvironmentErrorHandler);
+
+    if (qxt_d->cacheSize > 0)
+    {
+        const qint64 gb = Q_INT64_C(1024) * 1024 * 1024;
+        env->set_cachesize(env, BerkeleyDB::u_int32_t(qxt_d->cacheSize / gb),
+                           BerkeleyDB::u_int32_t(qxt_d->cacheSize % gb), 0);
+    }
+
+    BerkeleyDB::u_int32_t f = DB_CREATE | DB_INIT_MPOOL | DB_THREAD;
+    if (flags & Transactions)
+    {
+        f |= DB_INIT_TXN | DB_INIT_LOG | DB_INIT_LOCK;
+        if (flags & Recover)
+            f |= DB_RECOVER;
+        if (flags & NoSyncOnCommit)
+            env->set_flags(env, DB_TXN_WRITE_NOSYNC, 1);
+        if (flags & MultiVersion)
+        {
+#ifdef DB_MULTIVERSION
+            // every database opened in the environment is opened with DB_MULTIVERSION
+            env->set_flags(env, DB_MULTIVERSION, 1);
+#else
+            qWarning("QxtBdbEnvironment::open: MultiVersion needs BerkeleyDB 4.5 or newer");
+            flags &= ~MultiVersion;
+#endif
+        }
+    }
+    else
+    {
+        flags &= ~MultiVersion;
+    }
+
+    qxt_d->isOpen = (env->open(env, QFile::encodeName(home).constData(), f, 0) == 0);
+    if (qxt_d->isOpen)
+    {
+        qxt_d->home = home;
+        qxt_d->flags = flags;
+    }
+    return qxt_d->isOpen;
+}
+
+/*!
+    Returns \c true if the environment has been opened successfully.
+*/
+bool QxtBdbEnvironment::isOpen() const
+{
+    return qxt_d->isOpen;
+}
+
+/*!
+    Returns the flags the environment was opened with.
+*/
+QxtBdbEnvironment::OpenFlags QxtBdbEnvironment::openFlags() const
+{
+    return qxt_d->flags;
+}
+
+/*!
+    Returns the home directory of the environment.
+*/
+QString QxtBdbEnvironment::home() const
+{
+    return qxt_d->home;
+}
+
+/*!
+    Writes all committed changes to the database files so the log up to this
+    point is no longer needed for recovery.
+*/
+bool QxtBdbEnvironment::checkpoint()
+{
+    if (!qxt_d->isOpen || !(qxt_d->flags & Transactions))
+        return false;
+    return (qxt_d->env->txn_checkpoint(qxt_d->env, 0, 0, 0) == 0);
+}
+
+/*!
+    Returns the BerkeleyDB handle, or 0 if the environment is not open.
+*/
+BerkeleyDB::DB_ENV * QxtBdbEnvironment::env() const
+{
+    return qxt_d->isOpen ? qxt_d->env : 0;
+}
@@ -0,0 +1,75 @@
+/****************************************************************************
+** Copyright (c) 2006 - 2011, the LibQxt project.
+** See the Qxt AUTHORS file for a list of authors and copyright holders.
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**     * Redistributions of source code must retain the above copyright
+**       notice, this list of conditions and the following disclaimer.
+**     * Redistributions in binary form must reproduce the above copyright
+**       notice, this list of conditions and the following disclaimer in the
+**       documentation and/or other materials provided with the distribution.
+**     * Neither the name of the LibQxt project nor the
+**       names of its contributors may be used to endorse or promote products
+**       derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+** ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+** DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+** (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+** LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+** ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** <http://libqxt.org>  <foundation@libqxt.org>
+*****************************************************************************/
+
+#ifndef QXTBDBENVIRONMENT_H
+#define QXTBDBENVIRONMENT_H
+
+#include "qxtbdb.h"
+#include <QExplicitlySharedDataPointer>
+#include <QString>
+
+class QxtBdbEnvironmentPrivate;
+
+class QXT_BERKELEY_EXPORT QxtBdbEnvironment
+{
+public:
+    enum OpenFlag
+    {
+        Transactions    = 0x1,
+        Recover         = 0x2,
+        NoSyncOnCommit  = 0x4,
+        MultiVersion    = 0x8
+    };
+    Q_DECLARE_FLAGS(OpenFlags, OpenFlag)
+
+    QxtBdbEnvironment();
+    QxtBdbEnvironment(const QxtBdbEnvironment & other);
+    ~QxtBdbEnvironment();
+    QxtBdbEnvironment & operator=(const QxtBdbEnvironment & other);
+
+    qint64 cacheSize() const;
+    void setCacheSize(qint64 bytes);
+
+    bool open(const QString & home, OpenFlags flags = Transactions);
+    bool isOpen() const;
+    OpenFlags openFlags() const;
+    QString home() const;
+
+    bool checkpoint();
+
+    BerkeleyDB::DB_ENV * env() const;
+
+private:
+    QExplicitlySharedDataPointer<QxtBdbEnvironmentPrivate> qxt_d;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(QxtBdbEnvironment::OpenFlags)
+
+#endif // QXTBDBENVIRONMENT_H
@@ -38,6 +38,13 @@
     \brief The QxtBdbHash class is a template class that provides key/value access to a berkeley db file.
 
     Both value and key must be registered with the qt meta system.
+    Keys and values are written through QxtBdbCodec: integers and floating point numbers
+    are stored big endian in an order preserving form, QString as UTF-8, QByteArray as is
+    and other types without constructors as their raw bytes. Everything else goes through
+    QDataStream. Since keys of the first kinds compare like their values, iterating from
+    begin() visits the pairs sorted by key. Specialize QxtBdbCodec to give your own types
+    a cheaper encoding.
+
     You may not touch the file while a QxtBdbHash instance is running on it.
 
     examples usage:
@@ -51,8 +58,15 @@
     There is an extensive example in /examples/berkeley/adressbook.
 
 
-    All functions of this class are thread safe.
-    Calling open() multiple times is undefined.
+    All functions of this class are thread safe, one QxtBdbHash can be shared by any number of
+    threads without additional locking. Lookups with value() and contains() reuse a cursor
+    per thread instead of opening a new one inside berkeley db every time. Transactions started
+    with transaction() or snapshot() belong to the calling thread only.
+    In a QxtBdbEnvironment with transactions, readers take read locks and wait for writers of the
+    same pages. Open the environment with QxtBdbEnvironment::MultiVersion and read inside snapshot()
+    to let readers and writers run past each other.
+
+    Calling open() multiple times is undefined. clear() must not run while other threads read.
     An iterator may only be used from one thread at once, but you can have multiple iterators.
 
     TODO: {implicitshared}
@@ -71,6 +85,12 @@
     Constructs a QxtBdbHash, and opens the \a file specified as its database.
 */
 
+/*!
+    \fn void QxtBdbHash::QxtBdbHash(const QxtBdbEnvironment & env, QString file)
+
+    Constructs a QxtBdbHash, and opens the \a file specified as its database inside the environment \a env.
+*/
+
 
 /*!
     \fn bool QxtBdbHash::open(QString file)
@@ -81,6 +101,16 @@
     \bold {Note:} A sanity check is performed before opening the file.
 */
 
+/*!
+    \fn bool QxtBdbHash::open(const QxtBdbEnvironment & env, QString file)
+
+    Opens the specified \a file inside the environment \a env. The file name is relative to the
+    environment's home directory. If the environment supports transactions, every write outside
+    of transaction() is committed on its own.
+
+    Returns \c true on success and \c false on failure.
+*/
+
 /*!
     \fn void QxtBdbHash::clear()
 
@@ -108,6 +138,43 @@
     \sa QxtBdbHashIterator
 */
 
+/*!
+    \fn QxtBdbHashIterator<KEY,VAL> QxtBdbHash::lowerBound ( const KEY & key )
+
+    Returns an iterator to the first pair whose key is not less than \a key in the order of the
+    encoded keys, or an invalid iterator if there is none.
+    \sa upperBound(), QxtBdbCodec
+*/
+
+/*!
+    \fn QxtBdbHashIterator<KEY,VAL> QxtBdbHash::upperBound ( const KEY & key )
+
+    Returns an iterator to the first pair whose key is greater than \a key, or an invalid iterator if there is none.
+    \sa lowerBound()
+*/
+
+/*!
+    \fn QxtBdbHashScan<KEY,VAL> QxtBdbHash::scan() const
+
+    Returns a scan over all pairs in key order. Scans fetch many pairs per call into one
+    buffer and decode keys and values only when asked for, which makes them much faster
+    than iterators for reading large parts of the database.
+    \sa QxtBdbHashScan
+*/
+
+/*!
+    \fn QxtBdbHashScan<KEY,VAL> QxtBdbHash::scan(const KEY & from, const KEY & to) const
+
+    Returns a scan over the pairs with keys from \a from up to, but not including, \a to.
+*/
+
+/*!
+    \fn QxtBdbHashScan<KEY,VAL> QxtBdbHash::scanPrefix(const KEY & prefix) const
+
+    Returns a scan over the pairs whose encoded key starts with the encoded \a prefix.
+    This is meaningful for QString and QByteArray keys, where it selects all keys starting with \a prefix.
+*/
+
 /*!
     \fn bool QxtBdbHash::contains ( const KEY & key ) const
 
@@ -121,7 +188,7 @@
 */
 
 /*!
-    \fn bool QxtBdbHash::insert( KEY key, VAL value )
+    \fn bool QxtBdbHash::insert( const KEY & key, const VAL & value )
 
     Inserts a record with the specified \a key / \a value combination. Replaces any record with the same key.
     \bold {Note:} When working with iterators, keep in mind that inserting pairs, works reverse to the iteration.
@@ -139,12 +206,106 @@
     Same as value()
 */
 
+/*!
+    \fn bool QxtBdbHash::load(const QList<QPair<KEY, VAL> > & pairs)
+
+    Inserts all \a pairs at once. This is much faster than calling insert() for every pair when
+    filling a database: the records are sorted by their encoded keys and handed to berkeley db in
+    large bulk buffers. Pairs with equal keys are written in the order given, so the last one wins.
+
+    If no transaction() is active and the hash was opened in an environment with transactions,
+    every bulk buffer is committed on its own, so a crash loses at most the buffer being written.
+    Loading huge data sets should be done in chunks of a few hundred thousand pairs.
+
+    Returns \c true on success and \c false on failure.
+*/
+
+/*!
+    \fn bool QxtBdbHash::transaction()
+
+    Starts a transaction for the calling thread. All its reads and writes up to commit() or rollback()
+    belong to it, which also saves writing the log to disk for every single insert(). Other threads
+    keep working outside of it. Only available if the hash was opened in a QxtBdbEnvironment with transactions.
+
+    Iterators created inside the transaction must be destroyed before it ends.
+
+    Returns \c true on success and \c false on failure.
+    \sa commit(), rollback()
+*/
+
+/*!
+    \fn bool QxtBdbHash::snapshot()
+
+    Starts a read only transaction for the calling thread that sees the hash as it was at this point.
+    Readers in a snapshot take no locks, so they never wait for writers and writers never wait for
+    them. End it with commit() to see newer data again. Only available in a QxtBdbEnvironment opened
+    with QxtBdbEnvironment::MultiVersion.
+
+    \code
+    hash.snapshot();
+    foreach (int key, keys)
+        total += hash.value(key);
+    hash.commit();
+    \endcode
+
+    Returns \c true on success and \c false on failure.
+    \sa transaction()
+*/
+
+/*!
+    \fn bool QxtBdbHash::commit()
+
+    Commits the running transaction. Returns \c true on success and \c false on failure.
+    \sa transaction()
+*/
+
+/*!
+    \fn bool QxtBdbHash::rollback()
+
+    Discards all changes made since transaction(). Returns \c true on success and \c false on failure.
+    \sa transaction()
+*/
+
 /*!
     \fn bool QxtBdbHash::flush()
 
     Flushes the underlying DB file. All changes are synced to disk.
 */
 
+/*!
+    \fn void QxtBdbHash::setCacheSize(int bytes)
+
+    Keeps up to about \a bytes of recently read values in memory, already decoded, so value() does not
+    go to berkeley db for keys that are read again and again. Each entry counts with the size of its
+    encoded key and value. 0 turns the cache off, which is the default.
+
+    The cache is split into shards with their own lock, so concurrent readers rarely wait for each other.
+    insert(), remove(), clear(), load(), commit() and QxtBdbHashIterator::erase() keep it up to date.
+    Changes made through another QxtBdbHash on the same file or by another process are not seen
+    until the entry is evicted. Inside a transaction() or snapshot() the cache is bypassed.
+
+    Call this before sharing the hash between threads. The cached values are discarded.
+    \sa cacheHits(), cacheMisses()
+*/
+
+/*!
+    \fn int QxtBdbHash::cacheSize() const
+
+    Returns the maximum size of the value cache in bytes, or 0 if there is none.
+*/
+
+/*!
+    \fn quint64 QxtBdbHash::cacheHits() const
+
+    Returns how many calls to value() were answered from the cache.
+*/
+
+/*!
+    \fn quint64 QxtBdbHash::cacheMisses() const
+
+    Returns how many calls to value() had to read from the database while the cache was enabled.
+*/
+
 
 
 
@@ -268,3 +429,60 @@
 
     This instance is invalid then, and cannot be used further.
 */
+
+/*!
+    \class QxtBdbHashScan
+    \inmodule QxtBerkeley
+    \brief The QxtBdbHashScan class reads ranges of a QxtBdbHash in bulk
+
+    A scan walks forward through the pairs of a QxtBdbHash in key order. It fetches
+    as many records as fit into a one megabyte buffer at once, and key() and value()
+    decode only the part that is asked for, so reading just the keys costs no value decoding.
+
+    \code
+    QxtBdbHashScan<QString, int> scan = hash.scanPrefix("user/");
+    while (scan.next())
+        qDebug() << scan.key() << scan.value();
+    \endcode
+
+    Copies of a scan share their position. A scan holds a cursor until it reaches its
+    end or close() is called, which must happen before the transaction it was created in ends.
+
+    \sa QxtBdbHash::scan(), QxtBdbHashIterator
+*/
+
+/*!
+    \fn QxtBdbHashScan<KEY,VAL>::QxtBdbHashScan()
+
+    Constructs an empty scan.
+*/
+
+/*!
+    \fn bool QxtBdbHashScan<KEY,VAL>::next()
+
+    Advances to the next pair. Returns \c false when there are no more pairs in the range.
+*/
+
+/*!
+    \fn bool QxtBdbHashScan<KEY,VAL>::isValid() const
+
+    Returns \c true if the scan is positioned on a pair.
+*/
+
+/*!
+    \fn KEY QxtBdbHashScan<KEY,VAL>::key() const
+
+    Returns the key of the current pair.
+*/
+
+/*!
+    \fn VAL QxtBdbHashScan<KEY,VAL>::value() const
+
+    Returns the value of the current pair.
+*/
+
+/*!
+    \fn void QxtBdbHashScan<KEY,VAL>::close()
+
+    Ends the scan and releases its cursor.
+*/
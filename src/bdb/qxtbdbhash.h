@@ -33,41 +33,176 @@
 #define QxtBdbHash_H_kpasd
 
 #include "qxtbdb.h"
+#include "qxtbdbcodec.h"
+#include "qxtbdbenvironment.h"
 #include <QBuffer>
 #include <QDataStream>
 #include <QVariant>
+#include <QCache>
+#include <QHash>
+#include <QMutex>
 #include <qxtsharedprivate.h>
+#include <QExplicitlySharedDataPointer>
 #include <qxtglobal.h>
 
 
 template<class KEY, class VAL>
 class QxtBdbHashIterator;
 
+template<class KEY, class VAL>
+class QxtBdbHashScan;
+
+/*
+    Decoded values of a QxtBdbHash by encoded key, split into shards with their own lock and LRU list
+    so concurrent readers rarely meet. A lookup that misses remembers the generation of its shard and
+    only stores the value it read from the database if no write invalidated the shard in the meantime.
+*/
+template<class VAL>
+class QxtBdbHashCache : public QSharedData
+{
+public:
+    enum { Shards = 16 };
+
+    explicit QxtBdbHashCache(int bytes) : maxCost(bytes)
+    {
+        for (int i = 0; i < Shards; i++)
+            shards[i].cache.setMaxCost(qMax(1, bytes / Shards));
+    }
+
+    bool find(const QByteArray & key, VAL & value, quint32 * generation)
+    {
+        Shard & s = shard(key);
+        QMutexLocker locker(&s.mutex);
+        if (const VAL * v = s.cache.object(key))
+        {
+            s.hits++;
+            value = *v;
+            return true;
+        }
+        s.misses++;
+        *generation = s.generation;
+        return false;
+    }
+
+    void store(const QByteArray & key, const VAL & value, int size, quint32 generation)
+    {
+        Shard & s = shard(key);
+        QMutexLocker locker(&s.mutex);
+        if (s.generation == generation)
+            s.cache.insert(QByteArray(key.constData(), key.size()), new VAL(value), key.size() + size + int(sizeof(VAL)));
+    }
+
+    void invalidate(const QByteArray & key)
+    {
+        Shard & s = shard(key);
+        QMutexLocker locker(&s.mutex);
+        s.generation++;
+        s.cache.remove(key);
+    }
+
+    void invalidateAll()
+    {
+        for (int i = 0; i < Shards; i++)
+        {
+            QMutexLocker locker(&shards[i].mutex);
+            shards[i].generation++;
+            shards[i].cache.clear();
+        }
+    }
+
+    quint64 hits()
+    {
+        quint64 n = 0;
+        for (int i = 0; i < Shards; i++)
+        {
+            QMutexLocker locker(&shards[i].mutex);
+            n += shards[i].hits;
+        }
+        return n;
+    }
+
+    quint64 misses()
+    {
+        quint64 n = 0;
+        for (int i = 0; i < Shards; i++)
+        {
+            QMutexLocker locker(&shards[i].mutex);
+            n += shards[i].misses;
+        }
+        return n;
+    }
+
+    const int maxCost;
+
+private:
+    Q_DISABLE_COPY(QxtBdbHashCache)
+
+    struct Shard
+    {
+        Shard() : generation(0), hits(0), misses(0) {}
+        QMutex mutex;
+        QCache<QByteArray, VAL> cache;
+        quint32 generation;
+        quint64 hits;
+        quint64 misses;
+    };
+
+    Shard & shard(const QByteArray & key)
+    {
+        return shards[qHash(key) % Shards];
+    }
+
+    Shard shards[Shards];
+};
+
 template<class KEY, class VAL>
 class /*QXT_BERKELEY_EXPORT*/ QxtBdbHash
 {
 public:
     QxtBdbHash();
     QxtBdbHash(QString file);
+    QxtBdbHash(const QxtBdbEnvironment & env, QString file);
     bool open(QString file);
+    bool open(const QxtBdbEnvironment & env, QString file);
 
     QxtBdbHashIterator<KEY, VAL> begin();
     QxtBdbHashIterator<KEY, VAL> end();
     QxtBdbHashIterator<KEY, VAL> find(const KEY & key);
+    QxtBdbHashIterator<KEY, VAL> lowerBound(const KEY & key);
+    QxtBdbHashIterator<KEY, VAL> upperBound(const KEY & key);
+
+    QxtBdbHashScan<KEY, VAL> scan() const;
+    QxtBdbHashScan<KEY, VAL> scan(const KEY & from, const KEY & to) const;
+    QxtBdbHashScan<KEY, VAL> scanPrefix(const KEY & prefix) const;
 
     void clear();
     bool contains(const KEY & key) const;
     bool remove(const KEY & key);
-    bool insert(KEY k, VAL v);
+    bool insert(const KEY & k, const VAL & v);
     const VAL value(const KEY & key) const;
     const VAL operator[](const KEY & key) const;
+    bool load(const QList<QPair<KEY, VAL> > & pairs);
+
+    bool transaction();
+    bool snapshot();
+    bool commit();
+    bool rollback();
 
     bool flush();
 
+    void setCacheSize(int bytes);
+    int cacheSize() const;
+    quint64 cacheHits() const;
+    quint64 cacheMisses() const;
+
 private:
+    QxtBdbHashCache<VAL> * readCache() const;
+    void invalidate(const QxtBdbData & key);
+
     int meta_id_key;
     int meta_id_val;
     QxtSharedPrivate<QxtBdb> qxt_d;
+    QExplicitlySharedDataPointer<QxtBdbHashCache<VAL> > cache;
 };
 
 
@@ -120,8 +255,9 @@ public:
 
 private:
     friend class QxtBdbHash<KEY, VAL>;
-    QxtBdbHashIterator(BerkeleyDB::DBC*, QxtBdb * p);
+    QxtBdbHashIterator(BerkeleyDB::DBC*, QxtBdb * p, QxtBdbHashCache<VAL> * cache = 0);
     QxtSharedPrivate<QxtBdbHashIteratorPrivate> qxt_d;
+    QExplicitlySharedDataPointer<QxtBdbHashCache<VAL> > cache;
 
     int meta_id_key;
     int meta_id_val;
@@ -139,6 +275,45 @@ private:
 
 
 
+template<class KEY, class VAL>
+class QxtBdbHashScan
+{
+public:
+    QxtBdbHashScan() {}
+
+    bool next()
+    {
+        return qxt_d && qxt_d->next();
+    }
+    bool isValid() const
+    {
+        return qxt_d && qxt_d->key;
+    }
+    KEY key() const
+    {
+        KEY k;
+        if (!isValid() || !QxtBdbCodec<KEY>::decode(qxt_d->key, qxt_d->keySize, k))
+            return KEY();
+        return k;
+    }
+    VAL value() const
+    {
+        VAL v;
+        if (!isValid() || !QxtBdbCodec<VAL>::decode(qxt_d->value, qxt_d->valueSize, v))
+            return VAL();
+        return v;
+    }
+    void close()
+    {
+        if (qxt_d)
+            qxt_d->close();
+    }
+
+private:
+    friend class QxtBdbHash<KEY, VAL>;
+    explicit QxtBdbHashScan(QxtBdbBulkReader * reader) : qxt_d(reader) {}
+    QExplicitlySharedDataPointer<QxtBdbBulkReader> qxt_d;
+};
 
 
 
@@ -175,12 +350,30 @@ QxtBdbHash<KEY, VAL>::QxtBdbHash(QString file)
     meta_id_val = qMetaTypeId<VAL>();
 }
 
+template<class KEY, class VAL>
+QxtBdbHash<KEY, VAL>::QxtBdbHash(const QxtBdbEnvironment & env, QString file)
+{
+    qxt_d = new QxtBdb();
+    open(env, file);
+
+    meta_id_key = qMetaTypeId<KEY>();
+    meta_id_val = qMetaTypeId<VAL>();
+}
+
 template<class KEY, class VAL>
 bool QxtBdbHash<KEY, VAL>::open(QString file)
 {
     return qxt_d().open(file, QxtBdb::CreateDatabase | QxtBdb::LockFree);
 }
 
+template<class KEY, class VAL>
+bool QxtBdbHash<KEY, VAL>::open(const QxtBdbEnvironment & env, QString file)
+{
+    if (!qxt_d().setEnvironment(env))
+        return false;
+    return qxt_d().open(file, QxtBdb::CreateDatabase | QxtBdb::LockFree);
+}
+
 
 
 
@@ -188,33 +381,35 @@ template<class KEY, class VAL>
 QxtBdbHashIterator<KEY, VAL> QxtBdbHash<KEY, VAL>::begin()
 {
     BerkeleyDB::DBC *cursor;
-    qxt_d().db->cursor(qxt_d().db, NULL, &cursor, 0);
-    if (qxt_d().get((void*)0, 0, 0, 0, DB_FIRST, cursor))
-        return QxtBdbHashIterator<KEY, VAL>(cursor, &qxt_d());
-    else
-        return QxtBdbHashIterator<KEY, VAL>();
+    qxt_d().db->cursor(qxt_d().db, qxt_d().transaction(), &cursor, 0);
+    if (qxt_d().move(cursor, DB_FIRST))
+        return QxtBdbHashIterator<KEY, VAL>(cursor, &qxt_d(), cache.data());
+    cursor->c_close(cursor);
+    return QxtBdbHashIterator<KEY, VAL>();
 }
 
 template<class KEY, class VAL>
 QxtBdbHashIterator<KEY, VAL> QxtBdbHash<KEY, VAL>::end()
 {
     BerkeleyDB::DBC *cursor;
-    qxt_d().db->cursor(qxt_d().db, NULL, &cursor, 0);
-    if (qxt_d().get((void*)0, 0, 0, 0, DB_LAST, cursor))
-        return QxtBdbHashIterator<KEY, VAL>(cursor, &qxt_d());
-    else
-        return QxtBdbHashIterator<KEY, VAL>();
+    qxt_d().db->cursor(qxt_d().db, qxt_d().transaction(), &cursor, 0);
+    if (qxt_d().move(cursor, DB_LAST))
+        return QxtBdbHashIterator<KEY, VAL>(cursor, &qxt_d(), cache.data());
+    cursor->c_close(cursor);
+    return QxtBdbHashIterator<KEY, VAL>();
 }
 
 template<class KEY, class VAL>
 QxtBdbHashIterator<KEY, VAL> QxtBdbHash<KEY, VAL>::find(const KEY & k)
 {
     BerkeleyDB::DBC *cursor;
-    qxt_d().db->cursor(qxt_d().db, NULL, &cursor, 0);
-    if (qxt_d().get(&k, meta_id_key, 0, 0, DB_SET, cursor))
-        return QxtBdbHashIterator<KEY, VAL>(cursor, &qxt_d());
-    else
-        return QxtBdbHashIterator<KEY, VAL>();
+    qxt_d().db->cursor(qxt_d().db, qxt_d().transaction(), &cursor, 0);
+    QxtBdbData d_key;
+    QxtBdbCodec<KEY>::encode(k, d_key);
+    if (qxt_d().fetch(cursor, &d_key, 0, DB_SET))
+        return QxtBdbHashIterator<KEY, VAL>(cursor, &qxt_d(), cache.data());
+    cursor->c_close(cursor);
+    return QxtBdbHashIterator<KEY, VAL>();
 }
 
 
@@ -222,14 +417,81 @@ QxtBdbHashIterator<KEY, VAL> QxtBdbHash<KEY, VAL>::find(const KEY & k)
 
 
 
+template<class KEY, class VAL>
+QxtBdbHashIterator<KEY, VAL> QxtBdbHash<KEY, VAL>::lowerBound(const KEY & k)
+{
+    BerkeleyDB::DBC *cursor;
+    qxt_d().db->cursor(qxt_d().db, qxt_d().transaction(), &cursor, 0);
+    QxtBdbData d_key;
+    QxtBdbCodec<KEY>::encode(k, d_key);
+    if (qxt_d().fetch(cursor, &d_key, 0, DB_SET_RANGE))
+        return QxtBdbHashIterator<KEY, VAL>(cursor, &qxt_d(), cache.data());
+    cursor->c_close(cursor);
+    return QxtBdbHashIterator<KEY, VAL>();
+}
+
+template<class KEY, class VAL>
+QxtBdbHashIterator<KEY, VAL> QxtBdbHash<KEY, VAL>::upperBound(const KEY & k)
+{
+    BerkeleyDB::DBC *cursor;
+    qxt_d().db->cursor(qxt_d().db, qxt_d().transaction(), &cursor, 0);
+    QxtBdbData d_key, found;
+    QxtBdbCodec<KEY>::encode(k, d_key);
+    found.append(d_key.constData(), d_key.size());
+    // DB_SET_RANGE lands on the key itself if it exists, keys are unique so one step is enough
+    if (qxt_d().fetch(cursor, &found, 0, DB_SET_RANGE)
+            && (found.size() != d_key.size() || ::memcmp(found.constData(), d_key.constData(), d_key.size()) != 0
+                || qxt_d().move(cursor, DB_NEXT)))
+        return QxtBdbHashIterator<KEY, VAL>(cursor, &qxt_d(), cache.data());
+    cursor->c_close(cursor);
+    return QxtBdbHashIterator<KEY, VAL>();
+}
+
+template<class KEY, class VAL>
+QxtBdbHashScan<KEY, VAL> QxtBdbHash<KEY, VAL>::scan() const
+{
+    if (!qxt_d().isOpen)
+        return QxtBdbHashScan<KEY, VAL>();
+    return QxtBdbHashScan<KEY, VAL>(new QxtBdbBulkReader(&qxt_d()));
+}
+
+template<class KEY, class VAL>
+QxtBdbHashScan<KEY, VAL> QxtBdbHash<KEY, VAL>::scan(const KEY & from, const KEY & to) const
+{
+    if (!qxt_d().isOpen)
+        return QxtBdbHashScan<KEY, VAL>();
+    QxtBdbData d_from, d_to;
+    QxtBdbCodec<KEY>::encode(from, d_from);
+    QxtBdbCodec<KEY>::encode(to, d_to);
+    QxtBdbBulkReader * reader = new QxtBdbBulkReader(&qxt_d());
+    reader->setLowerBound(QByteArray(d_from.constData(), d_from.size()));
+    reader->setUpperBound(QByteArray(d_to.constData(), d_to.size()));
+    return QxtBdbHashScan<KEY, VAL>(reader);
+}
+
+template<class KEY, class VAL>
+QxtBdbHashScan<KEY, VAL> QxtBdbHash<KEY, VAL>::scanPrefix(const KEY & prefix) const
+{
+    if (!qxt_d().isOpen)
+        return QxtBdbHashScan<KEY, VAL>();
+    QxtBdbData d_prefix;
+    QxtBdbCodec<KEY>::encode(prefix, d_prefix);
+    QxtBdbBulkReader * reader = new QxtBdbBulkReader(&qxt_d());
+    reader->setPrefix(QByteArray(d_prefix.constData(), d_prefix.size()));
+    return QxtBdbHashScan<KEY, VAL>(reader);
+}
+
 template<class KEY, class VAL>
 void QxtBdbHash<KEY, VAL>::clear()
 {
     if (!qxt_d().isOpen)
         return;
 
+    qxt_d().releaseCursors();
     BerkeleyDB::u_int32_t x;
-    qxt_d().db->truncate(qxt_d().db, NULL, &x, 0);
+    qxt_d().db->truncate(qxt_d().db, qxt_d().transaction(), &x, 0);
+    if (cache)
+        cache->invalidateAll();
 
 }
 
@@ -240,25 +502,9 @@ bool QxtBdbHash<KEY, VAL>::contains(const KEY & k) const
     if (!qxt_d().isOpen)
         return false;
 
-    BerkeleyDB::DBT key;
-    /* Zero out the DBTs before using them. */
-    memset(&key, 0, sizeof(BerkeleyDB::DBT));
-
-    QByteArray d_key;
-    {
-        QBuffer buffer(&d_key);
-        buffer.open(QIODevice::WriteOnly);
-        QDataStream s(&buffer);
-        if (!QMetaType::save(s, meta_id_key, &k))
-            qCritical("QMetaType::save failed. is your type registered with the QMetaType?");
-
-        buffer.close();
-    }
-
-    key.data = d_key.data();
-    key.size = d_key.size();
-
-    return (qxt_d().db->exists(qxt_d().db, NULL, &key, 0) == 0);
+    QxtBdbData d_key;
+    QxtBdbCodec<KEY>::encode(k, d_key);
+    return qxt_d().lookup(&d_key, 0);
 }
 
 template<class KEY, class VAL>
@@ -267,70 +513,31 @@ bool QxtBdbHash<KEY, VAL>::remove(const KEY & k)
     if (!qxt_d().isOpen)
         return false;
 
-    BerkeleyDB::DBT key;
-    /* Zero out the DBTs before using them. */
-    memset(&key, 0, sizeof(BerkeleyDB::DBT));
-
-    QByteArray d_key;
-    {
-        QBuffer buffer(&d_key);
-        buffer.open(QIODevice::WriteOnly);
-        QDataStream s(&buffer);
-        if (!QMetaType::save(s, meta_id_key, &k))
-            qCritical("QMetaType::save failed. is your type registered with the QMetaType?");
-
-        buffer.close();
-    }
+    QxtBdbData d_key;
+    QxtBdbCodec<KEY>::encode(k, d_key);
+    BerkeleyDB::DBT key = d_key.dbt();
 
-    key.data = d_key.data();
-    key.size = d_key.size();
-
-
-    return (qxt_d().db->del(qxt_d().db, NULL, &key, 0) == 0);
+    const bool ok = (qxt_d().db->del(qxt_d().db, qxt_d().transaction(), &key, 0) == 0);
+    invalidate(d_key);
+    return ok;
 }
 
 
 
 template<class KEY, class VAL>
-bool QxtBdbHash<KEY, VAL>::insert(KEY k, VAL v)
+bool QxtBdbHash<KEY, VAL>::insert(const KEY & k, const VAL & v)
 {
     if (!qxt_d().isOpen)
         return false;
 
-    QByteArray d_key, d_value;
-
-    {
-        QBuffer buffer(&d_key);
-        buffer.open(QIODevice::WriteOnly);
-        QDataStream s(&buffer);
-        if (!QMetaType::save(s, meta_id_key, &k))
-            qCritical("QMetaType::save failed. is your type registered with the QMetaType?");
-
-        buffer.close();
-    }
-    {
-        QBuffer buffer(&d_value);
-        buffer.open(QIODevice::WriteOnly);
-        QDataStream s(&buffer);
-        if (!QMetaType::save(s, meta_id_val, &v))
-            qCritical("QMetaType::save failed. is your value registered with the QMetaType?");
-
-        buffer.close();
-    }
-
-    BerkeleyDB::DBT key, value;
-    /* Zero out the DBTs before using them. */
-    memset(&key, 0,  sizeof(BerkeleyDB::DBT));
-    memset(&value, 0, sizeof(BerkeleyDB::DBT));
-
-    key.data = d_key.data();
-    key.size = d_key.size();
+    QxtBdbData d_key, d_value;
+    QxtBdbCodec<KEY>::encode(k, d_key);
+    QxtBdbCodec<VAL>::encode(v, d_value);
 
-    value.data = d_value.data();
-    value.size = d_value.size();
-
-
-    int ret = qxt_d().db->put(qxt_d().db, NULL, &key, &value, 0);
+    BerkeleyDB::DBT key = d_key.dbt();
+    BerkeleyDB::DBT value = d_value.dbt();
+    int ret = qxt_d().db->put(qxt_d().db, qxt_d().transaction(), &key, &value, 0);
+    invalidate(d_key);
     return (ret == 0);
 
 }
@@ -343,9 +550,20 @@ const VAL QxtBdbHash<KEY, VAL>::value(const KEY & k) const
     if (!qxt_d().isOpen)
         return VAL() ;
 
+    QxtBdbData d_key, d_value;
+    QxtBdbCodec<KEY>::encode(k, d_key);
     VAL v;
-    if (!qxt_d().get(&k, meta_id_key, &v, meta_id_val))
+
+    QxtBdbHashCache<VAL> * c = readCache();
+    const QByteArray cacheKey = c ? QByteArray::fromRawData(d_key.constData(), d_key.size()) : QByteArray();
+    quint32 generation = 0;
+    if (c && c->find(cacheKey, v, &generation))
+        return v;
+
+    if (!qxt_d().lookup(&d_key, &d_value) || !QxtBdbCodec<VAL>::decode(d_value.constData(), d_value.size(), v))
         return VAL();
+    if (c)
+        c->store(cacheKey, v, d_value.size(), generation);
     return v;
 }
 
@@ -356,12 +574,105 @@ const VAL QxtBdbHash<KEY, VAL>::operator[](const KEY & key) const
 }
 
 
+template<class KEY, class VAL>
+bool QxtBdbHash<KEY, VAL>::load(const QList<QPair<KEY, VAL> > & pairs)
+{
+    if (!qxt_d().isOpen)
+        return false;
+
+    QVector<QPair<QByteArray, QByteArray> > records(pairs.count());
+    for (int i = 0; i < pairs.count(); i++)
+    {
+        QxtBdbData d_key, d_value;
+        QxtBdbCodec<KEY>::encode(pairs.at(i).first, d_key);
+        QxtBdbCodec<VAL>::encode(pairs.at(i).second, d_value);
+        records[i].first = QByteArray(d_key.constData(), d_key.size());
+        records[i].second = QByteArray(d_value.constData(), d_value.size());
+    }
+    const bool ok = qxt_d().load(records);
+    if (cache)
+        cache->invalidateAll();
+    return ok;
+}
+
+template<class KEY, class VAL>
+bool QxtBdbHash<KEY, VAL>::transaction()
+{
+    return qxt_d().beginTransaction();
+}
+
+template<class KEY, class VAL>
+bool QxtBdbHash<KEY, VAL>::snapshot()
+{
+    return qxt_d().beginTransaction(true);
+}
+
+template<class KEY, class VAL>
+bool QxtBdbHash<KEY, VAL>::commit()
+{
+    // the cache only holds committed values, the writes of the transaction just became visible
+    const bool wrote = !qxt_d().isSnapshot();
+    const bool ok = qxt_d().commitTransaction();
+    if (cache && wrote)
+        cache->invalidateAll();
+    return ok;
+}
+
+template<class KEY, class VAL>
+bool QxtBdbHash<KEY, VAL>::rollback()
+{
+    return qxt_d().rollbackTransaction();
+}
+
 template<class KEY, class VAL>
 bool QxtBdbHash<KEY, VAL>::flush()
 {
     return qxt_d().flush();
 }
 
+template<class KEY, class VAL>
+void QxtBdbHash<KEY, VAL>::setCacheSize(int bytes)
+{
+    if (bytes > 0)
+        cache = new QxtBdbHashCache<VAL>(bytes);
+    else
+        cache = 0;
+}
+
+template<class KEY, class VAL>
+int QxtBdbHash<KEY, VAL>::cacheSize() const
+{
+    return cache ? cache->maxCost : 0;
+}
+
+template<class KEY, class VAL>
+quint64 QxtBdbHash<KEY, VAL>::cacheHits() const
+{
+    return cache ? cache->hits() : 0;
+}
+
+template<class KEY, class VAL>
+quint64 QxtBdbHash<KEY, VAL>::cacheMisses() const
+{
+    return cache ? cache->misses() : 0;
+}
+
+template<class KEY, class VAL>
+QxtBdbHashCache<VAL> * QxtBdbHash<KEY, VAL>::readCache() const
+{
+    // inside a transaction a thread has to see its own writes, or its snapshot
+    if (!cache || qxt_d().transaction())
+        return 0;
+    return cache.data();
+}
+
+template<class KEY, class VAL>
+void QxtBdbHash<KEY, VAL>::invalidate(const QxtBdbData & key)
+{
+    if (cache)
+        cache->invalidate(QByteArray::fromRawData(key.constData(), key.size()));
+}
+
 
 
 
@@ -392,6 +703,7 @@ QxtBdbHashIterator<KEY, VAL>::QxtBdbHashIterator(const QxtBdbHashIterator<KEY, V
 {
     ///FIXME: possible leaking, since the other isnt properly destructed?
     qxt_d = other.qxt_d;
+    cache = other.cache;
     meta_id_key = qMetaTypeId<KEY>();
     meta_id_val = qMetaTypeId<VAL>();
 
@@ -402,6 +714,7 @@ QxtBdbHashIterator<KEY, VAL> & QxtBdbHashIterator<KEY, VAL>::operator= (const Qx
 {
     ///FIXME: possible leaking, since the other isnt properly destructed?
     qxt_d = other.qxt_d;
+    cache = other.cache;
     return *this;
 }
 
@@ -425,8 +738,9 @@ KEY     QxtBdbHashIterator<KEY, VAL>::key() const
 
     if (!isValid())
         return KEY();
+    QxtBdbData d_key;
     KEY k;
-    if (qxt_d().db->get(&k, meta_id_key, 0, 0, DB_CURRENT, qxt_d().dbc))
+    if (qxt_d().db->fetch(qxt_d().dbc, &d_key, 0, DB_CURRENT) && QxtBdbCodec<KEY>::decode(d_key.constData(), d_key.size(), k))
         return k;
     else
         return KEY();
@@ -439,8 +753,9 @@ VAL   QxtBdbHashIterator<KEY, VAL>::value() const
     if (!isValid())
         return VAL();
 
+    QxtBdbData d_value;
     VAL v;
-    if (qxt_d().db->get((void*)0, 0, &v, meta_id_val, DB_CURRENT, qxt_d().dbc))
+    if (qxt_d().db->fetch(qxt_d().dbc, 0, &d_value, DB_CURRENT) && QxtBdbCodec<VAL>::decode(d_value.constData(), d_value.size(), v))
         return v;
     else
         return VAL();
@@ -466,7 +781,7 @@ QxtBdbHashIterator<KEY, VAL> &  QxtBdbHashIterator<KEY, VAL>::operator ++ () /*p
     if (!isValid())
         return *this;
 
-    if (!qxt_d().db->get((void*)0, 0, 0, 0, DB_NEXT, qxt_d().dbc))
+    if (!qxt_d().db->move(qxt_d().dbc, DB_NEXT))
     {
         qxt_d().invalidate();
     }
@@ -516,7 +831,7 @@ QxtBdbHashIterator<KEY, VAL> &  QxtBdbHashIterator<KEY, VAL>::operator -- ()  /*
     if (!isValid())
         return *this;
 
-    if (!qxt_d().db->get((void*)0, 0, 0, 0, DB_PREV, qxt_d().dbc))
+    if (!qxt_d().db->move(qxt_d().dbc, DB_PREV))
         qxt_d().invalidate();
 
     return *this;
@@ -554,8 +869,13 @@ QxtBdbHashIterator<KEY, VAL> QxtBdbHashIterator<KEY, VAL>::erase()
 {
     BerkeleyDB::DBC * newdbc;
     qxt_d().dbc->c_dup(qxt_d().dbc, &newdbc, DB_POSITION);
-    QxtBdbHashIterator<KEY, VAL> d(newdbc, qxt_d().db);
+    QxtBdbHashIterator<KEY, VAL> d(newdbc, qxt_d().db, cache.data());
+    QxtBdbData d_key;
+    if (cache)
+        qxt_d().db->fetch(qxt_d().dbc, &d_key, 0, DB_CURRENT);
     qxt_d().dbc->del(qxt_d().dbc, NULL);
+    if (cache)
+        cache->invalidate(QByteArray::fromRawData(d_key.constData(), d_key.size()));
     ++d;
 
     qxt_d().invalidate();
@@ -563,7 +883,8 @@ QxtBdbHashIterator<KEY, VAL> QxtBdbHashIterator<KEY, VAL>::erase()
 }
 
 template<class KEY, class VAL>
-QxtBdbHashIterator<KEY, VAL>::QxtBdbHashIterator(BerkeleyDB::DBC* dbc, QxtBdb * p)
+QxtBdbHashIterator<KEY, VAL>::QxtBdbHashIterator(BerkeleyDB::DBC* dbc, QxtBdb * p, QxtBdbHashCache<VAL> * c)
+    : cache(c)
 {
     qxt_d = new QxtBdbHashIteratorPrivate;
     qxt_d().dbc = dbc;
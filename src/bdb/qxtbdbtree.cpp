@@ -36,6 +36,7 @@
     \brief The QxtBdbTree class is a template berkeley container for tree structured data
 
     The template argument must be registered with the Qt meta system.
+    Values are written through QxtBdbCodec, see QxtBdbHash for the encodings used.
     You may not touch the file while a QxtBdbTree instance is running on it.
 
     Example usage:
@@ -73,6 +74,19 @@
     \bold {Note:} a sanity check is performed before opening the file.
 */
 
+/*!
+    \fn QxtBdbTree<T>::QxtBdbTree (const QxtBdbEnvironment & env, QString file)
+    Constructs a QxtBdbTree, and opens the \a file specified as its database inside the environment \a env.
+*/
+
+/*!
+    \fn bool QxtBdbTree<T>::open (const QxtBdbEnvironment & env, QString file)
+    Opens the specified \a file inside the environment \a env. The file name is relative to the
+    environment's home directory.
+
+    Returns \c true on success and \c false on failure.
+*/
+
 /*!
     \fn void QxtBdbTree<T>::clear()
     Erase all records. This does not delete the underlying file.
@@ -36,6 +36,8 @@
 #include <QPair>
 #include <QDebug>
 #include "qxtbdb.h"
+#include "qxtbdbcodec.h"
+#include "qxtbdbenvironment.h"
 
 
 template<class T>
@@ -48,7 +50,9 @@ class QxtBdbTree
 public:
     QxtBdbTree();
     QxtBdbTree(QString file);
+    QxtBdbTree(const QxtBdbEnvironment & env, QString file);
     bool open(QString file);
+    bool open(const QxtBdbEnvironment & env, QString file);
     void clear();
     bool flush();
     QxtBdbTreeIterator<T> root() const;
@@ -83,6 +87,22 @@ QxtBdbTree<T>::QxtBdbTree(QString file)
 }
 
 
+template<class T>
+QxtBdbTree<T>::QxtBdbTree(const QxtBdbEnvironment & env, QString file)
+{
+    meta_id = qMetaTypeId<T>();
+    qxt_d = new QxtBdb;
+    open(env, file);
+}
+
+template<class T>
+bool QxtBdbTree<T>::open(const QxtBdbEnvironment & env, QString file)
+{
+    if (!qxt_d().setEnvironment(env))
+        return false;
+    return open(file);
+}
+
 template<class T>
 bool QxtBdbTree<T>::open(QString file)
 {
@@ -159,7 +179,7 @@ void QxtBdbTree<T>::dumpTree() const
 {
     BerkeleyDB::DBC *cursor;
     qxt_d().db->cursor(qxt_d().db, NULL, &cursor, 0);
-    if (!qxt_d().get((void*)0, 0, 0, 0, DB_FIRST, cursor))
+    if (!qxt_d().move(cursor, DB_FIRST))
     {
         return;
     }
@@ -171,7 +191,7 @@ void QxtBdbTree<T>::dumpTree() const
     Q_FOREVER
     {
         qDebug() << k.level() << "  \t->\t" << k.value();
-        if (!qxt_d().get((void*)0, 0, 0, 0, DB_NEXT, cursor))
+        if (!qxt_d().move(cursor, DB_NEXT))
             break;
     }
     qDebug() << "\r\n";
@@ -256,6 +276,7 @@ private:
     friend class QxtBdbTree<T>;
     QxtBdbTreeIterator(BerkeleyDB::DBC*, QxtBdb * p);
     QxtBdbTreeIterator<T> croot() const;
+    static void encodeRecord(quint64 level, const T & t, QxtBdbData & out);
 
 
     int meta_id;
@@ -379,35 +400,12 @@ T QxtBdbTreeIterator<T>::value() const
         return T();
     }
 
-    BerkeleyDB::DBT dbkey, dbvalue;
-    memset(&dbkey, 0, sizeof(BerkeleyDB::DBT));
-    memset(&dbvalue, 0, sizeof(BerkeleyDB::DBT));
-
-    dbvalue.ulen = 0;
-    dbvalue.flags = DB_DBT_USERMEM;
-
-    dbkey.ulen = 0;
-    dbkey.flags = DB_DBT_USERMEM;
-
-    int ret = dbc->c_get(dbc, &dbkey, &dbvalue, DB_CURRENT);
-    if (ret != DB_BUFFER_SMALL)
+    QxtBdbData record;
+    T t;
+    if (!db->fetch(dbc, 0, &record, DB_CURRENT) || record.size() < int(sizeof(quint64)))
         return T();
-
-
-    dbvalue.ulen = dbvalue.size;
-    dbvalue.data =::malloc(dbvalue.size);
-
-    dbkey.ulen = dbkey.size;
-    dbkey.data =::malloc(dbkey.size);
-
-    ret = dbc->c_get(dbc, &dbkey, &dbvalue, DB_CURRENT);
-    T t = QxtBdb::qxtMetaLoad<T>((quint64*)dbvalue.data + 1, dbvalue.size - sizeof(quint64));
-    ::free(dbkey.data);
-    ::free(dbvalue.data);
-
-    if (ret != 0)
+    if (!QxtBdbCodec<T>::decode(record.constData() + sizeof(quint64), record.size() - int(sizeof(quint64)), t))
         return T();
-
     return t;
 
 }
@@ -433,20 +431,11 @@ bool QxtBdbTreeIterator<T>::setValue(T t)
     dbkey.ulen = 0;
     dbkey.flags = DB_DBT_USERMEM;
 
-    quint64 mylevel = level();
-    QByteArray d = QxtBdb::qxtMetaSave<T>(t);
+    QxtBdbData record;
+    encodeRecord(level(), t, record);
+    dbvalue = record.dbt();
 
-
-    dbvalue.size = sizeof(quint64) + d.size();
-    dbvalue.ulen = dbvalue.size;
-    dbvalue.data =::malloc(dbvalue.size);
-    ::memcpy(dbvalue.data, &mylevel, sizeof(quint64));
-    ::memcpy((quint64*)dbvalue.data + 1, d.data(), d.size());
-    dbvalue.flags = DB_DBT_USERMEM;
-
-    int ret = 234525;
-    ret = dbc->c_put(dbc, &dbkey, &dbvalue, DB_CURRENT);
-    ::free(dbvalue.data);
+    int ret = dbc->c_put(dbc, &dbkey, &dbvalue, DB_CURRENT);
 
     if (ret != 0)
         return false;
@@ -470,9 +459,9 @@ QxtBdbTreeIterator<T>    QxtBdbTreeIterator<T>::parent() const
     {
 #if DB_VERSION_MINOR > 5
 
-        if (!d.db->get((void*)0, 0, 0, 0, DB_PREV_DUP, d.dbc))
+        if (!d.db->move(d.dbc, DB_PREV_DUP))
 #else
-        if (!d.db->get((void*)0, 0, 0, 0, DB_PREV, d.dbc))
+        if (!d.db->move(d.dbc, DB_PREV))
 #endif
             return croot();
         if (d.level() == lvl - 1)
@@ -510,7 +499,7 @@ QxtBdbTreeIterator<T>    QxtBdbTreeIterator<T>::child() const
         db->db->cursor(db->db, NULL, &cursor, 0);
         d = QxtBdbTreeIterator<T>(cursor, db);
 
-        if (!d.db->get((void*)0, 0, 0, 0, DB_FIRST, d.dbc))
+        if (!d.db->move(d.dbc, DB_FIRST))
         {
             return QxtBdbTreeIterator<T>();
         }
@@ -522,7 +511,7 @@ QxtBdbTreeIterator<T>    QxtBdbTreeIterator<T>::child() const
 
 
         quint64 lvl = level();
-        if (!d.db->get((void*)0, 0, 0, 0, DB_NEXT_DUP, d.dbc))
+        if (!d.db->move(d.dbc, DB_NEXT_DUP))
         {
             return QxtBdbTreeIterator<T>();
         }
@@ -562,7 +551,7 @@ QxtBdbTreeIterator<T> &  QxtBdbTreeIterator<T>::operator ++ ()
     Q_FOREVER
     {
 
-        if (!db->get((void*)0, 0, 0, 0, DB_NEXT_DUP, dbc))
+        if (!db->move(dbc, DB_NEXT_DUP))
         {
             invalidate();
             break;
@@ -630,7 +619,7 @@ QxtBdbTreeIterator<T> &  QxtBdbTreeIterator<T>::operator -- ()
 #if DB_VERSION_MINOR > 5
     do
     {
-        if (!db->get((void*)0, 0, 0, 0, DB_PREV_DUP, dbc))
+        if (!db->move(dbc, DB_PREV_DUP))
         {
             invalidate();
             break;
@@ -640,7 +629,7 @@ QxtBdbTreeIterator<T> &  QxtBdbTreeIterator<T>::operator -- ()
 #else
     do
     {
-        if (!db->get((void*)0, 0, 0, 0, DB_PREV, dbc))
+        if (!db->move(dbc, DB_PREV))
         {
             invalidate();
             break;
@@ -689,18 +678,9 @@ QxtBdbTreeIterator<T>   QxtBdbTreeIterator<T>::append(const T & t)
     dbkey.flags = DB_DBT_USERMEM;
 
 
-    quint64 newlevel = level() + 1;
-
-
-    QByteArray d = QxtBdb::qxtMetaSave<T>(t);
-
-
-    dbvalue.size = sizeof(quint64) + d.size();
-    dbvalue.ulen = dbvalue.size;
-    dbvalue.data =::malloc(dbvalue.size);
-    ::memcpy(dbvalue.data, &newlevel, sizeof(quint64));
-    ::memcpy((quint64*)dbvalue.data + 1, d.data(), d.size());
-    dbvalue.flags = DB_DBT_USERMEM;
+    QxtBdbData record;
+    encodeRecord(level() + 1, t, record);
+    dbvalue = record.dbt();
 
     int ret = 234525;
 
@@ -708,14 +688,14 @@ QxtBdbTreeIterator<T>   QxtBdbTreeIterator<T>::append(const T & t)
     QxtBdbTreeIterator<T> e = *this;
     if (dbc)
     {
-        while (e.db->get((void*)0, 0, 0, 0, DB_NEXT_DUP, e.dbc))
+        while (e.db->move(e.dbc, DB_NEXT_DUP))
         {
             if (e.level() <= level())
             {
 #if DB_VERSION_MINOR > 5
-                e.db->get((void*)0, 0, 0, 0, DB_PREV_DUP, e.dbc);
+                e.db->move(e.dbc, DB_PREV_DUP);
 #else
-                e.db->get((void*)0, 0, 0, 0, DB_PREV, e.dbc);
+                e.db->move(e.dbc, DB_PREV);
 #endif
                 break;
             }
@@ -727,11 +707,11 @@ QxtBdbTreeIterator<T>   QxtBdbTreeIterator<T>::append(const T & t)
         ret = db->db->put(db->db, NULL, &dbkey, &dbvalue, NULL);
         BerkeleyDB::DBC *cursor;
         db->db->cursor(db->db, NULL, &cursor, 0);
-        if (db->get((void*)0, 0, 0, 0, DB_LAST, cursor))
+        if (db->move(cursor, DB_LAST))
             e = QxtBdbTreeIterator<T>(cursor, db);
-
+        else
+            cursor->c_close(cursor);
     }
-    ::free(dbvalue.data);
 
     if (ret != 0)
     {
@@ -760,22 +740,11 @@ QxtBdbTreeIterator<T>   QxtBdbTreeIterator<T>::prepend(const T & t)
     dbkey.flags = DB_DBT_USERMEM;
 
 
-    quint64 newlevel = level();
-
-
-    QByteArray d = QxtBdb::qxtMetaSave<T>(t);
+    QxtBdbData record;
+    encodeRecord(level(), t, record);
+    dbvalue = record.dbt();
 
-
-    dbvalue.size = sizeof(quint64) + d.size();
-    dbvalue.ulen = dbvalue.size;
-    dbvalue.data =::malloc(dbvalue.size);
-    ::memcpy(dbvalue.data, &newlevel, sizeof(quint64));
-    ::memcpy((quint64*)dbvalue.data + 1, d.data(), d.size());
-    dbvalue.flags = DB_DBT_USERMEM;
-
-    int ret = 234525;
-    ret = e.dbc->c_put(e.dbc, &dbkey, &dbvalue, DB_BEFORE);
-    ::free(dbvalue.data);
+    int ret = e.dbc->c_put(e.dbc, &dbkey, &dbvalue, DB_BEFORE);
 
     if (ret != 0)
         return QxtBdbTreeIterator<T>();
@@ -783,43 +752,23 @@ QxtBdbTreeIterator<T>   QxtBdbTreeIterator<T>::prepend(const T & t)
 }
 
 
+template<class T>
+void QxtBdbTreeIterator<T>::encodeRecord(quint64 level, const T & t, QxtBdbData & out)
+{
+    out.append(reinterpret_cast<const char*>(&level), sizeof(quint64));
+    QxtBdbCodec<T>::encode(t, out);
+}
+
 template<class T>
 quint64 QxtBdbTreeIterator<T>::level() const
 {
     if (!dbc)
         return 0;
 
-    BerkeleyDB::DBT dbkey, dbvalue;
-    memset(&dbkey, 0, sizeof(BerkeleyDB::DBT));
-    memset(&dbvalue, 0, sizeof(BerkeleyDB::DBT));
-
-    dbvalue.size = 0;
-    dbvalue.size = 0;
-    dbvalue.ulen = 0;
-    dbvalue.flags = DB_DBT_USERMEM;
-
-
-    dbkey.ulen = 0;
-    dbkey.flags = DB_DBT_USERMEM;
-
-    int ret = dbc->c_get(dbc, &dbkey, &dbvalue, DB_CURRENT);
-    if (ret != DB_BUFFER_SMALL)
-        qFatal("QxtBdbTreeIterator::level() %s", qPrintable(QxtBdb::dbErrorCodeToString(ret)));
-    dbvalue.ulen = dbvalue.size;
-    dbvalue.data =::malloc(dbvalue.size);
-
-    dbkey.ulen = dbkey.size;
-    dbkey.data =::malloc(dbkey.size);
-
-    ret = dbc->c_get(dbc, &dbkey, &dbvalue, DB_CURRENT);
-
+    // the level leads every record, there is no need to copy the value behind it
     quint64 lvl;
-    ::memcpy(&lvl, dbvalue.data, sizeof(quint64));
-    ::free(dbkey.data);
-    ::free(dbvalue.data);
-
-    if (ret != 0)
-        return 0;
+    if (!db->fetchHead(dbc, &lvl, sizeof(quint64)))
+        qFatal("QxtBdbTreeIterator::level() failed to read the current record");
 
     return lvl;
 }
@@ -840,7 +789,7 @@ QxtBdbTreeIterator<T> QxtBdbTreeIterator<T>::erase()
         }
 
 
-        if (!db->get((void*)0, 0, 0, 0, DB_NEXT_DUP, dbc))
+        if (!db->move(dbc, DB_NEXT_DUP))
             return *this;
         if (level() <= before)
             return *this;
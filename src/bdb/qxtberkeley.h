@@ -32,6 +32,8 @@
 #define QXTBERKELEY_H_INCLUDED
 
 #include "qxtbdb.h"
+#include "qxtbdbcodec.h"
+#include "qxtbdbenvironment.h"
 #include "qxtbdbhash.h"
 #include "qxtbdbtree.h"
 
@@ -8,13 +8,21 @@ HEADERS  += qxtabstractsignalserializer.h
 HEADERS  += qxtalgorithms.h
 HEADERS  += qxtbasicfileloggerengine.h
 HEADERS  += qxtbasicstdloggerengine.h
+HEADERS  += qxtbinaryloggerengine.h
+HEADERS  += qxtbufferedfileloggerengine.h
 HEADERS  += qxtboundcfunction.h
 HEADERS  += qxtboundfunction.h
 HEADERS  += qxtboundfunctionbase.h
 HEADERS  += qxtcore.h
 HEADERS  += qxtcommandoptions.h
+HEADERS  += qxtcpufeatures_p.h
 HEADERS  += qxtcsvmodel.h
+HEADERS  += qxtcsvreader.h
+HEADERS  += qxtcsvscanner_p.h
+HEADERS  += qxtcsvwriter.h
 HEADERS  += qxtcurrency.h
+HEADERS  += qxtcurrency_p.h
+HEADERS  += qxtcurrencyvector.h
 HEADERS  += qxtdaemon.h
 HEADERS  += qxtdatastreamsignalserializer.h
 HEADERS  += qxtdeplex.h
@@ -26,6 +34,8 @@ HEADERS  += qxthmac.h
 HEADERS  += qxtjson.h
 HEADERS  += qxtjob.h
 HEADERS  += qxtjob_p.h
+HEADERS  += qxtjobexecutor.h
+HEADERS  += qxtjobexecutor_p.h
 HEADERS  += qxtlinesocket.h
 HEADERS  += qxtlinesocket_p.h
 HEADERS  += qxtlinkedtree.h
@@ -60,6 +70,7 @@ HEADERS  += qxtstdstreambufdevice.h
 HEADERS  += qxttemporarydir.h
 HEADERS  += qxttemporarydir_p.h
 HEADERS  += qxttimer.h
+HEADERS  += qxttypedboundfunction.h
 HEADERS  += qxttypelist.h
 HEADERS  += qxtrpcservice.h
 HEADERS  += qxtrpcservice_p.h
@@ -70,9 +81,16 @@ SOURCES  += qxtabstractfileloggerengine.cpp
 SOURCES  += qxtabstractiologgerengine.cpp
 SOURCES  += qxtbasicfileloggerengine.cpp
 SOURCES  += qxtbasicstdloggerengine.cpp
+SOURCES  += qxtbinaryloggerengine.cpp
+SOURCES  += qxtbufferedfileloggerengine.cpp
 SOURCES  += qxtcommandoptions.cpp
+SOURCES  += qxtcpufeatures.cpp
 SOURCES  += qxtcsvmodel.cpp
+SOURCES  += qxtcsvreader.cpp
+SOURCES  += qxtcsvscanner.cpp
+SOURCES  += qxtcsvwriter.cpp
 SOURCES  += qxtcurrency.cpp
+SOURCES  += qxtcurrencyvector.cpp
 SOURCES  += qxtdaemon.cpp
 SOURCES  += qxtdatastreamsignalserializer.cpp
 SOURCES  += qxtdeplex.cpp
@@ -83,6 +101,7 @@ SOURCES  += qxthmac.cpp
 SOURCES  += qxtlocale.cpp
 SOURCES  += qxtjson.cpp
 SOURCES  += qxtjob.cpp
+SOURCES  += qxtjobexecutor.cpp
 SOURCES  += qxtlinesocket.cpp
 SOURCES  += qxtlinkedtree.cpp
 SOURCES  += qxtlogger.cpp
@@ -102,6 +121,7 @@ SOURCES  += qxtstdio.cpp
 SOURCES  += qxtstdstreambufdevice.cpp
 SOURCES  += qxttemporarydir.cpp
 SOURCES  += qxttimer.cpp
+SOURCES  += qxttypedboundfunction.cpp
 SOURCES  += qxtrpcservice.cpp
 SOURCES  += qxtxmlfileloggerengine.cpp
 
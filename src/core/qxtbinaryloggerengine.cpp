@@ -0,0 +1,478 @@
+/****************************************************************************
+** Copyright (c) 2006 - 2011, the LibQxt project.
+** See the Qxt AUTHORS file for a list of authors and copyright holders.
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**     * Redistributions of source code must retain the above copyright
+**       notice, this list of conditions and the following disclaimer.
+**     * Redistributions in binary form must reproduce the above copyright
+**       notice, this list of conditions and the following disclaimer in the
+**       documentation and/or other materials provided with the distribution.
+**     * Neither the name of the LibQxt project nor the
+**       names of its contributors may be used to endorse or promote products
+**       derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+** ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+** DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+** (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+** LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+** ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** <http://libqxt.org>  <foundation@libqxt.org>
+*****************************************************************************/
+
+#include "qxtbinaryloggerengine.h"
+#include <QDataStream>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QThread>
+#include <string.h>
+
+/*!
+    \class QxtBinaryLoggerEngine
+    \brief The QxtBinaryLoggerEngine class writes compact binary log records to memory mapped files.
+    \inmodule QxtCore
+
+    The text based engines render every argument to a string while the message is being logged.
+    QxtBinaryLoggerEngine stores the raw argument values instead and leaves the formatting to
+    the \c qxtlogdecode tool, which renders the files as text or as JSON lines later on.
+
+    If the first message of a record is a string, it is treated as the format of the record:
+    it is written to the file once per segment and records refer to it by a numeric ID. Each
+    record also carries a monotonic timestamp with nanosecond resolution and the ID of the
+    thread that handed the record to the engine.
+
+    \code
+    qxtLog->addLoggerEngine("binary", new QxtBinaryLoggerEngine("server.qlog"));
+    qxtLog->info("request %1 served in %2 ms", id, elapsed);
+    \endcode
+    \code
+    $ qxtlogdecode server.qlog server.qlog.1
+    $ qxtlogdecode --json server.qlog
+    \endcode
+
+    Records are written into a memory mapped segment file of segmentSize() bytes, so that a
+    record costs a copy into memory and no system call. Data of a crashed process is still
+    written back by the operating system. When a segment is full, the engine continues with the
+    next one; segments are named logFileName(), logFileName() + ".1", logFileName() + ".2" and
+    so on, and each of them can be decoded on its own. On initialization the engine starts with
+    the first segment file that does not exist yet, so logs of earlier runs are never
+    overwritten. A closed segment is truncated to the data it holds.
+
+    \note With asynchronous logging or when logging from another thread than the one
+    QxtLogger lives in, the timestamp and thread ID are those of the thread that delivers the
+    record to the engine.
+
+    \section1 File format
+
+    All values are stored in the byte order of the writing machine, which is recorded in the
+    segment header.
+
+    \table
+    \header \o Offset \o Size \o Segment header
+    \row \o 0  \o 8 \o Magic "QXTBLOG\\0"
+    \row \o 8  \o 1 \o Format version, currently 1
+    \row \o 9  \o 1 \o 1 for little endian, 0 for big endian
+    \row \o 12 \o 4 \o Segment index
+    \row \o 16 \o 8 \o Wall clock time in milliseconds since the epoch at timestamp 0
+    \endtable
+
+    The header is 32 bytes long and is followed by records, each starting with a type byte.
+    A type of 0 marks the end of the data.
+
+    \table
+    \header \o Offset \o Size \o Format record (type 1)
+    \row \o 4 \o 4 \o Format ID
+    \row \o 8 \o 4 \o Length N of the format in bytes
+    \row \o 12 \o N \o The format, UTF-8 encoded
+    \endtable
+
+    \table
+    \header \o Offset \o Size \o Event record (type 2)
+    \row \o 2  \o 2 \o QxtLogger::LogLevel
+    \row \o 4  \o 2 \o Number of arguments
+    \row \o 8  \o 4 \o Format ID, 0 if the record has no format
+    \row \o 12 \o 8 \o Timestamp in nanoseconds
+    \row \o 20 \o 8 \o Thread ID
+    \row \o 28 \o 4 \o Length N of the arguments in bytes
+    \row \o 32 \o N \o Arguments
+    \endtable
+
+    Each argument is a tag byte followed by its value: 0 null, 1 bool (1 byte), 2 int (4 bytes),
+    3 unsigned int (4 bytes), 4 64-bit integer, 5 unsigned 64-bit integer, 6 double (8 bytes),
+    7 string (4 byte length in UTF-16 code units, then the code units), 8 byte array (4 byte
+    length, then the bytes) and 9 for any other QVariant (4 byte length, then the variant
+    serialized with QDataStream version Qt_4_6).
+
+    \sa QxtLogger
+ */
+
+enum
+{
+    QxtBinaryLogHeaderSize = 32,
+    QxtBinaryLogFormatHeaderSize = 12,
+    QxtBinaryLogEventHeaderSize = 32
+};
+
+enum QxtBinaryLogArgument
+{
+    QxtBinaryLogNull = 0,
+    QxtBinaryLogBool,
+    QxtBinaryLogInt,
+    QxtBinaryLogUInt,
+    QxtBinaryLogLongLong,
+    QxtBinaryLogULongLong,
+    QxtBinaryLogDouble,
+    QxtBinaryLogString,
+    QxtBinaryLogByteArray,
+    QxtBinaryLogVariant
+};
+
+template <typename T>
+static inline void qxt_put(uchar* at, T value)
+{
+    memcpy(at, &value, sizeof(T));
+}
+
+class QxtBinaryLoggerEnginePrivate : public QxtPrivate<QxtBinaryLoggerEngine>
+{
+public:
+    QXT_DECLARE_PUBLIC(QxtBinaryLoggerEngine)
+    QxtBinaryLoggerEnginePrivate();
+
+    bool openSegment();
+    void closeSegment();
+    void encode(const QVariant& value);
+
+    inline void append(const void* data, int len)
+    {
+        if (used + len > args.size())
+            args.resize(qMax(args.size() * 2, used + len));
+        memcpy(args.data() + used, data, len);
+        used += len;
+    }
+    template <typename T>
+    inline void append(uchar tag, T value)
+    {
+        append(&tag, 1);
+        append(&value, sizeof(T));
+    }
+
+    QString fileName;
+    qint64 segmentSize;
+    int segment;
+    QFile* file;
+    uchar* map;
+    qint64 capacity;
+    qint64 pos;
+    QHash<QString, quint32> formats;
+    QElapsedTimer clock;
+    qint64 epoch;
+    quint64 dropped;
+    // Arguments of the record being written; only the first 'used' bytes are valid.
+    QByteArray args;
+    int used;
+};
+
+QxtBinaryLoggerEnginePrivate::QxtBinaryLoggerEnginePrivate()
+        : segmentSize(0), segment(0), file(0), map(0), capacity(0), pos(0), epoch(0), dropped(0), used(0)
+{
+}
+
+bool QxtBinaryLoggerEnginePrivate::openSegment()
+{
+    file = new QFile(qxt_p().segmentFileName(segment));
+    if (!file->open(QIODevice::ReadWrite | QIODevice::Truncate) || !file->resize(segmentSize))
+    {
+        delete file;
+        file = 0;
+        return false;
+    }
+    map = file->map(0, segmentSize);
+    if (!map)
+    {
+        file->remove();
+        delete file;
+        file = 0;
+        return false;
+    }
+
+    capacity = segmentSize;
+    memset(map, 0, QxtBinaryLogHeaderSize);
+    memcpy(map, "QXTBLOG", 8);
+    map[8] = 1;
+    map[9] = (QSysInfo::ByteOrder == QSysInfo::LittleEndian) ? 1 : 0;
+    qxt_put<quint32>(map + 12, quint32(segment));
+    qxt_put<qint64>(map + 16, epoch);
+    pos = QxtBinaryLogHeaderSize;
+    formats.clear();
+    return true;
+}
+
+void QxtBinaryLoggerEnginePrivate::closeSegment()
+{
+    if (!file) return;
+    if (map)
+        file->unmap(map);
+    map = 0;
+    capacity = 0;
+    file->resize(pos);
+    file->close();
+    delete file;
+    file = 0;
+    pos = 0;
+}
+
+void QxtBinaryLoggerEnginePrivate::encode(const QVariant& value)
+{
+    switch (value.userType())
+    {
+    case QVariant::Invalid:
+    {
+        const uchar tag = QxtBinaryLogNull;
+        append(&tag, 1);
+        break;
+    }
+    case QVariant::Bool:
+        append<quint8>(QxtBinaryLogBool, value.toBool() ? 1 : 0);
+        break;
+    case QVariant::Int:
+        append<qint32>(QxtBinaryLogInt, value.toInt());
+        break;
+    case QVariant::UInt:
+        append<quint32>(QxtBinaryLogUInt, value.toUInt());
+        break;
+    case QVariant::LongLong:
+        append<qint64>(QxtBinaryLogLongLong, value.toLongLong());
+        break;
+    case QVariant::ULongLong:
+        append<quint64>(QxtBinaryLogULongLong, value.toULongLong());
+        break;
+    case QVariant::Double:
+        append<double>(QxtBinaryLogDouble, value.toDouble());
+        break;
+    case QVariant::String:
+    {
+        // a QString held by a QVariant is shared, not copied
+        const QString string = value.toString();
+        append<quint32>(QxtBinaryLogString, quint32(string.size()));
+        append(string.constData(), string.size() * int(sizeof(QChar)));
+        break;
+    }
+    case QVariant::ByteArray:
+    {
+        const QByteArray bytes = value.toByteArray();
+        append<quint32>(QxtBinaryLogByteArray, quint32(bytes.size()));
+        append(bytes.constData(), bytes.size());
+        break;
+    }
+    default:
+    {
+        QByteArray bytes;
+        QDataStream stream(&bytes, QIODevice::WriteOnly);
+        stream.setVersion(QDataStream::Qt_4_6);
+        stream << value;
+        append<quint32>(QxtBinaryLogVariant, quint32(bytes.size()));
+        append(bytes.constData(), bytes.size());
+        break;
+    }
+    }
+}
+
+/*!
+    Constructs a binary logger engine writing to \a fileName in segments of \a segmentSize bytes.
+ */
+QxtBinaryLoggerEngine::QxtBinaryLoggerEngine(const QString& fileName, qint64 segmentSize)
+{
+    QXT_INIT_PRIVATE(QxtBinaryLoggerEngine);
+    qxt_d().segmentSize = qMax(qint64(4096), segmentSize);
+    qxt_d().args.resize(256);
+    qxt_d().clock.start();
+    qxt_d().epoch = QDateTime::currentMSecsSinceEpoch();
+    setLogFileName(fileName);
+}
+
+/*!
+    Destructs the engine and closes the current segment.
+ */
+QxtBinaryLoggerEngine::~QxtBinaryLoggerEngine()
+{
+    killLoggerEngine();
+}
+
+/*!
+    \reimp
+ */
+void QxtBinaryLoggerEngine::initLoggerEngine()
+{
+    killLoggerEngine();
+    if (qxt_d().fileName.isEmpty()) return;
+
+    int segment = 0;
+    while (QFile::exists(segmentFileName(segment)))
+        segment++;
+    qxt_d().segment = segment;
+    if (qxt_d().openSegment())
+        enableLogging();
+}
+
+/*!
+    \reimp
+ */
+void QxtBinaryLoggerEngine::killLoggerEngine()
+{
+    qxt_d().closeSegment();
+}
+
+/*!
+    \reimp
+ */
+bool QxtBinaryLoggerEngine::isInitialized() const
+{
+    return qxt_d().map != 0;
+}
+
+/*!
+    \reimp
+ */
+void QxtBinaryLoggerEngine::writeFormatted(QxtLogger::LogLevel level, const QList<QVariant>& messages)
+{
+    QxtBinaryLoggerEnginePrivate& d = qxt_d();
+    if (!d.map) return;
+
+    const qint64 timestamp = d.clock.nsecsElapsed();
+    const bool hasFormat = !messages.isEmpty() && messages.first().userType() == QVariant::String;
+    const QString format = hasFormat ? messages.first().toString() : QString();
+
+    d.used = 0;
+    for (int i = hasFormat ? 1 : 0; i < messages.count(); i++)
+        d.encode(messages.at(i));
+
+    // A format is defined in every segment it is used in, so a segment switch may add a definition.
+    const qint64 eventSize = QxtBinaryLogEventHeaderSize + d.used;
+    quint32 formatId = 0;
+    QByteArray definition;
+    for (bool rolled = false;; rolled = true)
+    {
+        qint64 needed = eventSize;
+        if (hasFormat)
+        {
+            formatId = d.formats.value(format);
+            if (!formatId)
+            {
+                if (definition.isNull())
+                    definition = format.toUtf8();
+                needed += QxtBinaryLogFormatHeaderSize + definition.size();
+            }
+        }
+        if (d.pos + needed <= d.capacity)
+            break;
+        if (rolled || needed > d.segmentSize - QxtBinaryLogHeaderSize)
+        {
+            d.dropped++;
+            return;
+        }
+        d.closeSegment();
+        d.segment++;
+        if (!d.openSegment())
+        {
+            d.dropped++;
+            return;
+        }
+    }
+
+    if (hasFormat && !formatId)
+    {
+        formatId = quint32(d.formats.count() + 1);
+        d.formats.insert(format, formatId);
+        uchar* at = d.map + d.pos;
+        memset(at, 0, 4);
+        at[0] = 1;
+        qxt_put<quint32>(at + 4, formatId);
+        qxt_put<quint32>(at + 8, quint32(definition.size()));
+        memcpy(at + QxtBinaryLogFormatHeaderSize, definition.constData(), definition.size());
+        d.pos += QxtBinaryLogFormatHeaderSize + definition.size();
+    }
+
+    uchar* at = d.map + d.pos;
+    at[1] = 0;
+    qxt_put<quint16>(at + 2, quint16(level));
+    qxt_put<quint16>(at + 4, quint16(messages.count() - (hasFormat ? 1 : 0)));
+    qxt_put<quint16>(at + 6, 0);
+    qxt_put<quint32>(at + 8, formatId);
+    qxt_put<qint64>(at + 12, timestamp);
+    qxt_put<quint64>(at + 20, quint64(quintptr(QThread::currentThreadId())));
+    qxt_put<quint32>(at + 28, quint32(d.used));
+    memcpy(at + QxtBinaryLogEventHeaderSize, d.args.constData(), d.used);
+    // the type byte goes last, so that an interrupted record reads as the end of the data
+    at[0] = 2;
+    d.pos += eventSize;
+}
+
+/*!
+    Sets the log \a fileName, which is also the name of the first segment, and reinitializes the engine.
+ */
+void QxtBinaryLoggerEngine::setLogFileName(const QString& fileName)
+{
+    qxt_d().fileName = fileName;
+    initLoggerEngine();
+}
+
+/*!
+    Returns the log file name.
+ */
+QString QxtBinaryLoggerEngine::logFileName() const
+{
+    return qxt_d().fileName;
+}
+
+/*!
+    Returns the size of a segment file in bytes. The default is 16 MiB.
+ */
+qint64 QxtBinaryLoggerEngine::segmentSize() const
+{
+    return qxt_d().segmentSize;
+}
+
+/*!
+    Sets the size of segment files to \a bytes. The new size applies to the next segment.
+ */
+void QxtBinaryLoggerEngine::setSegmentSize(qint64 bytes)
+{
+    qxt_d().segmentSize = qMax(qint64(4096), bytes);
+}
+
+/*!
+    Returns the index of the segment currently being written.
+ */
+int QxtBinaryLoggerEngine::segmentIndex() const
+{
+    return qxt_d().segment;
+}
+
+/*!
+    Returns the file name of the segment with \a index.
+ */
+QString QxtBinaryLoggerEngine::segmentFileName(int index) const
+{
+    if (index == 0)
+        return qxt_d().fileName;
+    return qxt_d().fileName + '.' + QString::number(index);
+}
+
+/*!
+    Returns the number of records that could not be written, either because they
+    were larger than a segment or because a new segment could not be created.
+ */
+quint64 QxtBinaryLoggerEngine::droppedRecordCount() const
+{
+    return qxt_d().dropped;
+}
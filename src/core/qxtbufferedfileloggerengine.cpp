@@ -0,0 +1,689 @@
+/****************************************************************************
+** Copyright (c) 2006 - 2011, the LibQxt project.
+** See the Qxt AUTHORS file for a list of authors and copyright holders.
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**     * Redistributions of source code must retain the above copyright
+**       notice, this list of conditions and the following disclaimer.
+**     * Redistributions in binary form must reproduce the above copyright
+**       notice, this list of conditions and the following disclaimer in the
+**       documentation and/or other materials provided with the distribution.
+**     * Neither the name of the LibQxt project nor the
+**       names of its contributors may be used to endorse or promote products
+**       derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+** ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+** DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+** (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+** LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+** ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** <http://libqxt.org>  <foundation@libqxt.org>
+*****************************************************************************/
+
+#include "qxtbufferedfileloggerengine.h"
+#include <QDateTime>
+#include <QFileInfo>
+#include <QMutex>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QDir>
+#include <QFile>
+
+/*!
+    \class QxtBufferedFileLoggerEngine
+    \brief The QxtBufferedFileLoggerEngine class provides a buffered file logger engine with log rotation.
+    \inmodule QxtCore
+
+    QxtBufferedFileLoggerEngine writes the same format as QxtBasicFileLoggerEngine, but formats
+    records into a reusable in-memory buffer and hands the buffer to the file with a single
+    write() once one of the following happens:
+
+    \list
+    \o the buffer holds flushThreshold() bytes or more,
+    \o flushInterval() milliseconds have passed since the last flush when a record is written,
+    \o a record of one of the flushLevels() is written (by default errors, critical and fatal
+       messages, so the last words of a crashing process reach the disk),
+    \o flush(), rotate() or killLoggerEngine() is called, or the engine is destroyed.
+    \endlist
+
+    The timestamp is formatted through QDateTime only once per second; the milliseconds
+    ("zzz" in dateFormat()) are filled in directly.
+
+    The log file can be rotated when it grows beyond maximumFileSize(), when the
+    rotationPeriod() elapses, or explicitly with rotate(). The current file is then renamed to
+    \c{<fileName>.<yyyyMMdd-hhmmss>} and a new file is started. Compression of the renamed file
+    to gzip format and the removal of backups beyond maximumBackupCount() are carried out in
+    the background on QThreadPool::globalInstance(), so the logging thread never waits for them.
+
+    \code
+    QxtBufferedFileLoggerEngine* engine = new QxtBufferedFileLoggerEngine("server.log");
+    engine->setMaximumFileSize(16 * 1024 * 1024);
+    engine->setRotationPeriod(QxtBufferedFileLoggerEngine::DailyRotation);
+    engine->setMaximumBackupCount(14);
+    qxtLog->addLoggerEngine("file", engine);
+    \endcode
+
+    \note Records of levels outside flushLevels() may stay in memory for up to flushInterval()
+    milliseconds, or longer if nothing else is logged. Call flush() from a timer if that matters.
+
+    \sa QxtBasicFileLoggerEngine, QxtLogger
+ */
+
+/*!
+    \enum QxtBufferedFileLoggerEngine::RotationPeriod
+
+    This enum describes time based rotation of the log file.
+
+    \value NoRotation       The log file is only rotated by size or explicitly.
+    \value HourlyRotation   The log file is rotated with the first record of every hour.
+    \value DailyRotation    The log file is rotated with the first record of every day.
+ */
+
+Q_GLOBAL_STATIC(QMutex, qxt_logArchiveMutex)
+
+// The CRC-32 (IEEE 802.3) lookup table, built on first use
+struct QxtCrc32Table
+{
+    QxtCrc32Table()
+    {
+        for (quint32 n = 0; n < 256; n++)
+        {
+            quint32 c = n;
+            for (int k = 0; k < 8; k++)
+                c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+            entries[n] = c;
+        }
+    }
+    quint32 entries[256];
+};
+Q_GLOBAL_STATIC(QxtCrc32Table, qxt_crc32Table)
+
+static quint32 qxt_crc32(const QByteArray& data)
+{
+    const quint32* table = qxt_crc32Table()->entries;
+    quint32 crc = 0xFFFFFFFFu;
+    const uchar* p = reinterpret_cast<const uchar*>(data.constData());
+    for (int i = 0; i < data.size(); i++)
+        crc = table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFFu;
+}
+
+static void qxt_appendLE32(QByteArray& out, quint32 value)
+{
+    for (int i = 0; i < 4; i++)
+        out.append(char((value >> (8 * i)) & 0xFF));
+}
+
+// qCompress() produces a 4 byte length prefix followed by a zlib stream; the raw deflate
+// data in between the zlib header and its checksum is wrapped into a gzip member instead,
+// so that rotated logs can be read with the usual tools.
+static QByteArray qxt_gzip(const QByteArray& data)
+{
+    const QByteArray zlib = qCompress(data);
+    if (data.isEmpty() || zlib.size() < 10)
+        return QByteArray();
+    static const char header[10] = { 0x1f, char(0x8b), 8, 0, 0, 0, 0, 0, 0, 3 };
+    QByteArray out;
+    out.reserve(zlib.size() + 8);
+    out.append(header, 10);
+    out.append(zlib.constData() + 6, zlib.size() - 10);
+    qxt_appendLE32(out, qxt_crc32(data));
+    qxt_appendLE32(out, quint32(data.size()));
+    return out;
+}
+
+// rotated files are compressed in blocks of this size, each into a gzip member of its own;
+// gzip readers decompress a sequence of members as the concatenation of their contents
+enum { QxtLogArchiveBlockSize = 1024 * 1024 };
+
+class QxtLogArchiver : public QRunnable
+{
+public:
+    QxtLogArchiver(const QString& fileName, const QString& backup, bool compress, int maxBackups)
+            : fileName(fileName), backup(backup), compress(compress), maxBackups(maxBackups) {}
+
+    void run()
+    {
+        QMutexLocker locker(qxt_logArchiveMutex());
+        if (compress)
+            compressBackup();
+        if (maxBackups > 0)
+            removeOldBackups();
+    }
+
+private:
+    void compressBackup()
+    {
+        QFile in(backup);
+        if (!in.open(QIODevice::ReadOnly) || in.size() == 0)
+            return;
+
+        QFile out(backup + ".gz");
+        bool ok = out.open(QIODevice::WriteOnly);
+        while (ok && !in.atEnd())
+        {
+            const QByteArray block = in.read(QxtLogArchiveBlockSize);
+            const QByteArray gz = qxt_gzip(block);
+            ok = !gz.isEmpty() && out.write(gz) == gz.size();
+        }
+        ok = ok && in.error() == QFile::NoError;
+        in.close();
+        out.close();
+        if (ok)
+            QFile::remove(backup);
+        else
+            QFile::remove(backup + ".gz");
+    }
+
+    void removeOldBackups()
+    {
+        QFileInfo info(fileName);
+        QDir dir = info.absoluteDir();
+        // <fileName>.yyyyMMdd-hhmmss[_nnn][.gz]; the names sort chronologically
+        QStringList backups = dir.entryList(QStringList(info.fileName() + ".????????-??????*"), QDir::Files, QDir::Name);
+        while (backups.count() > maxBackups)
+            dir.remove(backups.takeFirst());
+    }
+
+    QString fileName;
+    QString backup;
+    bool compress;
+    int maxBackups;
+};
+
+class QxtBufferedFileLoggerEnginePrivate : public QxtPrivate<QxtBufferedFileLoggerEngine>
+{
+public:
+    QXT_DECLARE_PUBLIC(QxtBufferedFileLoggerEngine)
+    QxtBufferedFileLoggerEnginePrivate();
+
+    void setDateFormat(const QString& format);
+    void appendTimestamp(qint64 msecs);
+    void appendUtf8(const QString& text);
+    void resetFile(qint64 now);
+    void flushBuffer(qint64 now);
+    void writeRecord(const char* level, int levelSize, bool urgent, const QVariantList& messages);
+    QString backupName(const QString& fileName, qint64 now);
+    static qint64 nextBoundary(QxtBufferedFileLoggerEngine::RotationPeriod period, qint64 msecs);
+
+    inline void append(const char* data, int len)
+    {
+        if (used + len > buffer.size())
+            buffer.resize(qMax(buffer.size() * 2, used + len));
+        memcpy(buffer.data() + used, data, len);
+        used += len;
+    }
+    inline void append(const QByteArray& data)
+    {
+        append(data.constData(), data.size());
+    }
+    inline void append(char c)
+    {
+        if (used == buffer.size())
+            buffer.resize(qMax(buffer.size() * 2, 256));
+        buffer.data()[used++] = c;
+    }
+
+    QMutex mutex;
+    QString dateFormat;
+    QString headFormat;
+    QString tailFormat;
+    bool cacheable;
+    bool hasMsecs;
+    qint64 cachedSecond;
+    QByteArray cachedHead;
+    QByteArray cachedTail;
+
+    // Only the first 'used' bytes of 'buffer' are valid; the array itself is kept allocated between flushes.
+    QByteArray buffer;
+    int used;
+    int flushThreshold;
+    int flushInterval;
+    QxtLogger::LogLevels flushLevels;
+    qint64 lastFlush;
+
+    qint64 fileSize;
+    qint64 maxFileSize;
+    QxtBufferedFileLoggerEngine::RotationPeriod period;
+    qint64 nextRotation;
+    int maxBackups;
+    bool compress;
+    qint64 backupSecond;
+    int backupSequence;
+};
+
+QxtBufferedFileLoggerEnginePrivate::QxtBufferedFileLoggerEnginePrivate()
+        : mutex(QMutex::Recursive), cacheable(false), hasMsecs(false), cachedSecond(-1), used(0),
+        flushThreshold(64 * 1024), flushInterval(1000),
+        flushLevels(QxtLogger::ErrorLevel | QxtLogger::CriticalLevel | QxtLogger::FatalLevel), lastFlush(0),
+        fileSize(0), maxFileSize(0), period(QxtBufferedFileLoggerEngine::NoRotation), nextRotation(0),
+        maxBackups(0), compress(true), backupSecond(-1), backupSequence(0)
+{
+}
+
+void QxtBufferedFileLoggerEnginePrivate::setDateFormat(const QString& format)
+{
+    dateFormat = format;
+    cachedSecond = -1;
+    const int msecs = format.indexOf("zzz");
+    hasMsecs = (msecs != -1);
+    headFormat = hasMsecs ? format.left(msecs) : format;
+    tailFormat = hasMsecs ? format.mid(msecs + 3) : QString();
+    // any other millisecond field would change within a second
+    cacheable = !headFormat.contains('z') && !tailFormat.contains('z');
+}
+
+void QxtBufferedFileLoggerEnginePrivate::appendTimestamp(qint64 msecs)
+{
+    if (!cacheable)
+    {
+        append('[');
+        appendUtf8(QDateTime::fromMSecsSinceEpoch(msecs).toString(dateFormat));
+        append("] ", 2);
+        return;
+    }
+
+    const qint64 second = msecs / 1000;
+    if (second != cachedSecond)
+    {
+        const QDateTime time = QDateTime::fromMSecsSinceEpoch(second * 1000);
+        cachedHead = '[' + time.toString(headFormat).toUtf8();
+        cachedTail = time.toString(tailFormat).toUtf8() + "] ";
+        cachedSecond = second;
+    }
+    append(cachedHead);
+    if (hasMsecs)
+    {
+        const int ms = int(msecs % 1000);
+        append(char('0' + ms / 100));
+        append(char('0' + ms / 10 % 10));
+        append(char('0' + ms % 10));
+    }
+    append(cachedTail);
+}
+
+void QxtBufferedFileLoggerEnginePrivate::appendUtf8(const QString& text)
+{
+    append(text.toUtf8());
+}
+
+void QxtBufferedFileLoggerEnginePrivate::resetFile(qint64 now)
+{
+    QIODevice* file = qxt_p().device();
+    fileSize = file ? file->size() : 0;
+    lastFlush = now;
+    // a file left over from an earlier period is rotated with the first record written to it
+    qint64 since = now;
+    if (fileSize > 0)
+        since = QFileInfo(qxt_p().logFileName()).lastModified().toMSecsSinceEpoch();
+    nextRotation = nextBoundary(period, since);
+}
+
+void QxtBufferedFileLoggerEnginePrivate::flushBuffer(qint64 now)
+{
+    lastFlush = now;
+    if (used == 0)
+        return;
+    QIODevice* file = qxt_p().device();
+    if (file)
+    {
+        const qint64 written = file->write(buffer.constData(), used);
+        if (written > 0)
+            fileSize += written;
+    }
+    used = 0;
+    // give back the memory of an exceptionally large record
+    if (buffer.size() > 2 * flushThreshold + 4096)
+        buffer.resize(flushThreshold + 4096);
+}
+
+void QxtBufferedFileLoggerEnginePrivate::writeRecord(const char* level, int levelSize, bool urgent, const QVariantList& messages)
+{
+    if (messages.isEmpty() || !qxt_p().isInitialized()) return;
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    if (period != QxtBufferedFileLoggerEngine::NoRotation && now >= nextRotation)
+        qxt_p().rotate();
+
+    const int start = used;
+    appendTimestamp(now);
+    append('[');
+    append(level, levelSize);
+    append("] ", 2);
+    const int headerSize = used - start;
+
+    int count = 0;
+    Q_FOREACH(const QVariant& out, messages)
+    {
+        if (!out.isNull())
+        {
+            if (count != 0)
+            {
+                if (used + headerSize > buffer.size())
+                    buffer.resize(qMax(buffer.size() * 2, used + headerSize));
+                memset(buffer.data() + used, ' ', headerSize);
+                used += headerSize;
+            }
+            if (out.type() == QVariant::ByteArray)
+                append(out.toByteArray());
+            else
+                appendUtf8(out.toString());
+            append('\n');
+        }
+        count++;
+    }
+
+    if (urgent || used >= flushThreshold || now - lastFlush >= flushInterval)
+        flushBuffer(now);
+    if (maxFileSize > 0 && fileSize + used >= maxFileSize)
+        qxt_p().rotate();
+}
+
+QString QxtBufferedFileLoggerEnginePrivate::backupName(const QString& fileName, qint64 now)
+{
+    // several rotations within one second get a counter that keeps the names in chronological order
+    const QString base = fileName + '.' + QDateTime::fromMSecsSinceEpoch(now).toString("yyyyMMdd-hhmmss");
+    if (now / 1000 != backupSecond)
+    {
+        backupSecond = now / 1000;
+        backupSequence = 0;
+    }
+    QString name;
+    do
+    {
+        name = base;
+        if (backupSequence > 0)
+            name += '_' + QString::number(backupSequence).rightJustified(3, '0');
+        backupSequence++;
+    }
+    while (QFile::exists(name) || QFile::exists(name + ".gz"));
+    return name;
+}
+
+qint64 QxtBufferedFileLoggerEnginePrivate::nextBoundary(QxtBufferedFileLoggerEngine::RotationPeriod period, qint64 msecs)
+{
+    const QDateTime time = QDateTime::fromMSecsSinceEpoch(msecs);
+    switch (period)
+    {
+    case QxtBufferedFileLoggerEngine::HourlyRotation:
+        return QDateTime(time.date(), QTime(time.time().hour(), 0)).addSecs(3600).toMSecsSinceEpoch();
+    case QxtBufferedFileLoggerEngine::DailyRotation:
+        return QDateTime(time.date().addDays(1), QTime(0, 0)).toMSecsSinceEpoch();
+    default:
+        return 0;
+    }
+}
+
+/*!
+    Constructs a buffered file logger engine with \a fileName.
+*/
+QxtBufferedFileLoggerEngine::QxtBufferedFileLoggerEngine(const QString &fileName)
+        : QxtAbstractFileLoggerEngine(fileName, QIODevice::ReadWrite | QIODevice::Append | QIODevice::Unbuffered)
+{
+    QXT_INIT_PRIVATE(QxtBufferedFileLoggerEngine);
+    qxt_d().setDateFormat("hh:mm:ss.zzz");
+    qxt_d().buffer.resize(qxt_d().flushThreshold + 4096);
+    qxt_d().resetFile(QDateTime::currentMSecsSinceEpoch());
+}
+
+/*!
+    Destructs the engine. Buffered records are written to the file.
+*/
+QxtBufferedFileLoggerEngine::~QxtBufferedFileLoggerEngine()
+{
+    killLoggerEngine();
+}
+
+/*!
+    Returns the date format in use by this logger engine.
+
+    The default format is "hh:mm:ss.zzz".
+
+    \sa QDateTime::toString()
+ */
+QString QxtBufferedFileLoggerEngine::dateFormat() const
+{
+    return qxt_d().dateFormat;
+}
+
+/*!
+    Sets the date \a format used by this logger engine.
+    \sa QDateTime::toString()
+ */
+void QxtBufferedFileLoggerEngine::setDateFormat(const QString& format)
+{
+    QMutexLocker locker(&qxt_d().mutex);
+    qxt_d().setDateFormat(format);
+}
+
+/*!
+    Returns the amount of buffered bytes that triggers a write to the file.
+
+    The default threshold is 64 KiB.
+ */
+int QxtBufferedFileLoggerEngine::flushThreshold() const
+{
+    return qxt_d().flushThreshold;
+}
+
+/*!
+    Sets the amount of buffered \a bytes that triggers a write to the file.
+    A threshold of \c 0 writes every record immediately.
+ */
+void QxtBufferedFileLoggerEngine::setFlushThreshold(int bytes)
+{
+    QMutexLocker locker(&qxt_d().mutex);
+    qxt_d().flushThreshold = qMax(0, bytes);
+    if (qxt_d().used >= qxt_d().flushThreshold)
+        qxt_d().flushBuffer(QDateTime::currentMSecsSinceEpoch());
+}
+
+/*!
+    Returns the maximum time in milliseconds a record is kept in the buffer,
+    provided another record is written after it.
+
+    The default interval is 1000 milliseconds.
+ */
+int QxtBufferedFileLoggerEngine::flushInterval() const
+{
+    return qxt_d().flushInterval;
+}
+
+/*!
+    Sets the flush interval to \a msecs.
+ */
+void QxtBufferedFileLoggerEngine::setFlushInterval(int msecs)
+{
+    QMutexLocker locker(&qxt_d().mutex);
+    qxt_d().flushInterval = qMax(0, msecs);
+}
+
+/*!
+    Returns the log levels that are written to the file immediately.
+
+    By default these are QxtLogger::ErrorLevel, QxtLogger::CriticalLevel and QxtLogger::FatalLevel.
+ */
+QxtLogger::LogLevels QxtBufferedFileLoggerEngine::flushLevels() const
+{
+    return qxt_d().flushLevels;
+}
+
+/*!
+    Sets the log \a levels that are written to the file immediately.
+ */
+void QxtBufferedFileLoggerEngine::setFlushLevels(QxtLogger::LogLevels levels)
+{
+    QMutexLocker locker(&qxt_d().mutex);
+    qxt_d().flushLevels = levels;
+}
+
+/*!
+    Returns the size in bytes at which the log file is rotated, or \c 0 if the
+    file is not rotated by size. This is the default.
+ */
+qint64 QxtBufferedFileLoggerEngine::maximumFileSize() const
+{
+    return qxt_d().maxFileSize;
+}
+
+/*!
+    Sets the size in \a bytes at which the log file is rotated. The file is
+    rotated after the record that reaches the limit.
+ */
+void QxtBufferedFileLoggerEngine::setMaximumFileSize(qint64 bytes)
+{
+    QMutexLocker locker(&qxt_d().mutex);
+    qxt_d().maxFileSize = qMax(Q_INT64_C(0), bytes);
+}
+
+/*!
+    Returns the time based rotation period. The default is NoRotation.
+ */
+QxtBufferedFileLoggerEngine::RotationPeriod QxtBufferedFileLoggerEngine::rotationPeriod() const
+{
+    return qxt_d().period;
+}
+
+/*!
+    Sets the time based rotation \a period.
+ */
+void QxtBufferedFileLoggerEngine::setRotationPeriod(RotationPeriod period)
+{
+    QMutexLocker locker(&qxt_d().mutex);
+    qxt_d().period = period;
+    qxt_d().nextRotation = QxtBufferedFileLoggerEnginePrivate::nextBoundary(period, QDateTime::currentMSecsSinceEpoch());
+}
+
+/*!
+    Returns the number of rotated files that are kept, or \c 0 if all of them
+    are kept. This is the default.
+ */
+int QxtBufferedFileLoggerEngine::maximumBackupCount() const
+{
+    return qxt_d().maxBackups;
+}
+
+/*!
+    Sets the number of rotated files that are kept to \a count. The oldest
+    files are removed after each rotation.
+ */
+void QxtBufferedFileLoggerEngine::setMaximumBackupCount(int count)
+{
+    QMutexLocker locker(&qxt_d().mutex);
+    qxt_d().maxBackups = qMax(0, count);
+}
+
+/*!
+    Returns \c true if rotated files are compressed. This is the default.
+ */
+bool QxtBufferedFileLoggerEngine::isCompressionEnabled() const
+{
+    return qxt_d().compress;
+}
+
+/*!
+    Sets whether rotated files are compressed to gzip format according to \a enable.
+    Compressed files get the suffix ".gz".
+ */
+void QxtBufferedFileLoggerEngine::setCompressionEnabled(bool enable)
+{
+    QMutexLocker locker(&qxt_d().mutex);
+    qxt_d().compress = enable;
+}
+
+/*!
+    Writes all buffered records to the file.
+ */
+void QxtBufferedFileLoggerEngine::flush()
+{
+    QMutexLocker locker(&qxt_d().mutex);
+    qxt_d().flushBuffer(QDateTime::currentMSecsSinceEpoch());
+}
+
+/*!
+    Writes all buffered records, renames the log file to a backup name and
+    starts a new log file. Compression of the backup and removal of old backups
+    happen in the background.
+
+    \sa maximumFileSize(), rotationPeriod()
+ */
+void QxtBufferedFileLoggerEngine::rotate()
+{
+    QMutexLocker locker(&qxt_d().mutex);
+    const QString name = logFileName();
+    if (name.isEmpty() || !isInitialized())
+        return;
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    qxt_d().flushBuffer(now);
+    QxtAbstractFileLoggerEngine::killLoggerEngine();
+    const QString backup = qxt_d().backupName(name, now);
+    const bool renamed = QFile::rename(name, backup);
+    QxtAbstractFileLoggerEngine::initLoggerEngine();
+    qxt_d().resetFile(now);
+
+    if (renamed && (qxt_d().compress || qxt_d().maxBackups > 0))
+        QThreadPool::globalInstance()->start(new QxtLogArchiver(name, backup, qxt_d().compress, qxt_d().maxBackups));
+}
+
+/*!
+    \reimp
+ */
+void QxtBufferedFileLoggerEngine::initLoggerEngine()
+{
+    QMutexLocker locker(&qxt_d().mutex);
+    QxtAbstractFileLoggerEngine::initLoggerEngine();
+    qxt_d().resetFile(QDateTime::currentMSecsSinceEpoch());
+}
+
+/*!
+    \reimp
+ */
+void QxtBufferedFileLoggerEngine::killLoggerEngine()
+{
+    QMutexLocker locker(&qxt_d().mutex);
+    qxt_d().flushBuffer(QDateTime::currentMSecsSinceEpoch());
+    QxtAbstractFileLoggerEngine::killLoggerEngine();
+}
+
+/*!
+    \reimp
+ */
+void QxtBufferedFileLoggerEngine::writeFormatted(QxtLogger::LogLevel level, const QList<QVariant> &messages)
+{
+    const char* name;
+    switch (level)
+    {
+    case QxtLogger::ErrorLevel:    name = "Error";    break;
+    case QxtLogger::WarningLevel:  name = "Warning";  break;
+    case QxtLogger::CriticalLevel: name = "Critical"; break;
+    case QxtLogger::FatalLevel:    name = "Fatal";    break;
+    case QxtLogger::TraceLevel:    name = "Trace";    break;
+    case QxtLogger::DebugLevel:    name = "Debug";    break;
+    case QxtLogger::InfoLevel:     name = "Info";     break;
+    default:                       name = "";         break;
+    }
+    QMutexLocker locker(&qxt_d().mutex);
+    qxt_d().writeRecord(name, int(qstrlen(name)), int(qxt_d().flushLevels & level) != 0, messages);
+}
+
+/*!
+    \reimp
+
+    QxtBufferedFileLoggerEngine reimplements writeFormatted() and does not call
+    this function itself.
+ */
+void QxtBufferedFileLoggerEngine::writeToFile(const QString &level, const QVariantList &messages)
+{
+    const QByteArray name = level.toUtf8();
+    QMutexLocker locker(&qxt_d().mutex);
+    qxt_d().writeRecord(name.constData(), name.size(), false, messages);
+}
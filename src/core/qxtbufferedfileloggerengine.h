@@ -0,0 +1,84 @@
+/****************************************************************************
+** Copyright (c) 2006 - 2011, the LibQxt project.
+** See the Qxt AUTHORS file for a list of authors and copyright holders.
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**     * Redistributions of source code must retain the above copyright
+**       notice, this list of conditions and the following disclaimer.
+**     * Redistributions in binary form must reproduce the above copyright
+**       notice, this list of conditions and the following disclaimer in the
+**       documentation and/or other materials provided with the distribution.
+**     * Neither the name of the LibQxt project nor the
+**       names of its contributors may be used to endorse or promote products
+**       derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+** ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+** DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+** (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+** LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+** ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** <http://libqxt.org>  <foundation@libqxt.org>
+*****************************************************************************/
+
+#ifndef QXTBUFFEREDFILELOGGERENGINE_H
+#define QXTBUFFEREDFILELOGGERENGINE_H
+
+#include "qxtloggerengine.h"
+#include "qxtabstractfileloggerengine.h"
+
+class QxtBufferedFileLoggerEnginePrivate;
+class QXT_CORE_EXPORT QxtBufferedFileLoggerEngine : public QxtAbstractFileLoggerEngine
+{
+public:
+    enum RotationPeriod
+    {
+        NoRotation,
+        HourlyRotation,
+        DailyRotation
+    };
+
+    QxtBufferedFileLoggerEngine(const QString &fileName = QString());
+    ~QxtBufferedFileLoggerEngine();
+
+    QString dateFormat() const;
+    void setDateFormat(const QString& format);
+
+    int flushThreshold() const;
+    void setFlushThreshold(int bytes);
+    int flushInterval() const;
+    void setFlushInterval(int msecs);
+    QxtLogger::LogLevels flushLevels() const;
+    void setFlushLevels(QxtLogger::LogLevels levels);
+
+    qint64 maximumFileSize() const;
+    void setMaximumFileSize(qint64 bytes);
+    RotationPeriod rotationPeriod() const;
+    void setRotationPeriod(RotationPeriod period);
+    int maximumBackupCount() const;
+    void setMaximumBackupCount(int count);
+    bool isCompressionEnabled() const;
+    void setCompressionEnabled(bool enable);
+
+    void flush();
+    void rotate();
+
+    virtual void initLoggerEngine();
+    virtual void killLoggerEngine();
+    virtual void writeFormatted(QxtLogger::LogLevel level, const QList<QVariant> &messages);
+
+protected:
+    virtual void writeToFile(const QString &level, const QVariantList &messages);
+
+private:
+    QXT_DECLARE_PRIVATE(QxtBufferedFileLoggerEngine)
+};
+
+#endif // QXTBUFFEREDFILELOGGERENGINE_H
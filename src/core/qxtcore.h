@@ -38,11 +38,15 @@
 #include "qxtalgorithms.h"
 #include "qxtbasicfileloggerengine.h"
 #include "qxtbasicstdloggerengine.h"
+#include "qxtbinaryloggerengine.h"
+#include "qxtbufferedfileloggerengine.h"
 #include "qxtboundcfunction.h"
 #include "qxtboundfunction.h"
 #include "qxtboundfunctionbase.h"
 #include "qxtcommandoptions.h"
 #include "qxtcsvmodel.h"
+#include "qxtcsvreader.h"
+#include "qxtcsvwriter.h"
 #include "qxtdaemon.h"
 #include "qxtdatastreamsignalserializer.h"
 #include "qxtdeplex.h"
@@ -53,6 +57,7 @@
 #include "qxthmac.h"
 #include "qxtjson.h"
 #include "qxtjob.h"
+#include "qxtjobexecutor.h"
 #include "qxtlinesocket.h"
 #include "qxtlinkedtree.h"
 #include "qxtlogger.h"
@@ -80,6 +85,7 @@
 #include "qxtstdstreambufdevice.h"
 #include "qxttemporarydir.h"
 #include "qxttimer.h"
+#include "qxttypedboundfunction.h"
 #include "qxttypelist.h"
 #include "qxtxmlfileloggerengine.h"
 
@@ -33,28 +33,196 @@
 \class QxtCsvModel
 \inmodule QxtCore
 \brief The QxtCsvModel class provides a QAbstractTableModel for CSV Files
+
+setSource() reads a whole file into memory. For large files, mapSource() maps the file
+instead and only builds an index of the row offsets when it is opened; the fields of a
+row are parsed when the row is first accessed, and the most recently used rows are
+kept in a cache of rowCacheSize() rows.
  */
 
 
 
 #include "qxtcsvmodel.h"
+#include "qxtcsvscanner_p.h"
+#include "qxtcsvwriter.h"
 #include <QFile>
 #include <QTextStream>
+#include <QTextCodec>
+#include <QVector>
+#include <QCache>
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QSemaphore>
 #include <QDebug>
+#include <cstring>
+
+// Scans one chunk of a large file on the global thread pool. Every chunk but the first
+// starts right after a newline and assumes that it is not inside quotes; the assumption
+// is checked when the chunks are joined.
+class QxtCsvScanJob : public QRunnable
+{
+public:
+    QxtCsvScanJob(const uchar* base, qint64 from, qint64 to, const QxtCsvScanTable& table, QSemaphore* done)
+            : base(base), from(from), to(to), table(table), done(done), maxFields(0)
+    {
+        setAutoDelete(false);
+    }
+
+    void run()
+    {
+        qxt_scanCsv(base, from, to, table, state, starts, maxFields);
+        done->release();
+    }
+
+    const uchar* base;
+    qint64 from;
+    qint64 to;
+    const QxtCsvScanTable& table;
+    QSemaphore* done;
+    QxtCsvScanState state;
+    QVector<qint64> starts;
+    int maxFields;
+};
 
 class QxtCsvModelPrivate : public QxtPrivate<QxtCsvModel>
 {
 public:
-    QxtCsvModelPrivate() : csvData(), header(), maxColumn(0), quoteMode(QxtCsvModel::DefaultQuoteMode)
+    QxtCsvModelPrivate() : csvData(), header(), maxColumn(0), quoteMode(QxtCsvModel::DefaultQuoteMode),
+            mappedFile(0), map(0), firstRow(0), codec(0), rowCache(1000)
     {}
+    ~QxtCsvModelPrivate()
+    {
+        unmap();
+    }
     QXT_DECLARE_PUBLIC(QxtCsvModel)
 
+    int rowCount() const;
+    QStringList row(int index) const;
+    QStringList parseMappedRow(int index) const;
+    void scan(qint64 from, qint64 size, int& maxFields);
+    void materialize();
+    void unmap();
+
     QList<QStringList> csvData;
     QStringList header;
     int maxColumn;
     QxtCsvModel::QuoteMode quoteMode;
+
+    // mapped mode: rowStarts holds the offset of every row and the end of the last one
+    QFile* mappedFile;
+    const uchar* map;
+    QVector<qint64> rowStarts;
+    int firstRow;
+    QTextCodec* codec;
+    QxtCsvScanTable table;
+    mutable QCache<int, QStringList> rowCache;
 };
 
+int QxtCsvModelPrivate::rowCount() const
+{
+    if (!map)
+        return csvData.count();
+    return rowStarts.count() - 1 - firstRow;
+}
+
+QStringList QxtCsvModelPrivate::row(int index) const
+{
+    if (!map)
+        return csvData.at(index);
+    if (QStringList* cached = rowCache.object(index))
+        return *cached;
+    const QStringList parsed = parseMappedRow(index + firstRow);
+    rowCache.insert(index, new QStringList(parsed));
+    return parsed;
+}
+
+QStringList QxtCsvModelPrivate::parseMappedRow(int index) const
+{
+    const char* data = reinterpret_cast<const char*>(map);
+    QStringList fields;
+    qxt_splitCsvRow(data + rowStarts.at(index), data + rowStarts.at(index + 1), table, codec, fields);
+    return fields;
+}
+
+void QxtCsvModelPrivate::scan(qint64 from, qint64 size, int& maxFields)
+{
+    const qint64 minimumChunk = 4 * 1024 * 1024;
+    const int chunkCount = int(qBound(qint64(1), (size - from) / minimumChunk, qint64(qMax(1, QThread::idealThreadCount()))));
+
+    // chunks start right after a newline
+    QVector<qint64> bounds;
+    bounds << from;
+    for (int i = 1; i < chunkCount; i++)
+    {
+        qint64 at = from + (size - from) * i / chunkCount;
+        if (at <= bounds.last())
+            continue;
+        const void* newline = memchr(map + at, '\n', size - at);
+        if (!newline)
+            break;
+        at = static_cast<const uchar*>(newline) - map + 1;
+        if (at < size && at > bounds.last())
+            bounds << at;
+    }
+    bounds << size;
+
+    QSemaphore done;
+    QList<QxtCsvScanJob*> jobs;
+    for (int i = 0; i + 1 < bounds.count(); i++)
+        jobs << new QxtCsvScanJob(map, bounds.at(i), bounds.at(i + 1), table, &done);
+    for (int i = 1; i < jobs.count(); i++)
+        QThreadPool::globalInstance()->start(jobs.at(i));
+    jobs.first()->run();
+    done.acquire(jobs.count());
+
+    // join the chunks; one that did not actually start outside quotes is scanned again
+    QxtCsvScanState state;
+    for (int i = 0; i < jobs.count(); i++)
+    {
+        QxtCsvScanJob* job = jobs.at(i);
+        if (i > 0 && !state.isClean())
+        {
+            job->state = state;
+            job->starts.clear();
+            job->maxFields = 0;
+            qxt_scanCsv(map, job->from, job->to, table, job->state, job->starts, job->maxFields);
+        }
+        rowStarts += job->starts;
+        maxFields = qMax(maxFields, job->maxFields);
+        state = job->state;
+    }
+    qDeleteAll(jobs);
+
+    if (rowStarts.last() < size)
+    {
+        rowStarts << size;
+        maxFields = qMax(maxFields, state.fields);
+    }
+}
+
+void QxtCsvModelPrivate::materialize()
+{
+    if (!map)
+        return;
+    QList<QStringList> rows;
+    const int count = rowCount();
+    for (int i = 0; i < count; i++)
+        rows << parseMappedRow(i + firstRow);
+    unmap();
+    csvData = rows;
+}
+
+void QxtCsvModelPrivate::unmap()
+{
+    rowCache.clear();
+    rowStarts.clear();
+    map = 0;
+    firstRow = 0;
+    delete mappedFile;
+    mappedFile = 0;
+}
+
 /*!
   Creates an empty QxtCsvModel with parent \a parent.
   */
@@ -103,7 +271,7 @@ QxtCsvModel::~QxtCsvModel()
 int QxtCsvModel::rowCount(const QModelIndex& parent) const
 {
     if (parent.row() != -1 && parent.column() != -1) return 0;
-    return qxt_d().csvData.count();
+    return qxt_d().rowCount();
 }
 
 /*!
@@ -124,7 +292,7 @@ QVariant QxtCsvModel::data(const QModelIndex& index, int role) const
     if(role == Qt::DisplayRole || role == Qt::EditRole || role == Qt::UserRole) {
         if(index.row() < 0 || index.column() < 0 || index.row() >= rowCount())
             return QVariant();
-        const QStringList& row = qxt_d().csvData[index.row()];
+        const QStringList row = qxt_d().row(index.row());
         if(index.column() >= row.length())
             return QVariant();
         return row[index.column()];
@@ -166,6 +334,7 @@ void QxtCsvModel::setSource(const QString filename, bool withHeader, QChar separ
 void QxtCsvModel::setSource(QIODevice *file, bool withHeader, QChar separator, QTextCodec* codec)
 {
     QxtCsvModelPrivate* d_ptr = &qxt_d();
+    d_ptr->unmap();
     bool headerSet = !withHeader;
     if(!file->isOpen())
         file->open(QIODevice::ReadOnly);
@@ -192,8 +361,10 @@ void QxtCsvModel::setSource(QIODevice *file, bool withHeader, QChar separator, Q
         } else {
             stream >> ch;
         }
-        if(ch == '\n' && readCR) 
+        if(ch == '\n' && readCR) {
+            readCR = false;
             continue;
+        }
         else if(ch == '\r')
             readCR = true;
         else
@@ -250,6 +421,99 @@ void QxtCsvModel::setSource(QIODevice *file, bool withHeader, QChar separator, Q
     file->close();
 }
 
+/*!
+  Maps the CSV file \a filename into memory instead of reading it using \a codec.
+
+  Only the offsets of the rows are computed when the file is opened; large files are
+  indexed by several threads at once. The fields of a row are parsed the first time the
+  row is accessed, and the rowCacheSize() most recently used rows are kept. \a withHeader
+  and \a separator have the same meaning as for setSource(); the quoting mode that is
+  set when the file is mapped is used for as long as it stays mapped.
+
+  Editing the model reads every row into memory and releases the mapping.
+
+  Mapping requires an encoding in which the separator, quotes and line breaks are single
+  ASCII bytes. If \a codec is 0, UTF-8 is assumed. If the file cannot be mapped or its
+  encoding is not supported, it is read with setSource() instead and false is returned.
+
+  \sa isMapped, setSource
+  */
+bool QxtCsvModel::mapSource(const QString& filename, bool withHeader, QChar separator, QTextCodec* codec)
+{
+    QxtCsvModelPrivate* d_ptr = &qxt_d();
+    bool supported = separator.unicode() < 0x80;
+    if(supported && codec)
+        supported = codec->fromUnicode(QString(separator) + "\"'\r\n\\") == QByteArray(1, separator.toLatin1()) + "\"'\r\n\\";
+
+    QFile* file = new QFile(filename);
+    uchar* map = 0;
+    if(supported && file->open(QIODevice::ReadOnly) && file->size() > 0)
+        map = file->map(0, file->size());
+    if(map && file->size() >= 2 && ((map[0] == 0xFF && map[1] == 0xFE) || (map[0] == 0xFE && map[1] == 0xFF)))
+        map = 0;
+    if(!map) {
+        delete file;
+        beginResetModel();
+        setSource(filename, withHeader, separator, codec);
+        endResetModel();
+        return false;
+    }
+
+    beginResetModel();
+    d_ptr->unmap();
+    d_ptr->csvData.clear();
+    d_ptr->mappedFile = file;
+    d_ptr->map = map;
+    d_ptr->codec = codec;
+    d_ptr->table = QxtCsvScanTable(separator.toLatin1(), d_ptr->quoteMode);
+
+    const qint64 size = file->size();
+    qint64 dataStart = 0;
+    if(size >= 3 && map[0] == 0xEF && map[1] == 0xBB && map[2] == 0xBF)
+        dataStart = 3;
+    d_ptr->rowStarts << dataStart;
+    int maxFields = 0;
+    d_ptr->scan(dataStart, size, maxFields);
+
+    if(withHeader && d_ptr->rowStarts.count() > 1) {
+        d_ptr->header = d_ptr->parseMappedRow(0);
+        d_ptr->firstRow = 1;
+    }
+    d_ptr->maxColumn = withHeader ? maxFields : qMax(maxFields, d_ptr->header.size());
+    endResetModel();
+    return true;
+}
+
+/*!
+  Returns true if the content of the model is read from a mapped file.
+
+  \sa mapSource
+  */
+bool QxtCsvModel::isMapped() const
+{
+    return qxt_d().map != 0;
+}
+
+/*!
+  Returns the number of parsed rows that are cached for a mapped file. The default is 1000.
+
+  \sa setRowCacheSize, mapSource
+  */
+int QxtCsvModel::rowCacheSize() const
+{
+    return qxt_d().rowCache.maxCost();
+}
+
+/*!
+  Sets the number of parsed rows that are cached for a mapped file to \a rows.
+
+  \sa rowCacheSize, mapSource
+  */
+void QxtCsvModel::setRowCacheSize(int rows)
+{
+    qxt_d().rowCache.setMaxCost(qMax(0, rows));
+}
+
 /*!
   Sets the horizontal headers of the model to the values provided in \a data.
  */
@@ -284,6 +548,7 @@ bool QxtCsvModel::setData(const QModelIndex& index, const QVariant& data, int ro
 
     if(role == Qt::DisplayRole || role == Qt::EditRole || role == Qt::UserRole) {
         if(index.row() >= rowCount() || index.column() >= columnCount() || index.row() < 0 || index.column() < 0) return false;
+        qxt_d().materialize();
         QStringList& row = qxt_d().csvData[index.row()];
         while(row.length() <= index.column())
             row << QString();
@@ -310,6 +575,7 @@ bool QxtCsvModel::insertRows(int row, int count, const QModelIndex& parent)
     if (parent != QModelIndex() || row < 0) return false;
     emit beginInsertRows(parent, row, row + count);
     QxtCsvModelPrivate& d_ptr = qxt_d();
+    d_ptr.materialize();
     if(row >= rowCount()) {
         for(int i = 0; i < count; i++) d_ptr.csvData << QStringList();
     } else {
@@ -337,6 +603,7 @@ bool QxtCsvModel::removeRows(int row, int count, const QModelIndex& parent)
     if (row + count >= rowCount()) count = rowCount() - row;
     emit beginRemoveRows(parent, row, row + count);
     QxtCsvModelPrivate& d_ptr = qxt_d();
+    d_ptr.materialize();
     for (int i = 0;i < count;i++)
         d_ptr.csvData.removeAt(row);
     emit endRemoveRows();
@@ -359,6 +626,7 @@ bool QxtCsvModel::insertColumns(int col, int count, const QModelIndex& parent)
     if (parent != QModelIndex() || col < 0) return false;
     beginInsertColumns(parent, col, col + count - 1);
     QxtCsvModelPrivate& d_ptr = qxt_d();
+    d_ptr.materialize();
     for(int i = 0; i < rowCount(); i++) {
         QStringList& row = d_ptr.csvData[i];
         while(col >= row.length()) row.append(QString());
@@ -391,6 +659,7 @@ bool QxtCsvModel::removeColumns(int col, int count, const QModelIndex& parent)
     if (col + count >= columnCount()) count = columnCount() - col;
     emit beginRemoveColumns(parent, col, col + count);
     QxtCsvModelPrivate& d_ptr = qxt_d();
+    d_ptr.materialize();
     QString before, after;
     for(int i = 0; i < rowCount(); i++) {
         for(int j = 0; j < count; j++) {
@@ -403,31 +672,6 @@ bool QxtCsvModel::removeColumns(int col, int count, const QModelIndex& parent)
     return true;
 }
 
-static QString qxt_addCsvQuotes(QxtCsvModel::QuoteMode mode, QString field)
-{
-    bool addDoubleQuotes = ((mode & QxtCsvModel::DoubleQuote) && field.contains('"'));
-    bool addSingleQuotes = ((mode & QxtCsvModel::SingleQuote) && field.contains('\''));
-    bool quoteField = (mode & QxtCsvModel::AlwaysQuoteOutput) || addDoubleQuotes || addSingleQuotes;
-    if(quoteField && !addDoubleQuotes && !addSingleQuotes) {
-        if(mode & QxtCsvModel::DoubleQuote)
-            addDoubleQuotes = true;
-        else if(mode & QxtCsvModel::SingleQuote)
-            addSingleQuotes = true;
-    } 
-    if(mode & QxtCsvModel::BackslashEscape) {
-        if(addDoubleQuotes) 
-            return '"' + field.replace("\\", "\\\\").replace("\"", "\\\"") + '"';
-        if(addSingleQuotes)
-            return '\'' + field.replace("\\", "\\\\").replace("'", "\\'") + '\'';
-    } else {
-        if(addDoubleQuotes) 
-            return '"' + field.replace("\"", "\"\"") + '"';
-        if(addSingleQuotes)
-            return '\'' + field.replace("'", "''") + '\'';
-    }
-    return field;
-}
-
 /*!
   Outputs the content of the model as a CSV file to the device \a dest using \a codec.
 
@@ -437,35 +681,25 @@ static QString qxt_addCsvQuotes(QxtCsvModel::QuoteMode mode, QString field)
 void QxtCsvModel::toCSV(QIODevice* dest, bool withHeader, QChar separator, QTextCodec* codec) const
 {
     const QxtCsvModelPrivate& d_ptr = qxt_d();
-    int row, col, rows, cols;
+    int row, rows, cols;
     rows = rowCount();
     cols = columnCount();
-    QString data;
     if(!dest->isOpen()) dest->open(QIODevice::WriteOnly | QIODevice::Truncate);
-    QTextStream stream(dest);
-    if(codec) stream.setCodec(codec);
+    QxtCsvWriter writer(dest, separator, d_ptr.quoteMode);
+    writer.setCodec(codec ? codec : QTextCodec::codecForLocale());
     if(withHeader) {
-        data = "";
-        for(col = 0; col < cols; ++col) {
-            if(col > 0) data += separator;
-            data += qxt_addCsvQuotes(d_ptr.quoteMode, d_ptr.header.at(col)); 
-        }
-        stream << data << endl;
+        QStringList header = d_ptr.header.mid(0, cols);
+        while(header.length() < cols) header << QString();
+        writer.writeRow(header);
     }
     for(row = 0; row < rows; ++row)
     {
-        const QStringList& rowData = d_ptr.csvData[row];
-        data = "";
-        for(col = 0; col < cols; ++col) {
-            if(col > 0) data += separator;
-            if(col < rowData.length())
-                data += qxt_addCsvQuotes(d_ptr.quoteMode, rowData.at(col)); 
-            else
-                data += qxt_addCsvQuotes(d_ptr.quoteMode, QString());; 
-        }
-        stream << data << endl;
+        QStringList rowData = d_ptr.row(row);
+        if(rowData.length() > cols) rowData = rowData.mid(0, cols);
+        while(rowData.length() < cols) rowData << QString();
+        writer.writeRow(rowData);
     }
-    stream << flush;
+    writer.flush();
     dest->close();
 }
 
@@ -75,6 +75,11 @@ public:
 
     void setSource(QIODevice *file, bool withHeader = false, QChar separator = ',', QTextCodec* codec = 0);
     void setSource(const QString filename, bool withHeader = false, QChar separator = ',', QTextCodec* codec = 0);
+    bool mapSource(const QString& filename, bool withHeader = false, QChar separator = ',', QTextCodec* codec = 0);
+    bool isMapped() const;
+
+    int rowCacheSize() const;
+    void setRowCacheSize(int rows);
 
     void toCSV(QIODevice *file, bool withHeader = false, QChar separator = ',', QTextCodec* codec = 0) const;
     void toCSV(const QString filename, bool withHeader = false, QChar separator = ',', QTextCodec* codec = 0) const;
@@ -0,0 +1,313 @@
+/****************************************************************************
+** Copyright (c) 2006 - 2011, the LibQxt project.
+** See the Qxt AUTHORS file for a list of authors and copyright holders.
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**     * Redistributions of source code must retain the above copyright
+**       notice, this list of conditions and the following disclaimer.
+**     * Redistributions in binary form must reproduce the above copyright
+**       notice, this list of conditions and the following disclaimer in the
+**       documentation and/or other materials provided with the distribution.
+**     * Neither the name of the LibQxt project nor the
+**       names of its contributors may be used to endorse or promote products
+**       derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+** ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+** DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+** (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+** LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+** ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** <http://libqxt.org>  <foundation@libqxt.org>
+*****************************************************************************/
+
+/*!
+\class QxtCsvReader
+\inmodule QxtCore
+\brief The QxtCsvReader class reads CSV data row by row from a QIODevice
+
+QxtCsvReader parses CSV data without building a model, so files of any size can be
+processed in constant memory. It accepts the same syntax as QxtCsvModel::setSource()
+and honours every QxtCsvModel::QuoteMode flag.
+
+\code
+QFile file("data.csv");
+QxtCsvReader reader(&file);
+QStringList row;
+while (reader.readRow(row))
+    process(row);
+\endcode
+
+Rows can also be passed to a function or functor with readRows().
+
+The device is read in large blocks, which are scanned for separators, quotes and line
+breaks with the widest vector instructions the CPU supports. The data must use an
+encoding in which these characters are single ASCII bytes, such as UTF-8 or ISO 8859-1.
+
+\sa QxtCsvWriter, QxtCsvModel
+ */
+
+#include "qxtcsvreader.h"
+#include "qxtcsvscanner_p.h"
+#include <QIODevice>
+#include <QTextCodec>
+
+static const int qxt_csvReadBlock = 256 * 1024;
+
+class QxtCsvReaderPrivate : public QxtPrivate<QxtCsvReader>
+{
+public:
+    QxtCsvReaderPrivate() : device(0), separator(','), quoteMode(QxtCsvModel::DefaultQuoteMode), codec(0),
+            dirty(true), consumed(0), scanned(0), nextEnd(0), started(false), eof(false), rows(0)
+    {}
+    QXT_DECLARE_PUBLIC(QxtCsvReader)
+
+    void reset();
+    bool fill();
+    void split(int from, int to, QStringList& row);
+
+    QIODevice* device;
+    QChar separator;
+    QxtCsvModel::QuoteMode quoteMode;
+    QTextCodec* codec;
+    bool dirty;
+    QxtCsvScanTable table;
+
+    // buffer holds the unread data; ends holds the end offsets of the complete rows in it
+    QByteArray buffer;
+    int consumed;
+    int scanned;
+    QxtCsvScanState state;
+    QVector<qint64> ends;
+    int nextEnd;
+    bool started;
+    bool eof;
+    qint64 rows;
+};
+
+void QxtCsvReaderPrivate::reset()
+{
+    buffer.clear();
+    consumed = 0;
+    scanned = 0;
+    state = QxtCsvScanState();
+    ends.clear();
+    nextEnd = 0;
+    started = false;
+    eof = false;
+    rows = 0;
+}
+
+bool QxtCsvReaderPrivate::fill()
+{
+    if (consumed > 0)
+    {
+        buffer.remove(0, consumed);
+        scanned -= consumed;
+        consumed = 0;
+    }
+    ends.clear();
+    nextEnd = 0;
+
+    if (!device->isOpen())
+        device->open(QIODevice::ReadOnly);
+    const int old = buffer.size();
+    buffer.resize(old + qxt_csvReadBlock);
+    const qint64 read = device->read(buffer.data() + old, qxt_csvReadBlock);
+    buffer.resize(old + int(qMax(read, qint64(0))));
+    if (read <= 0)
+    {
+        if (read == 0 && !device->atEnd())
+            return false;
+        eof = true;
+    }
+
+    if (!started)
+    {
+        if (buffer.size() < 3 && !eof)
+            return true;
+        started = true;
+        if (buffer.startsWith("\xEF\xBB\xBF"))
+            consumed = scanned = 3;
+    }
+    if (dirty)
+    {
+        if (separator.unicode() >= 0x80)
+            qWarning("QxtCsvReader: the separator must be an ASCII character");
+        table = QxtCsvScanTable(separator.toLatin1(), quoteMode);
+        dirty = false;
+    }
+
+    // a "\r" at the end of the block may be the first half of "\r\n"
+    int limit = buffer.size();
+    if (!eof && limit > scanned && buffer.at(limit - 1) == '\r')
+        limit--;
+    int maxFields = 0;
+    qxt_scanCsv(reinterpret_cast<const uchar*>(buffer.constData()), scanned, limit, table, state, ends, maxFields);
+    scanned = limit;
+    return true;
+}
+
+void QxtCsvReaderPrivate::split(int from, int to, QStringList& row)
+{
+    row.clear();
+    qxt_splitCsvRow(buffer.constData() + from, buffer.constData() + to, table, codec, row);
+    consumed = to;
+    rows++;
+}
+
+/*!
+  Creates a reader that reads from \a device. Fields are separated by \a separator and
+  quoted according to \a mode.
+  */
+QxtCsvReader::QxtCsvReader(QIODevice* device, QChar separator, QxtCsvModel::QuoteMode mode)
+{
+    QXT_INIT_PRIVATE(QxtCsvReader);
+    qxt_d().device = device;
+    qxt_d().separator = separator;
+    qxt_d().quoteMode = mode;
+}
+
+/*!
+  Destroys the reader. The device is not closed.
+  */
+QxtCsvReader::~QxtCsvReader()
+{
+}
+
+/*!
+  Returns the device the reader reads from.
+  */
+QIODevice* QxtCsvReader::device() const
+{
+    return qxt_d().device;
+}
+
+/*!
+  Sets the device the reader reads from to \a device and starts reading from its current
+  position. The device is opened for reading if it is not open yet.
+  */
+void QxtCsvReader::setDevice(QIODevice* device)
+{
+    qxt_d().reset();
+    qxt_d().device = device;
+}
+
+/*!
+  Returns the field separator. The default is a comma.
+  */
+QChar QxtCsvReader::separator() const
+{
+    return qxt_d().separator;
+}
+
+/*!
+  Sets the field separator to \a separator, which must be an ASCII character.
+  */
+void QxtCsvReader::setSeparator(QChar separator)
+{
+    qxt_d().separator = separator;
+    qxt_d().dirty = true;
+}
+
+/*!
+  Returns the quoting mode.
+  */
+QxtCsvModel::QuoteMode QxtCsvReader::quoteMode() const
+{
+    return qxt_d().quoteMode;
+}
+
+/*!
+  Sets the quoting mode to \a mode.
+
+  \sa QxtCsvModel::QuoteOption
+  */
+void QxtCsvReader::setQuoteMode(QxtCsvModel::QuoteMode mode)
+{
+    qxt_d().quoteMode = mode;
+    qxt_d().dirty = true;
+}
+
+/*!
+  Returns the codec used to decode fields, or 0 if fields are decoded as UTF-8.
+  */
+QTextCodec* QxtCsvReader::codec() const
+{
+    return qxt_d().codec;
+}
+
+/*!
+  Sets the codec used to decode fields to \a codec. If \a codec is 0, UTF-8 is used.
+  */
+void QxtCsvReader::setCodec(QTextCodec* codec)
+{
+    qxt_d().codec = codec;
+}
+
+/*!
+  Reads the next row into \a row and returns true, or returns false if no complete row
+  is available.
+
+  For sequential devices such as sockets, false may also mean that the rest of the row
+  has not arrived yet; use atEnd() to tell the cases apart.
+  */
+bool QxtCsvReader::readRow(QStringList& row)
+{
+    QxtCsvReaderPrivate& d = qxt_d();
+    if (!d.device)
+        return false;
+    for (;;)
+    {
+        if (d.nextEnd < d.ends.count())
+        {
+            d.split(d.consumed, int(d.ends.at(d.nextEnd++)), row);
+            return true;
+        }
+        if (d.eof)
+        {
+            if (d.consumed == d.buffer.size())
+                return false;
+            d.split(d.consumed, d.buffer.size(), row);
+            return true;
+        }
+        if (!d.fill())
+            return false;
+    }
+}
+
+/*!
+  Returns true if every row of the device has been read.
+  */
+bool QxtCsvReader::atEnd() const
+{
+    const QxtCsvReaderPrivate& d = qxt_d();
+    if (!d.device)
+        return true;
+    return d.nextEnd == d.ends.count() && d.consumed == d.buffer.size() && (d.eof || d.device->atEnd());
+}
+
+/*!
+  Returns the number of rows read since the device was set.
+  */
+qint64 QxtCsvReader::rowsRead() const
+{
+    return qxt_d().rows;
+}
+
+/*!
+  \fn qint64 QxtCsvReader::readRows(Handler handler)
+
+  Reads the remaining rows and calls \a handler with each of them. \a handler is a
+  function or functor that takes a \c{const QStringList&} and returns false to stop
+  reading. Returns the number of rows passed to \a handler.
+
+  The list passed to \a handler is reused for the next row; copy it to keep it.
+  */
@@ -0,0 +1,310 @@
+/****************************************************************************
+** Copyright (c) 2006 - 2011, the LibQxt project.
+** See the Qxt AUTHORS file for a list of authors and copyright holders.
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**     * Redistributions of source code must retain the above copyright
+**       notice, this list of conditions and the following disclaimer.
+**     * Redistributions in binary form must reproduce the above copyright
+**       notice, this list of conditions and the following disclaimer in the
+**       documentation and/or other materials provided with the distribution.
+**     * Neither the name of the LibQxt project nor the
+**       names of its contributors may be used to endorse or promote products
+**       derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+** ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+** DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+** (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+** LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+** ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** <http://libqxt.org>  <foundation@libqxt.org>
+*****************************************************************************/
+
+#include "qxtcsvscanner_p.h"
+#include "qxtcpufeatures_p.h"
+#include <QTextCodec>
+#include <cstring>
+
+#if defined(QXT_HAVE_SSE2) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+QxtCsvScanTable::QxtCsvScanTable() : separator(','), mode(QxtCsvModel::DefaultQuoteMode)
+{
+    memset(classes, QxtCsvPlain, sizeof(classes));
+}
+
+QxtCsvScanTable::QxtCsvScanTable(char separator, QxtCsvModel::QuoteMode mode) : separator(separator), mode(mode)
+{
+    memset(classes, QxtCsvPlain, sizeof(classes));
+    for (int c = 0; c < 0x20; c++)
+        classes[c] = QxtCsvTerminator;
+    classes[0x7F] = QxtCsvTerminator;
+    if (mode & QxtCsvModel::DoubleQuote)
+        classes[uchar('"')] = QxtCsvQuote;
+    if (mode & QxtCsvModel::SingleQuote)
+        classes[uchar('\'')] = QxtCsvQuote;
+    classes[uchar(separator)] = QxtCsvSeparator;
+}
+
+QxtCsvNeedles QxtCsvScanTable::outsideQuotes(bool controls) const
+{
+    QxtCsvNeedles needles(uchar(separator), controls);
+    if (mode & QxtCsvModel::DoubleQuote)
+        needles.add('"');
+    if (mode & QxtCsvModel::SingleQuote)
+        needles.add('\'');
+    return needles;
+}
+
+QxtCsvNeedles QxtCsvScanTable::insideQuotes(uchar quote) const
+{
+    QxtCsvNeedles needles(quote);
+    if (mode & QxtCsvModel::BackslashEscape)
+        needles.add('\\');
+    return needles;
+}
+
+static const uchar* qxt_csvFindScalar(const uchar* p, const uchar* end, const QxtCsvNeedles& needles)
+{
+    const uchar b0 = needles.bytes[0], b1 = needles.bytes[1], b2 = needles.bytes[2], b3 = needles.bytes[3];
+    for (; p < end; ++p)
+    {
+        const uchar c = *p;
+        if (c == b0 || c == b1 || c == b2 || c == b3)
+            return p;
+        if (needles.controls && (c < 0x20 || c == 0x7F))
+            return p;
+    }
+    return end;
+}
+
+#ifdef QXT_HAVE_SSE2
+static inline int qxt_csvFirstBit(quint32 mask)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return int(index);
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+static const uchar* qxt_csvFindSse2(const uchar* p, const uchar* end, const QxtCsvNeedles& needles)
+{
+    const __m128i b0 = _mm_set1_epi8(char(needles.bytes[0]));
+    const __m128i b1 = _mm_set1_epi8(char(needles.bytes[1]));
+    const __m128i b2 = _mm_set1_epi8(char(needles.bytes[2]));
+    const __m128i b3 = _mm_set1_epi8(char(needles.bytes[3]));
+    const __m128i lastControl = _mm_set1_epi8(0x1F);
+    const __m128i del = _mm_set1_epi8(0x7F);
+    while (end - p >= 16)
+    {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, b0), _mm_cmpeq_epi8(v, b1)),
+                                    _mm_or_si128(_mm_cmpeq_epi8(v, b2), _mm_cmpeq_epi8(v, b3)));
+        if (needles.controls)
+        {
+            // max(v, 0x1F) == 0x1F exactly for the unsigned bytes below 0x20
+            hits = _mm_or_si128(hits, _mm_or_si128(_mm_cmpeq_epi8(_mm_max_epu8(v, lastControl), lastControl),
+                                                   _mm_cmpeq_epi8(v, del)));
+        }
+        const quint32 mask = quint32(_mm_movemask_epi8(hits));
+        if (mask)
+            return p + qxt_csvFirstBit(mask);
+        p += 16;
+    }
+    return qxt_csvFindScalar(p, end, needles);
+}
+#endif
+
+#ifdef QXT_HAVE_AVX2
+__attribute__((target("avx2")))
+static const uchar* qxt_csvFindAvx2(const uchar* p, const uchar* end, const QxtCsvNeedles& needles)
+{
+    const __m256i b0 = _mm256_set1_epi8(char(needles.bytes[0]));
+    const __m256i b1 = _mm256_set1_epi8(char(needles.bytes[1]));
+    const __m256i b2 = _mm256_set1_epi8(char(needles.bytes[2]));
+    const __m256i b3 = _mm256_set1_epi8(char(needles.bytes[3]));
+    const __m256i lastControl = _mm256_set1_epi8(0x1F);
+    const __m256i del = _mm256_set1_epi8(0x7F);
+    while (end - p >= 32)
+    {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i hits = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, b0), _mm256_cmpeq_epi8(v, b1)),
+                                       _mm256_or_si256(_mm256_cmpeq_epi8(v, b2), _mm256_cmpeq_epi8(v, b3)));
+        if (needles.controls)
+        {
+            hits = _mm256_or_si256(hits, _mm256_or_si256(_mm256_cmpeq_epi8(_mm256_max_epu8(v, lastControl), lastControl),
+                                                         _mm256_cmpeq_epi8(v, del)));
+        }
+        const quint32 mask = quint32(_mm256_movemask_epi8(hits));
+        if (mask)
+            return p + qxt_csvFirstBit(mask);
+        p += 32;
+    }
+    return qxt_csvFindSse2(p, end, needles);
+}
+#endif
+
+const uchar* qxt_csvFind(const uchar* p, const uchar* end, const QxtCsvNeedles& needles)
+{
+#ifdef QXT_HAVE_AVX2
+    if (qxt_cpuFeatures() & QxtCpuAvx2)
+        return qxt_csvFindAvx2(p, end, needles);
+#endif
+#ifdef QXT_HAVE_SSE2
+    return qxt_csvFindSse2(p, end, needles);
+#else
+    return qxt_csvFindScalar(p, end, needles);
+#endif
+}
+
+void qxt_scanCsv(const uchar* base, qint64 from, qint64 to, const QxtCsvScanTable& table,
+                 QxtCsvScanState& state, QVector<qint64>& starts, int& maxFields)
+{
+    const uchar* p = base + from;
+    const uchar* end = base + to;
+    const bool backslash = table.mode & QxtCsvModel::BackslashEscape;
+    const bool twoQuote = table.mode & QxtCsvModel::TwoQuoteEscape;
+    const QxtCsvNeedles outside = table.outsideQuotes();
+    while (p < end)
+    {
+        if (state.quote)
+        {
+            if (state.closing)
+            {
+                state.closing = false;
+                if (*p == state.quote)
+                {
+                    ++p;
+                    continue;
+                }
+                state.quote = 0;
+                continue;
+            }
+            if (state.escaped)
+            {
+                state.escaped = false;
+                ++p;
+                continue;
+            }
+            p = qxt_csvFind(p, end, table.insideQuotes(state.quote));
+            if (p == end)
+                break;
+            if (*p++ == '\\' && backslash)
+                state.escaped = true;
+            else if (twoQuote)
+                state.closing = true;
+            else
+                state.quote = 0;
+            continue;
+        }
+
+        p = qxt_csvFind(p, end, outside);
+        if (p == end)
+            break;
+        const uchar c = *p++;
+        switch (table.classes[c])
+        {
+        case QxtCsvSeparator:
+            state.fields++;
+            break;
+        case QxtCsvQuote:
+            state.quote = c;
+            break;
+        case QxtCsvTerminator:
+            if (c == '\r' && p < end && *p == '\n')
+                ++p;
+            if (state.fields > maxFields)
+                maxFields = state.fields;
+            state.fields = 1;
+            starts.append(p - base);
+            break;
+        }
+    }
+}
+
+static inline QString qxt_decodeCsv(const char* data, int size, QTextCodec* codec)
+{
+    if (codec)
+        return codec->toUnicode(data, size);
+    return QString::fromUtf8(data, size);
+}
+
+void qxt_splitCsvRow(const char* p, const char* end, const QxtCsvScanTable& table, QTextCodec* codec,
+                     QStringList& fields)
+{
+    if (end > p && end[-1] == '\n')
+    {
+        --end;
+        if (end > p && end[-1] == '\r')
+            --end;
+    }
+    else if (end > p && table.classes[uchar(end[-1])] == QxtCsvTerminator)
+    {
+        --end;
+    }
+
+    const bool backslash = table.mode & QxtCsvModel::BackslashEscape;
+    const bool twoQuote = table.mode & QxtCsvModel::TwoQuoteEscape;
+    const QxtCsvNeedles outside = table.outsideQuotes(false);
+    QByteArray buffer;
+    bool buffered = false;
+    const char* start = p;
+    for (;;)
+    {
+        const char* next = reinterpret_cast<const char*>(qxt_csvFind(reinterpret_cast<const uchar*>(p),
+                                                                     reinterpret_cast<const uchar*>(end), outside));
+        if (buffered)
+            buffer.append(p, next - p);
+        p = next;
+        if (p == end || *p == table.separator)
+        {
+            fields << (buffered ? qxt_decodeCsv(buffer.constData(), buffer.size(), codec)
+                                : qxt_decodeCsv(start, p - start, codec));
+            if (p == end)
+                break;
+            start = ++p;
+            buffer.clear();
+            buffered = false;
+            continue;
+        }
+
+        // quoted sections are unescaped into the buffer
+        if (!buffered)
+        {
+            buffer = QByteArray(start, p - start);
+            buffered = true;
+        }
+        const char quote = *p++;
+        while (p < end)
+        {
+            const char c = *p++;
+            if (c == '\\' && backslash)
+            {
+                if (p < end)
+                    buffer += *p++;
+            }
+            else if (c == quote)
+            {
+                if (!twoQuote || p == end || *p != quote)
+                    break;
+                buffer += *p++;
+            }
+            else
+            {
+                buffer += c;
+            }
+        }
+    }
+}
@@ -0,0 +1,112 @@
+/****************************************************************************
+** Copyright (c) 2006 - 2011, the LibQxt project.
+** See the Qxt AUTHORS file for a list of authors and copyright holders.
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**     * Redistributions of source code must retain the above copyright
+**       notice, this list of conditions and the following disclaimer.
+**     * Redistributions in binary form must reproduce the above copyright
+**       notice, this list of conditions and the following disclaimer in the
+**       documentation and/or other materials provided with the distribution.
+**     * Neither the name of the LibQxt project nor the
+**       names of its contributors may be used to endorse or promote products
+**       derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+** ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+** DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+** (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+** LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+** ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** <http://libqxt.org>  <foundation@libqxt.org>
+*****************************************************************************/
+
+#ifndef QXTCSVSCANNER_P_H
+#define QXTCSVSCANNER_P_H
+
+#include "qxtcsvmodel.h"
+#include <QVector>
+#include <QStringList>
+
+class QTextCodec;
+
+// Byte classes used when scanning CSV data. Like QxtCsvModel::setSource(), the scanner ends
+// a row at any control character other than the separator.
+enum QxtCsvByteClass
+{
+    QxtCsvPlain = 0,
+    QxtCsvSeparator,
+    QxtCsvQuote,
+    QxtCsvTerminator
+};
+
+// Up to four bytes to look for, optionally together with every control character.
+struct QxtCsvNeedles
+{
+    QxtCsvNeedles(uchar first, bool controls = false) : controls(controls)
+    {
+        bytes[0] = bytes[1] = bytes[2] = bytes[3] = first;
+        count = 1;
+    }
+    void add(uchar byte)
+    {
+        if (count < 4)
+            bytes[count++] = byte;
+    }
+
+    uchar bytes[4];
+    int count;
+    bool controls;
+};
+
+class QxtCsvScanTable
+{
+public:
+    QxtCsvScanTable();
+    QxtCsvScanTable(char separator, QxtCsvModel::QuoteMode mode);
+
+    QxtCsvNeedles outsideQuotes(bool controls = true) const;
+    QxtCsvNeedles insideQuotes(uchar quote) const;
+
+    uchar classes[256];
+    char separator;
+    QxtCsvModel::QuoteMode mode;
+};
+
+struct QxtCsvScanState
+{
+    QxtCsvScanState() : quote(0), escaped(false), closing(false), fields(1) {}
+
+    bool isClean() const
+    {
+        return !quote && !escaped && !closing;
+    }
+
+    uchar quote;        // quote character of the open quoted section, 0 outside quotes
+    bool escaped;       // a backslash escape is pending inside quotes
+    bool closing;       // a quote character was seen inside quotes; it may be doubled
+    int fields;         // fields of the current row so far
+};
+
+// Returns the first byte in [p, end) that matches needles, or end. Uses the widest vector
+// instructions the CPU supports.
+const uchar* qxt_csvFind(const uchar* p, const uchar* end, const QxtCsvNeedles& needles);
+
+// Scans [from, to) of base, appending the offset that follows every row terminator to
+// starts and keeping track of the largest number of fields in a row.
+void qxt_scanCsv(const uchar* base, qint64 from, qint64 to, const QxtCsvScanTable& table,
+                 QxtCsvScanState& state, QVector<qint64>& starts, int& maxFields);
+
+// Splits the row in [p, end), which may include its terminator, into fields decoded with
+// codec, or UTF-8 if codec is 0.
+void qxt_splitCsvRow(const char* p, const char* end, const QxtCsvScanTable& table, QTextCodec* codec,
+                     QStringList& fields);
+
+#endif // QXTCSVSCANNER_P_H
@@ -0,0 +1,278 @@
+/****************************************************************************
+** Copyright (c) 2006 - 2011, the LibQxt project.
+** See the Qxt AUTHORS file for a list of authors and copyright holders.
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**     * Redistributions of source code must retain the above copyright
+**       notice, this list of conditions and the following disclaimer.
+**     * Redistributions in binary form must reproduce the above copyright
+**       notice, this list of conditions and the following disclaimer in the
+**       documentation and/or other materials provided with the distribution.
+**     * Neither the name of the LibQxt project nor the
+**       names of its contributors may be used to endorse or promote products
+**       derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+** ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+** DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+** (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+** LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+** ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** <http://libqxt.org>  <foundation@libqxt.org>
+*****************************************************************************/
+
+/*!
+\class QxtCsvWriter
+\inmodule QxtCore
+\brief The QxtCsvWriter class writes CSV data row by row to a QIODevice
+
+QxtCsvWriter produces CSV data without building a model. Its output can be read by
+QxtCsvReader and QxtCsvModel using the same separator and quoting mode.
+
+\code
+QFile file("data.csv");
+file.open(QIODevice::WriteOnly);
+QxtCsvWriter writer(&file);
+writer.writeRow(QStringList() << "id" << "name");
+writer.writeRow(QStringList() << "1" << "Smith, John");
+writer.flush();
+\endcode
+
+Fields are quoted if the quoting mode includes QxtCsvModel::AlwaysQuoteOutput, or if
+they contain the separator, a quote character or a line break. Output is collected in a
+buffer that is written to the device in large blocks, and when flush() is called or the
+writer is destroyed.
+
+\sa QxtCsvReader, QxtCsvModel
+ */
+
+#include "qxtcsvwriter.h"
+#include <QIODevice>
+#include <QTextCodec>
+
+static const int qxt_csvWriteBlock = 256 * 1024;
+
+class QxtCsvWriterPrivate : public QxtPrivate<QxtCsvWriter>
+{
+public:
+    QxtCsvWriterPrivate() : device(0), separator(','), quoteMode(QxtCsvModel::DefaultQuoteMode),
+            codec(0), encoder(0), rows(0)
+    {}
+    ~QxtCsvWriterPrivate()
+    {
+        delete encoder;
+    }
+    QXT_DECLARE_PUBLIC(QxtCsvWriter)
+
+    void appendField(const QString& field);
+
+    QIODevice* device;
+    QChar separator;
+    QxtCsvModel::QuoteMode quoteMode;
+    QTextCodec* codec;
+    QTextEncoder* encoder;
+    QString line;
+    QByteArray buffer;
+    qint64 rows;
+};
+
+void QxtCsvWriterPrivate::appendField(const QString& field)
+{
+    QChar quote;
+    if (quoteMode & QxtCsvModel::DoubleQuote)
+        quote = QLatin1Char('"');
+    else if (quoteMode & QxtCsvModel::SingleQuote)
+        quote = QLatin1Char('\'');
+
+    const QChar* data = field.constData();
+    const int size = field.size();
+    bool quoted = !quote.isNull() && (quoteMode & QxtCsvModel::AlwaysQuoteOutput);
+    bool escapes = false;
+    if (!quote.isNull())
+    {
+        for (int i = 0; i < size; i++)
+        {
+            const ushort c = data[i].unicode();
+            if (c == quote.unicode() || (c == '\\' && (quoteMode & QxtCsvModel::BackslashEscape)))
+            {
+                quoted = escapes = true;
+                break;
+            }
+            if (c == separator.unicode() || c < 0x20 || c == 0x7F || c == '"' || c == '\'')
+                quoted = true;
+        }
+    }
+    if (!quoted)
+    {
+        line.append(data, size);
+        return;
+    }
+
+    line += quote;
+    if (!escapes)
+    {
+        line.append(data, size);
+    }
+    else
+    {
+        const bool backslash = quoteMode & QxtCsvModel::BackslashEscape;
+        for (int i = 0; i < size; i++)
+        {
+            const QChar c = data[i];
+            if (c == quote)
+                line += backslash ? QLatin1Char('\\') : quote;
+            else if (backslash && c == QLatin1Char('\\'))
+                line += QLatin1Char('\\');
+            line += c;
+        }
+    }
+    line += quote;
+}
+
+/*!
+  Creates a writer that writes to \a device. Fields are separated by \a separator and
+  quoted according to \a mode.
+  */
+QxtCsvWriter::QxtCsvWriter(QIODevice* device, QChar separator, QxtCsvModel::QuoteMode mode)
+{
+    QXT_INIT_PRIVATE(QxtCsvWriter);
+    qxt_d().device = device;
+    qxt_d().separator = separator;
+    qxt_d().quoteMode = mode;
+}
+
+/*!
+  Flushes any buffered rows and destroys the writer. The device is not closed.
+  */
+QxtCsvWriter::~QxtCsvWriter()
+{
+    flush();
+}
+
+/*!
+  Returns the device the writer writes to.
+  */
+QIODevice* QxtCsvWriter::device() const
+{
+    return qxt_d().device;
+}
+
+/*!
+  Flushes any buffered rows to the current device and sets the device to \a device.
+  */
+void QxtCsvWriter::setDevice(QIODevice* device)
+{
+    flush();
+    qxt_d().device = device;
+    qxt_d().rows = 0;
+}
+
+/*!
+  Returns the field separator. The default is a comma.
+  */
+QChar QxtCsvWriter::separator() const
+{
+    return qxt_d().separator;
+}
+
+/*!
+  Sets the field separator to \a separator.
+  */
+void QxtCsvWriter::setSeparator(QChar separator)
+{
+    qxt_d().separator = separator;
+}
+
+/*!
+  Returns the quoting mode.
+  */
+QxtCsvModel::QuoteMode QxtCsvWriter::quoteMode() const
+{
+    return qxt_d().quoteMode;
+}
+
+/*!
+  Sets the quoting mode to \a mode. A field is quoted with double quotes if \a mode
+  includes QxtCsvModel::DoubleQuote, and with single quotes otherwise. Quotes inside
+  a field are escaped with a backslash if \a mode includes QxtCsvModel::BackslashEscape,
+  and doubled otherwise.
+
+  \sa QxtCsvModel::QuoteOption
+  */
+void QxtCsvWriter::setQuoteMode(QxtCsvModel::QuoteMode mode)
+{
+    qxt_d().quoteMode = mode;
+}
+
+/*!
+  Returns the codec used to encode rows, or 0 if rows are encoded as UTF-8.
+  */
+QTextCodec* QxtCsvWriter::codec() const
+{
+    return qxt_d().codec;
+}
+
+/*!
+  Sets the codec used to encode rows to \a codec. If \a codec is 0, UTF-8 is used.
+  */
+void QxtCsvWriter::setCodec(QTextCodec* codec)
+{
+    QxtCsvWriterPrivate& d = qxt_d();
+    delete d.encoder;
+    d.encoder = codec ? codec->makeEncoder() : 0;
+    d.codec = codec;
+}
+
+/*!
+  Writes \a row followed by a line break.
+  */
+void QxtCsvWriter::writeRow(const QStringList& row)
+{
+    QxtCsvWriterPrivate& d = qxt_d();
+    d.line.clear();
+    for (int i = 0; i < row.size(); i++)
+    {
+        if (i > 0)
+            d.line += d.separator;
+        d.appendField(row.at(i));
+    }
+    d.line += QLatin1Char('\n');
+    if (d.encoder)
+        d.buffer += d.encoder->fromUnicode(d.line);
+    else
+        d.buffer += d.line.toUtf8();
+    d.rows++;
+    if (d.buffer.size() >= qxt_csvWriteBlock)
+        flush();
+}
+
+/*!
+  Writes any buffered rows to the device. Returns false if the device reported an error.
+  */
+bool QxtCsvWriter::flush()
+{
+    QxtCsvWriterPrivate& d = qxt_d();
+    if (d.buffer.isEmpty() || !d.device)
+        return true;
+    if (!d.device->isOpen())
+        d.device->open(QIODevice::WriteOnly | QIODevice::Truncate);
+    const qint64 written = d.device->write(d.buffer);
+    const bool ok = written == qint64(d.buffer.size());
+    d.buffer.clear();
+    return ok;
+}
+
+/*!
+  Returns the number of rows written since the device was set.
+  */
+qint64 QxtCsvWriter::rowsWritten() const
+{
+    return qxt_d().rows;
+}
@@ -31,6 +31,7 @@
 
 #include <QDebug>
 #include "qxtcurrency.h"
+#include "qxtcurrency_p.h"
 #include <stdlib.h>
 #include <stdint.h>
 
@@ -104,6 +105,29 @@ QDataStream &operator>>(QDataStream &in, QxtCurrency &v)
     return in;
 }
 
+static int qxt_currencySymbol(const QString &symbol, char *out)
+{
+    const QByteArray utf8 = symbol.toUtf8();
+    const int size = qMin(utf8.size(), 4);
+    ::memcpy(out, utf8.constData(), size);
+    return size;
+}
+
+QxtCurrencySymbols::QxtCurrencySymbols()
+    : decimalSize(1), groupSize(0)
+{
+    decimal[0] = '.';
+}
+
+QxtCurrencySymbols::QxtCurrencySymbols(const QLocale &locale)
+{
+    decimalSize = qxt_currencySymbol(QString(locale.decimalPoint()), decimal);
+    if(locale.numberOptions() & QLocale::OmitGroupSeparator)
+	groupSize = 0;
+    else
+	groupSize = qxt_currencySymbol(QString(locale.groupSeparator()), group);
+}
+
 //////////////////////////////////////////////////////////////////////////////
 // QxtCurrency class
 
@@ -116,14 +140,18 @@ QxtCurrency QxtCurrency::fromVariant(const QVariant &v)
     QxtCurrency result;
     if(v.isNull())
 	result.setNull();
+    else if(v.userType() == qMetaTypeId<QxtCurrency>())
+	result = v.value<QxtCurrency>();
     else{
 	switch(v.type()){
 	case QVariant::ByteArray:
-	    result = QxtCurrency(v.toByteArray().constData());
+	    result.parseASCII(v.toByteArray().constData());
 	    break;
-	case QVariant::String:
-	    result = QxtCurrency(v.toString());
+	case QVariant::String:{
+	    const QString s = v.toString();
+	    result.value = qxt_currencyParse(s.utf16(), s.utf16() + s.size());
 	    break;
+	}
 	case QVariant::Int:
 	case QVariant::UInt:
 	    result = QxtCurrency(v.toInt());
@@ -138,10 +166,7 @@ QxtCurrency QxtCurrency::fromVariant(const QVariant &v)
 	case QVariant::Invalid:
 	    break; // Treating as zero
 	default:
-	    if(v.userType() == qMetaTypeId<QxtCurrency>())
-		result = v.value<QxtCurrency>();
-	    else
-		qWarning() << "Conversion failure in QxtCurrency::fromVariant";
+	    qWarning() << "Conversion failure in QxtCurrency::fromVariant";
 	}
     }
     return result;
@@ -153,7 +178,7 @@ QxtCurrency QxtCurrency::fromVariant(const QVariant &v)
  */
 QxtCurrency::QxtCurrency(const QString &s)
 {
-    parseASCII(s.toLatin1().data());
+    value = qxt_currencyParse(s.utf16(), s.utf16() + s.size());
 }
 
 /*! Converts a string \a s into a QxtCurrency value. The decimal point used is
@@ -171,37 +196,7 @@ QxtCurrency::QxtCurrency(const char *s)
  */
 void QxtCurrency::parseASCII(const char *s)
 {
-    value = 0LL;
-    if(s){
-	int mult = 10000;
-	bool seenDP = false, seenSign = false;
-	for(; *s; ++s){
-	    if(*s == '+' || *s == '-'){
-		if(seenSign)
-		    break; // Error
-		if(*s == '-')
-		    mult = -mult;
-		seenSign = true;
-	    }
-	    else if(*s == '.'){
-		if(seenDP)
-		    break; // Error
-		seenDP = true;
-	    }
-	    else if(isdigit(*s)){
-		value = value * 10 + (*s - '0');
-		if(seenDP){
-		    mult /= 10;
-		    if(mult == 1 || mult == -1)
-			break; // We're done
-		}
-	    }
-	    else
-		break; // Error
-	}
-	if(mult)
-	    value *= mult;
-    }
+    value = s ? qxt_currencyParse(s, s + ::strlen(s)) : 0LL;
 }
 
 /*! Converts a QxtCurrency value to a string. The decimal point used is always
@@ -212,42 +207,8 @@ void QxtCurrency::parseASCII(const char *s)
  */
 QByteArray QxtCurrency::toString() const
 {
-    const int ndigs = std::numeric_limits<QxtCurrency>::digits10 + 5;
-    char buf[ndigs] = {0};
-    char* const end = buf + ndigs - 2;
-    bool neg = value < 0;
-    qlonglong v = ::llabs(value);
-    if(v < 0)
-	v = numeric_limits<qlonglong>::max();
-#ifndef Q_CC_GNU
-    register int decp = 4;
-#else
-    int_fast8_t decp = 4;
-#endif
-    // Do the raw conversion of digits right-to-left
-    char* p = end;
-    for(; p > buf && v; --decp){
-	lldiv_t d = ::lldiv(v,10);
-	v = d.quot;
-	if(p != end && decp == 0)
-	    *p-- = '.';
-	if(d.rem || p != end || decp < 1)
-	    *p-- = char('0' + d.rem);
-    }
-    // Check for need of zero fill (values between 0.0001 and 0.0999)
-    if(p != end && decp >= 0){
-	for(; decp > 0; --decp)
-	    *p-- = '0';
-	*p-- = '.';
-    }
-    // Check for need of zero preceding decimal point
-    if(p == end || decp == 0)
-	*p-- = '0';
-    // Check for negative sign
-    if(neg)
-	*p-- = '-';
-    // Done -- return the result now...
-    return (p+1);
+    char buf[QxtCurrencyFormatMax];
+    return QByteArray(buf, qxt_currencyFormat(value, buf));
 }
 
 /*! Rounds a QxtCurrency value to \a n number of decimal places. Since the
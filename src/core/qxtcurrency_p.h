@@ -0,0 +1,187 @@
+/****************************************************************************
+** Copyright (c) 2006 - 2011, the LibQxt project.
+** See the Qxt AUTHORS file for a list of authors and copyright holders.
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**     * Redistributions of source code must retain the above copyright
+**       notice, this list of conditions and the following disclaimer.
+**     * Redistributions in binary form must reproduce the above copyright
+**       notice, this list of conditions and the following disclaimer in the
+**       documentation and/or other materials provided with the distribution.
+**     * Neither the name of the LibQxt project nor the
+**       names of its contributors may be used to endorse or promote products
+**       derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+** ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+** DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+** (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+** LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+** ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** <http://libqxt.org>  <foundation@libqxt.org>
+*****************************************************************************/
+
+#ifndef QXTCURRENCY_P_H
+#define QXTCURRENCY_P_H
+
+#include "qxtcurrency.h"
+#include <QLocale>
+#include <cstring>
+#include <limits>
+
+// Decimal point and group separator of a locale in UTF-8
+class QxtCurrencySymbols
+{
+public:
+    QxtCurrencySymbols();
+    explicit QxtCurrencySymbols(const QLocale &locale);
+
+    char decimal[4];
+    int decimalSize;
+    char group[4];
+    int groupSize;
+};
+
+enum { QxtCurrencyFormatMax = 48 };
+
+/*  Parses [s, end) with the rules of QxtCurrency::parseASCII(): an optional
+ *  sign, digits and at most 4 decimal places. Stops at the first invalid
+ *  character or a NUL.
+ */
+template<typename Char>
+inline qlonglong qxt_currencyParse(const Char *s, const Char *end)
+{
+    qlonglong value = 0LL;
+    int mult = 10000;
+    bool seenDP = false, seenSign = false;
+    for(; s != end && *s; ++s){
+	const Char c = *s;
+	if(c == '+' || c == '-'){
+	    if(seenSign)
+		break; // Error
+	    if(c == '-')
+		mult = -mult;
+	    seenSign = true;
+	}
+	else if(c == '.'){
+	    if(seenDP)
+		break; // Error
+	    seenDP = true;
+	}
+	else if(c >= '0' && c <= '9'){
+	    value = value * 10 + (c - '0');
+	    if(seenDP){
+		mult /= 10;
+		if(mult == 1 || mult == -1)
+		    break; // We're done
+	    }
+	}
+	else
+	    break; // Error
+    }
+    if(mult)
+	value *= mult;
+    return value;
+}
+
+/*  Same as qxt_currencyParse() with the decimal point of symbols, group
+ *  separators before the decimal point are skipped.
+ */
+inline qlonglong qxt_currencyParse(const char *s, const char *end,
+	const QxtCurrencySymbols &symbols)
+{
+    qlonglong value = 0LL;
+    int mult = 10000;
+    bool seenDP = false, seenSign = false;
+    while(s != end){
+	const char c = *s;
+	if(end - s >= symbols.decimalSize
+		&& ::memcmp(s, symbols.decimal, symbols.decimalSize) == 0){
+	    if(seenDP)
+		break; // Error
+	    seenDP = true;
+	    s += symbols.decimalSize;
+	    continue;
+	}
+	if(!seenDP && symbols.groupSize && end - s >= symbols.groupSize
+		&& ::memcmp(s, symbols.group, symbols.groupSize) == 0){
+	    s += symbols.groupSize;
+	    continue;
+	}
+	if(c == '+' || c == '-'){
+	    if(seenSign)
+		break; // Error
+	    if(c == '-')
+		mult = -mult;
+	    seenSign = true;
+	}
+	else if(c >= '0' && c <= '9'){
+	    value = value * 10 + (c - '0');
+	    if(seenDP){
+		mult /= 10;
+		if(mult == 1 || mult == -1)
+		    break; // We're done
+	    }
+	}
+	else
+	    break; // Error
+	++s;
+    }
+    return value * mult;
+}
+
+/*  Writes value as QxtCurrency::toString() does to out, which must hold
+ *  QxtCurrencyFormatMax bytes. Without symbols the decimal point is '.' and
+ *  the digits are not grouped. Returns the number of bytes written.
+ */
+inline int qxt_currencyFormat(qlonglong value, char *out,
+	const QxtCurrencySymbols *symbols = 0)
+{
+    char buf[QxtCurrencyFormatMax];
+    char *const end = buf + QxtCurrencyFormatMax;
+    char *p = end;
+    const bool neg = value < 0;
+    quint64 v = neg ? 0 - quint64(value) : quint64(value);
+    // The null value has no positive counterpart, toString() always wrote the maximum
+    if(v > quint64(std::numeric_limits<qlonglong>::max()))
+	v = quint64(std::numeric_limits<qlonglong>::max());
+    quint64 whole = v / 10000;
+    unsigned frac = unsigned(v % 10000);
+    if(frac){
+	int digits = 4;
+	for(; frac % 10 == 0; --digits)
+	    frac /= 10;
+	for(; digits > 0; --digits){
+	    *--p = char('0' + frac % 10);
+	    frac /= 10;
+	}
+	if(symbols){
+	    p -= symbols->decimalSize;
+	    ::memcpy(p, symbols->decimal, symbols->decimalSize);
+	}
+	else
+	    *--p = '.';
+    }
+    for(int n = 0; n == 0 || whole; ++n){
+	if(n && n % 3 == 0 && symbols && symbols->groupSize){
+	    p -= symbols->groupSize;
+	    ::memcpy(p, symbols->group, symbols->groupSize);
+	}
+	*--p = char('0' + whole % 10);
+	whole /= 10;
+    }
+    if(neg)
+	*--p = '-';
+    const int size = int(end - p);
+    ::memcpy(out, p, size);
+    return size;
+}
+
+#endif // QXTCURRENCY_P_H
@@ -0,0 +1,585 @@
+/****************************************************************************
+** Copyright (c) 2006 - 2011, the LibQxt project.
+** See the Qxt AUTHORS file for a list of authors and copyright holders.
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**     * Redistributions of source code must retain the above copyright
+**       notice, this list of conditions and the following disclaimer.
+**     * Redistributions in binary form must reproduce the above copyright
+**       notice, this list of conditions and the following disclaimer in the
+**       documentation and/or other materials provided with the distribution.
+**     * Neither the name of the LibQxt project nor the
+**       names of its contributors may be used to endorse or promote products
+**       derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+** ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+** DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+** (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+** LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+** ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** <http://libqxt.org>  <foundation@libqxt.org>
+*****************************************************************************/
+
+#include "qxtcurrencyvector.h"
+#include "qxtcurrency_p.h"
+#include "qxtcpufeatures_p.h"
+#include <cstring>
+
+/*!
+ *  \class QxtCurrencyVector
+ *  \inmodule QxtCore
+ *  \brief The QxtCurrencyVector class provides batch operations on arrays
+ *  of QxtCurrency values.
+ *
+ *  \since 0.7
+ *
+ *  Every function gives exactly the results of the corresponding QxtCurrency
+ *  operator or method applied to each element, including the handling of
+ *  null values, but without the per value overhead. Addition, subtraction
+ *  and sum() work on the 64-bit integers directly and use SSE2 or AVX2 where
+ *  the processor supports them. The amortization functions compute the
+ *  schedules of many loans in one call into arrays supplied by the caller,
+ *  and parse() and format() convert between arrays and delimited text
+ *  without allocating memory for each value.
+ *
+ *  \code
+ *  QVector<QxtCurrency> balances, payments;
+ *  ...
+ *  QxtCurrencyVector::subtract(balances.constData(), payments.constData(),
+ *	balances.data(), balances.count());
+ *  QxtCurrency total = QxtCurrencyVector::sum(balances.constData(), balances.count());
+ *  \endcode
+ */
+
+using namespace std;
+
+static const qint64 qxt_currencyNull = qint64(Q_INT64_C(0x8000000000000000));
+
+//////////////////////////////////////////////////////////////////////////////
+// Element-wise kernels on the raw values
+
+typedef void (*QxtCurrencyBinaryFunction)(const qint64 *, const qint64 *, qint64 *, int);
+typedef qint64 (*QxtCurrencySumFunction)(const qint64 *, int);
+
+static inline qint64 qxt_currencyAdd(qint64 a, qint64 b)
+{
+    if(a == qxt_currencyNull || b == qxt_currencyNull)
+	return qxt_currencyNull;
+    return qint64(quint64(a) + quint64(b));
+}
+
+static inline qint64 qxt_currencySubtract(qint64 a, qint64 b)
+{
+    if(a == qxt_currencyNull || b == qxt_currencyNull)
+	return qxt_currencyNull;
+    return qint64(quint64(a) - quint64(b));
+}
+
+static void qxt_currencyAddScalar(const qint64 *a, const qint64 *b, qint64 *out, int count)
+{
+    for(int i = 0; i < count; ++i)
+	out[i] = qxt_currencyAdd(a[i], b[i]);
+}
+
+static void qxt_currencySubtractScalar(const qint64 *a, const qint64 *b, qint64 *out, int count)
+{
+    for(int i = 0; i < count; ++i)
+	out[i] = qxt_currencySubtract(a[i], b[i]);
+}
+
+static qint64 qxt_currencySumScalar(const qint64 *a, int count)
+{
+    quint64 total = 0;
+    for(int i = 0; i < count; ++i){
+	if(a[i] != qxt_currencyNull)
+	    total += quint64(a[i]);
+    }
+    return qint64(total);
+}
+
+#ifdef QXT_HAVE_SSE2
+static inline __m128i qxt_currencyNullSse2()
+{
+    // _mm_set1_epi64x() is missing on 32-bit MSVC
+    return _mm_set_epi32(int(0x80000000), 0, int(0x80000000), 0);
+}
+
+// SSE2 has no 64-bit compare, both 32-bit halves have to match
+static inline __m128i qxt_currencyIsNullSse2(__m128i v, __m128i null)
+{
+    const __m128i halves = _mm_cmpeq_epi32(v, null);
+    return _mm_and_si128(halves, _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1)));
+}
+
+static void qxt_currencyAddSse2(const qint64 *a, const qint64 *b, qint64 *out, int count)
+{
+    const __m128i null = qxt_currencyNullSse2();
+    int i = 0;
+    for(; i + 2 <= count; i += 2){
+	const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+	const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+	const __m128i nulls = _mm_or_si128(qxt_currencyIsNullSse2(va, null), qxt_currencyIsNullSse2(vb, null));
+	const __m128i sum = _mm_add_epi64(va, vb);
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i),
+		_mm_or_si128(_mm_andnot_si128(nulls, sum), _mm_and_si128(nulls, null)));
+    }
+    qxt_currencyAddScalar(a + i, b + i, out + i, count - i);
+}
+
+static void qxt_currencySubtractSse2(const qint64 *a, const qint64 *b, qint64 *out, int count)
+{
+    const __m128i null = qxt_currencyNullSse2();
+    int i = 0;
+    for(; i + 2 <= count; i += 2){
+	const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+	const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+	const __m128i nulls = _mm_or_si128(qxt_currencyIsNullSse2(va, null), qxt_currencyIsNullSse2(vb, null));
+	const __m128i difference = _mm_sub_epi64(va, vb);
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i),
+		_mm_or_si128(_mm_andnot_si128(nulls, difference), _mm_and_si128(nulls, null)));
+    }
+    qxt_currencySubtractScalar(a + i, b + i, out + i, count - i);
+}
+
+static qint64 qxt_currencySumSse2(const qint64 *a, int count)
+{
+    const __m128i null = qxt_currencyNullSse2();
+    __m128i total = _mm_setzero_si128();
+    int i = 0;
+    for(; i + 2 <= count; i += 2){
+	const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+	total = _mm_add_epi64(total, _mm_andnot_si128(qxt_currencyIsNullSse2(v, null), v));
+    }
+    qint64 lanes[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), total);
+    return qint64(quint64(lanes[0]) + quint64(lanes[1]) + quint64(qxt_currencySumScalar(a + i, count - i)));
+}
+#endif
+
+#ifdef QXT_HAVE_AVX2
+__attribute__((target("avx2")))
+static void qxt_currencyAddAvx2(const qint64 *a, const qint64 *b, qint64 *out, int count)
+{
+    const __m256i null = _mm256_set1_epi64x(qxt_currencyNull);
+    int i = 0;
+    for(; i + 4 <= count; i += 4){
+	const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+	const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+	const __m256i nulls = _mm256_or_si256(_mm256_cmpeq_epi64(va, null), _mm256_cmpeq_epi64(vb, null));
+	_mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i),
+		_mm256_blendv_epi8(_mm256_add_epi64(va, vb), null, nulls));
+    }
+    qxt_currencyAddSse2(a + i, b + i, out + i, count - i);
+}
+
+__attribute__((target("avx2")))
+static void qxt_currencySubtractAvx2(const qint64 *a, const qint64 *b, qint64 *out, int count)
+{
+    const __m256i null = _mm256_set1_epi64x(qxt_currencyNull);
+    int i = 0;
+    for(; i + 4 <= count; i += 4){
+	const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+	const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+	const __m256i nulls = _mm256_or_si256(_mm256_cmpeq_epi64(va, null), _mm256_cmpeq_epi64(vb, null));
+	_mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i),
+		_mm256_blendv_epi8(_mm256_sub_epi64(va, vb), null, nulls));
+    }
+    qxt_currencySubtractSse2(a + i, b + i, out + i, count - i);
+}
+
+__attribute__((target("avx2")))
+static qint64 qxt_currencySumAvx2(const qint64 *a, int count)
+{
+    const __m256i null = _mm256_set1_epi64x(qxt_currencyNull);
+    __m256i total = _mm256_setzero_si256();
+    int i = 0;
+    for(; i + 4 <= count; i += 4){
+	const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+	total = _mm256_add_epi64(total, _mm256_andnot_si256(_mm256_cmpeq_epi64(v, null), v));
+    }
+    qint64 lanes[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes), total);
+    return qint64(quint64(lanes[0]) + quint64(lanes[1]) + quint64(lanes[2]) + quint64(lanes[3])
+	    + quint64(qxt_currencySumSse2(a + i, count - i)));
+}
+#endif
+
+static inline QxtCurrencyBinaryFunction qxt_currencyAddKernel()
+{
+#ifdef QXT_HAVE_AVX2
+    if(qxt_cpuFeatures() & QxtCpuAvx2)
+	return qxt_currencyAddAvx2;
+#endif
+#ifdef QXT_HAVE_SSE2
+    return qxt_currencyAddSse2;
+#else
+    return qxt_currencyAddScalar;
+#endif
+}
+
+static inline QxtCurrencyBinaryFunction qxt_currencySubtractKernel()
+{
+#ifdef QXT_HAVE_AVX2
+    if(qxt_cpuFeatures() & QxtCpuAvx2)
+	return qxt_currencySubtractAvx2;
+#endif
+#ifdef QXT_HAVE_SSE2
+    return qxt_currencySubtractSse2;
+#else
+    return qxt_currencySubtractScalar;
+#endif
+}
+
+static inline QxtCurrencySumFunction qxt_currencySumKernel()
+{
+#ifdef QXT_HAVE_AVX2
+    if(qxt_cpuFeatures() & QxtCpuAvx2)
+	return qxt_currencySumAvx2;
+#endif
+#ifdef QXT_HAVE_SSE2
+    return qxt_currencySumSse2;
+#else
+    return qxt_currencySumScalar;
+#endif
+}
+
+// QxtCurrency is a single qlonglong, an array of them is an array of values
+static inline const qint64 *qxt_currencyValues(const QxtCurrency *a)
+{
+    return reinterpret_cast<const qint64 *>(a);
+}
+
+static inline qint64 *qxt_currencyValues(QxtCurrency *a)
+{
+    return reinterpret_cast<qint64 *>(a);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Rounding, the same computation as QxtCurrency::round() with the modulus
+// determined once
+
+static qlonglong qxt_currencyModulus(int n)
+{
+    if(n < -10)
+	throw std::range_error("rounding value too large");
+#if defined(Q_CC_GNU) & defined(__USE_GNU)
+    return qRound64(exp10(4-n));
+#else
+    return qRound64(pow(10.0, 4-n));
+#endif
+}
+
+static inline qlonglong qxt_currencyRound(qlonglong value, qlonglong modv)
+{
+    qlonglong frac = value % modv;
+    qlonglong result = value - frac;
+    if(frac >= (modv >> 1))
+	result += modv;
+    return result;
+}
+
+// One period of interest as computed by QxtCurrency::amortize(), rounded to cents
+static inline QxtCurrency qxt_currencyInterest(const QxtCurrency &P, double r)
+{
+    QxtCurrency pint(qxt_currencyRound(QxtCurrency(double(P) * r).value, 100));
+    if(pint < 0)
+	pint = 0;
+    return pint;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// QxtCurrencyVector class
+
+/*! Stores \a a[i] + \a b[i] in \a out[i] for \a count elements. The result is
+ *  null where either operand is null.
+ */
+void QxtCurrencyVector::add(const QxtCurrency *a, const QxtCurrency *b,
+	QxtCurrency *out, int count)
+{
+    qxt_currencyAddKernel()(qxt_currencyValues(a), qxt_currencyValues(b),
+	    qxt_currencyValues(out), count);
+}
+
+/*! Stores \a a[i] - \a b[i] in \a out[i] for \a count elements. The result is
+ *  null where either operand is null.
+ */
+void QxtCurrencyVector::subtract(const QxtCurrency *a, const QxtCurrency *b,
+	QxtCurrency *out, int count)
+{
+    qxt_currencySubtractKernel()(qxt_currencyValues(a), qxt_currencyValues(b),
+	    qxt_currencyValues(out), count);
+}
+
+/*! Stores \a a[i] * \a factor in \a out[i] for \a count elements.
+ */
+void QxtCurrencyVector::scale(const QxtCurrency *a, int factor,
+	QxtCurrency *out, int count)
+{
+    for(int i = 0; i < count; ++i){
+	if(a[i].isNull())
+	    out[i].setNull();
+	else
+	    out[i].value = a[i].value * factor;
+    }
+}
+
+/*! \overload
+ *  The products are rounded to the nearest 4th decimal place like
+ *  \c {QxtCurrency * double}.
+ */
+void QxtCurrencyVector::scale(const QxtCurrency *a, double factor,
+	QxtCurrency *out, int count)
+{
+    for(int i = 0; i < count; ++i){
+	if(a[i].isNull())
+	    out[i].setNull();
+	else
+	    out[i].value = qRound64(a[i].value * factor);
+    }
+}
+
+/*! Stores \a a[i] rounded to \a n decimal places in \a out[i] for \a count
+ *  elements. See QxtCurrency::round() for the rules and the exception thrown
+ *  for a negative \a n that is too large.
+ */
+void QxtCurrencyVector::round(const QxtCurrency *a, QxtCurrency *out, int count,
+	int n)
+{
+    if(n > 3){
+	if(out != a)
+	    ::memmove(out, a, count * sizeof(QxtCurrency));
+	return;
+    }
+    const qlonglong modv = qxt_currencyModulus(n);
+    for(int i = 0; i < count; ++i)
+	out[i].value = qxt_currencyRound(a[i].value, modv);
+}
+
+/*! Returns the sum of the \a count values in \a a. Null values are treated
+ *  as zero, just as adding them with \c += does.
+ */
+QxtCurrency QxtCurrencyVector::sum(const QxtCurrency *a, int count)
+{
+    return QxtCurrency(qlonglong(qxt_currencySumKernel()(qxt_currencyValues(a), count)));
+}
+
+/*! Stores QxtCurrency::amortizedPayment(\a P[i], \a r[i], \a n[i]) in
+ *  \a out[i] for \a count loans.
+ */
+void QxtCurrencyVector::amortizedPayment(const QxtCurrency *P, const double *r,
+	const int *n, QxtCurrency *out, int count)
+{
+    for(int i = 0; i < count; ++i)
+	out[i] = QxtCurrency::amortizedPayment(P[i], r[i], n[i]);
+}
+
+/*! Stores QxtCurrency::amortizedInterest(\a P[i], \a r[i], \a n[i], \a p[i])
+ *  in \a out[i] for \a count loans.
+ */
+void QxtCurrencyVector::amortizedInterest(const QxtCurrency *P, const double *r,
+	const int *n, const QxtCurrency *p, QxtCurrency::Pair *out, int count)
+{
+    for(int i = 0; i < count; ++i){
+	QxtCurrency balance = P[i];
+	const double rate = r[i];
+	const QxtCurrency payment = p[i];
+	QxtCurrency::Pair result;
+	for(int k = n[i]; k > 0; --k){
+	    QxtCurrency pint = qxt_currencyInterest(balance, rate);
+	    balance -= (payment - pint);
+	    result.first += pint;
+	}
+	result.second = balance;
+	out[i] = result;
+    }
+}
+
+/*! Returns the number of installments in the schedules of \a count loans
+ *  with \a n[i] payments each, which is the size amortize() needs.
+ */
+int QxtCurrencyVector::scheduleSize(const int *n, int count)
+{
+    int size = 0;
+    for(int i = 0; i < count; ++i)
+	size += qMax(0, n[i]);
+    return size;
+}
+
+/*! Generates the amortization schedules of \a count loans into \a schedules.
+ *  Loan i has the principal \a P[i], periodic rate \a r[i], \a n[i] payments
+ *  and the payment amount \a p[i]. A negative payment amount, or a null
+ *  \a p, lets the payment be calculated as QxtCurrency::amortize() does.
+ *
+ *  The schedules follow each other, schedule i starts after the \a n[0] to
+ *  \a n[i-1] installments of the loans before it. \a schedules must hold
+ *  scheduleSize() pairs, which are identical to the lists returned by
+ *  QxtCurrency::amortize().
+ *
+ *  \code
+ *  QVector<QxtCurrency::Pair> schedules(QxtCurrencyVector::scheduleSize(terms.constData(), count));
+ *  QxtCurrencyVector::amortize(principals.constData(), rates.constData(),
+ *	terms.constData(), 0, schedules.data(), count);
+ *  \endcode
+ */
+void QxtCurrencyVector::amortize(const QxtCurrency *P, const double *r,
+	const int *n, const QxtCurrency *p, QxtCurrency::Pair *schedules,
+	int count)
+{
+    QxtCurrency::Pair *s = schedules;
+    for(int i = 0; i < count; ++i){
+	Q_ASSERT(P[i] >= 0); Q_ASSERT(n[i] >= 0);
+	QxtCurrency balance = P[i];
+	const double rate = r[i];
+	QxtCurrency payment = p ? p[i] : QxtCurrency(-1);
+	if(payment < 0)
+	    payment = QxtCurrency::amortizedPayment(balance, rate, n[i]).round();
+	for(int k = n[i]; k > 0; --k){
+	    QxtCurrency pint = qxt_currencyInterest(balance, rate);
+	    QxtCurrency pp = qMin(balance, payment);
+	    s->first = pp;
+	    s->second = pint;
+	    ++s;
+	    balance -= (pp - pint);
+	}
+    }
+}
+
+static inline bool qxt_currencyBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+static int qxt_currencyParseFields(const char *data, int size, char delimiter,
+	QxtCurrency *out, int count, int *consumed,
+	const QxtCurrencySymbols *symbols)
+{
+    const char *s = data;
+    const char *const end = data + qMax(size, 0);
+    int n = 0;
+    for(; n < count && s != end; ++n){
+	const char *next = static_cast<const char*>(::memchr(s, delimiter, end - s));
+	const char *last = next ? next : end;
+	while(s != last && qxt_currencyBlank(*s))
+	    ++s;
+	while(last != s && qxt_currencyBlank(last[-1]))
+	    --last;
+	if(s == last)
+	    out[n].setNull();
+	else if(symbols)
+	    out[n].value = qxt_currencyParse(s, last, *symbols);
+	else
+	    out[n].value = qxt_currencyParse(s, last);
+	s = next ? next + 1 : end;
+    }
+    if(consumed)
+	*consumed = int(s - data);
+    return n;
+}
+
+static int qxt_currencyFormatFields(const QxtCurrency *values, int count,
+	char delimiter, char *buffer, int size, int *written,
+	const QxtCurrencySymbols *symbols)
+{
+    char *p = buffer;
+    char *const end = buffer + qMax(size, 0);
+    int n = 0;
+    for(; n < count; ++n){
+	const int separator = n ? 1 : 0;
+	int length = 0;
+	if(values[n].isNull()){
+	    if(end - p < separator)
+		break;
+	}
+	else if(end - p >= separator + QxtCurrencyFormatMax)
+	    length = qxt_currencyFormat(values[n].value, p + separator, symbols);
+	else{
+	    // Near the end of the buffer the text has to be measured first
+	    char text[QxtCurrencyFormatMax];
+	    length = qxt_currencyFormat(values[n].value, text, symbols);
+	    if(end - p < separator + length)
+		break;
+	    ::memcpy(p + separator, text, length);
+	}
+	if(separator)
+	    *p = delimiter;
+	p += separator + length;
+    }
+    if(written)
+	*written = int(p - buffer);
+    return n;
+}
+
+/*! Parses up to \a count values from the \a size bytes at \a data into
+ *  \a out. The values are separated by \a delimiter, for example ',' or a
+ *  newline. Each field is read as QxtCurrency(const char*) does, after
+ *  surrounding spaces, tabs and carriage returns are removed; an empty
+ *  field gives a null value. A delimiter at the end of \a data does not
+ *  start another field.
+ *
+ *  Returns the number of values stored. If \a consumed is not null, it
+ *  receives the number of bytes read, which is where parsing continues
+ *  when \a out was filled before the end of \a data.
+ *
+ *  \code
+ *  QVector<QxtCurrency> prices(lines);
+ *  QxtCurrencyVector::parse(file.constData(), file.size(), '\n',
+ *	prices.data(), prices.count());
+ *  \endcode
+ */
+int QxtCurrencyVector::parse(const char *data, int size, char delimiter,
+	QxtCurrency *out, int count, int *consumed)
+{
+    return qxt_currencyParseFields(data, size, delimiter, out, count, consumed, 0);
+}
+
+/*! \overload
+ *  Uses the decimal point and group separator of \a locale, in UTF-8.
+ *  Group separators are skipped anywhere before the decimal point; unless
+ *  it is quoted, a field cannot contain the \a delimiter, so it should not
+ *  be the group separator of \a locale. Only the ASCII digits are read.
+ */
+int QxtCurrencyVector::parse(const char *data, int size, char delimiter,
+	QxtCurrency *out, int count, const QLocale &locale, int *consumed)
+{
+    const QxtCurrencySymbols symbols(locale);
+    return qxt_currencyParseFields(data, size, delimiter, out, count, consumed,
+	    &symbols);
+}
+
+/*! Writes the \a count \a values to \a buffer, which holds \a size bytes,
+ *  as QxtCurrency::toString() does and separated by \a delimiter. A null
+ *  value gives an empty field. Nothing is written after the last value and
+ *  the text is not terminated with a NUL.
+ *
+ *  Returns the number of values written, which is less than \a count when
+ *  \a buffer is full; a value is never split. If \a written is not null, it
+ *  receives the number of bytes used.
+ */
+int QxtCurrencyVector::format(const QxtCurrency *values, int count,
+	char delimiter, char *buffer, int size, int *written)
+{
+    return qxt_currencyFormatFields(values, count, delimiter, buffer, size, written, 0);
+}
+
+/*! \overload
+ *  Uses the decimal point and group separator of \a locale, in UTF-8. The
+ *  integer digits are grouped by three unless the number options of
+ *  \a locale include QLocale::OmitGroupSeparator. The result can be read
+ *  back with parse() using the same \a locale.
+ */
+int QxtCurrencyVector::format(const QxtCurrency *values, int count,
+	char delimiter, char *buffer, int size, const QLocale &locale,
+	int *written)
+{
+    const QxtCurrencySymbols symbols(locale);
+    return qxt_currencyFormatFields(values, count, delimiter, buffer, size, written,
+	    &symbols);
+}
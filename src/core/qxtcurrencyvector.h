@@ -0,0 +1,84 @@
+/****************************************************************************
+** Copyright (c) 2006 - 2011, the LibQxt project.
+** See the Qxt AUTHORS file for a list of authors and copyright holders.
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**     * Redistributions of source code must retain the above copyright
+**       notice, this list of conditions and the following disclaimer.
+**     * Redistributions in binary form must reproduce the above copyright
+**       notice, this list of conditions and the following disclaimer in the
+**       documentation and/or other materials provided with the distribution.
+**     * Neither the name of the LibQxt project nor the
+**       names of its contributors may be used to endorse or promote products
+**       derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+** ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+** DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+** (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+** LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+** ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** <http://libqxt.org>  <foundation@libqxt.org>
+*****************************************************************************/
+
+#ifndef QXTCURRENCYVECTOR_H
+#define QXTCURRENCYVECTOR_H
+#include "qxtglobal.h"
+#include "qxtcurrency.h"
+
+QT_FORWARD_DECLARE_CLASS(QLocale)
+
+//////////////////////////////////////////////////////////////////////////////
+// QxtCurrencyVector -- batch operations on arrays of QxtCurrency
+
+class QXT_CORE_EXPORT QxtCurrencyVector
+{
+public:
+    // Element-wise arithmetic, out may be the same array as an input
+    static void add(const QxtCurrency *a, const QxtCurrency *b,
+	    QxtCurrency *out, int count);
+    static void subtract(const QxtCurrency *a, const QxtCurrency *b,
+	    QxtCurrency *out, int count);
+    static void scale(const QxtCurrency *a, int factor,
+	    QxtCurrency *out, int count);
+    static void scale(const QxtCurrency *a, double factor,
+	    QxtCurrency *out, int count);
+    static void round(const QxtCurrency *a, QxtCurrency *out, int count,
+	    int n=2);
+    // Reduction
+    static QxtCurrency sum(const QxtCurrency *a, int count);
+
+    // Amortization of count loans at once
+    static void amortizedPayment(const QxtCurrency *P, const double *r,
+	    const int *n, QxtCurrency *out, int count);
+    static void amortizedInterest(const QxtCurrency *P, const double *r,
+	    const int *n, const QxtCurrency *p, QxtCurrency::Pair *out,
+	    int count);
+    static int scheduleSize(const int *n, int count);
+    static void amortize(const QxtCurrency *P, const double *r,
+	    const int *n, const QxtCurrency *p, QxtCurrency::Pair *schedules,
+	    int count);
+
+    // Delimited text in caller supplied buffers
+    static int parse(const char *data, int size, char delimiter,
+	    QxtCurrency *out, int count, int *consumed=0);
+    static int parse(const char *data, int size, char delimiter,
+	    QxtCurrency *out, int count, const QLocale &locale,
+	    int *consumed=0);
+    static int format(const QxtCurrency *values, int count, char delimiter,
+	    char *buffer, int size, int *written=0);
+    static int format(const QxtCurrency *values, int count, char delimiter,
+	    char *buffer, int size, const QLocale &locale, int *written=0);
+
+private:
+    QxtCurrencyVector();
+};
+
+#endif // QXTCURRENCYVECTOR_H
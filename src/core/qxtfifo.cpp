@@ -48,6 +48,28 @@ QxtFifo fifo;
  qDebug()<<a;
 \endcode
 
+Notifications are coalesced: however many writes happen before the event loop
+gets to run, the fifo emits a single bytesWritten() signal with their total size,
+followed by one readyRead() signal.
+
+\section1 Ring buffer mode
+
+By default the fifo grows without bounds and every write allocates a buffer. After
+setRingBufferCapacity() it uses a fixed ring buffer instead, which is lock-free for
+one thread writing and one thread reading at the same time. In this mode write()
+accepts only as many bytes as there is free space, see bytesFree().
+
+readPointer() and commitRead() give the reader access to the buffered data without
+copying it:
+
+\code
+qint64 size;
+while (const char* data = fifo.readPointer(&size)) {
+    size = parse(data, size);
+    if (size == 0) break;
+    fifo.commitRead(size);
+}
+\endcode
 */
 
 
@@ -96,10 +118,15 @@ struct QxtFifoNode {
     QBasicAtomicPointer<QxtFifoNode> next;
 };
 
+static inline int qxt_fifoLoad(const QAtomicInt& value)
+{
+    return const_cast<QAtomicInt&>(value).fetchAndAddAcquire(0);
+}
+
 class QxtFifoPrivate : public QxtPrivate<QxtFifo> {
 public:
     QXT_DECLARE_PUBLIC(QxtFifo)
-    QxtFifoPrivate() {
+    QxtFifoPrivate() : headOffset(0), ring(0), capacity(0) {
         QxtFifoNode *n = new QxtFifoNode(NULL, 0);
 #if QT_VERSION >=  0x50000
         head.store(n);
@@ -115,11 +142,50 @@ public:
         available = 0;
 #endif
     }
+    ~QxtFifoPrivate() {
+        delete[] ring;
+    }
+
+    inline QxtFifoNode* headNode() const {
+#if QT_VERSION >=  0x50000
+        return head.load();
+#else
+        return head;
+#endif
+    }
+    inline int availableBytes() const {
+        if (ring)
+            return int(uint(qxt_fifoLoad(writePos)) - uint(qxt_fifoLoad(readPos)));
+#if QT_VERSION >=  0x50000
+        return available.load();
+#else
+        return available;
+#endif
+    }
+    void wrote(qint64 size);
 
     QBasicAtomicPointer<QxtFifoNode> head, tail;
     QBasicAtomicInt available;
+    // Read position inside the head node; only touched by the reader.
+    int headOffset;
+
+    // Ring buffer mode. The positions run freely and wrap around; capacity is a power of two.
+    char* ring;
+    int capacity;
+    QAtomicInt readPos, writePos;
+
+    // At most one notification is queued at a time; it reports everything written until it runs.
+    QAtomicInt notifyPending;
+    QAtomicInt unreported;
 };
 
+void QxtFifoPrivate::wrote(qint64 size)
+{
+    unreported.fetchAndAddOrdered(int(size));
+    if (notifyPending.testAndSetOrdered(0, 1))
+        QMetaObject::invokeMethod(&qxt_p(), "deliverNotifications", Qt::QueuedConnection);
+}
+
 /*!
 Constructs a new QxtFifo with \a parent.
 */
@@ -152,47 +218,47 @@ QxtFifo::QxtFifo(const QByteArray &prime, QObject *parent) : QIODevice(parent)
 */
 qint64 QxtFifo::readData ( char * data, qint64 maxSize )
 {
-    int bytes, step;
-#if QT_VERSION >=  0x50000
-    bytes = qxt_d().available.load();
-#else
-    bytes =  qxt_d().available;
-#endif
-
-
+    QxtFifoPrivate& d = qxt_d();
+    int bytes = d.availableBytes();
     if(!bytes) return 0;
     if(bytes > maxSize) bytes = maxSize;
+
+    if (d.ring) {
+        const uint pos = uint(qxt_fifoLoad(d.readPos));
+        const int index = int(pos & uint(d.capacity - 1));
+        const int first = qMin(bytes, d.capacity - index);
+        memcpy(data, d.ring + index, first);
+        memcpy(data + first, d.ring, bytes - first);
+        d.readPos.fetchAndStoreRelease(int(pos + uint(bytes)));
+        return bytes;
+    }
+
     int written = bytes;
     char* writePos = data;
     QxtFifoNode* node;
+    int step;
     while(bytes > 0) {
-
-#if QT_VERSION >=  0x50000
-        node = qxt_d().head.load();
-#else
-        node = qxt_d().head;
-#endif
-
-        step = node->content.size();
+        node = d.headNode();
+        step = node->content.size() - d.headOffset;
         if(step >= bytes) {
-            int rem = step - bytes;
-            memcpy(writePos, node->content.constData(), bytes);
+            memcpy(writePos, node->content.constData() + d.headOffset, bytes);
             step = bytes;
-            node->content = node->content.right(rem);
+            d.headOffset += bytes;
+            // the node may still be the tail, so it stays; only its buffer is released
+            if(d.headOffset == node->content.size()) {
+                node->content = QByteArray();
+                d.headOffset = 0;
+            }
         } else {
-            memcpy(writePos, node->content.constData(), step);
-            qxt_d().head.QXT_EXCHANGE_(node->next);
+            memcpy(writePos, node->content.constData() + d.headOffset, step);
+            d.head.QXT_EXCHANGE_(node->next);
+            d.headOffset = 0;
             delete node;
-#if QT_VERSION >=  0x50000
-            node = qxt_d().head.load();
-#else
-            node = qxt_d().head;
-#endif
         }
         writePos += step;
         bytes -= step;
     }
-    qxt_d().available.QXT_ADD(-written);
+    d.available.QXT_ADD(-written);
     return written;
 }
 
@@ -201,18 +267,32 @@ qint64 QxtFifo::readData ( char * data, qint64 maxSize )
 */
 qint64 QxtFifo::writeData ( const char * data, qint64 maxSize )
 {
+    QxtFifoPrivate& d = qxt_d();
     if(maxSize > 0) {
         if(maxSize > INT_MAX) maxSize = INT_MAX; // qint64 could easily exceed QAtomicInt, so let's play it safe
-        QxtFifoNode* newData = new QxtFifoNode(data, maxSize);
+        if (d.ring) {
+            const uint pos = uint(qxt_fifoLoad(d.writePos));
+            const int used = int(pos - uint(qxt_fifoLoad(d.readPos)));
+            const int bytes = int(qMin(maxSize, qint64(d.capacity - used)));
+            if (bytes == 0)
+                return 0;
+            const int index = int(pos & uint(d.capacity - 1));
+            const int first = qMin(bytes, d.capacity - index);
+            memcpy(d.ring + index, data, first);
+            memcpy(d.ring, data + first, bytes - first);
+            d.writePos.fetchAndStoreRelease(int(pos + uint(bytes)));
+            maxSize = bytes;
+        } else {
+            QxtFifoNode* newData = new QxtFifoNode(data, maxSize);
 #if QT_VERSION >=  0x50000
-        qxt_d().tail.load()->next.QXT_EXCHANGE(newData);
+            d.tail.load()->next.QXT_EXCHANGE(newData);
 #else
-        qxt_d().tail->next.QXT_EXCHANGE(newData);
+            d.tail->next.QXT_EXCHANGE(newData);
 #endif
-        qxt_d().tail.QXT_EXCHANGE(newData);
-        qxt_d().available.QXT_ADD(maxSize);
-        QMetaObject::invokeMethod(this, "bytesWritten", Qt::QueuedConnection, Q_ARG(qint64, maxSize));
-        QMetaObject::invokeMethod(this, "readyRead", Qt::QueuedConnection);
+            d.tail.QXT_EXCHANGE(newData);
+            d.available.QXT_ADD(maxSize);
+        }
+        d.wrote(maxSize);
     }
     return maxSize;
 }
@@ -230,25 +310,145 @@ bool QxtFifo::isSequential () const
 */
 qint64 QxtFifo::bytesAvailable () const
 {
-#if QT_VERSION >=  0x50000
-    return qxt_d().available.load() + QIODevice::bytesAvailable();
-#else
-    return qxt_d().available + QIODevice::bytesAvailable();
+    return qxt_d().availableBytes() + QIODevice::bytesAvailable();
+}
 
-#endif
+/*!
+Returns the number of bytes that can be written without blocking or being refused,
+or \c -1 if the fifo is not in ring buffer mode and can grow without limits.
+*/
+qint64 QxtFifo::bytesFree() const
+{
+    const QxtFifoPrivate& d = qxt_d();
+    if (!d.ring)
+        return -1;
+    return d.capacity - d.availableBytes();
+}
+
+/*!
+Switches the fifo to a fixed ring buffer of at least \a capacity bytes; the capacity is
+rounded up to the next power of two. A \a capacity of \c 0 switches back to the default
+unbounded mode.
+
+The mode can only be changed while the fifo is empty and nothing reads from or writes
+to it. Ring buffer mode also makes the device unbuffered. Returns \c true on success.
+
+\sa ringBufferCapacity()
+*/
+bool QxtFifo::setRingBufferCapacity(int capacity)
+{
+    QxtFifoPrivate& d = qxt_d();
+    if (bytesAvailable() != 0 || capacity < 0 || capacity > (1 << 30))
+        return false;
+
+    int size = 0;
+    if (capacity > 0) {
+        size = 1;
+        while (size < capacity)
+            size <<= 1;
+    }
+    delete[] d.ring;
+    d.ring = size ? new char[size] : 0;
+    d.capacity = size;
+    d.readPos.fetchAndStoreOrdered(0);
+    d.writePos.fetchAndStoreOrdered(0);
+    // QIODevice's own read buffer would only add a copy and hide the free space of the ring
+    if (size)
+        setOpenMode(openMode() | QIODevice::Unbuffered);
+    return true;
+}
+
+/*!
+Returns the capacity of the ring buffer, or \c 0 if the fifo is not in ring buffer mode.
+
+\sa setRingBufferCapacity()
+*/
+int QxtFifo::ringBufferCapacity() const
+{
+    return qxt_d().capacity;
+}
+
+/*!
+Returns a pointer to the next contiguous block of buffered data and stores its length
+in \a size, or returns \c 0 if there is nothing to read. The data stays in the fifo until
+it is released with commitRead().
+
+The block may be shorter than bytesAvailable(); call the function again after
+commitRead() to get the rest. If QIODevice holds data read ahead by read() or peek() in
+its own buffer, this function returns \c 0 and the data has to be read with read().
+
+\sa commitRead()
+*/
+const char* QxtFifo::readPointer(qint64* size)
+{
+    QxtFifoPrivate& d = qxt_d();
+    *size = 0;
+    const int bytes = d.availableBytes();
+    if (!bytes || QIODevice::bytesAvailable() > 0)
+        return 0;
+
+    if (d.ring) {
+        const int index = int(uint(qxt_fifoLoad(d.readPos)) & uint(d.capacity - 1));
+        *size = qMin(bytes, d.capacity - index);
+        return d.ring + index;
+    }
+
+    QxtFifoNode* node = d.headNode();
+    while (node->content.size() == d.headOffset) {
+        // data is available, so the consumed head node already has a successor
+        d.head.QXT_EXCHANGE_(node->next);
+        d.headOffset = 0;
+        delete node;
+        node = d.headNode();
+    }
+    *size = node->content.size() - d.headOffset;
+    return node->content.constData() + d.headOffset;
+}
+
+/*!
+Removes \a size bytes returned by readPointer() from the fifo.
+
+\sa readPointer()
+*/
+void QxtFifo::commitRead(qint64 size)
+{
+    QxtFifoPrivate& d = qxt_d();
+    if (size <= 0)
+        return;
+
+    if (d.ring) {
+        d.readPos.fetchAndAddRelease(int(size));
+        return;
+    }
+
+    QxtFifoNode* node = d.headNode();
+    Q_ASSERT(size <= node->content.size() - d.headOffset);
+    d.headOffset += int(size);
+    if (d.headOffset == node->content.size()) {
+        node->content = QByteArray();
+        d.headOffset = 0;
+    }
+    d.available.QXT_ADD(-int(size));
 }
 
 /*!
 */
 void QxtFifo::clear()
 {
-    qxt_d().available.QXT_EXCHANGE(0);
-    qxt_d().tail.QXT_EXCHANGE_(qxt_d().head);
+    QxtFifoPrivate& d = qxt_d();
+    if (d.ring) {
+        d.readPos.fetchAndStoreOrdered(qxt_fifoLoad(d.writePos));
+        return;
+    }
+
+    d.available.QXT_EXCHANGE(0);
+    d.tail.QXT_EXCHANGE_(d.head);
+    d.headOffset = 0;
 
 #if QT_VERSION >=  0x50000
-    QxtFifoNode* node = qxt_d().head.load()->next.QXT_EXCHANGE(NULL);
+    QxtFifoNode* node = d.head.load()->next.QXT_EXCHANGE(NULL);
 #else
-    QxtFifoNode* node = qxt_d().head->next.QXT_EXCHANGE(NULL);
+    QxtFifoNode* node = d.head->next.QXT_EXCHANGE(NULL);
 #endif
 
 #if QT_VERSION >=  0x50000
@@ -262,8 +462,20 @@ void QxtFifo::clear()
         node = next;
     }
 #if QT_VERSION >=  0x50000
-    qxt_d().head.load()->content = QByteArray();
+    d.head.load()->content = QByteArray();
 #else
-    qxt_d().head->content = QByteArray();
+    d.head->content = QByteArray();
 #endif
 }
+
+void QxtFifo::deliverNotifications()
+{
+    QxtFifoPrivate& d = qxt_d();
+    // reset the flag first, so that a write racing with this slot queues another notification
+    d.notifyPending.fetchAndStoreOrdered(0);
+    const int bytes = d.unreported.fetchAndStoreOrdered(0);
+    if (bytes > 0) {
+        emit bytesWritten(bytes);
+        emit readyRead();
+    }
+}
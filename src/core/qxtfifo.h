@@ -45,11 +45,21 @@ public:
 
     void clear();
 
+    qint64 bytesFree() const;
+    bool setRingBufferCapacity(int capacity);
+    int ringBufferCapacity() const;
+
+    const char* readPointer(qint64* size);
+    void commitRead(qint64 size);
+
 protected:
     explicit QxtFifo(const QByteArray &prime, QObject * parent = 0);
     virtual qint64 readData(char * data, qint64 maxSize);
     virtual qint64 writeData(const char * data, qint64 maxSize);
 
+private Q_SLOTS:
+    void deliverNotifications();
+
 private:
     QXT_DECLARE_PRIVATE(QxtFifo)
 };
@@ -34,6 +34,301 @@
 
 #if QT_VERSION >= 0x040300
 
+#include <QThreadStorage>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QVector>
+#include <QHash>
+
+#ifndef QXT_DOXYGEN_RUN
+class QxtHmacKeyPrivate
+{
+public:
+    QxtHmacKeyPrivate() : algorithm(QCryptographicHash::Md5) {}
+    QCryptographicHash::Algorithm algorithm;
+    QByteArray opad, ipad;
+};
+
+class QxtHmacPrivate : public QxtPrivate<QxtHmac>
+{
+public:
+    QXT_DECLARE_PUBLIC(QxtHmac)
+    QxtHmacPrivate() : ohash(0), ihash(0) {}
+    ~QxtHmacPrivate()
+    {
+        // deleting NULL is safe, so no tests are needed here
+        delete ohash;
+        delete ihash;
+    }
+    QCryptographicHash* ohash;
+    QCryptographicHash* ihash;
+    QxtHmacKey key;
+    QByteArray result;
+    QCryptographicHash::Algorithm algorithm;
+
+    // the key is never modified, so it is only accessed through a const reference to avoid detaching it
+    const QxtHmacKeyPrivate& pads() const
+    {
+        return key.qxt_d();
+    }
+};
+
+// One hash object per algorithm and thread, so that signing with a QxtHmacKey never allocates one.
+class QxtHmacHashes
+{
+public:
+    ~QxtHmacHashes()
+    {
+        qDeleteAll(hashes);
+    }
+    QCryptographicHash& hash(QCryptographicHash::Algorithm algorithm)
+    {
+        QCryptographicHash*& hash = hashes[int(algorithm)];
+        if (!hash)
+            hash = new QCryptographicHash(algorithm);
+        return *hash;
+    }
+    QHash<int, QCryptographicHash*> hashes;
+};
+Q_GLOBAL_STATIC(QThreadStorage<QxtHmacHashes*>, qxt_hmacHashes)
+
+static QCryptographicHash& qxt_hmacHash(QCryptographicHash::Algorithm algorithm)
+{
+    QThreadStorage<QxtHmacHashes*>* storage = qxt_hmacHashes();
+    if (!storage->hasLocalData())
+        storage->setLocalData(new QxtHmacHashes);
+    return storage->localData()->hash(algorithm);
+}
+
+static int qxt_hmacBlockSize(QCryptographicHash::Algorithm algorithm)
+{
+    switch (algorithm)
+    {
+#if QT_VERSION >= 0x050000
+    case QCryptographicHash::Sha384:
+    case QCryptographicHash::Sha512:
+        return 128;
+#endif
+#if QT_VERSION >= 0x050100
+    case QCryptographicHash::Sha3_224:
+        return 144;
+    case QCryptographicHash::Sha3_256:
+        return 136;
+    case QCryptographicHash::Sha3_384:
+        return 104;
+    case QCryptographicHash::Sha3_512:
+        return 72;
+#endif
+#if QT_VERSION >= 0x050902
+    case QCryptographicHash::Keccak_224:
+        return 144;
+    case QCryptographicHash::Keccak_256:
+        return 136;
+    case QCryptographicHash::Keccak_384:
+        return 104;
+    case QCryptographicHash::Keccak_512:
+        return 72;
+#endif
+    default:
+        return 64;
+    }
+}
+
+// Signs a contiguous range of a batch on the global thread pool.
+class QxtHmacBatchJob : public QRunnable
+{
+public:
+    QxtHmacBatchJob(const QxtHmacKey& key, const QList<QByteArray>& messages, QByteArray* results,
+                    int from, int to, QSemaphore* done)
+            : key(key), messages(messages), results(results), from(from), to(to), done(done)
+    {
+        setAutoDelete(false);
+    }
+
+    void run()
+    {
+        for (int i = from; i < to; i++)
+            results[i] = key.sign(messages.at(i));
+        done->release();
+    }
+
+    const QxtHmacKey& key;
+    const QList<QByteArray>& messages;
+    QByteArray* results;
+    int from;
+    int to;
+    QSemaphore* done;
+};
+#endif
+
+/*!
+\class QxtHmacKey
+
+\inmodule QxtCore
+
+\brief The QxtHmacKey class holds a shared secret prepared for computing HMACs
+
+Preparing a key for HMAC derives the padded inner and outer keys, which involves hashing
+keys that are longer than a block of the hash function. QxtHmacKey does this once, so that
+a key that signs many messages does not repeat the work for every message. QxtHmacKey is
+implicitly shared and cheap to copy; a copy can be used by another thread.
+
+\code
+QxtHmacKey key(secret, QCryptographicHash::Sha1);
+QByteArray mac = key.sign(message);
+bool valid = key.verify(message, receivedMac);
+\endcode
+
+To compute a HMAC of a message that arrives in pieces, pass the key to QxtHmac.
+
+\sa QxtHmac
+*/
+
+/*!
+ * Constructs a null key.
+ */
+QxtHmacKey::QxtHmacKey()
+{
+    qxt_d = new QxtHmacKeyPrivate;
+}
+
+/*!
+ * Prepares \a key for computing HMACs using \a algorithm.
+ */
+QxtHmacKey::QxtHmacKey(const QByteArray& key, QCryptographicHash::Algorithm algorithm)
+{
+    QxtHmacKeyPrivate* d = &(qxt_d = new QxtHmacKeyPrivate);
+    const int blockSize = qxt_hmacBlockSize(algorithm);
+    const QByteArray block = key.size() > blockSize ? QCryptographicHash::hash(key, algorithm) : key;
+    d->algorithm = algorithm;
+    d->opad = QByteArray(blockSize, 0x5c);
+    d->ipad = QByteArray(blockSize, 0x36);
+    for (int i = block.size() - 1; i >= 0; --i)
+    {
+        d->opad[i] = d->opad[i] ^ block[i];
+        d->ipad[i] = d->ipad[i] ^ block[i];
+    }
+}
+
+/*!
+ * Constructs a copy of \a other.
+ */
+QxtHmacKey::QxtHmacKey(const QxtHmacKey& other) : qxt_d(other.qxt_d)
+{
+}
+
+/*!
+ * Assigns \a other to this key.
+ */
+QxtHmacKey& QxtHmacKey::operator=(const QxtHmacKey& other)
+{
+    qxt_d = other.qxt_d;
+    return *this;
+}
+
+QxtHmacKey::~QxtHmacKey()
+{
+}
+
+/*!
+ * Returns true if the key was constructed without a secret.
+ */
+bool QxtHmacKey::isNull() const
+{
+    return qxt_d().opad.isEmpty();
+}
+
+/*!
+ * Returns the hashing algorithm the key was prepared for.
+ */
+QCryptographicHash::Algorithm QxtHmacKey::algorithm() const
+{
+    return qxt_d().algorithm;
+}
+
+/*!
+ * Returns the HMAC of the \a length bytes at \a data.
+ */
+QByteArray QxtHmacKey::sign(const char* data, int length) const
+{
+    const QxtHmacKeyPrivate& d = qxt_d();
+    Q_ASSERT(d.opad.size());
+    QCryptographicHash& hash = qxt_hmacHash(d.algorithm);
+    hash.reset();
+    hash.addData(d.ipad);
+    hash.addData(data, length);
+    const QByteArray inner = hash.result();
+    hash.reset();
+    hash.addData(d.opad);
+    hash.addData(inner);
+    return hash.result();
+}
+
+/*!
+ * Returns the HMAC of \a message.
+ */
+QByteArray QxtHmacKey::sign(const QByteArray& message) const
+{
+    return sign(message.constData(), message.size());
+}
+
+/*!
+ * Returns the HMACs of \a messages, in the same order.
+ *
+ * Large batches are divided between the threads of the global QThreadPool and the calling thread.
+ */
+QList<QByteArray> QxtHmacKey::signAll(const QList<QByteArray>& messages) const
+{
+    QVector<QByteArray> results(messages.count());
+    qint64 total = 0;
+    Q_FOREACH(const QByteArray& message, messages)
+        total += message.size() + 64;
+
+    const qint64 minimumJob = 256 * 1024;
+    const int jobCount = int(qMin(qint64(messages.count()),
+                                  qBound(qint64(1), total / minimumJob, qint64(QThreadPool::globalInstance()->maxThreadCount() + 1))));
+    QByteArray* out = results.data();
+    if (jobCount <= 1)
+    {
+        for (int i = 0; i < messages.count(); i++)
+            out[i] = sign(messages.at(i));
+        return results.toList();
+    }
+
+    // split the batch into ranges of roughly the same number of bytes
+    QSemaphore done;
+    QList<QxtHmacBatchJob*> jobs;
+    int from = 0;
+    qint64 bytes = 0;
+    for (int i = 0; i < messages.count(); i++)
+    {
+        bytes += messages.at(i).size() + 64;
+        if (bytes * jobCount >= total * (jobs.count() + 1) || i + 1 == messages.count())
+        {
+            jobs << new QxtHmacBatchJob(*this, messages, out, from, i + 1, &done);
+            from = i + 1;
+        }
+    }
+    for (int i = 1; i < jobs.count(); i++)
+        QThreadPool::globalInstance()->start(jobs.at(i));
+    jobs.first()->run();
+    done.acquire(jobs.count());
+    qDeleteAll(jobs);
+    return results.toList();
+}
+
+/*!
+ * Returns true if \a hmac is the HMAC of \a message.
+ *
+ * The comparison takes the same time wherever the codes differ.
+ *
+ * \sa QxtHmac::compare()
+ */
+bool QxtHmacKey::verify(const QByteArray& message, const QByteArray& hmac) const
+{
+    return QxtHmac::compare(sign(message), hmac);
+}
 
 /*
 \class QxtHmac
@@ -58,26 +353,10 @@ instance, a login server) only needs to store this inner hash generated by the i
 authentication, the user calculates a HMAC using this key and message and sends his username and this HMAC to the
 authenticator. The authenticator can then use verify() using the provided HMAC and the stored inner hash. When using
 this scheme, the password is never stored or transmitted in plain text.
-*/
 
-#ifndef QXT_DOXYGEN_RUN
-class QxtHmacPrivate : public QxtPrivate<QxtHmac>
-{
-public:
-    QXT_DECLARE_PUBLIC(QxtHmac)
-    QxtHmacPrivate() : ohash(0), ihash(0) {}
-    ~QxtHmacPrivate()
-    {
-        // deleting NULL is safe, so no tests are needed here
-        delete ohash;
-        delete ihash;
-    }
-    QCryptographicHash* ohash;
-    QCryptographicHash* ihash;
-    QByteArray opad, ipad, result;
-    QCryptographicHash::Algorithm algorithm;
-};
-#endif
+When many messages are signed with the same key, construct a QxtHmacKey once and pass it to the constructor or
+setKey(), or use QxtHmacKey::sign() directly.
+*/
 
 /*!
  * Constructs a QxtHmac object using the specified algorithm.
@@ -90,6 +369,18 @@ QxtHmac::QxtHmac(QCryptographicHash::Algorithm algorithm)
     qxt_d().algorithm = algorithm;
 }
 
+/*!
+ * Constructs a QxtHmac object using the prepared \a key and its algorithm.
+ */
+QxtHmac::QxtHmac(const QxtHmacKey& key)
+{
+    QXT_INIT_PRIVATE(QxtHmac);
+    qxt_d().ohash = new QCryptographicHash(key.algorithm());
+    qxt_d().ihash = new QCryptographicHash(key.algorithm());
+    qxt_d().algorithm = key.algorithm();
+    setKey(key);
+}
+
 /*!
  * Sets the shared secret key for the message authentication code.
  *
@@ -97,22 +388,30 @@ QxtHmac::QxtHmac(QCryptographicHash::Algorithm algorithm)
  */
 void QxtHmac::setKey(QByteArray key)
 {
-    // We make the assumption that all hashes use a 512-bit block size; as of Qt 4.4.0 this is true of all supported hash functions
-    QxtHmacPrivate* d = &qxt_d();
-    d->opad = QByteArray(64, 0x5c);
-    d->ipad = QByteArray(64, 0x36);
-    if (key.size() > 64)
-    {
-        key = QCryptographicHash::hash(key, d->algorithm);
-    }
-    for (int i = key.size() - 1; i >= 0; --i)
-    {
-        d->opad[i] = d->opad[i] ^ key[i];
-        d->ipad[i] = d->ipad[i] ^ key[i];
-    }
+    setKey(QxtHmacKey(key, qxt_d().algorithm));
+}
+
+/*!
+ * Sets the shared secret key for the message authentication code to the prepared \a key.
+ * The key must have been prepared for the algorithm of this object.
+ *
+ * Any data that had been processed using addData() will be discarded.
+ */
+void QxtHmac::setKey(const QxtHmacKey& key)
+{
+    Q_ASSERT(key.algorithm() == qxt_d().algorithm);
+    qxt_d().key = key;
     reset();
 }
 
+/*!
+ * Returns the prepared key, which can be used to sign further messages without a QxtHmac object.
+ */
+QxtHmacKey QxtHmac::key() const
+{
+    return qxt_d().key;
+}
+
 /*!
  * Resets the object.
  *
@@ -123,7 +422,7 @@ void QxtHmac::reset()
 {
     QxtHmacPrivate* d = &qxt_d();
     d->ihash->reset();
-    d->ihash->addData(d->ipad);
+    d->ihash->addData(d->pads().ipad);
 }
 
 /*!
@@ -145,11 +444,11 @@ QByteArray QxtHmac::innerHash() const
 QByteArray QxtHmac::result()
 {
     QxtHmacPrivate* d = &qxt_d();
-    Q_ASSERT(d->opad.size());
+    Q_ASSERT(!d->key.isNull());
     if (d->result.size())
         return d->result;
     d->ohash->reset();
-    d->ohash->addData(d->opad);
+    d->ohash->addData(d->pads().opad);
     d->ohash->addData(innerHash());
     d->result = d->ohash->result();
     return d->result;
@@ -165,9 +464,9 @@ bool QxtHmac::verify(const QByteArray& otherInner)
     result(); // populates d->result
     QxtHmacPrivate* d = &qxt_d();
     d->ohash->reset();
-    d->ohash->addData(d->opad);
+    d->ohash->addData(d->pads().opad);
     d->ohash->addData(otherInner);
-    return d->result == d->ohash->result();
+    return compare(d->result, d->ohash->result());
 }
 
 /*!
@@ -175,7 +474,7 @@ bool QxtHmac::verify(const QByteArray& otherInner)
  */
 void QxtHmac::addData(const char* data, int length)
 {
-    Q_ASSERT(qxt_d().opad.size());
+    Q_ASSERT(!qxt_d().key.isNull());
     qxt_d().ihash->addData(data, length);
     qxt_d().result.clear();
 }
@@ -193,10 +492,7 @@ void QxtHmac::addData(const QByteArray& data)
  */
 QByteArray QxtHmac::hash(const QByteArray& key, const QByteArray& data, Algorithm algorithm)
 {
-    QxtHmac hmac(algorithm);
-    hmac.setKey(key);
-    hmac.addData(data);
-    return hmac.result();
+    return QxtHmacKey(key, algorithm).sign(data);
 }
 
 /*!
@@ -209,9 +505,28 @@ bool QxtHmac::verify(const QByteArray& key, const QByteArray& hmac, const QByteA
 
     QxtHmacPrivate* d = &calc.qxt_d();
     d->ohash->reset();
-    d->ohash->addData(d->opad);
+    d->ohash->addData(d->pads().opad);
     d->ohash->addData(inner);
-    return hmac == d->ohash->result();
+    return compare(hmac, d->ohash->result());
+}
+
+/*!
+ * Returns true if \a a and \a b are equal.
+ *
+ * Unlike QByteArray::operator==(), the comparison does not stop at the first difference, so the time it
+ * takes does not reveal how much of a forged authentication code is correct. Only the lengths of the
+ * arrays can be learned from it.
+ */
+bool QxtHmac::compare(const QByteArray& a, const QByteArray& b)
+{
+    if (a.size() != b.size())
+        return false;
+    const char* x = a.constData();
+    const char* y = b.constData();
+    uchar diff = 0;
+    for (int i = 0; i < a.size(); i++)
+        diff |= uchar(x[i] ^ y[i]);
+    return diff == 0;
 }
 
 #endif
@@ -39,7 +39,33 @@
 #else
 
 #include <QCryptographicHash>
+#include <QList>
 #include "qxtglobal.h"
+#include "qxtsharedprivate.h"
+
+class QxtHmacKeyPrivate;
+class QXT_CORE_EXPORT QxtHmacKey
+{
+public:
+    QxtHmacKey();
+    QxtHmacKey(const QByteArray& key, QCryptographicHash::Algorithm algorithm);
+    QxtHmacKey(const QxtHmacKey& other);
+    QxtHmacKey& operator=(const QxtHmacKey& other);
+    ~QxtHmacKey();
+
+    bool isNull() const;
+    QCryptographicHash::Algorithm algorithm() const;
+
+    QByteArray sign(const char* data, int length) const;
+    QByteArray sign(const QByteArray& message) const;
+    QList<QByteArray> signAll(const QList<QByteArray>& messages) const;
+    bool verify(const QByteArray& message, const QByteArray& hmac) const;
+
+private:
+    friend class QxtHmac;
+    friend class QxtHmacPrivate;
+    QxtSharedPrivate<QxtHmacKeyPrivate> qxt_d;
+};
 
 class QxtHmacPrivate;
 class QXT_CORE_EXPORT QxtHmac
@@ -48,8 +74,11 @@ public:
     typedef QCryptographicHash::Algorithm Algorithm;
 
     QxtHmac(QCryptographicHash::Algorithm algorithm);
+    explicit QxtHmac(const QxtHmacKey& key);
 
     void setKey(QByteArray key);
+    void setKey(const QxtHmacKey& key);
+    QxtHmacKey key() const;
     void reset();
 
     void addData(const char* data, int length);
@@ -61,6 +90,7 @@ public:
 
     static QByteArray hash(const QByteArray& key, const QByteArray& data, Algorithm algorithm);
     static bool verify(const QByteArray& key, const QByteArray& hmac, const QByteArray& inner, Algorithm algorithm);
+    static bool compare(const QByteArray& a, const QByteArray& b);
 
 private:
     QXT_DECLARE_PRIVATE(QxtHmac)
@@ -58,28 +58,24 @@ Returning from this method will end the execution of the job.
 
 /*
 \fn  void QxtJob::done()
-This signal is emitted, when the run() function returns.
+This signal is emitted, when the run() function returns. The job counts as finished by then,
+so slots may call wait() or join().
 */
 
 #include "qxtjob_p.h"
+#include "qxtjobexecutor.h"
+#include "qxtjobexecutor_p.h"
 #include <cassert>
+#include <climits>
+#include <QElapsedTimer>
 #include <QThread>
 
-class Thread : public QThread
-{
-public:
-    static void usleep(unsigned long usecs)
-    {
-        QThread::usleep(usecs);
-    }
-};
 /*!
 default constructor
 */
 QxtJob::QxtJob()
 {
     QXT_INIT_PRIVATE(QxtJob);
-    qxt_d().running.set(false);
     connect(&qxt_d(), SIGNAL(done()), this, SIGNAL(done()));
 }
 /*!
@@ -90,15 +86,32 @@ void QxtJob::exec(QThread * onthread)
     qxt_d().moveToThread(onthread);
     connect(this, SIGNAL(subseed()), &qxt_d(), SLOT(inwrap_d()), Qt::QueuedConnection);
 
-    qxt_d().running.set(true);
+    {
+        QMutexLocker locker(&qxt_d().mutexa);
+        qxt_d().state = QxtJobPrivate::Pending;
+        qxt_d().cancelRequested = false;
+        qxt_d().executor = 0;
+    }
     emit(subseed());
 }
 /*!
+execute the Job on one of the threads of \a executor
+
+\sa QxtJobExecutor::submit()
+*/
+void QxtJob::exec(QxtJobExecutor * executor)
+{
+    executor->submit(this);
+}
+/*!
 \warning The destructor joins. Means it blocks until the job is finished
 */
 QxtJob::~QxtJob()
 {
     join();
+    qxt_d().waitForFinish();
+    // jobs waiting on one that never ran would wait forever
+    qxt_d().dropObservers();
 }
 /*!
 block until the Job finished
@@ -108,32 +121,180 @@ Maybe you actualy want to use QxtSignalWaiter.
 */
 void QxtJob::join()
 {
-    while (qxt_d().running.get() == true)
+    wait();
+}
+/*!
+Blocks until the job has finished or has been canceled, or until \a msecs milliseconds
+have passed. A negative \a msecs waits without a timeout. Returns \c false on timeout.
+
+Unlike join(), which it replaces, this does not poll; the waiting thread sleeps until
+the job ends.
+*/
+bool QxtJob::wait(int msecs)
+{
+    QxtJobPrivate& d = qxt_d();
+    QElapsedTimer timer;
+    timer.start();
+    QMutexLocker locker(&d.mutexa);
+    while (d.isActive())
     {
-        /*!
-        oh yeah that sucks ass,
-        but since any kind of waitcondition will just fail due to undeterminnism,
-        we have no chance then polling.
-        And no, a mutex won't work either.
-        using join for anything else then testcases sounds kindof retarded anyway.
-        */
-        Thread::usleep(1000);
+        if (msecs < 0)
+        {
+            d.synca.wait(&d.mutexa);
+            continue;
+        }
+        const qint64 left = msecs - timer.elapsed();
+        if (left <= 0 || !d.synca.wait(&d.mutexa, (unsigned long)left))
+            return !d.isActive();
     }
+    return true;
+}
+/*!
+Cancels the job. A job that has not started yet will not run at all; the function then
+returns \c true, waiters are woken up and jobs depending on it are canceled as well. The
+done() signal is not emitted for a canceled job.
 
+A job that is already running cannot be stopped. The function returns \c false, but
+isCanceled() returns \c true from now on, so a long running run() can check it and return early.
+*/
+bool QxtJob::cancel()
+{
+    QxtJobPrivate& d = qxt_d();
+    {
+        QMutexLocker locker(&d.mutexa);
+        if (d.state == QxtJobPrivate::Running)
+            d.cancelRequested = true;
+        if (d.state != QxtJobPrivate::Pending)
+            return false;
+        // a worker might have taken the job off the queue already; then it is as good as running
+        if (d.queuedIn && !QxtJobExecutorPrivate::dequeue(d.queuedIn, this))
+        {
+            d.cancelRequested = true;
+            return false;
+        }
+        d.queuedIn = 0;
+        d.cancelRequested = true;
+    }
+    d.finish(QxtJobPrivate::Canceled);
+    return true;
 }
-void QxtJobPrivate::inwrap_d()
+/*!
+Returns \c true if cancel() has been called since the job was last started.
+*/
+bool QxtJob::isCanceled() const
 {
-    synca.wakeAll();
-    qxt_p().run();
-    running.set(false);
-    emit(done());
+    QMutexLocker locker(&const_cast<QxtJob*>(this)->qxt_d().mutexa);
+    return qxt_d().cancelRequested;
 }
+/*!
+Returns \c true if the job ran to completion and has not been started again since.
+*/
+bool QxtJob::isFinished() const
+{
+    QMutexLocker locker(&const_cast<QxtJob*>(this)->qxt_d().mutexa);
+    return qxt_d().state == QxtJobPrivate::Finished;
+}
+/*!
+Runs \a next once this job has finished, on the executor this job ran on, or on
+QxtJobExecutor::globalInstance() if it ran on a QThread. The executor is chosen when this
+job ends, so continuations can be set up before it is submitted. If this job is canceled,
+or destroyed without having run, \a next is canceled too.
+Returns \a next, so that continuations can be chained:
 
+\code
+first->then(second)->then(third);
+first->exec(executor);
+\endcode
 
-
-
-
-
-
-
-
+\sa QxtJobExecutor::submitAfter()
+*/
+QxtJob * QxtJob::then(QxtJob * next)
+{
+    QxtJobExecutorPrivate::submitAfter(0, next, QList<QxtJob*>() << this, false);
+    return next;
+}
+void QxtJobPrivate::inwrap_d()
+{
+    {
+        QMutexLocker locker(&mutexa);
+        if (state != Pending)
+            return;
+        state = Running;
+    }
+    runJob();
+}
+void QxtJobPrivate::runJob()
+{
+    qxt_p().run();
+    finish(Finished);
+}
+void QxtJobPrivate::addObserver(QxtJobObserver* observer, bool idleEnded)
+{
+    bool finished;
+    {
+        QMutexLocker locker(&mutexa);
+        if (isActive() || (state == Idle && !idleEnded))
+        {
+            observers.append(observer);
+            return;
+        }
+        finished = (state != Canceled);
+    }
+    observer->jobEnded(&qxt_p(), finished);
+    observer->release();
+}
+bool QxtJobPrivate::removeObserver(QxtJobObserver* observer)
+{
+    QMutexLocker locker(&mutexa);
+    return observers.removeOne(observer);
+}
+void QxtJobPrivate::dropObservers()
+{
+    QList<QxtJobObserver*> dropped;
+    {
+        QMutexLocker locker(&mutexa);
+        dropped.swap(observers);
+    }
+    Q_FOREACH(QxtJobObserver* observer, dropped)
+    {
+        observer->jobEnded(&qxt_p(), false);
+        observer->release();
+    }
+}
+void QxtJobPrivate::waitForFinish()
+{
+    QMutexLocker locker(&mutexa);
+    while (endingIn && endingIn != QThread::currentThread())
+        synca.wait(&mutexa);
+}
+void QxtJobPrivate::finish(State end)
+{
+    // the destructor waits for endingIn to be cleared, so the job stays alive until then
+    QxtJob* job = &qxt_p();
+    QList<QxtJobObserver*> ended;
+    bool deleteJob;
+    {
+        QMutexLocker locker(&mutexa);
+        state = end;
+        endingIn = QThread::currentThread();
+        deleteJob = deleteWhenEnded;
+        ended.swap(observers);
+        synca.wakeAll();
+    }
+    // emitted after the state change, so that slots waiting on the job do not block
+    if (end == Finished)
+        emit(done());
+    Q_FOREACH(QxtJobObserver* observer, ended)
+    {
+        observer->jobEnded(job, end == Finished);
+        observer->release();
+    }
+    {
+        QMutexLocker locker(&mutexa);
+        endingIn = 0;
+        synca.wakeAll();
+    }
+    // nobody else owns a detached job, so it is still alive here
+    if (deleteJob)
+        job->deleteLater();
+}
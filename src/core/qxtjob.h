@@ -37,6 +37,7 @@
 #include <QObject>
 
 class QxtJobPrivate;
+class QxtJobExecutor;
 QT_FORWARD_DECLARE_CLASS(QThread)
 
 class QXT_CORE_EXPORT QxtJob : public QObject
@@ -46,12 +47,22 @@ public:
     QxtJob();
     ~QxtJob();
     void exec(QThread * onthread);
+    void exec(QxtJobExecutor * executor);
     void join();
+    bool wait(int msecs = -1);
+
+    bool cancel();
+    bool isCanceled() const;
+    bool isFinished() const;
+
+    QxtJob * then(QxtJob * next);
 protected:
     virtual void run() = 0;
 Q_SIGNALS:
     void done();
 private:
+    friend class QxtJobExecutorPrivate;
+    friend class QxtSlotJob;
     QXT_DECLARE_PRIVATE(QxtJob)
 Q_SIGNALS:
     ///\internal
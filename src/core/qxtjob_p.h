@@ -35,36 +35,74 @@
 #include <QMutex>
 #include <qxtjob.h>
 #include <QWaitCondition>
+#include <QAtomicInt>
+#include <QList>
+
+class QxtJobExecutor;
+class QThread;
+
+// Gets notified once when a job it was registered with ends, either finished or canceled.
+// Registered with several jobs, it is deleted after the last of them released it.
+class QxtJobObserver
+{
+public:
+    explicit QxtJobObserver(int references) : refs(references) {}
+    virtual ~QxtJobObserver() {}
+    virtual void jobEnded(QxtJob* job, bool finished) = 0;
+    void release()
+    {
+        if (!refs.deref())
+            delete this;
+    }
+
+private:
+    QAtomicInt refs;
+};
 
 class QxtJobPrivate : public QObject, public QxtPrivate<QxtJob>
 {
     Q_OBJECT
 public:
-    class RunningState
+    enum State
     {
-    public:
-        void set(bool a)
-        {
-            mutex.lock();
-            r = a;
-            mutex.unlock();
-        }
-        bool get()
-        {
-            mutex.lock();
-            bool a = r;
-            mutex.unlock();
-            return a;
-        }
+        Idle,
+        Pending,
+        Running,
+        Finished,
+        Canceled
+    };
 
-        QMutex mutex;
-        bool r;
+    QxtJobPrivate() : state(Idle), cancelRequested(false), deleteWhenEnded(false), endingIn(0), executor(0), queuedIn(0) {}
 
-    } running;
+    bool isActive() const
+    {
+        return state == Pending || state == Running;
+    }
+    // an idle job keeps the observer until it ends, unless idleEnded treats it as finished
+    void addObserver(QxtJobObserver* observer, bool idleEnded);
+    bool removeObserver(QxtJobObserver* observer);
+    // tells the observers of a job that is going away without having ended that it was canceled
+    void dropObservers();
+    // blocks until another thread is done with finish()
+    void waitForFinish();
+    // runs the job that was moved to Running by the caller and ends it
+    void runJob();
+    void finish(State end);
 
     QXT_DECLARE_PUBLIC(QxtJob)
+    // mutexa guards everything below; synca is signalled when the job ends
     QMutex mutexa;
     QWaitCondition synca;
+    State state;
+    bool cancelRequested;
+    // set for detached jobs, which are deleted once finish() is done with them
+    bool deleteWhenEnded;
+    // the thread emitting done() and notifying the observers after the job ended
+    QThread* endingIn;
+    QxtJobExecutor* executor;
+    // the executor whose queue holds the job right now
+    QxtJobExecutor* queuedIn;
+    QList<QxtJobObserver*> observers;
 
 
 public Q_SLOTS:
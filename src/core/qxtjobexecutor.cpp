@@ -0,0 +1,535 @@
+/****************************************************************************
+** Copyright (c) 2006 - 2011, the LibQxt project.
+** See the Qxt AUTHORS file for a list of authors and copyright holders.
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**     * Redistributions of source code must retain the above copyright
+**       notice, this list of conditions and the following disclaimer.
+**     * Redistributions in binary form must reproduce the above copyright
+**       notice, this list of conditions and the following disclaimer in the
+**       documentation and/or other materials provided with the distribution.
+**     * Neither the name of the LibQxt project nor the
+**       names of its contributors may be used to endorse or promote products
+**       derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+** ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+** DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+** (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+** LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+** ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** <http://libqxt.org>  <foundation@libqxt.org>
+*****************************************************************************/
+
+/*!
+\class QxtJobExecutor
+
+\inmodule QxtCore
+
+\brief The QxtJobExecutor class runs QxtJob instances on a fixed pool of worker threads.
+
+Every worker keeps its own queue of jobs. Jobs submitted from a worker thread, which
+includes continuations started when a job finishes, are pushed onto that worker's queue
+and run next, while their data is still in the cache. A worker whose queue runs empty
+takes the oldest job from the queue of another worker before going to sleep.
+
+Jobs can depend on other jobs. submitAfterAll() starts a job once all its dependencies
+have finished, submitAfterAny() as soon as the first of them has. If a dependency is
+canceled, the jobs waiting on it are canceled as well.
+
+\code
+QxtJobExecutor executor(4);
+load->then(parse)->then(store);
+executor.submit(load);
+store->wait();
+\endcode
+
+The executor does not take ownership of the jobs it runs. A job must stay alive until it
+has finished or has been canceled, and the executor must outlive every job that was
+submitted to it or is waiting on a dependency.
+
+\sa QxtJob::exec(), QxtJob::then()
+*/
+
+#include "qxtjobexecutor.h"
+#include "qxtjobexecutor_p.h"
+#include <QElapsedTimer>
+
+static inline int qxt_jobLoad(QAtomicInt& value)
+{
+    return value.fetchAndAddAcquire(0);
+}
+
+Q_GLOBAL_STATIC(QxtJobExecutor, qxt_globalJobExecutor)
+
+// Starts a job once its dependencies allow it, or cancels it.
+class QxtJobContinuation : public QxtJobObserver
+{
+public:
+    QxtJobContinuation(QxtJobExecutorPrivate* executor, QxtJob* job, int count, bool any)
+            : QxtJobObserver(count), executor(executor), job(job), pending(count), fired(0), failed(0), any(any) {}
+
+    void jobEnded(QxtJob* dependency, bool finished)
+    {
+        bool ready = false;
+        if (any)
+        {
+            if (finished && fired.testAndSetOrdered(0, 1))
+                ready = true;
+        }
+        else if (!finished)
+        {
+            failed.fetchAndStoreOrdered(1);
+        }
+        bool cancel = false;
+        if (!pending.deref())
+        {
+            if (any)
+                cancel = !qxt_jobLoad(fired);
+            else if (qxt_jobLoad(failed))
+                cancel = true;
+            else
+                ready = true;
+        }
+        if (ready)
+            target(dependency)->submit(job, true);
+        else if (cancel)
+            job->cancel();
+    }
+
+private:
+    QxtJobExecutorPrivate* target(QxtJob* dependency)
+    {
+        return executor ? executor : QxtJobExecutorPrivate::executorOf(dependency);
+    }
+
+    QxtJobExecutorPrivate* executor;
+    QxtJob* job;
+    QAtomicInt pending;
+    QAtomicInt fired;
+    QAtomicInt failed;
+    bool any;
+};
+
+// Lets waitForAny() sleep until one of the jobs ends.
+class QxtJobAnyWaiter : public QxtJobObserver
+{
+public:
+    QxtJobAnyWaiter(const QList<QxtJob*>& jobs) : QxtJobObserver(jobs.count() + 1), jobs(jobs), index(-1), ended(0) {}
+
+    void jobEnded(QxtJob* job, bool finished)
+    {
+        QMutexLocker locker(&mutex);
+        ended++;
+        if (finished && index < 0)
+            index = jobs.indexOf(job);
+        ready.wakeAll();
+    }
+
+    QList<QxtJob*> jobs;
+    QMutex mutex;
+    QWaitCondition ready;
+    int index;
+    int ended;
+};
+
+QxtJobWorker::QxtJobWorker(int index, QxtJobExecutorPrivate* pool) : index(index), pool(pool)
+{
+}
+
+void QxtJobWorker::run()
+{
+    for (;;)
+    {
+        QxtJob* job = pool->take(index);
+        if (job)
+        {
+            pool->execute(job);
+            continue;
+        }
+        QMutexLocker locker(&pool->idleLock);
+        if (pool->stopping)
+            return;
+        // enqueue() signals under idleLock, so a job queued after take() is either seen here or wakes us up
+        if (qxt_jobLoad(pool->queued) > 0)
+            continue;
+        pool->sleeping++;
+        pool->wake.wait(&pool->idleLock);
+        pool->sleeping--;
+    }
+}
+
+QxtJobExecutorPrivate::QxtJobExecutorPrivate() : queued(0), nextWorker(0), sleeping(0), active(0), stopping(false)
+{
+}
+
+void QxtJobExecutorPrivate::start(int count)
+{
+    workers.reserve(count);
+    for (int i = 0; i < count; i++)
+        workers.append(new QxtJobWorker(i, this));
+    Q_FOREACH(QxtJobWorker* worker, workers)
+        worker->start();
+}
+
+void QxtJobExecutorPrivate::stop()
+{
+    {
+        QMutexLocker locker(&idleLock);
+        stopping = true;
+        wake.wakeAll();
+    }
+    Q_FOREACH(QxtJobWorker* worker, workers)
+    {
+        worker->wait();
+        delete worker;
+    }
+    workers.clear();
+}
+
+bool QxtJobExecutorPrivate::submit(QxtJob* j, bool dependent)
+{
+    QxtJobPrivate& d = job(j);
+    QMutexLocker locker(&d.mutexa);
+    if (dependent)
+    {
+        // the job was canceled or submitted elsewhere while it waited for its dependencies
+        if (d.state != QxtJobPrivate::Pending || d.queuedIn)
+            return false;
+    }
+    else
+    {
+        if (d.isActive())
+            return false;
+        d.state = QxtJobPrivate::Pending;
+        d.cancelRequested = false;
+    }
+    d.executor = &qxt_p();
+    enqueue(j);
+    return true;
+}
+
+QxtJobExecutorPrivate* QxtJobExecutorPrivate::executorOf(QxtJob* j)
+{
+    QxtJobPrivate& d = job(j);
+    QxtJobExecutor* executor;
+    {
+        QMutexLocker locker(&d.mutexa);
+        executor = d.executor;
+    }
+    if (!executor)
+        executor = QxtJobExecutor::globalInstance();
+    return &executor->qxt_d();
+}
+
+bool QxtJobExecutorPrivate::submitAfter(QxtJobExecutorPrivate* executor, QxtJob* j, const QList<QxtJob*>& dependencies, bool any)
+{
+    if (dependencies.isEmpty())
+    {
+        if (!executor)
+            executor = &QxtJobExecutor::globalInstance()->qxt_d();
+        return executor->submit(j, false);
+    }
+
+    QxtJobPrivate& d = job(j);
+    {
+        QMutexLocker locker(&d.mutexa);
+        if (d.isActive())
+            return false;
+        d.state = QxtJobPrivate::Pending;
+        d.cancelRequested = false;
+        d.executor = executor ? &executor->qxt_p() : 0;
+    }
+    // every dependency holds one reference and may fire it right away if it has ended already
+    QxtJobContinuation* continuation = new QxtJobContinuation(executor, j, dependencies.count(), any);
+    Q_FOREACH(QxtJob* dependency, dependencies)
+        job(dependency).addObserver(continuation, false);
+    return true;
+}
+
+void QxtJobExecutorPrivate::enqueue(QxtJob* j)
+{
+    job(j).queuedIn = &qxt_p();
+
+    QxtJobWorker* target = 0;
+    QThread* current = QThread::currentThread();
+    Q_FOREACH(QxtJobWorker* worker, workers)
+    {
+        if (worker == current)
+        {
+            target = worker;
+            break;
+        }
+    }
+    if (!target)
+        target = workers.at(uint(nextWorker.fetchAndAddRelaxed(1)) % uint(workers.count()));
+    {
+        QMutexLocker locker(&target->lock);
+        target->jobs.append(j);
+    }
+    queued.ref();
+
+    QMutexLocker locker(&idleLock);
+    active++;
+    if (sleeping)
+        wake.wakeOne();
+}
+
+QxtJob* QxtJobExecutorPrivate::take(int self)
+{
+    if (qxt_jobLoad(queued) <= 0)
+        return 0;
+
+    QxtJobWorker* own = workers.at(self);
+    {
+        QMutexLocker locker(&own->lock);
+        if (!own->jobs.isEmpty())
+        {
+            queued.deref();
+            return own->jobs.takeLast();
+        }
+    }
+    const int count = workers.count();
+    for (int i = 1; i < count; i++)
+    {
+        QxtJobWorker* victim = workers.at((self + i) % count);
+        QMutexLocker locker(&victim->lock);
+        if (!victim->jobs.isEmpty())
+        {
+            queued.deref();
+            return victim->jobs.takeFirst();
+        }
+    }
+    return 0;
+}
+
+void QxtJobExecutorPrivate::execute(QxtJob* j)
+{
+    QxtJobPrivate& d = job(j);
+    bool run;
+    {
+        QMutexLocker locker(&d.mutexa);
+        d.queuedIn = 0;
+        run = (d.state == QxtJobPrivate::Pending);
+        if (run)
+            d.state = QxtJobPrivate::Running;
+    }
+    // the job may be deleted by its owner as soon as it has ended
+    if (run)
+        d.runJob();
+    jobDone();
+}
+
+void QxtJobExecutorPrivate::jobDone()
+{
+    QMutexLocker locker(&idleLock);
+    if (!--active)
+        allDone.wakeAll();
+}
+
+bool QxtJobExecutorPrivate::dequeue(QxtJobExecutor* executor, QxtJob* job)
+{
+    QxtJobExecutorPrivate& d = executor->qxt_d();
+    Q_FOREACH(QxtJobWorker* worker, d.workers)
+    {
+        bool removed;
+        {
+            QMutexLocker locker(&worker->lock);
+            removed = worker->jobs.removeOne(job);
+        }
+        if (removed)
+        {
+            d.queued.deref();
+            d.jobDone();
+            return true;
+        }
+    }
+    return false;
+}
+
+int QxtJobExecutorPrivate::waitForAny(const QList<QxtJob*>& jobs, int msecs)
+{
+    if (jobs.isEmpty())
+        return -1;
+
+    QxtJobAnyWaiter* waiter = new QxtJobAnyWaiter(jobs);
+    Q_FOREACH(QxtJob* j, jobs)
+        job(j).addObserver(waiter, true);
+
+    QElapsedTimer timer;
+    timer.start();
+    int index;
+    {
+        QMutexLocker locker(&waiter->mutex);
+        while (waiter->index < 0 && waiter->ended < jobs.count())
+        {
+            if (msecs < 0)
+            {
+                waiter->ready.wait(&waiter->mutex);
+                continue;
+            }
+            const qint64 left = msecs - timer.elapsed();
+            if (left <= 0 || !waiter->ready.wait(&waiter->mutex, (unsigned long)left))
+                break;
+        }
+        index = waiter->index;
+    }
+
+    // jobs that have not ended yet still hold a reference; take it back
+    Q_FOREACH(QxtJob* j, jobs)
+    {
+        if (job(j).removeObserver(waiter))
+            waiter->release();
+    }
+    waiter->release();
+    return index;
+}
+
+/*!
+    Constructs a new QxtJobExecutor with \a parent, running \a threadCount worker threads.
+    A negative \a threadCount uses QThread::idealThreadCount().
+ */
+QxtJobExecutor::QxtJobExecutor(int threadCount, QObject* parent) : QObject(parent)
+{
+    QXT_INIT_PRIVATE(QxtJobExecutor);
+    if (threadCount < 0)
+        threadCount = QThread::idealThreadCount();
+    qxt_d().start(qMax(1, threadCount));
+}
+
+/*!
+    Destroys the executor. Blocks until every queued job has run, then stops the workers.
+ */
+QxtJobExecutor::~QxtJobExecutor()
+{
+    waitForDone();
+    qxt_d().stop();
+}
+
+/*!
+    Returns the executor that QxtJob::then() uses for jobs that have never been submitted to one.
+    It runs QThread::idealThreadCount() workers.
+ */
+QxtJobExecutor* QxtJobExecutor::globalInstance()
+{
+    return qxt_globalJobExecutor();
+}
+
+/*!
+    Returns the number of worker threads.
+ */
+int QxtJobExecutor::threadCount() const
+{
+    return qxt_d().workers.count();
+}
+
+/*!
+    Returns the number of jobs that are queued or running. Jobs waiting on a dependency
+    are not counted until they are queued.
+ */
+int QxtJobExecutor::activeJobCount() const
+{
+    QMutexLocker locker(&const_cast<QxtJobExecutor*>(this)->qxt_d().idleLock);
+    return qxt_d().active;
+}
+
+/*!
+    Queues \a job to run on one of the worker threads. Returns \c false if the job is
+    already queued or running.
+
+    \sa QxtJob::exec()
+ */
+bool QxtJobExecutor::submit(QxtJob* job)
+{
+    return qxt_d().submit(job, false);
+}
+
+/*!
+    Runs \a job once \a dependency has finished. If \a dependency is canceled, \a job is
+    canceled too. Returns \c false if \a job is already queued or running.
+
+    \sa QxtJob::then()
+ */
+bool QxtJobExecutor::submitAfter(QxtJob* job, QxtJob* dependency)
+{
+    return QxtJobExecutorPrivate::submitAfter(&qxt_d(), job, QList<QxtJob*>() << dependency, false);
+}
+
+/*!
+    Runs \a job once every job in \a dependencies has finished. If any of them is canceled,
+    \a job is canceled instead. A dependency that has not been started yet is waited for.
+ */
+bool QxtJobExecutor::submitAfterAll(QxtJob* job, const QList<QxtJob*>& dependencies)
+{
+    return QxtJobExecutorPrivate::submitAfter(&qxt_d(), job, dependencies, false);
+}
+
+/*!
+    Runs \a job as soon as the first job in \a dependencies has finished. If all of them are
+    canceled, \a job is canceled instead.
+ */
+bool QxtJobExecutor::submitAfterAny(QxtJob* job, const QList<QxtJob*>& dependencies)
+{
+    return QxtJobExecutorPrivate::submitAfter(&qxt_d(), job, dependencies, true);
+}
+
+/*!
+    Blocks until no job is queued or running any more, or until \a msecs milliseconds have
+    passed. A negative \a msecs waits without a timeout. Returns \c false on timeout.
+ */
+bool QxtJobExecutor::waitForDone(int msecs)
+{
+    QxtJobExecutorPrivate& d = qxt_d();
+    QElapsedTimer timer;
+    timer.start();
+    QMutexLocker locker(&d.idleLock);
+    while (d.active > 0)
+    {
+        if (msecs < 0)
+        {
+            d.allDone.wait(&d.idleLock);
+            continue;
+        }
+        const qint64 left = msecs - timer.elapsed();
+        if (left <= 0 || !d.allDone.wait(&d.idleLock, (unsigned long)left))
+            return d.active == 0;
+    }
+    return true;
+}
+
+/*!
+    Blocks until every job in \a jobs has finished or has been canceled, or until \a msecs
+    milliseconds have passed. A negative \a msecs waits without a timeout. Returns \c false
+    on timeout.
+ */
+bool QxtJobExecutor::waitForAll(const QList<QxtJob*>& jobs, int msecs)
+{
+    QElapsedTimer timer;
+    timer.start();
+    Q_FOREACH(QxtJob* job, jobs)
+    {
+        int left = -1;
+        if (msecs >= 0)
+            left = qMax(0, msecs - int(timer.elapsed()));
+        if (!job->wait(left))
+            return false;
+    }
+    return true;
+}
+
+/*!
+    Blocks until one of the jobs in \a jobs has finished and returns its index. Returns -1
+    if all of them have been canceled, or if \a msecs milliseconds have passed first. A
+    negative \a msecs waits without a timeout.
+ */
+int QxtJobExecutor::waitForAny(const QList<QxtJob*>& jobs, int msecs)
+{
+    return QxtJobExecutorPrivate::waitForAny(jobs, msecs);
+}
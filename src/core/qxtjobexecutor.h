@@ -0,0 +1,66 @@
+/****************************************************************************
+** Copyright (c) 2006 - 2011, the LibQxt project.
+** See the Qxt AUTHORS file for a list of authors and copyright holders.
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**     * Redistributions of source code must retain the above copyright
+**       notice, this list of conditions and the following disclaimer.
+**     * Redistributions in binary form must reproduce the above copyright
+**       notice, this list of conditions and the following disclaimer in the
+**       documentation and/or other materials provided with the distribution.
+**     * Neither the name of the LibQxt project nor the
+**       names of its contributors may be used to endorse or promote products
+**       derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+** ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+** DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+** (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+** LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+** ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** <http://libqxt.org>  <foundation@libqxt.org>
+*****************************************************************************/
+
+#ifndef QXTJOBEXECUTOR_H
+#define QXTJOBEXECUTOR_H
+
+#include <qxtglobal.h>
+#include <QObject>
+#include <QList>
+
+class QxtJob;
+
+class QxtJobExecutorPrivate;
+class QXT_CORE_EXPORT QxtJobExecutor : public QObject
+{
+    Q_OBJECT
+public:
+    explicit QxtJobExecutor(int threadCount = -1, QObject* parent = 0);
+    virtual ~QxtJobExecutor();
+
+    static QxtJobExecutor* globalInstance();
+
+    int threadCount() const;
+    int activeJobCount() const;
+
+    bool submit(QxtJob* job);
+    bool submitAfter(QxtJob* job, QxtJob* dependency);
+    bool submitAfterAll(QxtJob* job, const QList<QxtJob*>& dependencies);
+    bool submitAfterAny(QxtJob* job, const QList<QxtJob*>& dependencies);
+
+    bool waitForDone(int msecs = -1);
+    static bool waitForAll(const QList<QxtJob*>& jobs, int msecs = -1);
+    static int waitForAny(const QList<QxtJob*>& jobs, int msecs = -1);
+
+private:
+    QXT_DECLARE_PRIVATE(QxtJobExecutor)
+};
+
+#endif // QXTJOBEXECUTOR_H
@@ -0,0 +1,95 @@
+/****************************************************************************
+** Copyright (c) 2006 - 2011, the LibQxt project.
+** See the Qxt AUTHORS file for a list of authors and copyright holders.
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**     * Redistributions of source code must retain the above copyright
+**       notice, this list of conditions and the following disclaimer.
+**     * Redistributions in binary form must reproduce the above copyright
+**       notice, this list of conditions and the following disclaimer in the
+**       documentation and/or other materials provided with the distribution.
+**     * Neither the name of the LibQxt project nor the
+**       names of its contributors may be used to endorse or promote products
+**       derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+** ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+** DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+** (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+** LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+** ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** <http://libqxt.org>  <foundation@libqxt.org>
+*****************************************************************************/
+
+#ifndef QXTJOBEXECUTOR_P_H
+#define QXTJOBEXECUTOR_P_H
+
+#include "qxtjobexecutor.h"
+#include "qxtjob_p.h"
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInt>
+#include <QVector>
+
+class QxtJobWorker : public QThread
+{
+public:
+    QxtJobWorker(int index, QxtJobExecutorPrivate* pool);
+
+    int index;
+    QxtJobExecutorPrivate* pool;
+    // the worker pops from the back of its own queue, idle workers steal from the front
+    QMutex lock;
+    QList<QxtJob*> jobs;
+
+protected:
+    void run();
+};
+
+class QxtJobExecutorPrivate : public QxtPrivate<QxtJobExecutor>
+{
+public:
+    QxtJobExecutorPrivate();
+    QXT_DECLARE_PUBLIC(QxtJobExecutor)
+
+    void start(int count);
+    void stop();
+    bool submit(QxtJob* job, bool dependent);
+    // without an executor, the job runs on the one of the dependency that releases it
+    static bool submitAfter(QxtJobExecutorPrivate* executor, QxtJob* job, const QList<QxtJob*>& dependencies, bool any);
+    // the job's mutex must be held by the caller
+    void enqueue(QxtJob* job);
+    QxtJob* take(int self);
+    void execute(QxtJob* job);
+    void jobDone();
+
+    static inline QxtJobPrivate& job(QxtJob* job)
+    {
+        return job->qxt_d();
+    }
+    // the executor the job last ran on, or the global one
+    static QxtJobExecutorPrivate* executorOf(QxtJob* job);
+    static bool dequeue(QxtJobExecutor* executor, QxtJob* job);
+    static int waitForAny(const QList<QxtJob*>& jobs, int msecs);
+
+    QVector<QxtJobWorker*> workers;
+    QAtomicInt queued;
+    QAtomicInt nextWorker;
+    // idleLock guards everything below
+    QMutex idleLock;
+    QWaitCondition wake;
+    QWaitCondition allDone;
+    int sleeping;
+    int active;
+    bool stopping;
+};
+
+#endif // QXTJOBEXECUTOR_P_H
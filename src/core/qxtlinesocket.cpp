@@ -31,6 +31,7 @@
 
 #include "qxtlinesocket_p.h"
 #include <QIODevice>
+#include <string.h>
 
 /*!
     \class QxtLineSocket
@@ -38,6 +39,15 @@
     \inmodule QxtCore
 
     \brief The QxtLineSocket class acts on a QIODevice as baseclass for line-based protocols
+
+    All complete lines available after a readyRead() of the socket are delivered
+    together: first one by one through newLineReceived() and newLine(), then as
+    a whole through newLinesReceived() and newLines(). Protocols that handle many
+    short lines should use the batch variants.
+
+    The received data is scanned for newlines once, and every line is copied out
+    of the read buffer exactly once. To bound the memory used by a peer that never
+    sends a newline, set a maximumLineLength().
 */
 
 /*!
@@ -46,12 +56,27 @@
     This signal is emitted whenever a new \a line is received.
  */
 
+/*!
+    \fn QxtLineSocket::newLinesReceived(const QList<QByteArray>& lines)
+
+    This signal is emitted once for all \a lines that became complete with a
+    single read from the socket.
+ */
+
+/*!
+    \fn QxtLineSocket::lineTooLong()
+
+    This signal is emitted when a line exceeds the maximumLineLength(). The line
+    is discarded up to and including its newline.
+ */
+
 /*!
     Constructs a new QxtLineSocket with \a parent.
  */
 QxtLineSocket::QxtLineSocket(QObject* parent) : QObject(parent)
 {
     QXT_INIT_PRIVATE(QxtLineSocket);
+    qRegisterMetaType<QList<QByteArray> >("QList<QByteArray>");
 }
 
 /*!
@@ -60,6 +85,7 @@ QxtLineSocket::QxtLineSocket(QObject* parent) : QObject(parent)
 QxtLineSocket::QxtLineSocket(QIODevice* socket, QObject* parent) : QObject(parent)
 {
     QXT_INIT_PRIVATE(QxtLineSocket);
+    qRegisterMetaType<QList<QByteArray> >("QList<QByteArray>");
     setSocket(socket);
 }
 
@@ -83,14 +109,59 @@ QIODevice* QxtLineSocket::socket() const
     return qxt_d().socket;
 }
 
+/*!
+    Returns the maximum length of a received line, or \c 0 if the length is
+    not limited. This is the default.
+ */
+int QxtLineSocket::maximumLineLength() const
+{
+    return qxt_d().maxLength;
+}
+
+/*!
+    Sets the maximum \a length of a received line, not counting the newline.
+    Longer lines are discarded and reported with lineTooLong(); at most \a length
+    bytes of a partial line are kept in memory. A \a length of \c 0 removes the limit.
+ */
+void QxtLineSocket::setMaximumLineLength(int length)
+{
+    qxt_d().maxLength = qMax(0, length);
+}
+
 /*!
     Sends a \a line.
  */
 void QxtLineSocket::sendLine(const QByteArray& line)
 {
-    QByteArray copy(line);
-    copy.replace(QByteArray("\n"), ""); //krazy:exclude=doublequote_chars
-    qxt_d().socket->write(copy + '\n');
+    QByteArray copy;
+    copy.reserve(line.size() + 1);
+    copy.append(line);
+    if (copy.contains('\n'))
+        copy.replace(QByteArray("\n"), ""); //krazy:exclude=doublequote_chars
+    copy.append('\n');
+    qxt_d().socket->write(copy);
+}
+
+/*!
+    Sends all \a lines with a single write to the socket.
+ */
+void QxtLineSocket::sendLines(const QList<QByteArray>& lines)
+{
+    int size = 0;
+    Q_FOREACH(const QByteArray& line, lines)
+        size += line.size() + 1;
+
+    QByteArray data;
+    data.reserve(size);
+    Q_FOREACH(const QByteArray& line, lines)
+    {
+        if (line.contains('\n'))
+            data.append(QByteArray(line).replace(QByteArray("\n"), "")); //krazy:exclude=doublequote_chars
+        else
+            data.append(line);
+        data.append('\n');
+    }
+    qxt_d().socket->write(data);
 }
 
 /*!
@@ -104,16 +175,83 @@ void QxtLineSocket::newLine(const QByteArray& line)
     Q_UNUSED(line);
 }
 
+/*!
+    This virtual function is called by QxtLineSocket with all \a lines that were
+    completed by a single read from the socket, after newLine() has been called
+    for each of them. Reimplement this function when creating a subclass of
+    QxtLineSocket that handles lines in batches.
+
+    \note The default implementation does nothing.
+ */
+void QxtLineSocket::newLines(const QList<QByteArray>& lines)
+{
+    Q_UNUSED(lines);
+}
+
 void QxtLineSocketPrivate::readyRead()
 {
-    buffer += socket->readAll();
+    const QByteArray data = socket->readAll();
+    if (data.isEmpty())
+        return;
+    if (start == buffer.size())
+    {
+        // nothing pending: take over the read buffer without copying it
+        buffer = data;
+        start = scanned = 0;
+    }
+    else
+    {
+        if (start > 0)
+        {
+            buffer.remove(0, start);
+            scanned -= start;
+            start = 0;
+        }
+        buffer.append(data);
+    }
+
+    QList<QByteArray> lines;
+    int tooLong = 0;
+    const char* base = buffer.constData();
+    const int size = buffer.size();
+    while (const char* newline = static_cast<const char*>(memchr(base + scanned, '\n', size - scanned)))
+    {
+        const int end = int(newline - base);
+        const int length = end - start;
+        if (discarding)
+            discarding = false;
+        else if (maxLength > 0 && length > maxLength)
+            tooLong++;
+        else
+            lines.append(QByteArray(base + start, length));
+        start = scanned = end + 1;
+    }
+    scanned = size;
+
+    // the rest of an overlong line is dropped as it arrives
+    if (maxLength > 0 && (discarding || size - start > maxLength))
+    {
+        if (!discarding)
+            tooLong++;
+        discarding = true;
+        start = scanned = size;
+    }
+    if (start == size)
+    {
+        buffer.clear();
+        start = scanned = 0;
+    }
 
-    int i = 0;
-    while ((i = buffer.indexOf('\n')) > -1)
+    QxtLineSocket& p = qxt_p();
+    for (int i = 0; i < tooLong; i++)
+        emit p.lineTooLong();
+    if (lines.isEmpty())
+        return;
+    Q_FOREACH(const QByteArray& line, lines)
     {
-        QByteArray line = buffer.left(i);
-        emit qxt_p().newLineReceived(line);
-        qxt_p().newLine(line);
-        buffer = buffer.mid(i + 1);
+        emit p.newLineReceived(line);
+        p.newLine(line);
     }
+    emit p.newLinesReceived(lines);
+    p.newLines(lines);
 }
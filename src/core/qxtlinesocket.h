@@ -32,6 +32,8 @@
 #define QXTLINESOCKET_H
 
 #include <QObject>
+#include <QList>
+#include <QByteArray>
 #include <qxtglobal.h>
 
 QT_FORWARD_DECLARE_CLASS(QIODevice)
@@ -47,14 +49,21 @@ public:
     void setSocket(QIODevice* socket);
     QIODevice* socket() const;
 
+    int maximumLineLength() const;
+    void setMaximumLineLength(int length);
+
 public Q_SLOTS:
     void sendLine(const QByteArray& line);
+    void sendLines(const QList<QByteArray>& lines);
 
 Q_SIGNALS:
     void newLineReceived(const QByteArray& line);
+    void newLinesReceived(const QList<QByteArray>& lines);
+    void lineTooLong();
 
 protected:
     virtual void newLine(const QByteArray& line);
+    virtual void newLines(const QList<QByteArray>& lines);
 
 private:
     QXT_DECLARE_PRIVATE(QxtLineSocket)
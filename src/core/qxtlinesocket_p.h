@@ -40,12 +40,17 @@ class QxtLineSocketPrivate : public QObject, public QxtPrivate<QxtLineSocket>
     QXT_DECLARE_PUBLIC(QxtLineSocket)
 
 public:
-    QxtLineSocketPrivate() : socket(0)
+    QxtLineSocketPrivate() : socket(0), start(0), scanned(0), maxLength(0), discarding(false)
     {
     }
 
     QIODevice* socket;
+    // Unconsumed data is buffer[start..]; buffer[scanned..] has not been searched for newlines yet.
     QByteArray buffer;
+    int start;
+    int scanned;
+    int maxLength;
+    bool discarding;
 
 private Q_SLOTS:
     void readyRead();
@@ -62,6 +62,17 @@ QxtLinkedTreeIterator<int> it= tree.fromVoid(root);
 \endcode
 
 
+Every node is normally allocated on its own. For large trees, construct the tree with a pool chunk size;
+its nodes are then allocated from chunks of that many nodes, and clearing or destroying the tree frees the
+chunks at once instead of deleting the nodes one by one. freeze() moves all nodes into a single chunk in
+depth-first order, so that walking the tree reads memory sequentially.
+
+\code
+QxtLinkedTree<QString> tree("config", 1024);
+// ... build the tree
+tree.freeze();
+\endcode
+
 TODO: {implicitshared}
 */
 
@@ -76,6 +87,12 @@ constructs a QxtLinkedTree.
 sets the rootnode to \a t
 */
 
+/*!
+\fn QxtLinkedTree::QxtLinkedTree(T t, int poolChunkSize);
+constructs a pooled QxtLinkedTree.
+sets the rootnode to \a t. the nodes of the tree are allocated in chunks of \a poolChunkSize nodes.
+*/
+
 /*!
 \fn QxtLinkedTree::~QxtLinkedTree()
 the destructor deletes all items, when they are no longer referenced by any other instance.
@@ -84,6 +101,21 @@ the destructor deletes all items, when they are no longer referenced by any othe
 /*!
 \fn void QxtLinkedTree::clear();
 deletes all nodes recursively. this might take forever depending on the size of your tree.
+for a pooled tree the chunks are freed at once, and the nodes are only destructed if T needs it.
+*/
+
+/*!
+\fn bool QxtLinkedTree::isPooled() const;
+returns true if the nodes of this tree are allocated from a pool.
+\sa freeze()
+*/
+
+/*!
+\fn void QxtLinkedTree::freeze();
+copies all nodes into one contiguous chunk in depth-first order and deletes the old nodes.
+afterwards the tree is pooled. nodes can still be added and removed, but new nodes are allocated
+outside of the frozen chunk.
+all iterators and pointers created by toVoid(), except those on the root node, are invalid after calling this.
 */
 
 /*!
@@ -33,6 +33,8 @@
 
 #include <qxtglobal.h>
 #include <qxtsharedprivate.h>
+#include <QVector>
+#include <new>
 
 template<class T>
 class QxtLinkedTree;
@@ -40,6 +42,9 @@ class QxtLinkedTree;
 template<class T>
 class QxtLinkedTreeIterator;
 
+template<class T>
+class QxtLinkedTreeArena;
+
 template<class T>
 class QXT_CORE_EXPORT QxtLinkedTreeItem
 {
@@ -47,6 +52,9 @@ public:
     ~QxtLinkedTreeItem()
     {
         clear();
+        // the root owns the pool of the tree
+        if (!parent)
+            delete arena;
     }
 
 private:
@@ -58,35 +66,148 @@ private:
         parent = 0;
         child = 0;
         childcount = 0;
+        arena = 0;
+    }
+
+    static QxtLinkedTreeItem * create(QxtLinkedTreeArena<T> * arena, const T & value)
+    {
+        QxtLinkedTreeItem * node = arena ? new (arena->allocate()) QxtLinkedTreeItem(value) : new QxtLinkedTreeItem(value);
+        node->arena = arena;
+        return node;
+    }
+
+    static void destroy(QxtLinkedTreeItem * node)
+    {
+        QxtLinkedTreeArena<T> * arena = node->arena;
+        if (arena)
+        {
+            node->~QxtLinkedTreeItem();
+            arena->release(node);
+        }
+        else
+        {
+            delete node;
+        }
     }
 
     void clear()
     {
-        if (child)
+        if (arena && !parent)
+        {
+            // pooled nodes are released all at once
+            arena->clear();
+        }
+        else if (child)
         {
             QxtLinkedTreeItem * c = child;
             while (c)
             {
                 QxtLinkedTreeItem * e = c;
                 c = c->next;
-                delete e;
+                destroy(e);
             }
-            child = 0;
         }
+        child = 0;
+        childcount = 0;
     }
 
     friend class QxtLinkedTree<T>;
     friend class QxtLinkedTreeIterator<T>;
+    friend class QxtLinkedTreeArena<T>;
     QxtLinkedTreeItem * next;
     QxtLinkedTreeItem * previous;
     QxtLinkedTreeItem * parent;
     QxtLinkedTreeItem * child;
     int childcount;
+    QxtLinkedTreeArena<T> * arena;
 
     T t;
     ///TODO: somehow notify all iterators when one deletes this. so they can be made invalid instead of undefined.
 };
 
+// Allocates the nodes of a pooled tree in chunks. Released nodes are kept on a free list for reuse;
+// the chunks themselves are only freed when the whole tree is cleared.
+template<class T>
+class QxtLinkedTreeArena
+{
+public:
+    typedef QxtLinkedTreeItem<T> Item;
+
+    explicit QxtLinkedTreeArena(int chunkSize) : chunkSize(qMax(chunkSize, 1)), freeList(0)
+    {
+    }
+
+    ~QxtLinkedTreeArena()
+    {
+        clear();
+    }
+
+    void * allocate()
+    {
+        if (freeList)
+        {
+            Item * item = freeList;
+            freeList = item->next;
+            return item;
+        }
+        if (chunks.isEmpty() || chunks.last().used == chunks.last().capacity)
+            addChunk(chunkSize);
+        Chunk & chunk = chunks.last();
+        return chunk.data + chunk.used++;
+    }
+
+    // the item must have been destroyed already
+    void release(Item * item)
+    {
+        item->childcount = -1;
+        item->next = freeList;
+        freeList = item;
+    }
+
+    // destroys the values of all live items and frees every chunk
+    void clear()
+    {
+        for (int i = 0; i < chunks.count(); i++)
+        {
+            const Chunk & chunk = chunks.at(i);
+            if (QTypeInfo<T>::isComplex)
+            {
+                for (int j = 0; j < chunk.used; j++)
+                {
+                    if (chunk.data[j].childcount >= 0)
+                        chunk.data[j].t.~T();
+                }
+            }
+            ::operator delete(chunk.data);
+        }
+        chunks.clear();
+        freeList = 0;
+    }
+
+    void addChunk(int capacity)
+    {
+        Chunk chunk;
+        chunk.data = static_cast<Item *>(::operator new(capacity * sizeof(Item)));
+        chunk.capacity = capacity;
+        chunk.used = 0;
+        chunks.append(chunk);
+    }
+
+    int chunkSize;
+
+private:
+    Q_DISABLE_COPY(QxtLinkedTreeArena)
+
+    struct Chunk
+    {
+        Item * data;
+        int capacity;
+        int used;
+    };
+    QVector<Chunk> chunks;
+    Item * freeList;
+};
+
 ///FIXME: nested would be cooler but c++ has no typdefs with templates and doxygen doesn't undertsand nested templates
 template<class T>
 class QXT_CORE_EXPORT QxtLinkedTreeIterator
@@ -139,8 +260,11 @@ public:
 
     QxtLinkedTree();
     QxtLinkedTree(T t);
+    QxtLinkedTree(T t, int poolChunkSize);
     ~QxtLinkedTree();
     void clear();
+    bool isPooled() const;
+    void freeze();
     QxtLinkedTreeIterator<T> root();
     static QxtLinkedTreeIterator<T> fromVoid(void *) ;
     static void * toVoid(QxtLinkedTreeIterator<T>) ;
@@ -354,8 +478,10 @@ QxtLinkedTreeIterator<T>  QxtLinkedTreeIterator<T>::erase()
         }
         n->next = node->next;
     }
+    if (next)
+        next->previous = node->previous;
     parent->childcount--;
-    delete node;
+    QxtLinkedTreeItem<T>::destroy(node);
     item = 0;
     return QxtLinkedTreeIterator<T>(next);
 }
@@ -366,7 +492,7 @@ QxtLinkedTreeIterator<T>  QxtLinkedTreeIterator<T>::append(const T & value)
     QxtLinkedTreeItem <T> * parent = item;
     Q_ASSERT_X(parent, Q_FUNC_INFO, "invalid iterator");
 
-    QxtLinkedTreeItem<T> *node = new QxtLinkedTreeItem<T>(value);
+    QxtLinkedTreeItem<T> *node = QxtLinkedTreeItem<T>::create(parent->arena, value);
 
     if (parent->child == 0)
     {
@@ -402,7 +528,7 @@ QxtLinkedTreeIterator<T>  QxtLinkedTreeIterator<T>::insert(int i, const T & valu
         return append(value);
     }
 
-    QxtLinkedTreeItem<T> *node = new QxtLinkedTreeItem<T>(value);
+    QxtLinkedTreeItem<T> *node = QxtLinkedTreeItem<T>::create(parent->arena, value);
 
     QxtLinkedTreeItem <T> * n = parent->child;
 
@@ -441,6 +567,13 @@ QxtLinkedTree<T>::QxtLinkedTree()
     qxt_d = new QxtLinkedTreeItem<T>(T());
 }
 
+template<class T>
+QxtLinkedTree<T>::QxtLinkedTree(T t, int poolChunkSize)
+{
+    qxt_d = new QxtLinkedTreeItem<T>(t);
+    qxt_d().arena = new QxtLinkedTreeArena<T>(poolChunkSize);
+}
+
 template<class T>
 QxtLinkedTree<T>::~QxtLinkedTree()
 {
@@ -452,6 +585,92 @@ void QxtLinkedTree<T>::clear()
     qxt_d().clear();
 }
 
+template<class T>
+bool QxtLinkedTree<T>::isPooled() const
+{
+    return qxt_d().arena != 0;
+}
+
+template<class T>
+void QxtLinkedTree<T>::freeze()
+{
+    typedef QxtLinkedTreeItem<T> Item;
+    Item & root = qxt_d();
+
+    int count = 0;
+    for (Item * n = root.child; n; )
+    {
+        count++;
+        if (n->child)
+        {
+            n = n->child;
+            continue;
+        }
+        while (n != &root && !n->next)
+            n = n->parent;
+        n = (n == &root) ? 0 : n->next;
+    }
+
+    QxtLinkedTreeArena<T> * old = root.arena;
+    QxtLinkedTreeArena<T> * arena = new QxtLinkedTreeArena<T>(old ? old->chunkSize : 256);
+    if (count)
+        arena->addChunk(count);
+
+    // copy the nodes in depth-first order, walking the old and the new tree side by side
+    Item * oldFirst = root.child;
+    Item * n = oldFirst;
+    Item * parentCopy = &root;
+    Item * previousCopy = 0;
+    while (n)
+    {
+        Item * copy = Item::create(arena, n->t);
+        copy->parent = parentCopy;
+        copy->previous = previousCopy;
+        copy->childcount = n->childcount;
+        if (previousCopy)
+            previousCopy->next = copy;
+        else
+            parentCopy->child = copy;
+
+        if (n->child)
+        {
+            parentCopy = copy;
+            previousCopy = 0;
+            n = n->child;
+            continue;
+        }
+        previousCopy = copy;
+        while (n && !n->next)
+        {
+            n = n->parent;
+            if (n == &root)
+            {
+                n = 0;
+                break;
+            }
+            previousCopy = parentCopy;
+            parentCopy = parentCopy->parent;
+        }
+        if (n)
+            n = n->next;
+    }
+
+    if (old)
+    {
+        delete old;
+    }
+    else
+    {
+        while (oldFirst)
+        {
+            Item * e = oldFirst;
+            oldFirst = oldFirst->next;
+            delete e;
+        }
+    }
+    root.arena = arena;
+}
+
 template<class T>
 QxtLinkedTreeIterator<T>  QxtLinkedTree<T>::fromVoid(void * d)
 {
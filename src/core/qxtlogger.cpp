@@ -81,6 +81,18 @@
     can give you a lot of data if you need it.  But if you only want to see warnings and errors, qxtLog->setMinimumLogLevel(WarningLevel) might
     be more useful.
 
+    \section1 Performance
+    QxtLogger keeps a cached mask of the levels that at least one enabled engine accepts, and every logging
+    function checks it before doing any work.  The arguments of a call are still evaluated by the caller,
+    though.  The qxtTrace(), qxtDebug(), qxtInfo(), qxtWarning(), qxtError(), qxtCritical(), qxtFatal() and
+    qxtWrite() macros check the mask first and skip the whole call, arguments included, when the level is off:
+    \code
+    qxtTrace("cache state", cache.dump()); // dump() only runs when some engine has TraceLevel enabled
+    qxtDebug() << "request" << request.toString();
+    \endcode
+    Defining QXT_NO_TRACE_OUTPUT (or QXT_NO_DEBUG_OUTPUT, which also removes debug messages) when compiling
+    turns the corresponding macros into dead code.
+
     \section1 Extending
     The functionality of QxtLogger can be extended by creating plugins derived from QxtLoggerEngine.  Logger Engines
     are the little workers that actually take the raw data, format it, and spit it out into meaningful forms.
@@ -136,10 +148,21 @@
 #include <QMutex>
 #include <QMutexLocker>
 
+QAtomicInt QxtLogger::activeLevels(0);
+
+// Set as soon as the singleton has its private data, so that engines never have to call getInstance().
+static QxtLoggerPrivate* qxt_loggerInstance = 0;
+
+void qxt_logLevelsChanged()
+{
+    if (qxt_loggerInstance)
+        qxt_loggerInstance->updateLevelMask();
+}
+
 /*******************************************************************************
 Constructor for QxtLogger's private data
 *******************************************************************************/
-QxtLoggerPrivate::QxtLoggerPrivate()
+QxtLoggerPrivate::QxtLoggerPrivate() : writer(0), writerUsers(0), droppedTotal(0)
 {
     mut_lock = new QMutex(QMutex::Recursive);
 }
@@ -149,6 +172,13 @@ Destructor for QxtLogger's private data
 *******************************************************************************/
 QxtLoggerPrivate::~QxtLoggerPrivate()
 {
+    qxt_loggerInstance = 0;
+    QxtLoggerWriter* async = writer.fetchAndStoreOrdered(0);
+    if (async)
+    {
+        async->stop();
+        delete async;
+    }
     Q_FOREACH(QxtLoggerEngine *eng, map_logEngineMap)
     {
         if (eng)
@@ -172,6 +202,242 @@ void QxtLoggerPrivate::log(QxtLogger::LogLevel level, const QList<QVariant>& msg
     }
 }
 
+void QxtLoggerPrivate::updateLevelMask()
+{
+    QMutexLocker lock(mut_lock);
+    int mask = QxtLogger::LevelMaskInitialized;
+    Q_FOREACH(QxtLoggerEngine *eng, map_logEngineMap)
+    {
+        if (!eng || !eng->isLoggingEnabled()) continue;
+        for (int level = QxtLogger::TraceLevel; level <= QxtLogger::WriteLevel; level <<= 1)
+        {
+            if (eng->isLogLevelEnabled(QxtLogger::LogLevel(level)))
+                mask |= level;
+        }
+    }
+    QxtLogger::activeLevels.fetchAndStoreRelease(mask);
+}
+
+void QxtLoggerPrivate::writeBatch(const QxtLogger::LogLevel* levels, const QList<QVariant>* records, int count, int dropped)
+{
+    // One lock per batch instead of one queued metacall per record.
+    QMutexLocker lock(mut_lock);
+    if (dropped > 0)
+        log(QxtLogger::WarningLevel, QList<QVariant>() << QString("QxtLogger: %1 records dropped, queue full").arg(dropped));
+    for (int i = 0; i < count; i++)
+        log(levels[i], records[i]);
+}
+
+/*******************************************************************************
+    Asynchronous logging
+*******************************************************************************/
+static inline int qxt_loadAcquire(const QAtomicInt& value)
+{
+    return const_cast<QAtomicInt&>(value).fetchAndAddAcquire(0);
+}
+
+/*******************************************************************************
+    QxtLoggerWriterLocker
+    Picks up the current writer and keeps disableAsynchronousLogging() from
+    deleting it until the locker goes out of scope. The count is raised before
+    the pointer is read, and disabling clears the pointer before it reads the
+    count, so one of the two always sees the other.
+*******************************************************************************/
+class QxtLoggerWriterLocker
+{
+public:
+    explicit QxtLoggerWriterLocker(const QxtLoggerPrivate& d) : users(const_cast<QAtomicInt&>(d.writerUsers))
+    {
+        users.fetchAndAddOrdered(1);
+        writer = const_cast<QAtomicPointer<QxtLoggerWriter>&>(d.writer).fetchAndAddOrdered(0);
+    }
+    ~QxtLoggerWriterLocker()
+    {
+        users.fetchAndAddRelease(-1);
+    }
+
+    QxtLoggerWriter* writer;
+
+private:
+    QAtomicInt& users;
+    Q_DISABLE_COPY(QxtLoggerWriterLocker)
+};
+
+// Positions wrap around; compare them through unsigned arithmetic so the wrap is well defined.
+static inline int qxt_distance(int a, int b)
+{
+    return int(uint(a) - uint(b));
+}
+
+static const int qxt_writerBatchSize = 256;
+
+QxtLoggerQueue::QxtLoggerQueue(int capacity) : enqueuePos(0), dequeuePos(0)
+{
+    int size = 2;
+    while (size < capacity)
+        size <<= 1;
+    slots = new Slot[size];
+    mask = size - 1;
+    for (int i = 0; i < size; i++)
+        slots[i].sequence.fetchAndStoreRelaxed(i);
+}
+
+QxtLoggerQueue::~QxtLoggerQueue()
+{
+    delete[] slots;
+}
+
+bool QxtLoggerQueue::tryPush(QxtLogger::LogLevel level, const QList<QVariant>& args)
+{
+    Slot* slot;
+    int pos = qxt_loadAcquire(enqueuePos);
+    for (;;)
+    {
+        slot = &slots[pos & mask];
+        int diff = qxt_distance(qxt_loadAcquire(slot->sequence), pos);
+        if (diff == 0)
+        {
+            // The slot is free; claim it.
+            if (enqueuePos.testAndSetRelaxed(pos, int(uint(pos) + 1)))
+                break;
+            pos = qxt_loadAcquire(enqueuePos);
+        }
+        else if (diff < 0)
+        {
+            // The slot still holds a record from the previous lap: the queue is full.
+            return false;
+        }
+        else
+        {
+            // Another producer claimed the slot first.
+            pos = qxt_loadAcquire(enqueuePos);
+        }
+    }
+    slot->level = level;
+    slot->args = args;
+    slot->sequence.fetchAndStoreRelease(int(uint(pos) + 1));
+    return true;
+}
+
+bool QxtLoggerQueue::tryPop(QxtLogger::LogLevel& level, QList<QVariant>& args)
+{
+    Slot* slot = &slots[dequeuePos & mask];
+    if (qxt_distance(qxt_loadAcquire(slot->sequence), int(uint(dequeuePos) + 1)) < 0)
+        return false;
+    level = slot->level;
+    args = slot->args;
+    slot->args = QList<QVariant>();
+    slot->sequence.fetchAndStoreRelease(int(uint(dequeuePos) + uint(mask) + 1));
+    dequeuePos = int(uint(dequeuePos) + 1);
+    return true;
+}
+
+bool QxtLoggerQueue::isEmpty() const
+{
+    const Slot* slot = &slots[dequeuePos & mask];
+    return qxt_distance(qxt_loadAcquire(slot->sequence), int(uint(dequeuePos) + 1)) < 0;
+}
+
+int QxtLoggerQueue::pushed() const
+{
+    return qxt_loadAcquire(enqueuePos);
+}
+
+QxtLoggerWriter::QxtLoggerWriter(QxtLoggerPrivate* logger, int capacity, QxtLogger::OverflowPolicy policy)
+        : QThread(0), queue(capacity), policy(policy), dropped(0), logger(logger),
+          sleeping(0), waiters(0), written(0), stopping(0)
+{
+}
+
+void QxtLoggerWriter::push(QxtLogger::LogLevel level, const QList<QVariant>& args)
+{
+    while (!queue.tryPush(level, args))
+    {
+        // An engine that logs from inside the writer thread must never wait for itself.
+        if (policy == QxtLogger::DropOnOverflow || QThread::currentThread() == this)
+        {
+            dropped.ref();
+            return;
+        }
+        QMutexLocker lock(&waitLock);
+        waiters.ref();
+        recordsAvailable.wakeOne();
+        recordsWritten.wait(&waitLock, 10);
+        waiters.deref();
+    }
+
+    // Only pay for the mutex when the writer is actually asleep.
+    if (qxt_loadAcquire(sleeping))
+    {
+        QMutexLocker lock(&waitLock);
+        recordsAvailable.wakeOne();
+    }
+}
+
+void QxtLoggerWriter::flush()
+{
+    if (QThread::currentThread() == this)
+        return;
+    int target = queue.pushed();
+    QMutexLocker lock(&waitLock);
+    waiters.ref();
+    while (qxt_distance(target, qxt_loadAcquire(written)) > 0 && isRunning())
+    {
+        recordsAvailable.wakeOne();
+        recordsWritten.wait(&waitLock, 10);
+    }
+    waiters.deref();
+}
+
+void QxtLoggerWriter::stop()
+{
+    stopping.fetchAndStoreOrdered(1);
+    {
+        QMutexLocker lock(&waitLock);
+        recordsAvailable.wakeOne();
+    }
+    wait();
+}
+
+void QxtLoggerWriter::run()
+{
+    QxtLogger::LogLevel levels[qxt_writerBatchSize];
+    QList<QVariant> records[qxt_writerBatchSize];
+    int reported = 0;
+
+    for (;;)
+    {
+        int count = 0;
+        while (count < qxt_writerBatchSize && queue.tryPop(levels[count], records[count]))
+            count++;
+
+        int lost = qxt_loadAcquire(dropped) - reported;
+        if (count > 0 || lost > 0)
+        {
+            logger->writeBatch(levels, records, count, lost);
+            reported += lost;
+            for (int i = 0; i < count; i++)
+                records[i] = QList<QVariant>();
+            written.fetchAndAddRelease(count);
+            if (qxt_loadAcquire(waiters))
+            {
+                QMutexLocker lock(&waitLock);
+                recordsWritten.wakeAll();
+            }
+            continue;
+        }
+
+        if (qxt_loadAcquire(stopping))
+            break;
+
+        QMutexLocker lock(&waitLock);
+        sleeping.fetchAndStoreOrdered(1);
+        if (queue.isEmpty() && !qxt_loadAcquire(stopping))
+            recordsAvailable.wait(&waitLock, 100);
+        sleeping.fetchAndStoreOrdered(0);
+    }
+}
+
 void QxtLoggerPrivate::setQxtLoggerEngineMinimumLevel(QxtLoggerEngine *eng, QxtLogger::LogLevel level)
 {
     QMutexLocker lock(mut_lock);
@@ -290,7 +556,7 @@ QxtLogStream QxtLogger::write()
 */
 void QxtLogger::info(const QVariant &message, const QVariant &msg1, const QVariant &msg2, const QVariant &msg3, const QVariant &msg4, const QVariant &msg5, const QVariant &msg6, const QVariant &msg7, const QVariant &msg8 , const QVariant &msg9)
 {
-    QMutexLocker lock(qxt_d().mut_lock);
+    if (!isLogLevelActive(QxtLogger::InfoLevel)) return;
     QList<QVariant> args;
     args.push_back(message);
     if (!msg1.isNull()) args.push_back(msg1);
@@ -314,7 +580,7 @@ void QxtLogger::info(const QVariant &message, const QVariant &msg1, const QVaria
 */
 void QxtLogger::trace(const QVariant &message, const QVariant &msg1 , const QVariant &msg2 , const QVariant &msg3 , const QVariant &msg4 , const QVariant &msg5 , const QVariant &msg6 , const QVariant &msg7 , const QVariant &msg8 , const QVariant &msg9)
 {
-    QMutexLocker lock(qxt_d().mut_lock);
+    if (!isLogLevelActive(QxtLogger::TraceLevel)) return;
     QList<QVariant> args;
     args.push_back(message);
     if (!msg1.isNull()) args.push_back(msg1);
@@ -337,7 +603,7 @@ void QxtLogger::trace(const QVariant &message, const QVariant &msg1 , const QVar
 */
 void QxtLogger::warning(const QVariant &message, const QVariant &msg1 , const QVariant &msg2 , const QVariant &msg3 , const QVariant &msg4 , const QVariant &msg5 , const QVariant &msg6 , const QVariant &msg7 , const QVariant &msg8 , const QVariant &msg9)
 {
-    QMutexLocker lock(qxt_d().mut_lock);
+    if (!isLogLevelActive(QxtLogger::WarningLevel)) return;
     QList<QVariant> args;
     args.push_back(message);
     if (!msg1.isNull()) args.push_back(msg1);
@@ -360,7 +626,7 @@ void QxtLogger::warning(const QVariant &message, const QVariant &msg1 , const QV
 */
 void QxtLogger::error(const QVariant &message, const QVariant &msg1 , const QVariant &msg2 , const QVariant &msg3 , const QVariant &msg4 , const QVariant &msg5 , const QVariant &msg6 , const QVariant &msg7 , const QVariant &msg8 , const QVariant &msg9)
 {
-    QMutexLocker lock(qxt_d().mut_lock);
+    if (!isLogLevelActive(QxtLogger::ErrorLevel)) return;
     QList<QVariant> args;
     args.push_back(message);
     if (!msg1.isNull()) args.push_back(msg1);
@@ -383,7 +649,7 @@ void QxtLogger::error(const QVariant &message, const QVariant &msg1 , const QVar
 */
 void QxtLogger::debug(const QVariant &message, const QVariant &msg1 , const QVariant &msg2 , const QVariant &msg3 , const QVariant &msg4 , const QVariant &msg5 , const QVariant &msg6 , const QVariant &msg7 , const QVariant &msg8 , const QVariant &msg9)
 {
-    QMutexLocker lock(qxt_d().mut_lock);
+    if (!isLogLevelActive(QxtLogger::DebugLevel)) return;
     QList<QVariant> args;
     args.push_back(message);
     if (!msg1.isNull()) args.push_back(msg1);
@@ -406,7 +672,7 @@ void QxtLogger::debug(const QVariant &message, const QVariant &msg1 , const QVar
 */
 void QxtLogger::write(const QVariant &message, const QVariant &msg1 , const QVariant &msg2, const QVariant &msg3 , const QVariant &msg4 , const QVariant &msg5 , const QVariant &msg6 , const QVariant &msg7 , const QVariant &msg8 , const QVariant &msg9)
 {
-    QMutexLocker lock(qxt_d().mut_lock);
+    if (!isLogLevelActive(QxtLogger::WriteLevel)) return;
     QList<QVariant> args;
     args.push_back(message);
     if (!msg1.isNull()) args.push_back(msg1);
@@ -429,7 +695,7 @@ void QxtLogger::write(const QVariant &message, const QVariant &msg1 , const QVar
 */
 void QxtLogger::critical(const QVariant &message, const QVariant &msg1 , const QVariant &msg2 , const QVariant &msg3 , const QVariant &msg4 , const QVariant &msg5 , const QVariant &msg6 , const QVariant &msg7 , const QVariant &msg8 , const QVariant &msg9)
 {
-    QMutexLocker lock(qxt_d().mut_lock);
+    if (!isLogLevelActive(QxtLogger::CriticalLevel)) return;
     QList<QVariant> args;
     args.push_back(message);
     if (!msg1.isNull()) args.push_back(msg1);
@@ -452,7 +718,7 @@ void QxtLogger::critical(const QVariant &message, const QVariant &msg1 , const Q
 */
 void QxtLogger::fatal(const QVariant &message, const QVariant &msg1 , const QVariant &msg2 , const QVariant &msg3 , const QVariant &msg4 , const QVariant &msg5 , const QVariant &msg6 , const QVariant &msg7 , const QVariant &msg8 , const QVariant &msg9)
 {
-    QMutexLocker lock(qxt_d().mut_lock);
+    if (!isLogLevelActive(QxtLogger::FatalLevel)) return;
     QList<QVariant> args;
     args.push_back(message);
     if (!msg1.isNull()) args.push_back(msg1);
@@ -546,10 +812,18 @@ void QxtLogger::write(const QList<QVariant> &args)
 */
 void QxtLogger::log(LogLevel level, const QList<QVariant>& args)
 {
-    /*
-    QMutexLocker lock(qxt_d().mut_lock);
-    qxt_d().log(level, msgList);
-    */
+    if (!isLogLevelActive(level)) return;
+    {
+        QxtLoggerWriterLocker locked(qxt_d());
+        if (locked.writer)
+        {
+            locked.writer->push(level, args);
+            // A fatal message is usually followed by abort(), so make sure it reaches the engines first.
+            if (level == QxtLogger::FatalLevel)
+                locked.writer->flush();
+            return;
+        }
+    }
     QMetaObject::invokeMethod(&qxt_d(), "log", Qt::AutoConnection, Q_ARG(QxtLogger::LogLevel, level), Q_ARG(QList<QVariant>, args));
 }
 
@@ -618,6 +892,7 @@ void QxtLogger::removeAsMessageHandler()
 QxtLogger::QxtLogger()
 {
     QXT_INIT_PRIVATE(QxtLogger);
+    qxt_loggerInstance = &qxt_d();
     qRegisterMetaType<QxtLogger::LogLevel>();
     qRegisterMetaType<QxtLogger::LogLevels>();
     addLoggerEngine("DEFAULT", new QxtBasicSTDLoggerEngine);
@@ -661,6 +936,12 @@ QxtLogger *QxtLogger::getInstance()
     return &objectInstance;
 }
 
+/*! \fn bool QxtLogger::isLogLevelActive(LogLevel level)
+    \brief Returns true if at least one enabled engine has the given \a level enabled.
+    This check is inline and lock-free, which makes it cheap enough to guard every logging call.
+    Levels removed at compile time with QXT_NO_TRACE_OUTPUT or QXT_NO_DEBUG_OUTPUT are never active.
+*/
+
 /*! \brief Returns a QString of the given LogLevel.
     This function is provided for convenience.
     */
@@ -739,7 +1020,8 @@ void QxtLogger::enableLogLevels(LogLevels levels)
 */
 QxtLogStream QxtLogger::stream(LogLevel level)
 {
-    return QxtLogStream(this, level, QList<QVariant>());
+    // A stream for a level nobody listens to has no private data and ignores everything written to it.
+    return QxtLogStream(isLogLevelActive(level) ? this : 0, level, QList<QVariant>());
 }
 
 /*! \brief Enables the given LogLevels on a named Engine.
@@ -873,6 +1155,80 @@ void QxtLogger::setMinimumLevel(const QString &engineName, LogLevel level)
     }
 }
 
+/*! \brief Moves the actual writing of log records to a dedicated thread.
+    Once enabled, the logging functions no longer post a queued metacall for every record.
+    Instead, the record is placed in a lock-free ring buffer holding up to \a capacity
+    records (rounded up to a power of two) and returns immediately. A writer thread drains
+    the buffer and hands the records to the engines in batches. When the buffer is full,
+    \a policy decides whether the caller waits for room or the record is dropped.
+    Records logged at FatalLevel are always flushed before the logging function returns.
+
+    Engines are invoked from the writer thread, so they must not rely on thread affinity.
+    Other threads may keep logging while asynchronous logging is enabled or disabled.
+    \code
+    qxtLog->enableAsynchronousLogging(16384, QxtLogger::DropOnOverflow);
+    \endcode
+    \sa disableAsynchronousLogging(), flush()
+*/
+void QxtLogger::enableAsynchronousLogging(int capacity, OverflowPolicy policy)
+{
+    QMutexLocker lock(qxt_d().mut_lock);
+    if (isAsynchronousLoggingEnabled()) return;
+    QxtLoggerWriter* writer = new QxtLoggerWriter(&qxt_d(), qMax(capacity, 2), policy);
+    writer->start();
+    qxt_d().writer.fetchAndStoreRelease(writer);
+}
+
+/*! \brief Writes all queued records and returns to synchronous logging.
+    \sa enableAsynchronousLogging()
+*/
+void QxtLogger::disableAsynchronousLogging()
+{
+    // The writer takes the logger lock for every batch, so it must not be held while waiting for the writer.
+    QxtLoggerWriter* writer = qxt_d().writer.fetchAndStoreOrdered(0);
+    if (!writer) return;
+    // Threads that picked up the writer before may still be pushing to it; it keeps draining meanwhile.
+    while (qxt_d().writerUsers.fetchAndAddOrdered(0))
+        QThread::yieldCurrentThread();
+    writer->stop();
+    {
+        QMutexLocker lock(qxt_d().mut_lock);
+        qxt_d().droppedTotal += qxt_loadAcquire(writer->dropped);
+    }
+    delete writer;
+}
+
+/*! \brief Returns true if records are written by a dedicated thread.
+    \sa enableAsynchronousLogging()
+*/
+bool QxtLogger::isAsynchronousLoggingEnabled() const
+{
+    return const_cast<QAtomicPointer<QxtLoggerWriter>&>(qxt_d().writer).fetchAndAddAcquire(0) != 0;
+}
+
+/*! \brief Returns the number of records discarded because the asynchronous queue was full.
+    \sa QxtLogger::DropOnOverflow
+*/
+int QxtLogger::droppedRecordCount() const
+{
+    QxtLoggerWriterLocker locked(qxt_d());
+    QMutexLocker lock(qxt_d().mut_lock);
+    int count = qxt_d().droppedTotal;
+    if (locked.writer)
+        count += qxt_loadAcquire(locked.writer->dropped);
+    return count;
+}
+
+/*! \brief Blocks until every record logged so far has been handed to the engines.
+    Does nothing when asynchronous logging is disabled.
+*/
+void QxtLogger::flush()
+{
+    QxtLoggerWriterLocker locked(qxt_d());
+    if (locked.writer)
+        locked.writer->flush();
+}
+
 /*! \brief Calls QxtLoggerEngine::initLoggerEngine() for the named Engine.
     Some QxtLoggerEngine plugins might require additional initialization.  Check the documentation
     for your plugin.  Most basic plugins will not require special tasks.
@@ -971,6 +1327,7 @@ void QxtLogger::addLoggerEngine(const QString &engineName, QxtLoggerEngine *engi
     if (!qxt_d().map_logEngineMap.contains(engineName) && engine)
     {
         qxt_d().map_logEngineMap.insert(engineName, engine);
+        qxt_d().updateLevelMask();
         emit loggerEngineAdded(engineName);
     }
 }
@@ -1042,6 +1399,7 @@ QxtLoggerEngine *QxtLogger::takeLoggerEngine(const QString &engineName)
     QMutexLocker lock(qxt_d().mut_lock);
     QxtLoggerEngine *eng = qxt_d().map_logEngineMap.take(engineName);
     if (!eng) return NULL;
+    qxt_d().updateLevelMask();
     emit loggerEngineRemoved(engineName);
     return eng;
 }
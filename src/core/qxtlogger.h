@@ -38,6 +38,7 @@
 #include <QString>
 #include <QStringList>
 #include <QFlags>
+#include <QAtomicInt>
 
 class QxtLoggerPrivate;
 class QxtLogStream;
@@ -74,10 +75,20 @@ public:
     };
     Q_DECLARE_FLAGS(LogLevels, LogLevel)
 
+    /*******************************************************************************
+    What an asynchronous logger does with a record when its queue is full.
+    *******************************************************************************/
+    enum OverflowPolicy
+    {
+        BlockOnOverflow,   /**< The logging thread waits until the writer thread makes room */
+        DropOnOverflow     /**< The record is discarded and counted in droppedRecordCount() */
+    };
+
     /* Sone useful things */
     static QString logLevelToString(LogLevel level);
     static QxtLogger::LogLevel stringToLogLevel(const QString& level);
     static QxtLogger* getInstance();
+    static inline bool isLogLevelActive(LogLevel level);
 
     void initLoggerEngine(const QString& engineName);
     void killLoggerEngine(const QString& engineName);
@@ -135,6 +146,15 @@ public:
     void setMinimumLevel(LogLevel level);
     void setMinimumLevel(const QString& engineName, LogLevel level);
 
+    /*******************************************************************************
+    Asynchronous logging: records are queued and written by a dedicated thread.
+    *******************************************************************************/
+    void enableAsynchronousLogging(int capacity = 8192, OverflowPolicy policy = BlockOnOverflow);
+    void disableAsynchronousLogging();
+    bool isAsynchronousLoggingEnabled() const;
+    int  droppedRecordCount() const;
+    void flush();
+
 public Q_SLOTS:
     /*******************************************************************************
     Logging Functions: what the QxtLogger is all about.
@@ -202,6 +222,13 @@ Q_SIGNALS:
     void loggerEngineRemoved(const QString& engineName);
     void loggerEngineEnabled(const QString& engineName);
     void loggerEngineDisabled(const QString& engineName);
+
+private:
+    friend class QxtLoggerPrivate;
+    // Union of the levels enabled on all enabled engines, kept up to date by QxtLoggerPrivate.
+    static QAtomicInt activeLevels;
+    // Set in activeLevels once the logger exists and the levels are known.
+    enum { LevelMaskInitialized = 1 << 30 };
 };
 Q_DECLARE_OPERATORS_FOR_FLAGS(QxtLogger::LogLevels)
 Q_DECLARE_METATYPE(QxtLogger::LogLevel)
@@ -209,6 +236,63 @@ Q_DECLARE_METATYPE(QxtLogger::LogLevels)
 
 #define qxtLog QxtLogger::getInstance()
 
+/*******************************************************************************
+Compile-time filtering: define QXT_NO_TRACE_OUTPUT to remove trace messages, or
+QXT_NO_DEBUG_OUTPUT to remove trace and debug messages, from the qxtTrace() etc.
+macros below and from QxtLogger::isLogLevelActive().
+*******************************************************************************/
+#if defined(QXT_NO_DEBUG_OUTPUT)
+#  define QXT_LOG_COMPILED_OUT_LEVELS (int(QxtLogger::TraceLevel) | int(QxtLogger::DebugLevel))
+#elif defined(QXT_NO_TRACE_OUTPUT)
+#  define QXT_LOG_COMPILED_OUT_LEVELS int(QxtLogger::TraceLevel)
+#else
+#  define QXT_LOG_COMPILED_OUT_LEVELS 0
+#endif
+
+inline bool QxtLogger::isLogLevelActive(LogLevel level)
+{
+    if (int(level) & QXT_LOG_COMPILED_OUT_LEVELS)
+        return false;
+#if QT_VERSION >= 0x050000
+    int mask = activeLevels.load();
+#else
+    int mask = activeLevels;
+#endif
+    if (!(mask & LevelMaskInitialized))
+    {
+        // Nothing has used the logger yet; creating it fills in the mask
+        getInstance();
+        mask = activeLevels.fetchAndAddAcquire(0);
+    }
+    return (mask & level) != 0;
+}
+
+/*******************************************************************************
+Logging macros that do not evaluate their arguments unless some engine wants the
+level. They accept the same arguments as the corresponding QxtLogger functions,
+including the parameterless stream form:
+    qxtTrace("state", expensiveDump());
+    qxtDebug() << "value" << value;
+*******************************************************************************/
+#define QXT_LOG_IF_ACTIVE(level) if (!QxtLogger::isLogLevelActive(level)) {} else qxtLog
+
+#if defined(QXT_NO_TRACE_OUTPUT) || defined(QXT_NO_DEBUG_OUTPUT)
+#  define qxtTrace while (false) qxtLog->trace
+#else
+#  define qxtTrace QXT_LOG_IF_ACTIVE(QxtLogger::TraceLevel)->trace
+#endif
+#if defined(QXT_NO_DEBUG_OUTPUT)
+#  define qxtDebug while (false) qxtLog->debug
+#else
+#  define qxtDebug QXT_LOG_IF_ACTIVE(QxtLogger::DebugLevel)->debug
+#endif
+#define qxtInfo     QXT_LOG_IF_ACTIVE(QxtLogger::InfoLevel)->info
+#define qxtWarning  QXT_LOG_IF_ACTIVE(QxtLogger::WarningLevel)->warning
+#define qxtError    QXT_LOG_IF_ACTIVE(QxtLogger::ErrorLevel)->error
+#define qxtCritical QXT_LOG_IF_ACTIVE(QxtLogger::CriticalLevel)->critical
+#define qxtFatal    QXT_LOG_IF_ACTIVE(QxtLogger::FatalLevel)->fatal
+#define qxtWrite    QXT_LOG_IF_ACTIVE(QxtLogger::WriteLevel)->write
+
 #include "qxtlogstream.h"
 
 #endif // QXTLOGGER_H
@@ -34,6 +34,80 @@
 
 #include "qxtlogger.h"
 #include <QHash>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInt>
+#include <QAtomicPointer>
+
+/*******************************************************************************
+    QxtLoggerQueue
+    A bounded multi-producer, single-consumer ring of log records. Producers
+    claim a slot with a single compare-and-swap; every slot carries a sequence
+    number that tells whether it is free, filled or being consumed, so neither
+    side ever takes a lock. The argument lists are implicitly shared, so pushing
+    a record only bumps a reference count.
+*******************************************************************************/
+class QxtLoggerQueue
+{
+public:
+    explicit QxtLoggerQueue(int capacity);
+    ~QxtLoggerQueue();
+
+    bool tryPush(QxtLogger::LogLevel level, const QList<QVariant>& args);
+    bool tryPop(QxtLogger::LogLevel& level, QList<QVariant>& args);
+    bool isEmpty() const;
+    int  pushed() const;
+
+private:
+    struct Slot
+    {
+        QAtomicInt sequence;
+        QxtLogger::LogLevel level;
+        QList<QVariant> args;
+    };
+
+    Slot* slots;
+    int mask;
+    QAtomicInt enqueuePos;
+    int dequeuePos; // only touched by the consumer
+
+    Q_DISABLE_COPY(QxtLoggerQueue)
+};
+
+class QxtLoggerPrivate;
+
+/*******************************************************************************
+    QxtLoggerWriter
+    The thread that drains a QxtLoggerQueue and hands the records to the engines
+    in batches.
+*******************************************************************************/
+class QxtLoggerWriter : public QThread
+{
+public:
+    QxtLoggerWriter(QxtLoggerPrivate* logger, int capacity, QxtLogger::OverflowPolicy policy);
+
+    void push(QxtLogger::LogLevel level, const QList<QVariant>& args);
+    void flush();
+    void stop();
+
+    QxtLoggerQueue queue;
+    QxtLogger::OverflowPolicy policy;
+    QAtomicInt dropped;
+
+protected:
+    void run();
+
+private:
+    QxtLoggerPrivate* logger;
+    QMutex waitLock;
+    QWaitCondition recordsAvailable;
+    QWaitCondition recordsWritten;
+    QAtomicInt sleeping;
+    QAtomicInt waiters;
+    QAtomicInt written;
+    QAtomicInt stopping;
+};
 
 /*******************************************************************************
     QxtLoggerPrivate
@@ -49,11 +123,21 @@ public:
     QxtLoggerPrivate();
     ~QxtLoggerPrivate();
     void setQxtLoggerEngineMinimumLevel(QxtLoggerEngine *engine, QxtLogger::LogLevel level);
+    void updateLevelMask();
+    void writeBatch(const QxtLogger::LogLevel* levels, const QList<QVariant>* records, int count, int dropped);
     QHash<QString, QxtLoggerEngine*> map_logEngineMap;
     QMutex* mut_lock;
+    // read by the logging functions without mut_lock; writerUsers counts the threads that
+    // picked up the writer, disableAsynchronousLogging() waits for them before deleting it
+    QAtomicPointer<QxtLoggerWriter> writer;
+    QAtomicInt writerUsers;
+    int droppedTotal;
 
 public Q_SLOTS:
     void log(QxtLogger::LogLevel, const QList<QVariant>&);
 };
 
+// Called by QxtLoggerEngine whenever an engine's levels or enabled state change.
+void qxt_logLevelsChanged();
+
 #endif // QXTLOGGERPRIVATE_H
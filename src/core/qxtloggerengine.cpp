@@ -30,6 +30,7 @@
 *****************************************************************************/
 
 #include "qxtloggerengine.h"
+#include "qxtlogger_p.h"
 
 /*! \class QxtLoggerEngine
     \brief The QxtLoggerEngine class is the parent class of all extended Engine Plugins.
@@ -135,6 +136,7 @@ void QxtLoggerEngine::disableLogging()
 void QxtLoggerEngine::setLoggingEnabled(bool enable)
 {
     qxt_d().b_isLogging = enable;
+    qxt_logLevelsChanged();
 }
 
 /*!
@@ -150,6 +152,7 @@ void QxtLoggerEngine::setLogLevelsEnabled(QxtLogger::LogLevels levels, bool enab
     {
         qxt_d().bm_logLevel &= ~levels;
     }
+    qxt_logLevelsChanged();
 }
 
 /*!
@@ -54,9 +54,11 @@ QxtLogStreamPrivate::~QxtLogStreamPrivate()
 /*!
     Constructs a new QxtLogStream with log \a level and \a data, owned by \a owner.
  */
-QxtLogStream::QxtLogStream(QxtLogger *owner, QxtLogger::LogLevel level, const QList<QVariant> &data) : d(new QxtLogStreamPrivate(owner, level, data))
+QxtLogStream::QxtLogStream(QxtLogger *owner, QxtLogger::LogLevel level, const QList<QVariant> &data) : d(0)
 {
-    // Nothing here either.
+    // Without an owner the stream is a no-op and needs no private data at all.
+    if (owner)
+        d = new QxtLogStreamPrivate(owner, level, data);
 }
 
 /*!
@@ -65,7 +67,7 @@ QxtLogStream::QxtLogStream(QxtLogger *owner, QxtLogger::LogLevel level, const QL
 QxtLogStream::QxtLogStream(const QxtLogStream &other)
 {
     d = other.d;
-    d->refcount++;
+    if (d) d->refcount++;
 }
 
 /*!
@@ -73,6 +75,7 @@ QxtLogStream::QxtLogStream(const QxtLogStream &other)
  */
 QxtLogStream::~QxtLogStream()
 {
+    if (!d) return;
     d->refcount--;
     if (d->refcount == 0) delete d;
 }
@@ -82,6 +85,6 @@ QxtLogStream::~QxtLogStream()
  */
 QxtLogStream& QxtLogStream::operator<< (const QVariant &value)
 {
-    d->data.append(value);
+    if (d) d->data.append(value);
     return *this;
 }
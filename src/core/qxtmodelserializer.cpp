@@ -30,14 +30,49 @@
 *****************************************************************************/
 
 #include <QAbstractItemModel>
+#include <QPersistentModelIndex>
 #include <QDataStream>
+#include <QBitArray>
+#include <QBuffer>
+#include <QVector>
+#include <QQueue>
+#include <QtEndian>
 
-/*
+/*!
     \class QxtModelSerializer
     \inmodule QxtCore
     \brief The QxtModelSerializer class provides serialization of QAbstractItemModel
+
+    QxtModelSerializer saves the data of a model, or of the subtree below an index,
+    to a QByteArray or a QIODevice, and restores it into another model.
+
+    The model is written one level at a time, without recursion. The children of
+    every parent are written in blocks of rows; within a block the values are
+    stored column by column, which keeps similar values together and makes the
+    optional compression more effective. Only one block is held in memory at a
+    time, so saving to a file does not need memory for a copy of the whole model.
+
+    By default every role returned by QAbstractItemModel::itemData() is saved.
+    setRoles() restricts the saved data to a list of roles, which is both smaller
+    and faster. setCompressionLevel() compresses each block with zlib.
+
+    Restoring inserts the rows and columns of each parent at once and sets the
+    data of each cell with a single QAbstractItemModel::setItemData() call. The
+    model emits its usual signals, so attached views and proxy models stay in
+    sync while the data arrives.
+
+    Data written by earlier versions of QxtModelSerializer can still be restored.
  */
 
+static const quint32 QXT_MODEL_MAGIC = 0x51784d53; // "QxMS"
+static const quint16 QXT_MODEL_VERSION = 1;
+static const int QXT_MODEL_BLOCK_ROWS = 1024;
+
+enum QxtModelFlag
+{
+    QxtModelCompressed = 0x1
+};
+
 struct QxtModelItem
 {
     QMap<int, QVariant> itemData;
@@ -64,28 +99,199 @@ inline QDataStream& operator>>(QDataStream& in, QxtModelItem& item)
 class QxtModelSerializerPrivate : public QxtPrivate<QxtModelSerializer>
 {
 public:
-    QxtModelSerializerPrivate() : model(0) { }
+    QxtModelSerializerPrivate() : model(0), compressionLevel(0) { }
 
+    QMap<int, QVariant> itemData(const QModelIndex& index) const;
     void save(QDataStream& stream, const QModelIndex& index) const;
     bool restore(QDataStream& stream, const QModelIndex& index);
-    void print(const QByteArray& data) const;
+    bool restoreLegacy(QDataStream& stream, const QModelIndex& index);
 
     QAbstractItemModel* model;
+    QList<int> roles;
+    int compressionLevel;
 };
 
+QMap<int, QVariant> QxtModelSerializerPrivate::itemData(const QModelIndex& index) const
+{
+    if (roles.isEmpty())
+        return model->itemData(index);
+    QMap<int, QVariant> data;
+    Q_FOREACH(int role, roles)
+    {
+        const QVariant value = model->data(index, role);
+        if (value.isValid())
+            data.insert(role, value);
+    }
+    return data;
+}
+
 void QxtModelSerializerPrivate::save(QDataStream& stream, const QModelIndex& index) const
 {
-    QxtModelItem item;
-    item.itemData = model->itemData(index);
-    item.rowCount = model->rowCount(index);
-    item.columnCount = model->columnCount(index);
-    stream << item;
-    for (int r = 0; r < item.rowCount; ++r)
-        for (int c = 0; c < item.columnCount; ++c)
-            save(stream, model->index(r, c, index));
+    stream << QXT_MODEL_MAGIC << QXT_MODEL_VERSION << quint16(compressionLevel ? QxtModelCompressed : 0);
+    stream << qint32(stream.version()) << qint32(QXT_MODEL_BLOCK_ROWS) << roles;
+    stream << itemData(index);
+
+    // Every parent is written as its row and column count followed by blocks of up to
+    // QXT_MODEL_BLOCK_ROWS rows. Parents are visited breadth first; the bitmap at the end
+    // of each block tells the reader which of its cells come back later as parents.
+    QQueue<QModelIndex> parents;
+    parents.enqueue(index);
+    while (!parents.isEmpty())
+    {
+        const QModelIndex parent = parents.dequeue();
+        const int rowCount = model->rowCount(parent);
+        const int columnCount = model->columnCount(parent);
+        stream << qint32(rowCount) << qint32(columnCount);
+
+        for (int first = 0; first < rowCount; first += QXT_MODEL_BLOCK_ROWS)
+        {
+            const int count = qMin(QXT_MODEL_BLOCK_ROWS, rowCount - first);
+            QByteArray block;
+            QDataStream out(&block, QIODevice::WriteOnly);
+            out.setVersion(stream.version());
+            for (int c = 0; c < columnCount; ++c)
+            {
+                if (roles.isEmpty())
+                {
+                    for (int r = 0; r < count; ++r)
+                        out << model->itemData(model->index(first + r, c, parent));
+                }
+                else
+                {
+                    Q_FOREACH(int role, roles)
+                    {
+                        for (int r = 0; r < count; ++r)
+                            out << model->data(model->index(first + r, c, parent), role);
+                    }
+                }
+            }
+
+            QBitArray children(count * columnCount);
+            for (int r = 0; r < count; ++r)
+            {
+                for (int c = 0; c < columnCount; ++c)
+                {
+                    const QModelIndex child = model->index(first + r, c, parent);
+                    if (model->hasChildren(child))
+                    {
+                        children.setBit(r * columnCount + c);
+                        parents.enqueue(child);
+                    }
+                }
+            }
+            out << children;
+
+            if (compressionLevel)
+                stream << qCompress(block, compressionLevel);
+            else
+                stream << block;
+        }
+    }
 }
 
 bool QxtModelSerializerPrivate::restore(QDataStream& stream, const QModelIndex& index)
+{
+    quint32 magic;
+    quint16 version, flags;
+    qint32 streamVersion, blockRows;
+    QList<int> savedRoles;
+    QMap<int, QVariant> data;
+    stream >> magic >> version >> flags;
+    if (magic != QXT_MODEL_MAGIC || version > QXT_MODEL_VERSION)
+    {
+        qWarning("QxtModelSerializer::restoreModel(): unsupported format");
+        return false;
+    }
+    stream >> streamVersion >> blockRows >> savedRoles;
+    stream.setVersion(streamVersion);
+    stream >> data;
+    if (stream.status() != QDataStream::Ok || blockRows <= 0)
+        return false;
+
+    if (index.isValid() && !data.isEmpty())
+        model->setItemData(index, data);
+
+    bool ok = true;
+    QVector<QMap<int, QVariant> > cells;
+    QQueue<QPersistentModelIndex> parents;
+    parents.enqueue(index);
+    while (ok && !parents.isEmpty())
+    {
+        const QModelIndex parent = parents.dequeue();
+        qint32 rowCount, columnCount;
+        stream >> rowCount >> columnCount;
+        if (stream.status() != QDataStream::Ok || rowCount < 0 || columnCount < 0)
+        {
+            ok = false;
+            break;
+        }
+        if (rowCount > 0)
+            model->insertRows(0, rowCount, parent);
+        if (columnCount > 0)
+            model->insertColumns(0, columnCount, parent);
+
+        for (int first = 0; ok && first < rowCount; first += blockRows)
+        {
+            const int count = qMin(int(blockRows), rowCount - first);
+            QByteArray block;
+            stream >> block;
+            if (flags & QxtModelCompressed)
+                block = qUncompress(block);
+            QDataStream in(block);
+            in.setVersion(streamVersion);
+
+            cells.resize(count * columnCount);
+            for (int c = 0; c < columnCount; ++c)
+            {
+                if (savedRoles.isEmpty())
+                {
+                    for (int r = 0; r < count; ++r)
+                        in >> cells[r * columnCount + c];
+                }
+                else
+                {
+                    Q_FOREACH(int role, savedRoles)
+                    {
+                        for (int r = 0; r < count; ++r)
+                        {
+                            QVariant value;
+                            in >> value;
+                            if (value.isValid())
+                                cells[r * columnCount + c].insert(role, value);
+                        }
+                    }
+                }
+            }
+            QBitArray children;
+            in >> children;
+            if (stream.status() != QDataStream::Ok || in.status() != QDataStream::Ok || children.size() != cells.size())
+            {
+                ok = false;
+                break;
+            }
+
+            for (int r = 0; r < count; ++r)
+            {
+                for (int c = 0; c < columnCount; ++c)
+                {
+                    const int i = r * columnCount + c;
+                    const QModelIndex child = model->index(first + r, c, parent);
+                    if (!cells.at(i).isEmpty())
+                    {
+                        model->setItemData(child, cells.at(i));
+                        cells[i].clear();
+                    }
+                    if (children.testBit(i))
+                        parents.enqueue(child);
+                }
+            }
+        }
+    }
+
+    return ok;
+}
+
+bool QxtModelSerializerPrivate::restoreLegacy(QDataStream& stream, const QModelIndex& index)
 {
     QxtModelItem item;
     stream >> item;
@@ -100,64 +306,145 @@ bool QxtModelSerializerPrivate::restore(QDataStream& stream, const QModelIndex&
     for (int r = 0; r < item.rowCount; ++r)
     {
         for (int c = 0; c < item.columnCount; ++c)
-            restore(stream, model->index(r, c, index));
+            restoreLegacy(stream, model->index(r, c, index));
     }
     return stream.status() == QDataStream::Ok;
 }
 
-void QxtModelSerializerPrivate::print(const QByteArray& data) const
-{
-    QDataStream stream(data);
-    while (!stream.atEnd())
-    {
-        QxtModelItem item;
-        stream >> item;
-    }
-}
-
+/*!
+    Constructs a new QxtModelSerializer for \a model.
+ */
 QxtModelSerializer::QxtModelSerializer(QAbstractItemModel* model)
 {
     qxt_d().model = model;
 }
 
+/*!
+    Destructs the model serializer.
+ */
 QxtModelSerializer::~QxtModelSerializer()
 {
 }
 
+/*!
+    Returns the model.
+ */
 QAbstractItemModel* QxtModelSerializer::model() const
 {
     return qxt_d().model;
 }
 
+/*!
+    Sets the \a model.
+ */
 void QxtModelSerializer::setModel(QAbstractItemModel* model)
 {
     qxt_d().model = model;
 }
 
+/*!
+    Returns the roles that are saved. An empty list, the default, saves every role
+    returned by QAbstractItemModel::itemData().
+ */
+QList<int> QxtModelSerializer::roles() const
+{
+    return qxt_d().roles;
+}
+
+/*!
+    Restricts the saved data to \a roles. Restoring is not affected; it restores
+    whatever roles were saved.
+ */
+void QxtModelSerializer::setRoles(const QList<int>& roles)
+{
+    qxt_d().roles = roles;
+}
+
+/*!
+    Returns the zlib compression level. The default is \c 0, no compression.
+ */
+int QxtModelSerializer::compressionLevel() const
+{
+    return qxt_d().compressionLevel;
+}
+
+/*!
+    Sets the zlib compression \a level used by saveModel(). Valid levels are 1 to 9,
+    \c -1 selects the zlib default and \c 0 disables compression.
+ */
+void QxtModelSerializer::setCompressionLevel(int level)
+{
+    qxt_d().compressionLevel = qBound(-1, level, 9);
+}
+
+/*!
+    Saves the data below \a index, the whole model by default, and returns it.
+ */
 QByteArray QxtModelSerializer::saveModel(const QModelIndex& index) const
+{
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    if (!saveModel(&buffer, index))
+        return QByteArray();
+    return data;
+}
+
+/*!
+    Writes the data below \a index, the whole model by default, to \a device.
+    Returns \c true on success.
+ */
+bool QxtModelSerializer::saveModel(QIODevice* device, const QModelIndex& index) const
 {
     if (!qxt_d().model)
     {
         qWarning("QxtModelSerializer::saveModel(): model == null");
-        return QByteArray();
+        return false;
+    }
+    if (!device || !device->isWritable())
+    {
+        qWarning("QxtModelSerializer::saveModel(): device is not writable");
+        return false;
     }
 
-    QByteArray data;
-    QDataStream stream(&data, QIODevice::WriteOnly);
+    QDataStream stream(device);
     qxt_d().save(stream, index);
-    qxt_d().print(data);
-    return data;
+    return stream.status() == QDataStream::Ok;
 }
 
+/*!
+    Restores the model data from \a data below \a index, the root of the model by default.
+    Returns \c true on success.
+ */
 bool QxtModelSerializer::restoreModel(const QByteArray& data, const QModelIndex& index)
+{
+    QBuffer buffer;
+    buffer.setData(data);
+    buffer.open(QIODevice::ReadOnly);
+    return restoreModel(&buffer, index);
+}
+
+/*!
+    Restores the model data read from \a device below \a index, the root of the model
+    by default. Returns \c true on success.
+ */
+bool QxtModelSerializer::restoreModel(QIODevice* device, const QModelIndex& index)
 {
     if (!qxt_d().model)
     {
         qWarning("QxtModelSerializer::restoreModel(): model == null");
         return false;
     }
+    if (!device || !device->isReadable())
+    {
+        qWarning("QxtModelSerializer::restoreModel(): device is not readable");
+        return false;
+    }
 
-    QDataStream stream(data);
-    qxt_d().print(data);
-    return qxt_d().restore(stream, index);
+    QDataStream stream(device);
+    const QByteArray magic = device->peek(sizeof(quint32));
+    if (magic.size() == int(sizeof(quint32))
+            && qFromBigEndian<quint32>(reinterpret_cast<const uchar*>(magic.constData())) == QXT_MODEL_MAGIC)
+        return qxt_d().restore(stream, index);
+    return qxt_d().restoreLegacy(stream, index);
 }
@@ -33,9 +33,11 @@
 
 #include <qxtglobal.h>
 #include <QModelIndex>
+#include <QList>
 
 class QxtModelSerializerPrivate;
 QT_FORWARD_DECLARE_CLASS(QByteArray)
+QT_FORWARD_DECLARE_CLASS(QIODevice)
 QT_FORWARD_DECLARE_CLASS(QAbstractItemModel)
 
 class QXT_CORE_EXPORT QxtModelSerializer
@@ -47,8 +49,16 @@ public:
     QAbstractItemModel* model() const;
     void setModel(QAbstractItemModel* model);
 
+    QList<int> roles() const;
+    void setRoles(const QList<int>& roles);
+
+    int compressionLevel() const;
+    void setCompressionLevel(int level);
+
     QByteArray saveModel(const QModelIndex& index = QModelIndex()) const;
+    bool saveModel(QIODevice* device, const QModelIndex& index = QModelIndex()) const;
     bool restoreModel(const QByteArray& data, const QModelIndex& index = QModelIndex());
+    bool restoreModel(QIODevice* device, const QModelIndex& index = QModelIndex());
 
 private:
     QXT_DECLARE_PRIVATE(QxtModelSerializer)
@@ -33,6 +33,8 @@
 #include <QList>
 #include <QQueue>
 #include <QMutableListIterator>
+#include <QThread>
+#include <string.h>
 
 /*!
  * \class  QxtPipe
@@ -55,6 +57,10 @@
  * qDebug()<<p1.readAll();
  * \endcode
 
+    Data travels through the pipe network as implicitly shared QByteArray chunks, so fanning
+    out to several pipes does not copy it. Connections to pipes living in the same thread
+    deliver the data with a direct function call; only connections to pipes in other threads,
+    or ones explicitly made with Qt::QueuedConnection, go through a queued meta call.
 
     <h4>Subclassing</h4>
     When implementing your own pipe element, like a de/encoder or something, you have to reimplement receiveData() and call sendData() whenever you have something to send to the pipe network.
@@ -89,7 +95,7 @@ bool QxtPipe::isSequential() const
 /*!\reimp*/
 qint64 QxtPipe::bytesAvailable() const
 {
-    return qxt_d().q.count();
+    return qxt_d().buffered + QIODevice::bytesAvailable();
 }
 
 /*!
@@ -166,15 +172,23 @@ QxtPipe & QxtPipe::operator | (QxtPipe & target)
 /*!\reimp*/
 qint64 QxtPipe::readData(char * data, qint64 maxSize)
 {
-    QQueue<char> * q = &qxt_d().q;
+    QxtPipePrivate& d = qxt_d();
 
     qint64 i = 0;
-    for (;i < maxSize;i++)
+    while (i < maxSize && !d.chunks.isEmpty())
     {
-        if (q->isEmpty())
-            break;
-        (*data++) = q->dequeue();
+        const QByteArray& head = d.chunks.head();
+        const qint64 n = qMin(maxSize - i, qint64(head.size() - d.headOffset));
+        memcpy(data + i, head.constData() + d.headOffset, n);
+        i += n;
+        d.headOffset += int(n);
+        if (d.headOffset == head.size())
+        {
+            d.chunks.dequeue();
+            d.headOffset = 0;
+        }
     }
+    d.buffered -= i;
     return i;
 }
 
@@ -207,6 +221,14 @@ void   QxtPipe::sendData(QByteArray data) const
             continue;
 
 
+        // same thread: skip the meta call, it would be delivered directly anyway
+        if (c.connectionType == Qt::DirectConnection
+                || (c.connectionType == Qt::AutoConnection && c.pipe->qxt_d().thread() == QThread::currentThread()))
+        {
+            c.pipe->receiveData(data, this);
+            continue;
+        }
+
         bool r = QMetaObject::invokeMethod(&c.pipe->qxt_d(), "push", c.connectionType,
                                            Q_ARG(QByteArray, data), Q_ARG(const QxtPipe *, this));
 
@@ -229,16 +251,11 @@ Call this from your subclass to make \a datab available to the QIODevice::read f
 */
 void   QxtPipe::enqueData(QByteArray datab)
 {
-    QQueue<char> * q = &qxt_d().q;
-
-    const char * data = datab.constData();
-    qint64 maxSize = datab.size();
-
-    qint64 i = 0;
-    for (;i < maxSize;i++)
-        q->enqueue(*data++);
-    if (i > 0)
-        emit(readyRead());
+    if (datab.isEmpty())
+        return;
+    qxt_d().chunks.enqueue(datab);
+    qxt_d().buffered += datab.size();
+    emit(readyRead());
 }
 
 /*!
@@ -49,8 +49,14 @@ public:
     QxtPipePrivate()
     {
         lastsender = 0;
+        headOffset = 0;
+        buffered = 0;
     }
-    QQueue<char> q;
+    // Received data is kept in the chunks it arrived in; the buffers are shared with the
+    // sender and every other pipe the data was fanned out to.
+    QQueue<QByteArray> chunks;
+    int headOffset;
+    qint64 buffered;
     QList<Connection> connections;
     mutable const QxtPipe * lastsender;
 public Q_SLOTS:
@@ -62,10 +62,34 @@ QxtFuture QxtSlotJob::detach(QThread * thread, QObject* recv, const char* slot,
                              QGenericArgument p10)
 {
     QxtSlotJob * p = new  QxtSlotJob(recv, slot, p1, p2, p3, p4, p5, p6, p7, p8, p9, p10);
-    connect(p, SIGNAL(done()), p, SLOT(deleteLater()));
+    // deleted after the job has ended, not on done(), which comes before that
+    p->QxtJob::qxt_d().deleteWhenEnded = true;
     return p->exec(thread);
 }
 /*!
+execute \a slot from \a recv on one of the threads of \a executor detached.
+The receiver is not moved to the worker thread; the slot must be safe to call from there.
+
+\warning keep your hands of \a recv until you called QFuture::result();
+*/
+QxtFuture QxtSlotJob::detach(QxtJobExecutor * executor, QObject* recv, const char* slot,
+                             QGenericArgument p1,
+                             QGenericArgument p2,
+                             QGenericArgument p3,
+                             QGenericArgument p4,
+                             QGenericArgument p5,
+                             QGenericArgument p6,
+                             QGenericArgument p7,
+                             QGenericArgument p8,
+                             QGenericArgument p9,
+                             QGenericArgument p10)
+{
+    QxtSlotJob * p = new  QxtSlotJob(recv, slot, p1, p2, p3, p4, p5, p6, p7, p8, p9, p10);
+    // deleted after the job has ended, not on done(), which comes before that
+    p->QxtJob::qxt_d().deleteWhenEnded = true;
+    return p->exec(executor);
+}
+/*!
 Construct a new Job Object that will run \a slot from \a precv with the specified arguments
 */
 QxtSlotJob::QxtSlotJob(QObject* recv, const char* slot,
@@ -83,6 +107,7 @@ QxtSlotJob::QxtSlotJob(QObject* recv, const char* slot,
     qxt_d().f = QxtMetaObject::bind(recv, slot, p1, p2, p3, p4, p5, p6, p7, p8, p9, p10);
     qxt_d().receiver = recv;
     qxt_d().orginalthread = QThread::currentThread();
+    qxt_d().moved = false;
 
     connect(this, SIGNAL(done()), this, SLOT(pdone()));
 }
@@ -102,14 +127,28 @@ execute this job on \a thread
 QxtFuture QxtSlotJob::exec(QThread *thread)
 {
     qxt_d().receiver->moveToThread(thread);
+    qxt_d().moved = true;
     QxtJob::exec(thread);
     return QxtFuture(this);
 }
+/*!
+execute this job on one of the threads of \a executor.
+Unlike exec(QThread*), the receiver stays in its thread and the slot is called directly
+from the worker thread.
+\warning keep your hands of the Object you passed until you called result() or join()
+*/
+QxtFuture QxtSlotJob::exec(QxtJobExecutor *executor)
+{
+    qxt_d().moved = false;
+    QxtJob::exec(executor);
+    return QxtFuture(this);
+}
 
 void QxtSlotJob::run()
 {
-    qxt_d().r = qVariantFromValue(qxt_d().f->invoke());
-    qxt_d().receiver->moveToThread(qxt_d().orginalthread);
+    qxt_d().r = qVariantFromValue(qxt_d().f->invoke(Qt::DirectConnection));
+    if (qxt_d().moved)
+        qxt_d().receiver->moveToThread(qxt_d().orginalthread);
 }
 
 
@@ -60,6 +60,7 @@ Q_SIGNALS:
 
 
 class QxtSlotJobPrivate;
+class QxtJobExecutor;
 QT_FORWARD_DECLARE_CLASS(QThread)
 class QXT_CORE_EXPORT QxtSlotJob : public QxtJob
 {
@@ -76,6 +77,17 @@ public:
                             QGenericArgument p8 = QGenericArgument(),
                             QGenericArgument p9 = QGenericArgument(),
                             QGenericArgument p10 = QGenericArgument());
+    static QxtFuture detach(QxtJobExecutor * executor, QObject* recv, const char* slot,
+                            QGenericArgument p1 = QGenericArgument(),
+                            QGenericArgument p2 = QGenericArgument(),
+                            QGenericArgument p3 = QGenericArgument(),
+                            QGenericArgument p4 = QGenericArgument(),
+                            QGenericArgument p5 = QGenericArgument(),
+                            QGenericArgument p6 = QGenericArgument(),
+                            QGenericArgument p7 = QGenericArgument(),
+                            QGenericArgument p8 = QGenericArgument(),
+                            QGenericArgument p9 = QGenericArgument(),
+                            QGenericArgument p10 = QGenericArgument());
 
     QxtSlotJob(QObject* recv, const char* slot,
                QGenericArgument p1 = QGenericArgument(),
@@ -91,6 +103,7 @@ public:
 
     QVariant result();
     QxtFuture exec(QThread *o);
+    QxtFuture exec(QxtJobExecutor *executor);
 
 protected:
     virtual void run();
@@ -32,6 +32,7 @@
 #define QXTSLOTJOB_P_H
 
 #include "qxtslotjob.h"
+#include "qxtjob_p.h"
 #include <qxtsignalwaiter.h>
 #include <qxtboundfunction.h>
 
@@ -43,6 +44,8 @@ public:
     QVariant r;
     QThread * orginalthread;
     QObject * receiver;
+    // set while the receiver has been moved to the thread passed to exec()
+    bool moved;
     QXT_DECLARE_PUBLIC(QxtSlotJob)
 };
 
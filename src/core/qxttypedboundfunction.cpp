@@ -0,0 +1,175 @@
+/****************************************************************************
+** Copyright (c) 2006 - 2011, the LibQxt project.
+** See the Qxt AUTHORS file for a list of authors and copyright holders.
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**     * Redistributions of source code must retain the above copyright
+**       notice, this list of conditions and the following disclaimer.
+**     * Redistributions in binary form must reproduce the above copyright
+**       notice, this list of conditions and the following disclaimer in the
+**       documentation and/or other materials provided with the distribution.
+**     * Neither the name of the LibQxt project nor the
+**       names of its contributors may be used to endorse or promote products
+**       derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+** ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+** DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+** (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+** LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+** ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** <http://libqxt.org>  <foundation@libqxt.org>
+*****************************************************************************/
+
+/*!
+\class QxtTypedBoundFunction
+
+\inmodule QxtCore
+
+\brief The QxtTypedBoundFunction class binds arguments of known types to a method call
+
+QxtTypedBoundFunction is a QxtBoundFunction whose bound arguments are stored by value,
+with the types given as template parameters. The target method is looked up once, when
+the binding is created. Every later invocation, whether by a connected signal or by
+invoke(), hands the stored values straight to the receiver's qt_metacall(), without
+converting them to QVariant or matching the signature again.
+
+\code
+QxtTypedBoundFunction<int, QObject*>* f = new QxtTypedBoundFunction<int, QObject*>(this, SLOT(dataReady(int, QObject*)));
+f->setArguments(requestID, source);
+QxtMetaObject::connect(source, SIGNAL(readyRead()), f);
+\endcode
+
+The bound values can be replaced with setArguments() at any time, so a binding can be
+kept and reused instead of creating a new QxtBoundFunction for every call.
+
+Unlike QxtMetaObject::bind(), a typed binding cannot forward signal parameters with
+QXT_BIND(); every parameter of the method has to be bound. Each type must be known to
+QMetaType.
+
+Like other bound functions, a QxtTypedBoundFunction is created as a child of the receiver.
+
+\sa QxtMetaObject::bindTyped(), QxtBoundFunction
+*/
+
+/*!
+\fn QxtTypedBoundFunction::QxtTypedBoundFunction(QObject* receiver, const char* invokable)
+
+Binds the signal, slot or Q_INVOKABLE method \a invokable of \a receiver. The parameter
+types of the method must match the template parameters; otherwise a warning is printed
+and isValid() returns \c false.
+*/
+
+/*!
+\fn void QxtTypedBoundFunction::setArguments(const A1& p1, ...)
+
+Replaces the bound argument values. A queued call made with invoke() copies the values
+when it is posted and keeps them. A signal connected with Qt::QueuedConnection, however,
+only queues its own arguments: the bound values are read when the event is delivered, so
+deliveries still pending see the values set here.
+*/
+
+#include "qxttypedboundfunction.h"
+#include <QMetaMethod>
+#include <QThread>
+#include <QtDebug>
+
+#ifndef QXT_DOXYGEN_RUN
+static QGenericArgument* qxt_noParams[10] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+static QByteArray qxt_noTypes[10];
+
+QxtTypedBoundFunctionBase::QxtTypedBoundFunctionBase(QObject* receiver) : QxtBoundFunctionBase(receiver, qxt_noParams, qxt_noTypes), method(-1)
+{
+    for (int i = 0; i < 10; i++)
+        types[i] = QMetaType::Void;
+    for (int i = 0; i < 11; i++)
+        args[i] = 0;
+}
+
+bool QxtTypedBoundFunctionBase::resolve(const char* invokable, const int argumentTypes[10])
+{
+    const QByteArray signature = QxtMetaObject::methodSignature(invokable);
+    const QMetaObject* meta = parent()->metaObject();
+    const int index = meta->indexOfMethod(signature.constData());
+    if (index == -1)
+    {
+        qWarning() << "QxtMetaObject::bindTyped: no such method " << signature;
+        return false;
+    }
+
+    const QList<QByteArray> paramTypes = meta->method(index).parameterTypes();
+    int count = 0;
+    while (count < 10 && argumentTypes[count] != QMetaType::Void)
+        count++;
+    bool compatible = (paramTypes.count() == count);
+    for (int i = 0; compatible && i < count; i++)
+        compatible = (QMetaType::type(paramTypes.at(i).constData()) == argumentTypes[i]);
+    if (!compatible)
+    {
+        qWarning() << "QxtMetaObject::bindTyped: bound argument types are incompatible with " << signature;
+        return false;
+    }
+
+    for (int i = 0; i < 10; i++)
+        types[i] = argumentTypes[i];
+    method = index;
+    return true;
+}
+
+bool QxtTypedBoundFunctionBase::isValid() const
+{
+    return method != -1;
+}
+
+int QxtTypedBoundFunctionBase::methodIndex() const
+{
+    return method;
+}
+
+int QxtTypedBoundFunctionBase::qt_metacall(QMetaObject::Call _c, int _id, void **_a)
+{
+    _id = QObject::qt_metacall(_c, _id, _a);
+    if (_id < 0)
+        return _id;
+    if (_c == QMetaObject::InvokeMetaMethod)
+    {
+        // the signal's own arguments are not used; the call always carries the bound values
+        if (_id == 0 && method != -1)
+            QMetaObject::metacall(parent(), QMetaObject::InvokeMetaMethod, method, args);
+        _id = -1;
+    }
+    return _id;
+}
+
+bool QxtTypedBoundFunctionBase::invokeImpl(Qt::ConnectionType type, QGenericReturnArgument returnValue, QXT_IMPL_10ARGS(QGenericArgument))
+{
+    QXT_10_UNUSED;
+    if (method == -1)
+        return false;
+
+    QObject* receiver = parent();
+    if (type == Qt::DirectConnection || (type == Qt::AutoConnection && receiver->thread() == QThread::currentThread()))
+    {
+        void* a[11];
+        a[0] = returnValue.data();
+        for (int i = 1; i < 11; i++)
+            a[i] = args[i];
+        QMetaObject::metacall(receiver, QMetaObject::InvokeMetaMethod, method, a);
+        return true;
+    }
+
+    // a queued call has to copy the values into the event, which QMetaMethod does by type name
+    QGenericArgument p[10];
+    for (int i = 0; i < 10 && types[i] != QMetaType::Void; i++)
+        p[i] = QGenericArgument(QMetaType::typeName(types[i]), args[i + 1]);
+    return receiver->metaObject()->method(method).invoke(receiver, type, returnValue,
+            p[0], p[1], p[2], p[3], p[4], p[5], p[6], p[7], p[8], p[9]);
+}
+#endif
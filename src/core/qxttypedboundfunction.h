@@ -0,0 +1,336 @@
+/****************************************************************************
+** Copyright (c) 2006 - 2011, the LibQxt project.
+** See the Qxt AUTHORS file for a list of authors and copyright holders.
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**     * Redistributions of source code must retain the above copyright
+**       notice, this list of conditions and the following disclaimer.
+**     * Redistributions in binary form must reproduce the above copyright
+**       notice, this list of conditions and the following disclaimer in the
+**       documentation and/or other materials provided with the distribution.
+**     * Neither the name of the LibQxt project nor the
+**       names of its contributors may be used to endorse or promote products
+**       derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+** ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+** DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+** (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+** LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+** ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** <http://libqxt.org>  <foundation@libqxt.org>
+*****************************************************************************/
+
+#ifndef QXTTYPEDBOUNDFUNCTION_H
+#define QXTTYPEDBOUNDFUNCTION_H
+
+#include <qxtboundfunctionbase.h>
+#include <QMetaType>
+
+#ifndef QXT_DOXYGEN_RUN
+template <typename T>
+class QxtTypedArgument
+{
+public:
+    QxtTypedArgument() : value() {}
+    void set(const T& v)
+    {
+        value = v;
+    }
+    void* data()
+    {
+        return &value;
+    }
+    static int type()
+    {
+        return qMetaTypeId<T>();
+    }
+
+private:
+    T value;
+};
+
+template <>
+class QxtTypedArgument<void>
+{
+public:
+    void* data()
+    {
+        return 0;
+    }
+    static int type()
+    {
+        return QMetaType::Void;
+    }
+};
+
+class QXT_CORE_EXPORT QxtTypedBoundFunctionBase : public QxtBoundFunctionBase
+{
+public:
+    bool isValid() const;
+    int methodIndex() const;
+
+    int qt_metacall(QMetaObject::Call _c, int _id, void **_a);
+
+protected:
+    explicit QxtTypedBoundFunctionBase(QObject* receiver);
+    bool resolve(const char* invokable, const int argumentTypes[10]);
+    virtual bool invokeImpl(Qt::ConnectionType type, QGenericReturnArgument returnValue, QXT_PROTO_10ARGS(QGenericArgument));
+
+    int method;
+    int types[10];
+    // args[0] is reserved for the return value, as in a qt_metacall() argument vector
+    void* args[11];
+};
+#endif
+
+template <typename T1 = void, typename T2 = void, typename T3 = void, typename T4 = void, typename T5 = void, typename T6 = void, typename T7 = void, typename T8 = void, typename T9 = void, typename T10 = void>
+class QxtTypedBoundFunction : public QxtTypedBoundFunctionBase
+{
+public:
+    QxtTypedBoundFunction(QObject* receiver, const char* invokable) : QxtTypedBoundFunctionBase(receiver)
+    {
+        args[1] = a1.data();
+        args[2] = a2.data();
+        args[3] = a3.data();
+        args[4] = a4.data();
+        args[5] = a5.data();
+        args[6] = a6.data();
+        args[7] = a7.data();
+        args[8] = a8.data();
+        args[9] = a9.data();
+        args[10] = a10.data();
+        const int argumentTypes[10] = { QxtTypedArgument<T1>::type(), QxtTypedArgument<T2>::type(), QxtTypedArgument<T3>::type(), QxtTypedArgument<T4>::type(), QxtTypedArgument<T5>::type(), QxtTypedArgument<T6>::type(), QxtTypedArgument<T7>::type(), QxtTypedArgument<T8>::type(), QxtTypedArgument<T9>::type(), QxtTypedArgument<T10>::type() };
+        resolve(invokable, argumentTypes);
+    }
+
+    void setArguments()
+    {
+    }
+    template <typename A1>
+    void setArguments(const A1& p1)
+    {
+        a1.set(p1);
+    }
+    template <typename A1, typename A2>
+    void setArguments(const A1& p1, const A2& p2)
+    {
+        a1.set(p1); a2.set(p2);
+    }
+    template <typename A1, typename A2, typename A3>
+    void setArguments(const A1& p1, const A2& p2, const A3& p3)
+    {
+        a1.set(p1); a2.set(p2); a3.set(p3);
+    }
+    template <typename A1, typename A2, typename A3, typename A4>
+    void setArguments(const A1& p1, const A2& p2, const A3& p3, const A4& p4)
+    {
+        a1.set(p1); a2.set(p2); a3.set(p3); a4.set(p4);
+    }
+    template <typename A1, typename A2, typename A3, typename A4, typename A5>
+    void setArguments(const A1& p1, const A2& p2, const A3& p3, const A4& p4, const A5& p5)
+    {
+        a1.set(p1); a2.set(p2); a3.set(p3); a4.set(p4); a5.set(p5);
+    }
+    template <typename A1, typename A2, typename A3, typename A4, typename A5, typename A6>
+    void setArguments(const A1& p1, const A2& p2, const A3& p3, const A4& p4, const A5& p5, const A6& p6)
+    {
+        a1.set(p1); a2.set(p2); a3.set(p3); a4.set(p4); a5.set(p5); a6.set(p6);
+    }
+    template <typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7>
+    void setArguments(const A1& p1, const A2& p2, const A3& p3, const A4& p4, const A5& p5, const A6& p6, const A7& p7)
+    {
+        a1.set(p1); a2.set(p2); a3.set(p3); a4.set(p4); a5.set(p5); a6.set(p6); a7.set(p7);
+    }
+    template <typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8>
+    void setArguments(const A1& p1, const A2& p2, const A3& p3, const A4& p4, const A5& p5, const A6& p6, const A7& p7, const A8& p8)
+    {
+        a1.set(p1); a2.set(p2); a3.set(p3); a4.set(p4); a5.set(p5); a6.set(p6); a7.set(p7); a8.set(p8);
+    }
+    template <typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9>
+    void setArguments(const A1& p1, const A2& p2, const A3& p3, const A4& p4, const A5& p5, const A6& p6, const A7& p7, const A8& p8, const A9& p9)
+    {
+        a1.set(p1); a2.set(p2); a3.set(p3); a4.set(p4); a5.set(p5); a6.set(p6); a7.set(p7); a8.set(p8); a9.set(p9);
+    }
+    template <typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10>
+    void setArguments(const A1& p1, const A2& p2, const A3& p3, const A4& p4, const A5& p5, const A6& p6, const A7& p7, const A8& p8, const A9& p9, const A10& p10)
+    {
+        a1.set(p1); a2.set(p2); a3.set(p3); a4.set(p4); a5.set(p5); a6.set(p6); a7.set(p7); a8.set(p8); a9.set(p9); a10.set(p10);
+    }
+
+private:
+    QxtTypedArgument<T1> a1;
+    QxtTypedArgument<T2> a2;
+    QxtTypedArgument<T3> a3;
+    QxtTypedArgument<T4> a4;
+    QxtTypedArgument<T5> a5;
+    QxtTypedArgument<T6> a6;
+    QxtTypedArgument<T7> a7;
+    QxtTypedArgument<T8> a8;
+    QxtTypedArgument<T9> a9;
+    QxtTypedArgument<T10> a10;
+};
+
+namespace QxtMetaObject
+{
+    /*!
+     * Creates a QxtTypedBoundFunction that invokes the signal, slot or Q_INVOKABLE method
+     * \a invokable of \a recv with copies of the given arguments. The bound types are deduced
+     * from the arguments and must match the parameters of the method exactly; pass an
+     * explicit QxtTypedBoundFunction if a conversion is needed, for instance from a
+     * QObject subclass pointer to QObject*.
+     *
+     * Returns NULL if \a recv has no such method or if the types do not match.
+     *
+     * \sa QxtMetaObject::bind(), QxtMetaObject::connect()
+     */
+    inline QxtTypedBoundFunction<>* bindTyped(QObject* recv, const char* invokable)
+    {
+        QxtTypedBoundFunction<>* f = new QxtTypedBoundFunction<>(recv, invokable);
+        if (!f->isValid())
+        {
+            delete f;
+            return 0;
+        }
+        return f;
+    }
+
+    template <typename T1>
+    QxtTypedBoundFunction<T1>* bindTyped(QObject* recv, const char* invokable, const T1& p1)
+    {
+        QxtTypedBoundFunction<T1>* f = new QxtTypedBoundFunction<T1>(recv, invokable);
+        if (!f->isValid())
+        {
+            delete f;
+            return 0;
+        }
+        f->setArguments(p1);
+        return f;
+    }
+
+    template <typename T1, typename T2>
+    QxtTypedBoundFunction<T1, T2>* bindTyped(QObject* recv, const char* invokable, const T1& p1, const T2& p2)
+    {
+        QxtTypedBoundFunction<T1, T2>* f = new QxtTypedBoundFunction<T1, T2>(recv, invokable);
+        if (!f->isValid())
+        {
+            delete f;
+            return 0;
+        }
+        f->setArguments(p1, p2);
+        return f;
+    }
+
+    template <typename T1, typename T2, typename T3>
+    QxtTypedBoundFunction<T1, T2, T3>* bindTyped(QObject* recv, const char* invokable, const T1& p1, const T2& p2, const T3& p3)
+    {
+        QxtTypedBoundFunction<T1, T2, T3>* f = new QxtTypedBoundFunction<T1, T2, T3>(recv, invokable);
+        if (!f->isValid())
+        {
+            delete f;
+            return 0;
+        }
+        f->setArguments(p1, p2, p3);
+        return f;
+    }
+
+    template <typename T1, typename T2, typename T3, typename T4>
+    QxtTypedBoundFunction<T1, T2, T3, T4>* bindTyped(QObject* recv, const char* invokable, const T1& p1, const T2& p2, const T3& p3, const T4& p4)
+    {
+        QxtTypedBoundFunction<T1, T2, T3, T4>* f = new QxtTypedBoundFunction<T1, T2, T3, T4>(recv, invokable);
+        if (!f->isValid())
+        {
+            delete f;
+            return 0;
+        }
+        f->setArguments(p1, p2, p3, p4);
+        return f;
+    }
+
+    template <typename T1, typename T2, typename T3, typename T4, typename T5>
+    QxtTypedBoundFunction<T1, T2, T3, T4, T5>* bindTyped(QObject* recv, const char* invokable, const T1& p1, const T2& p2, const T3& p3, const T4& p4, const T5& p5)
+    {
+        QxtTypedBoundFunction<T1, T2, T3, T4, T5>* f = new QxtTypedBoundFunction<T1, T2, T3, T4, T5>(recv, invokable);
+        if (!f->isValid())
+        {
+            delete f;
+            return 0;
+        }
+        f->setArguments(p1, p2, p3, p4, p5);
+        return f;
+    }
+
+    template <typename T1, typename T2, typename T3, typename T4, typename T5, typename T6>
+    QxtTypedBoundFunction<T1, T2, T3, T4, T5, T6>* bindTyped(QObject* recv, const char* invokable, const T1& p1, const T2& p2, const T3& p3, const T4& p4, const T5& p5, const T6& p6)
+    {
+        QxtTypedBoundFunction<T1, T2, T3, T4, T5, T6>* f = new QxtTypedBoundFunction<T1, T2, T3, T4, T5, T6>(recv, invokable);
+        if (!f->isValid())
+        {
+            delete f;
+            return 0;
+        }
+        f->setArguments(p1, p2, p3, p4, p5, p6);
+        return f;
+    }
+
+    template <typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7>
+    QxtTypedBoundFunction<T1, T2, T3, T4, T5, T6, T7>* bindTyped(QObject* recv, const char* invokable, const T1& p1, const T2& p2, const T3& p3, const T4& p4, const T5& p5, const T6& p6, const T7& p7)
+    {
+        QxtTypedBoundFunction<T1, T2, T3, T4, T5, T6, T7>* f = new QxtTypedBoundFunction<T1, T2, T3, T4, T5, T6, T7>(recv, invokable);
+        if (!f->isValid())
+        {
+            delete f;
+            return 0;
+        }
+        f->setArguments(p1, p2, p3, p4, p5, p6, p7);
+        return f;
+    }
+
+    template <typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7, typename T8>
+    QxtTypedBoundFunction<T1, T2, T3, T4, T5, T6, T7, T8>* bindTyped(QObject* recv, const char* invokable, const T1& p1, const T2& p2, const T3& p3, const T4& p4, const T5& p5, const T6& p6, const T7& p7, const T8& p8)
+    {
+        QxtTypedBoundFunction<T1, T2, T3, T4, T5, T6, T7, T8>* f = new QxtTypedBoundFunction<T1, T2, T3, T4, T5, T6, T7, T8>(recv, invokable);
+        if (!f->isValid())
+        {
+            delete f;
+            return 0;
+        }
+        f->setArguments(p1, p2, p3, p4, p5, p6, p7, p8);
+        return f;
+    }
+
+    template <typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7, typename T8, typename T9>
+    QxtTypedBoundFunction<T1, T2, T3, T4, T5, T6, T7, T8, T9>* bindTyped(QObject* recv, const char* invokable, const T1& p1, const T2& p2, const T3& p3, const T4& p4, const T5& p5, const T6& p6, const T7& p7, const T8& p8, const T9& p9)
+    {
+        QxtTypedBoundFunction<T1, T2, T3, T4, T5, T6, T7, T8, T9>* f = new QxtTypedBoundFunction<T1, T2, T3, T4, T5, T6, T7, T8, T9>(recv, invokable);
+        if (!f->isValid())
+        {
+            delete f;
+            return 0;
+        }
+        f->setArguments(p1, p2, p3, p4, p5, p6, p7, p8, p9);
+        return f;
+    }
+
+    template <typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7, typename T8, typename T9, typename T10>
+    QxtTypedBoundFunction<T1, T2, T3, T4, T5, T6, T7, T8, T9, T10>* bindTyped(QObject* recv, const char* invokable, const T1& p1, const T2& p2, const T3& p3, const T4& p4, const T5& p5, const T6& p6, const T7& p7, const T8& p8, const T9& p9, const T10& p10)
+    {
+        QxtTypedBoundFunction<T1, T2, T3, T4, T5, T6, T7, T8, T9, T10>* f = new QxtTypedBoundFunction<T1, T2, T3, T4, T5, T6, T7, T8, T9, T10>(recv, invokable);
+        if (!f->isValid())
+        {
+            delete f;
+            return 0;
+        }
+        f->setArguments(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10);
+        return f;
+    }
+}
+
+#endif // QXTTYPEDBOUNDFUNCTION_H
@@ -9,6 +9,8 @@ HEADERS += qxtsmtp_p.h
 HEADERS += qxtmailattachment.h
 HEADERS += qxtmailmessage.h
 HEADERS += qxtrpcpeer.h
+HEADERS += qxtshardedconnectionmanager.h
+HEADERS += qxtshardedconnectionmanager_p.h
 HEADERS += qxttcpconnectionmanager.h
 HEADERS += qxttcpconnectionmanager_p.h
 HEADERS += qxtxmlrpccall.h
@@ -29,6 +31,7 @@ SOURCES += qxtjsonrpcclient.cpp
 SOURCES += qxtmailattachment.cpp
 SOURCES += qxtmailmessage.cpp
 SOURCES += qxtrpcpeer.cpp
+SOURCES += qxtshardedconnectionmanager.cpp
 SOURCES += qxtsmtp.cpp
 SOURCES += qxttcpconnectionmanager.cpp
 SOURCES += qxtxmlrpccall.cpp
@@ -41,6 +41,7 @@
 #include "qxtpop3retrreply.h"
 #include "qxtpop3statreply.h"
 #include "qxtrpcpeer.h"
+#include "qxtshardedconnectionmanager.h"
 #include "qxtsmtp.h"
 #ifdef HAVE_OPENSSL
 #include "qxtsshchannel.h"
@@ -0,0 +1,476 @@
+/****************************************************************************
+** Copyright (c) 2006 - 2011, the LibQxt project.
+** See the Qxt AUTHORS file for a list of authors and copyright holders.
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**     * Redistributions of source code must retain the above copyright
+**       notice, this list of conditions and the following disclaimer.
+**     * Redistributions in binary form must reproduce the above copyright
+**       notice, this list of conditions and the following disclaimer in the
+**       documentation and/or other materials provided with the distribution.
+**     * Neither the name of the LibQxt project nor the
+**       names of its contributors may be used to endorse or promote products
+**       derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+** ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+** DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+** (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+** LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+** ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** <http://libqxt.org>  <foundation@libqxt.org>
+*****************************************************************************/
+
+#include "qxtshardedconnectionmanager.h"
+#include "qxtshardedconnectionmanager_p.h"
+#include <qxtrpcservice.h>
+#include <qxtmetaobject.h>
+#include <QTcpSocket>
+#include <QMetaObject>
+#include <QMetaType>
+#include <QtDebug>
+
+/*!
+ * \class QxtShardedConnectionManager
+ * \inmodule QxtNetwork
+ * \brief The QxtShardedConnectionManager class accepts TCP connections and distributes them across worker threads
+ *
+ * QxtShardedConnectionManager listens like QxtTcpConnectionManager, but instead of creating
+ * every socket in the listening thread it hands each accepted socket descriptor to one of
+ * a fixed number of shards. Every shard runs in its own QThread, owns the sockets assigned
+ * to it and runs its own QxtRPCService, so incoming RPC traffic is deserialized and
+ * dispatched in parallel. New connections are assigned to the shard with the fewest
+ * connections.
+ *
+ * Client IDs are unique across all shards; the shard that owns a client can be obtained
+ * with shardOf(). The newConnection() and disconnected() signals are emitted in the thread
+ * of the manager, but the QIODevice they carry lives in the worker thread of its shard and
+ * must not be used directly from any other thread.
+ *
+ * Slots are attached to the per-shard services from a slot connected to shardStarted()
+ * with Qt::DirectConnection. Such slots are invoked in the worker thread. Calls to clients
+ * should go through call() and callExcept(), which post one message per shard rather than
+ * one per client.
+ *
+ * \code
+ * QxtShardedConnectionManager manager(4);
+ * QObject::connect(&manager, SIGNAL(shardStarted(int, QxtRPCService*)),
+ *                  &handler, SLOT(setupShard(int, QxtRPCService*)), Qt::DirectConnection);
+ * manager.listen(QHostAddress::Any, 4242);
+ * \endcode
+ *
+ * \sa QxtTcpConnectionManager, QxtRPCService
+ */
+
+QxtConnectionShardThread::QxtConnectionShardThread(int index, QxtShardedConnectionManagerPrivate* owner)
+: QThread(0), index(index), owner(owner), shard(0), service(0)
+{
+    // initializers only
+}
+
+void QxtConnectionShardThread::run()
+{
+    // Everything belonging to the shard is created here so that it has affinity with this thread.
+    service = new QxtRPCService;
+    shard = new QxtConnectionShard(index, owner);
+    service->setConnectionManager(shard);
+    owner->announceShard(index, service);
+    owner->started.release();
+
+    exec();
+
+    // The service owns the shard, which in turn owns the remaining sockets.
+    delete service;
+    service = 0;
+    shard = 0;
+}
+
+QxtConnectionShard::QxtConnectionShard(int index, QxtShardedConnectionManagerPrivate* owner)
+: QxtAbstractConnectionManager(0), index(index), nextSerial(0), owner(owner), dying(0)
+{
+    QObject::connect(&mapper, SIGNAL(mapped(QObject*)), this, SLOT(socketDisconnected(QObject*)));
+}
+
+bool QxtConnectionShard::isAcceptingConnections() const
+{
+    return true;
+}
+
+void QxtConnectionShard::acceptDescriptor(qlonglong socketDescriptor)
+{
+    QIODevice* device = owner->createDevice(socketDescriptor);
+    if (!device)
+    {
+        QMetaObject::invokeMethod(owner, "clientRejected", Qt::QueuedConnection, Q_ARG(int, index));
+        return;
+    }
+    if (!device->parent())
+        device->setParent(this);
+
+    quint64 clientID = QxtShardedConnectionManagerPrivate::makeClientID(index, ++nextSerial);
+    ids.insert(device, clientID);
+    mapper.setMapping(device, device);
+    QObject::connect(device, SIGNAL(destroyed()), &mapper, SLOT(map()));
+    QTcpSocket* sock = qobject_cast<QTcpSocket*>(device);
+    if (sock)
+    {
+        QObject::connect(sock, SIGNAL(error(QAbstractSocket::SocketError)), &mapper, SLOT(map()));
+        QObject::connect(sock, SIGNAL(disconnected()), &mapper, SLOT(map()));
+    }
+
+    // The manager is told about the client before the service sees it, so that a disconnect triggered
+    // from the service is always delivered to the manager after the connection itself.
+    QMetaObject::invokeMethod(owner, "clientAdded", Qt::QueuedConnection, Q_ARG(int, index),
+                              Q_ARG(quint64, clientID), Q_ARG(QObject*, device));
+    addConnection(device, clientID);
+}
+
+void QxtConnectionShard::closeClient(quint64 clientID)
+{
+    // The client may already have gone away on its own; that's not worth a warning.
+    if (client(clientID))
+        disconnect(clientID);
+}
+
+void QxtConnectionShard::socketDisconnected(QObject* client)
+{
+    quint64 clientID = ids.value(client, 0);
+    if (!clientID)
+        return;
+
+    // qobject_cast fails for an object that is being destroyed.
+    QIODevice* device = qobject_cast<QIODevice*>(client);
+    if (!device)
+        dying = client;
+    disconnect(clientID);
+    dying = 0;
+}
+
+void QxtConnectionShard::removeConnection(QIODevice* device, quint64 clientID)
+{
+    if (device)
+    {
+        ids.remove(device);
+        if (device != dying)
+        {
+            QObject::disconnect(device, 0, &mapper, 0);
+            QAbstractSocket* sock = qobject_cast<QAbstractSocket*>(device);
+            if (sock) sock->disconnectFromHost();
+            device->close();
+            device->deleteLater();
+        }
+    }
+    QMetaObject::invokeMethod(owner, "clientRemoved", Qt::QueuedConnection, Q_ARG(int, index),
+                              Q_ARG(quint64, clientID));
+}
+
+QxtShardedConnectionManagerPrivate::QxtShardedConnectionManagerPrivate()
+: QTcpServer(0), shardCount(1), removingFromShard(false)
+{
+    qRegisterMetaType<quint64>("quint64");
+}
+
+void QxtShardedConnectionManagerPrivate::startShards()
+{
+    threads.resize(shardCount);
+    load.fill(0, shardCount);
+    for (int i = 0; i < shardCount; i++)
+    {
+        threads[i] = new QxtConnectionShardThread(i, this);
+        threads[i]->start();
+    }
+    // Wait until every shard has its service, so that shardService() is valid after listen().
+    started.acquire(shardCount);
+}
+
+void QxtShardedConnectionManagerPrivate::stopShards()
+{
+    foreach(QxtConnectionShardThread* thread, threads)
+    {
+        thread->quit();
+        thread->wait();
+        delete thread;
+    }
+    threads.clear();
+    load.clear();
+}
+
+void QxtShardedConnectionManagerPrivate::announceShard(int index, QxtRPCService* service)
+{
+    emit qxt_p().shardStarted(index, service);
+}
+
+QIODevice* QxtShardedConnectionManagerPrivate::createDevice(qlonglong socketDescriptor)
+{
+    return qxt_p().incomingConnection(socketDescriptor);
+}
+
+QString QxtShardedConnectionManagerPrivate::normalizedFunction(const QString& fn)
+{
+    // Normalize the function name if it has the form of a signal or slot, as QxtRPCService does for clients.
+    if (QxtMetaObject::isSignalOrSlot(fn.toLatin1().constData()))
+        return QxtMetaObject::methodSignature(fn.toLatin1().constData());
+    return fn;
+}
+
+QxtRPCService* QxtShardedConnectionManagerPrivate::serviceFor(quint64 clientID) const
+{
+    QxtConnectionShardThread* thread = threads.value(shardOf(clientID), 0);
+    return thread ? thread->service : 0;
+}
+
+#if QT_VERSION >= 0x050000
+void QxtShardedConnectionManagerPrivate::incomingConnection(qintptr socketDescriptor)
+#else
+void QxtShardedConnectionManagerPrivate::incomingConnection(int socketDescriptor)
+#endif
+{
+    int target = 0;
+    for (int i = 1; i < shardCount; i++)
+    {
+        if (load[i] < load[target])
+            target = i;
+    }
+    load[target]++;
+    QMetaObject::invokeMethod(threads[target]->shard, "acceptDescriptor", Qt::QueuedConnection,
+                              Q_ARG(qlonglong, socketDescriptor));
+}
+
+void QxtShardedConnectionManagerPrivate::clientAdded(int shard, quint64 clientID, QObject* device)
+{
+    Q_UNUSED(shard);
+    // The device belongs to the shard's thread and may already be gone, so it must not be dereferenced here.
+    qxt_p().addConnection(static_cast<QIODevice*>(device), clientID);
+}
+
+void QxtShardedConnectionManagerPrivate::clientRemoved(int shard, quint64 clientID)
+{
+    load[shard]--;
+    if (qxt_p().client(clientID))
+    {
+        removingFromShard = true;
+        qxt_p().disconnect(clientID);
+        removingFromShard = false;
+    }
+}
+
+void QxtShardedConnectionManagerPrivate::clientRejected(int shard)
+{
+    load[shard]--;
+}
+
+/*!
+ * Constructs a new QxtShardedConnectionManager object with the specified \a parent and
+ * one shard for each processor core.
+ */
+QxtShardedConnectionManager::QxtShardedConnectionManager(QObject* parent) : QxtAbstractConnectionManager(parent)
+{
+    QXT_INIT_PRIVATE(QxtShardedConnectionManager);
+    qxt_d().shardCount = qMax(1, QThread::idealThreadCount());
+}
+
+/*!
+ * Constructs a new QxtShardedConnectionManager object with the specified \a parent
+ * that distributes connections across \a shards worker threads.
+ */
+QxtShardedConnectionManager::QxtShardedConnectionManager(int shards, QObject* parent) : QxtAbstractConnectionManager(parent)
+{
+    QXT_INIT_PRIVATE(QxtShardedConnectionManager);
+    qxt_d().shardCount = qMax(1, shards);
+}
+
+/*!
+ * Destroys the connection manager. All worker threads are stopped and any connections
+ * still open are closed.
+ */
+QxtShardedConnectionManager::~QxtShardedConnectionManager()
+{
+    qxt_d().close();
+    qxt_d().stopShards();
+}
+
+/*!
+ * Listens on the specified interface \a iface on the specified \a port for connections.
+ * If \a iface is QHostAddress::Any, listens on all interfaces.
+ *
+ * The worker threads are started the first time this function is called; shardStarted()
+ * is emitted for every shard before it returns.
+ *
+ * Returns \c true on success; otherwise returns \c false.
+ */
+bool QxtShardedConnectionManager::listen(QHostAddress iface, int port)
+{
+    if (qxt_d().threads.isEmpty())
+        qxt_d().startShards();
+    return qxt_d().listen(iface, port);
+}
+
+/*!
+ * Stops listening for connections. Any connections still open will remain connected.
+ */
+void QxtShardedConnectionManager::stopListening()
+{
+    if (!qxt_d().isListening())
+    {
+        qWarning() << "QxtShardedConnectionManager: Not listening";
+        return;
+    }
+    qxt_d().close();
+}
+
+/*!
+ * \reimp
+ */
+bool QxtShardedConnectionManager::isAcceptingConnections() const
+{
+    return qxt_d().isListening();
+}
+
+/*!
+ * Returns the number of shards, and therefore worker threads, used by the connection manager.
+ */
+int QxtShardedConnectionManager::shardCount() const
+{
+    return qxt_d().shardCount;
+}
+
+/*!
+ * Returns the index of the shard that owns the client with the specified \a clientID.
+ * The shard is encoded in the ID itself, so this works even after the client has disconnected.
+ */
+int QxtShardedConnectionManager::shardOf(quint64 clientID) const
+{
+    return QxtShardedConnectionManagerPrivate::shardOf(clientID);
+}
+
+/*!
+ * Returns the number of connections currently assigned to the specified \a shard.
+ */
+int QxtShardedConnectionManager::shardClientCount(int shard) const
+{
+    return qxt_d().load.value(shard, 0);
+}
+
+/*!
+ * Returns the QxtRPCService that dispatches the traffic of the specified \a shard, or 0 if
+ * the worker threads have not been started yet. The service lives in the worker thread of
+ * the shard.
+ */
+QxtRPCService* QxtShardedConnectionManager::shardService(int shard) const
+{
+    QxtConnectionShardThread* thread = qxt_d().threads.value(shard, 0);
+    return thread ? thread->service : 0;
+}
+
+/*!
+ * Sends the signal \a fn with the given parameter list to all connected clients on all shards.
+ *
+ * The parameters are serialized once per shard, in the worker thread of that shard.
+ *
+ * \sa QxtRPCService::call()
+ */
+void QxtShardedConnectionManager::call(QString fn, const QVariant& p1, const QVariant& p2, const QVariant& p3,
+        const QVariant& p4, const QVariant& p5, const QVariant& p6, const QVariant& p7, const QVariant& p8)
+{
+    fn = QxtShardedConnectionManagerPrivate::normalizedFunction(fn);
+    foreach(QxtConnectionShardThread* thread, qxt_d().threads)
+    {
+        if (qxt_d().load.value(thread->index) == 0)
+            continue;
+        QMetaObject::invokeMethod(thread->service, "call", Qt::QueuedConnection, Q_ARG(QString, fn),
+                                  Q_ARG(QVariant, p1), Q_ARG(QVariant, p2), Q_ARG(QVariant, p3), Q_ARG(QVariant, p4),
+                                  Q_ARG(QVariant, p5), Q_ARG(QVariant, p6), Q_ARG(QVariant, p7), Q_ARG(QVariant, p8));
+    }
+}
+
+/*!
+ * Sends the signal \a fn with the given parameter list to the client with the specified \a id.
+ *
+ * The call is routed directly to the shard that owns the client.
+ */
+void QxtShardedConnectionManager::call(quint64 id, QString fn, const QVariant& p1, const QVariant& p2, const QVariant& p3,
+        const QVariant& p4, const QVariant& p5, const QVariant& p6, const QVariant& p7, const QVariant& p8)
+{
+    fn = QxtShardedConnectionManagerPrivate::normalizedFunction(fn);
+    // The shard is encoded in the ID; whether the client exists is only known to the registry.
+    QxtRPCService* service = qxt_d().serviceFor(id);
+    if (!service || !client(id))
+    {
+        qWarning() << "QxtShardedConnectionManager::call: client ID not in use";
+        return;
+    }
+    QMetaObject::invokeMethod(service, "call", Qt::QueuedConnection, Q_ARG(quint64, id), Q_ARG(QString, fn),
+                              Q_ARG(QVariant, p1), Q_ARG(QVariant, p2), Q_ARG(QVariant, p3), Q_ARG(QVariant, p4),
+                              Q_ARG(QVariant, p5), Q_ARG(QVariant, p6), Q_ARG(QVariant, p7), Q_ARG(QVariant, p8));
+}
+
+/*!
+ * Sends the signal \a fn with the given parameter list to all connected clients on all shards
+ * except for the client specified by \a id.
+ */
+void QxtShardedConnectionManager::callExcept(quint64 id, QString fn, const QVariant& p1, const QVariant& p2,
+        const QVariant& p3, const QVariant& p4, const QVariant& p5, const QVariant& p6, const QVariant& p7,
+        const QVariant& p8)
+{
+    fn = QxtShardedConnectionManagerPrivate::normalizedFunction(fn);
+    int owner = shardOf(id);
+    foreach(QxtConnectionShardThread* thread, qxt_d().threads)
+    {
+        if (thread->index != owner)
+        {
+            if (qxt_d().load.value(thread->index) == 0)
+                continue;
+            QMetaObject::invokeMethod(thread->service, "call", Qt::QueuedConnection, Q_ARG(QString, fn),
+                                      Q_ARG(QVariant, p1), Q_ARG(QVariant, p2), Q_ARG(QVariant, p3), Q_ARG(QVariant, p4),
+                                      Q_ARG(QVariant, p5), Q_ARG(QVariant, p6), Q_ARG(QVariant, p7), Q_ARG(QVariant, p8));
+        }
+        else
+        {
+            QMetaObject::invokeMethod(thread->service, "callExcept", Qt::QueuedConnection, Q_ARG(quint64, id),
+                                      Q_ARG(QString, fn), Q_ARG(QVariant, p1), Q_ARG(QVariant, p2), Q_ARG(QVariant, p3),
+                                      Q_ARG(QVariant, p4), Q_ARG(QVariant, p5), Q_ARG(QVariant, p6), Q_ARG(QVariant, p7),
+                                      Q_ARG(QVariant, p8));
+        }
+    }
+}
+
+/*!
+ * This function is called in the worker thread of the shard that will own a new TCP connection.
+ * The parameter is the native \a socketDescriptor for the connection, suitable for use in
+ * QTcpSocket::setSocketDescriptor.
+ *
+ * The default implementation returns a new QTcpSocket with the specified descriptor.
+ * Reimplementations must be thread-safe and must not give the device a parent that lives
+ * in another thread. Returning 0 rejects the connection.
+ */
+#if QT_VERSION >= 0x050000
+QIODevice* QxtShardedConnectionManager::incomingConnection(qintptr socketDescriptor)
+#else
+QIODevice* QxtShardedConnectionManager::incomingConnection(int socketDescriptor)
+#endif
+{
+    QTcpSocket* device = new QTcpSocket;
+    device->setSocketDescriptor(socketDescriptor);
+    return device;
+}
+
+/*!
+ * \reimp
+ */
+void QxtShardedConnectionManager::removeConnection(QIODevice* device, quint64 clientID)
+{
+    Q_UNUSED(device);
+    // The shard has already closed the connection if it reported the disconnection itself.
+    if (qxt_d().removingFromShard)
+        return;
+    QxtConnectionShardThread* thread = qxt_d().threads.value(shardOf(clientID), 0);
+    if (thread)
+        QMetaObject::invokeMethod(thread->shard, "closeClient", Qt::QueuedConnection, Q_ARG(quint64, clientID));
+}
@@ -0,0 +1,90 @@
+/****************************************************************************
+** Copyright (c) 2006 - 2011, the LibQxt project.
+** See the Qxt AUTHORS file for a list of authors and copyright holders.
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**     * Redistributions of source code must retain the above copyright
+**       notice, this list of conditions and the following disclaimer.
+**     * Redistributions in binary form must reproduce the above copyright
+**       notice, this list of conditions and the following disclaimer in the
+**       documentation and/or other materials provided with the distribution.
+**     * Neither the name of the LibQxt project nor the
+**       names of its contributors may be used to endorse or promote products
+**       derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+** ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+** DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+** (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+** LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+** ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** <http://libqxt.org>  <foundation@libqxt.org>
+*****************************************************************************/
+
+#ifndef QXTSHARDEDCONNECTIONMANAGER_H
+#define QXTSHARDEDCONNECTIONMANAGER_H
+
+#include <qxtabstractconnectionmanager.h>
+#include <QObject>
+#include <QVariant>
+#include <QHostAddress>
+QT_FORWARD_DECLARE_CLASS(QIODevice)
+class QxtRPCService;
+
+class QxtShardedConnectionManagerPrivate;
+class QXT_NETWORK_EXPORT QxtShardedConnectionManager : public QxtAbstractConnectionManager
+{
+    Q_OBJECT
+public:
+    QxtShardedConnectionManager(QObject* parent = 0);
+    explicit QxtShardedConnectionManager(int shards, QObject* parent = 0);
+    virtual ~QxtShardedConnectionManager();
+
+    bool listen(QHostAddress iface = QHostAddress::Any, int port = 80);
+    void stopListening();
+    bool isAcceptingConnections() const;
+
+    int shardCount() const;
+    int shardOf(quint64 clientID) const;
+    int shardClientCount(int shard) const;
+    QxtRPCService* shardService(int shard) const;
+
+public Q_SLOTS:
+    void call(QString fn, const QVariant& p1 = QVariant(), const QVariant& p2 = QVariant(),
+              const QVariant& p3 = QVariant(), const QVariant& p4 = QVariant(), const QVariant& p5 = QVariant(),
+              const QVariant& p6 = QVariant(), const QVariant& p7 = QVariant(), const QVariant& p8 = QVariant());
+    void call(quint64 id, QString fn, const QVariant& p1 = QVariant(), const QVariant& p2 = QVariant(),
+              const QVariant& p3 = QVariant(), const QVariant& p4 = QVariant(), const QVariant& p5 = QVariant(),
+              const QVariant& p6 = QVariant(), const QVariant& p7 = QVariant(), const QVariant& p8 = QVariant());
+    void callExcept(quint64 id, QString fn, const QVariant& p1 = QVariant(), const QVariant& p2 = QVariant(),
+                    const QVariant& p3 = QVariant(), const QVariant& p4 = QVariant(), const QVariant& p5 = QVariant(),
+                    const QVariant& p6 = QVariant(), const QVariant& p7 = QVariant(), const QVariant& p8 = QVariant());
+
+Q_SIGNALS:
+    /*!
+     * This signal is emitted from the worker thread of \a shard after its \a service has been
+     * created and before it accepts any connection. Connect to it with Qt::DirectConnection in
+     * order to attach signals and slots to the service.
+     */
+    void shardStarted(int shard, QxtRPCService* service);
+
+protected:
+#if QT_VERSION >= 0x050000
+    virtual QIODevice* incomingConnection(qintptr socketDescriptor);
+#else
+    virtual QIODevice* incomingConnection(int socketDescriptor);
+#endif
+    virtual void removeConnection(QIODevice* device, quint64 clientID);
+
+private:
+    QXT_DECLARE_PRIVATE(QxtShardedConnectionManager)
+};
+
+#endif
@@ -0,0 +1,132 @@
+/****************************************************************************
+** Copyright (c) 2006 - 2011, the LibQxt project.
+** See the Qxt AUTHORS file for a list of authors and copyright holders.
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**     * Redistributions of source code must retain the above copyright
+**       notice, this list of conditions and the following disclaimer.
+**     * Redistributions in binary form must reproduce the above copyright
+**       notice, this list of conditions and the following disclaimer in the
+**       documentation and/or other materials provided with the distribution.
+**     * Neither the name of the LibQxt project nor the
+**       names of its contributors may be used to endorse or promote products
+**       derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+** ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+** DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+** (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+** LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+** ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** <http://libqxt.org>  <foundation@libqxt.org>
+*****************************************************************************/
+
+#ifndef QXTSHARDEDCONNECTIONMANAGER_P_H
+#define QXTSHARDEDCONNECTIONMANAGER_P_H
+
+#include <qxtshardedconnectionmanager.h>
+#include <QTcpServer>
+#include <QThread>
+#include <QSemaphore>
+#include <QSignalMapper>
+#include <QVector>
+#include <QHash>
+
+class QxtConnectionShard;
+
+class QxtConnectionShardThread : public QThread
+{
+public:
+    QxtConnectionShardThread(int index, QxtShardedConnectionManagerPrivate* owner);
+
+    int index;
+    QxtShardedConnectionManagerPrivate* owner;
+    QxtConnectionShard* shard;
+    QxtRPCService* service;
+
+protected:
+    void run();
+};
+
+// Lives in its worker thread. Owns the sockets of every client assigned to the shard and feeds them
+// to the shard's own QxtRPCService.
+class QxtConnectionShard : public QxtAbstractConnectionManager
+{
+Q_OBJECT
+public:
+    QxtConnectionShard(int index, QxtShardedConnectionManagerPrivate* owner);
+
+    bool isAcceptingConnections() const;
+
+    int index;
+    quint64 nextSerial;
+    QxtShardedConnectionManagerPrivate* owner;
+
+public Q_SLOTS:
+    void acceptDescriptor(qlonglong socketDescriptor);
+    void closeClient(quint64 clientID);
+
+protected:
+    void removeConnection(QIODevice* device, quint64 clientID);
+
+private Q_SLOTS:
+    void socketDisconnected(QObject* client);
+
+private:
+    QSignalMapper mapper;
+    QHash<QObject*, quint64> ids;
+    QObject* dying;
+};
+
+class QxtShardedConnectionManagerPrivate : public QTcpServer, public QxtPrivate<QxtShardedConnectionManager>
+{
+Q_OBJECT
+public:
+    QxtShardedConnectionManagerPrivate();
+    QXT_DECLARE_PUBLIC(QxtShardedConnectionManager)
+
+    void startShards();
+    void stopShards();
+    void announceShard(int index, QxtRPCService* service);
+    QIODevice* createDevice(qlonglong socketDescriptor);
+    QxtRPCService* serviceFor(quint64 clientID) const;
+    static QString normalizedFunction(const QString& fn);
+
+    // Client IDs carry their shard in the upper bits, so routing a call to a client never needs a lookup table.
+    static inline quint64 makeClientID(int shard, quint64 serial)
+    {
+        return (quint64(shard + 1) << 48) | (serial & Q_UINT64_C(0xFFFFFFFFFFFF));
+    }
+    static inline int shardOf(quint64 clientID)
+    {
+        return int(clientID >> 48) - 1;
+    }
+
+    int shardCount;
+    bool removingFromShard;
+    QVector<QxtConnectionShardThread*> threads;
+    // Number of connections assigned to each shard, maintained on the listening thread only.
+    QVector<int> load;
+    QSemaphore started;
+
+public Q_SLOTS:
+    void clientAdded(int shard, quint64 clientID, QObject* device);
+    void clientRemoved(int shard, quint64 clientID);
+    void clientRejected(int shard);
+
+protected:
+#if QT_VERSION >= 0x050000
+    void incomingConnection(qintptr socketDescriptor);
+#else
+    void incomingConnection(int socketDescriptor);
+#endif
+};
+
+#endif
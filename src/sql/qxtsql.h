@@ -31,6 +31,8 @@
 
 #define QXTSQL_H_INCLUDED
 
+#include "qxtsqlasyncexecutor.h"
+#include "qxtsqlconnectionpool.h"
 #include "qxtsqlpackage.h"
 #include "qxtsqlpackagemodel.h"
 #include "qxtsqlthreadmanager.h"
@@ -0,0 +1,434 @@
+/****************************************************************************
+** Copyright (c) 2006 - 2011, the LibQxt project.
+** See the Qxt AUTHORS file for a list of authors and copyright holders.
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**     * Redistributions of source code must retain the above copyright
+**       notice, this list of conditions and the following disclaimer.
+**     * Redistributions in binary form must reproduce the above copyright
+**       notice, this list of conditions and the following disclaimer in the
+**       documentation and/or other materials provided with the distribution.
+**     * Neither the name of the LibQxt project nor the
+**       names of its contributors may be used to endorse or promote products
+**       derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+** ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+** DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+** (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+** LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+** ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** <http://libqxt.org>  <foundation@libqxt.org>
+*****************************************************************************/
+
+#include "qxtsqlasyncexecutor.h"
+#include "qxtsqlasyncexecutor_p.h"
+#include "qxtsqlthreadmanager.h"
+#include <QSqlQuery>
+#include <QPointer>
+#include <QElapsedTimer>
+
+/*!
+\class QxtSqlAsyncExecutor
+
+\inmodule QxtSql
+
+\brief The QxtSqlAsyncExecutor class runs queries on worker threads and streams their rows
+
+exec() queues a query and returns at once with a QxtSqlAsyncResult. One of the
+executor's threads runs the query on a connection of its own, obtained from
+QxtSqlThreadManager, and hands the rows back in batches of batchSize() rows.
+The batches arrive as QxtSqlAsyncResult::batchReady() signals in the thread
+that called exec(), so neither a user interface nor a service thread has to wait
+for the database.
+
+\code
+QxtSqlAsyncExecutor executor;
+QxtSqlAsyncResult* result = executor.exec("SELECT * FROM orders WHERE year = ?", QVariantList() << 2011);
+connect(result, SIGNAL(batchReady(QxtSqlPackage)), this, SLOT(addRows(QxtSqlPackage)));
+connect(result, SIGNAL(finished()), result, SLOT(deleteLater()));
+\endcode
+
+Each thread keeps its connection until the executor is destroyed. If a
+QxtSqlConnectionPool is set with QxtSqlThreadManager::setPool(), the
+connections are borrowed from the pool.
+
+\sa QxtSqlPackageModel::setQuery()
+*/
+
+/*!
+\class QxtSqlAsyncResult
+
+\inmodule QxtSql
+
+\brief The QxtSqlAsyncResult class is the pending result of a query run by QxtSqlAsyncExecutor
+
+The rows of the query are emitted in batches with batchReady(), followed by
+finished() once the query is done, has failed or was canceled. The first batch
+is emitted even if the query returned no rows, so that the columns are known.
+
+The result belongs to the caller of QxtSqlAsyncExecutor::exec(). Deleting it
+cancels the query.
+*/
+
+/*!
+\fn void QxtSqlAsyncResult::batchReady(const QxtSqlPackage& batch)
+
+This signal is emitted for every \a batch of rows in the thread of the result.
+To use it with a queued connection, QxtSqlPackage has to be registered with
+qRegisterMetaType().
+*/
+
+/*!
+\fn void QxtSqlAsyncResult::finished()
+
+This signal is emitted once after the last batch, see lastError() and isCanceled().
+*/
+
+QxtSqlAsyncJob::QxtSqlAsyncJob() : batchSize(256), receiver(0), done(false), finished(false), rows(0)
+{
+}
+
+QxtSqlAsyncJob::~QxtSqlAsyncJob()
+{
+    qDeleteAll(batches);
+}
+
+/*
+    hands a batch to the result, false if nobody waits for it any more
+*/
+bool QxtSqlAsyncJob::post(QxtSqlPackage* batch)
+{
+    QMutexLocker locker(&mutex);
+    if (!receiver || canceled.fetchAndAddAcquire(0))
+    {
+        delete batch;
+        return false;
+    }
+    batch->moveToThread(receiver->thread());
+    batches.append(batch);
+    if (batches.count() == 1)
+        QMetaObject::invokeMethod(receiver, "deliver", Qt::QueuedConnection);
+    return true;
+}
+
+void QxtSqlAsyncJob::end(const QSqlError& error)
+{
+    QMutexLocker locker(&mutex);
+    this->error = error;
+    done = true;
+    ended.wakeAll();
+    if (receiver)
+        QMetaObject::invokeMethod(receiver, "deliver", Qt::QueuedConnection);
+}
+
+QxtSqlAsyncWorker::QxtSqlAsyncWorker(QxtSqlAsyncExecutorPrivate* executor) : executor(executor)
+{
+}
+
+void QxtSqlAsyncWorker::run()
+{
+    // the connection is opened with the first query and closed by QxtSqlThreadManager when the thread exits
+    while (true)
+    {
+        QExplicitlySharedDataPointer<QxtSqlAsyncJob> job = executor->take();
+        if (!job)
+            return;
+        execute(job.data());
+    }
+}
+
+void QxtSqlAsyncWorker::execute(QxtSqlAsyncJob* job)
+{
+    if (job->canceled.fetchAndAddAcquire(0))
+    {
+        job->end(QSqlError());
+        return;
+    }
+
+    QSqlQuery query(QxtSqlThreadManager::connection(executor->masterName));
+    query.setForwardOnly(true);
+    if (!query.prepare(job->query))
+    {
+        job->end(query.lastError());
+        return;
+    }
+    Q_FOREACH(const QVariant& value, job->values)
+        query.addBindValue(value);
+    if (!query.exec() || !query.isSelect())
+    {
+        job->end(query.lastError());
+        return;
+    }
+
+    bool first = true;
+    while (!job->canceled.fetchAndAddAcquire(0))
+    {
+        QxtSqlPackage* batch = new QxtSqlPackage;
+        const int rows = batch->insert(query, job->batchSize);
+        if (!rows && !first)
+        {
+            delete batch;
+            break;
+        }
+        first = false;
+        if (!job->post(batch) || rows < job->batchSize)
+            break;
+    }
+    job->end(query.lastError());
+}
+
+QxtSqlAsyncExecutorPrivate::QxtSqlAsyncExecutorPrivate() : batchSize(256), stopping(false)
+{
+}
+
+QExplicitlySharedDataPointer<QxtSqlAsyncJob> QxtSqlAsyncExecutorPrivate::take()
+{
+    QMutexLocker locker(&mutex);
+    while (queue.isEmpty() && !stopping)
+        wake.wait(&mutex);
+    if (queue.isEmpty())
+        return QExplicitlySharedDataPointer<QxtSqlAsyncJob>();
+    return queue.dequeue();
+}
+
+/*!
+    Constructs a new QxtSqlAsyncExecutor with \a parent, running queries on \a threadCount
+    threads with connections cloned from the connection called \a masterName.
+    A negative \a threadCount uses QThread::idealThreadCount().
+ */
+QxtSqlAsyncExecutor::QxtSqlAsyncExecutor(const QString& masterName, int threadCount, QObject* parent) : QObject(parent)
+{
+    QXT_INIT_PRIVATE(QxtSqlAsyncExecutor);
+    qxt_d().masterName = masterName;
+    if (threadCount < 0)
+        threadCount = QThread::idealThreadCount();
+    for (int i = 0; i < qMax(1, threadCount); i++)
+    {
+        QxtSqlAsyncWorker* worker = new QxtSqlAsyncWorker(&qxt_d());
+        qxt_d().workers.append(worker);
+        worker->start();
+    }
+}
+
+/*!
+    Destroys the executor. Queries that have not started yet are canceled, running
+    queries are waited for.
+ */
+QxtSqlAsyncExecutor::~QxtSqlAsyncExecutor()
+{
+    QxtSqlAsyncExecutorPrivate& d = qxt_d();
+    QQueue<QExplicitlySharedDataPointer<QxtSqlAsyncJob> > queue;
+    {
+        QMutexLocker locker(&d.mutex);
+        d.stopping = true;
+        queue = d.queue;
+        d.queue.clear();
+        d.wake.wakeAll();
+    }
+    Q_FOREACH(const QExplicitlySharedDataPointer<QxtSqlAsyncJob>& job, queue)
+    {
+        job->canceled.fetchAndStoreRelease(1);
+        job->end(QSqlError());
+    }
+    Q_FOREACH(QxtSqlAsyncWorker* worker, d.workers)
+    {
+        worker->wait();
+        delete worker;
+    }
+}
+
+/*!
+    Returns the name of the connection the executor's connections are cloned from.
+ */
+QString QxtSqlAsyncExecutor::masterName() const
+{
+    return qxt_d().masterName;
+}
+
+/*!
+    Returns the number of worker threads, and so the number of queries that run at the same time.
+ */
+int QxtSqlAsyncExecutor::threadCount() const
+{
+    return qxt_d().workers.count();
+}
+
+/*!
+    Returns the number of rows in each QxtSqlAsyncResult::batchReady() signal. The default is 256.
+ */
+int QxtSqlAsyncExecutor::batchSize() const
+{
+    return qxt_d().batchSize;
+}
+
+/*!
+    Sets the number of rows in each QxtSqlAsyncResult::batchReady() signal to \a rows,
+    for queries started with exec() from now on.
+    Small batches show the first rows sooner, large batches cost less per row.
+ */
+void QxtSqlAsyncExecutor::setBatchSize(int rows)
+{
+    qxt_d().batchSize = qMax(1, rows);
+}
+
+/*!
+    Returns the number of queries that wait for a free thread.
+ */
+int QxtSqlAsyncExecutor::pendingCount() const
+{
+    QMutexLocker locker(&const_cast<QxtSqlAsyncExecutor*>(this)->qxt_d().mutex);
+    return qxt_d().queue.count();
+}
+
+/*!
+    Queues \a query with the positional bind \a values and returns its result.
+    The caller takes ownership of the result.
+ */
+QxtSqlAsyncResult* QxtSqlAsyncExecutor::exec(const QString& query, const QVariantList& values)
+{
+    QxtSqlAsyncExecutorPrivate& d = qxt_d();
+    QxtSqlAsyncJob* job = new QxtSqlAsyncJob;
+    job->query = query;
+    job->values = values;
+    job->batchSize = d.batchSize;
+    QxtSqlAsyncResult* result = new QxtSqlAsyncResult(job);
+
+    QMutexLocker locker(&d.mutex);
+    d.queue.enqueue(QExplicitlySharedDataPointer<QxtSqlAsyncJob>(job));
+    d.wake.wakeOne();
+    return result;
+}
+
+QxtSqlAsyncResult::QxtSqlAsyncResult(QxtSqlAsyncJob* job) : qxt_d(job)
+{
+    job->receiver = this;
+}
+
+/*!
+    Destroys the result and cancels the query if it is still running.
+ */
+QxtSqlAsyncResult::~QxtSqlAsyncResult()
+{
+    qxt_d->canceled.fetchAndStoreRelease(1);
+    QMutexLocker locker(&qxt_d->mutex);
+    qxt_d->receiver = 0;
+    qDeleteAll(qxt_d->batches);
+    qxt_d->batches.clear();
+}
+
+/*!
+    Returns the text of the query.
+ */
+QString QxtSqlAsyncResult::query() const
+{
+    return qxt_d->query;
+}
+
+/*!
+    Returns true once finished() has been emitted.
+ */
+bool QxtSqlAsyncResult::isFinished() const
+{
+    return qxt_d->finished;
+}
+
+/*!
+    Returns true if cancel() was called.
+ */
+bool QxtSqlAsyncResult::isCanceled() const
+{
+    return qxt_d->canceled.fetchAndAddAcquire(0);
+}
+
+/*!
+    Returns the error of the query, if any. Valid once the query has finished.
+ */
+QSqlError QxtSqlAsyncResult::lastError() const
+{
+    QMutexLocker locker(&qxt_d->mutex);
+    return qxt_d->error;
+}
+
+/*!
+    Returns the number of rows emitted with batchReady() so far.
+ */
+int QxtSqlAsyncResult::rowsFetched() const
+{
+    return qxt_d->rows;
+}
+
+/*!
+    Blocks for up to \a msecs milliseconds, or without a limit if \a msecs is negative,
+    until the query has run. Then the outstanding batches and finished() are emitted
+    before this function returns true. Returns false on timeout.
+ */
+bool QxtSqlAsyncResult::waitForFinished(int msecs)
+{
+    QElapsedTimer timer;
+    timer.start();
+    {
+        QMutexLocker locker(&qxt_d->mutex);
+        while (!qxt_d->done)
+        {
+            if (msecs < 0)
+            {
+                qxt_d->ended.wait(&qxt_d->mutex);
+                continue;
+            }
+            const qint64 left = msecs - timer.elapsed();
+            if (left <= 0 || !qxt_d->ended.wait(&qxt_d->mutex, (unsigned long)left))
+                return false;
+        }
+    }
+    deliver();
+    return true;
+}
+
+/*!
+    Cancels the query. No batchReady() is emitted after this, finished() still is.
+    The thread stops the query before it fetches the next batch, a statement that
+    is already executing in the database runs to its end.
+ */
+void QxtSqlAsyncResult::cancel()
+{
+    qxt_d->canceled.fetchAndStoreRelease(1);
+    QMutexLocker locker(&qxt_d->mutex);
+    qDeleteAll(qxt_d->batches);
+    qxt_d->batches.clear();
+}
+
+void QxtSqlAsyncResult::deliver()
+{
+    // one batch at a time, so that waitForFinished() from a slot keeps the order
+    while (true)
+    {
+        QxtSqlPackage* batch;
+        {
+            QMutexLocker locker(&qxt_d->mutex);
+            if (qxt_d->batches.isEmpty())
+            {
+                if (!qxt_d->done || qxt_d->finished)
+                    return;
+                qxt_d->finished = true;
+                break;
+            }
+            batch = qxt_d->batches.takeFirst();
+        }
+        qxt_d->rows += batch->count();
+        // a slot may delete the result
+        QPointer<QxtSqlAsyncResult> guard(this);
+        emit batchReady(*batch);
+        delete batch;
+        if (!guard)
+            return;
+    }
+    emit finished();
+}
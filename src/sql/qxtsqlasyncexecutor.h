@@ -0,0 +1,95 @@
+/****************************************************************************
+** Copyright (c) 2006 - 2011, the LibQxt project.
+** See the Qxt AUTHORS file for a list of authors and copyright holders.
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**     * Redistributions of source code must retain the above copyright
+**       notice, this list of conditions and the following disclaimer.
+**     * Redistributions in binary form must reproduce the above copyright
+**       notice, this list of conditions and the following disclaimer in the
+**       documentation and/or other materials provided with the distribution.
+**     * Neither the name of the LibQxt project nor the
+**       names of its contributors may be used to endorse or promote products
+**       derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+** ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+** DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+** (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+** LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+** ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** <http://libqxt.org>  <foundation@libqxt.org>
+*****************************************************************************/
+
+#ifndef QXTSQLASYNCEXECUTOR_H
+#define QXTSQLASYNCEXECUTOR_H
+
+#include <QObject>
+#include <QExplicitlySharedDataPointer>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QVariant>
+#include <qxtglobal.h>
+#include "qxtsqlpackage.h"
+
+class QxtSqlAsyncJob;
+class QxtSqlAsyncExecutorPrivate;
+
+class QXT_SQL_EXPORT QxtSqlAsyncResult : public QObject
+{
+    Q_OBJECT
+public:
+    ~QxtSqlAsyncResult();
+
+    QString query() const;
+    bool isFinished() const;
+    bool isCanceled() const;
+    QSqlError lastError() const;
+    int rowsFetched() const;
+
+    bool waitForFinished(int msecs = -1);
+
+public Q_SLOTS:
+    void cancel();
+
+Q_SIGNALS:
+    void batchReady(const QxtSqlPackage& batch);
+    void finished();
+
+private Q_SLOTS:
+    void deliver();
+
+private:
+    friend class QxtSqlAsyncExecutor;
+    explicit QxtSqlAsyncResult(QxtSqlAsyncJob* job);
+    QExplicitlySharedDataPointer<QxtSqlAsyncJob> qxt_d;
+};
+
+class QXT_SQL_EXPORT QxtSqlAsyncExecutor : public QObject
+{
+    Q_OBJECT
+public:
+    explicit QxtSqlAsyncExecutor(const QString& masterName =
+            QLatin1String(QSqlDatabase::defaultConnection), int threadCount = 1, QObject* parent = 0);
+    virtual ~QxtSqlAsyncExecutor();
+
+    QString masterName() const;
+    int threadCount() const;
+    int batchSize() const;
+    void setBatchSize(int rows);
+    int pendingCount() const;
+
+    QxtSqlAsyncResult* exec(const QString& query, const QVariantList& values = QVariantList());
+
+private:
+    QXT_DECLARE_PRIVATE(QxtSqlAsyncExecutor)
+};
+
+#endif // QXTSQLASYNCEXECUTOR_H
@@ -0,0 +1,104 @@
+/****************************************************************************
+** Copyright (c) 2006 - 2011, the LibQxt project.
+** See the Qxt AUTHORS file for a list of authors and copyright holders.
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**     * Redistributions of source code must retain the above copyright
+**       notice, this list of conditions and the following disclaimer.
+**     * Redistributions in binary form must reproduce the above copyright
+**       notice, this list of conditions and the following disclaimer in the
+**       documentation and/or other materials provided with the distribution.
+**     * Neither the name of the LibQxt project nor the
+**       names of its contributors may be used to endorse or promote products
+**       derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+** ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+** DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+** (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+** LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+** ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** <http://libqxt.org>  <foundation@libqxt.org>
+*****************************************************************************/
+
+#ifndef QXTSQLASYNCEXECUTOR_P_H
+#define QXTSQLASYNCEXECUTOR_P_H
+
+#include "qxtsqlasyncexecutor.h"
+#include <QSharedData>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInt>
+#include <QQueue>
+
+class QxtSqlAsyncJob : public QSharedData
+{
+public:
+    QxtSqlAsyncJob();
+    ~QxtSqlAsyncJob();
+
+    // called by the worker
+    bool post(QxtSqlPackage* batch);
+    void end(const QSqlError& error);
+
+    QString query;
+    QVariantList values;
+    int batchSize;
+    QAtomicInt canceled;
+
+    // mutex guards everything up to rows
+    QMutex mutex;
+    QWaitCondition ended;
+    // the result, cleared when it is deleted
+    QObject* receiver;
+    // batches already moved to the thread of the receiver
+    QList<QxtSqlPackage*> batches;
+    QSqlError error;
+    bool done;
+
+    // only used by the thread of the result
+    bool finished;
+    int rows;
+};
+
+class QxtSqlAsyncWorker : public QThread
+{
+public:
+    QxtSqlAsyncWorker(QxtSqlAsyncExecutorPrivate* executor);
+
+    QxtSqlAsyncExecutorPrivate* executor;
+
+protected:
+    void run();
+
+private:
+    void execute(QxtSqlAsyncJob* job);
+};
+
+class QxtSqlAsyncExecutorPrivate : public QxtPrivate<QxtSqlAsyncExecutor>
+{
+public:
+    QxtSqlAsyncExecutorPrivate();
+    QXT_DECLARE_PUBLIC(QxtSqlAsyncExecutor)
+
+    QExplicitlySharedDataPointer<QxtSqlAsyncJob> take();
+
+    QString masterName;
+    int batchSize;
+    QList<QxtSqlAsyncWorker*> workers;
+    // mutex guards queue and stopping
+    QMutex mutex;
+    QWaitCondition wake;
+    QQueue<QExplicitlySharedDataPointer<QxtSqlAsyncJob> > queue;
+    bool stopping;
+};
+
+#endif // QXTSQLASYNCEXECUTOR_P_H
@@ -0,0 +1,727 @@
+/****************************************************************************
+** Copyright (c) 2006 - 2011, the LibQxt project.
+** See the Qxt AUTHORS file for a list of authors and copyright holders.
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**     * Redistributions of source code must retain the above copyright
+**       notice, this list of conditions and the following disclaimer.
+**     * Redistributions in binary form must reproduce the above copyright
+**       notice, this list of conditions and the following disclaimer in the
+**       documentation and/or other materials provided with the distribution.
+**     * Neither the name of the LibQxt project nor the
+**       names of its contributors may be used to endorse or promote products
+**       derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+** ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+** DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+** (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+** LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+** ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** <http://libqxt.org>  <foundation@libqxt.org>
+*****************************************************************************/
+
+#include "qxtsqlconnectionpool.h"
+#include "qxtsqlthreadmanager.h"
+#include <QSharedData>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QThread>
+#include <QSqlDriver>
+#include <QSqlError>
+#include <QDebug>
+
+/*!
+\class QxtSqlConnectionPool
+
+\inmodule QxtSql
+
+\brief The QxtSqlConnectionPool class lends open database connections to any thread
+
+Opening a database connection is expensive, and QxtSqlThreadManager opens one
+for every thread that ever touches the database. QxtSqlConnectionPool keeps a
+set of open clones of a master connection instead. A thread borrows one with
+acquire(), uses it, and gives it back by destroying or releasing the returned
+QxtSqlPooledConnection. The next borrower, in whatever thread, gets the same
+open connection. This suits QThreadPool workers and other short lived threads.
+
+\code
+// main thread, after opening the default connection
+QxtSqlConnectionPool pool;
+pool.setMaximumConnections(16);
+
+// any thread
+QxtSqlPooledConnection conn = pool.acquire();
+QSqlQuery query = conn.prepare("SELECT name FROM users WHERE id = ?");
+query.addBindValue(id);
+query.exec();
+\endcode
+
+Between at least minimumConnections() and at most maximumConnections()
+connections are kept. acquire() waits while all of them are borrowed.
+Connections that stayed unused for idleTimeout() are closed the next time
+the pool is used, or by reapIdle(). Before a connection that has not been
+checked for healthCheckInterval() is handed out, it is tested with
+healthCheckQuery() and reopened if the server dropped it.
+
+Each connection caches up to statementCacheSize() prepared queries.
+QxtSqlPooledConnection::prepare() returns the cached query when the same SQL
+text was prepared on that connection before, so the database does not parse
+it again.
+
+Qt requires that a connection is used only by the thread that created it.
+The pool keeps idle connections without a thread and moves them to the
+borrowing thread in acquire(). A connection must be used and released in
+the thread that acquired it, and must never be used by two threads at once.
+
+QxtSqlThreadManager can take its connections from a pool, see
+QxtSqlThreadManager::setPool().
+
+\sa QxtSqlPooledConnection, QxtSqlThreadManager
+*/
+
+/*!
+\class QxtSqlPooledConnection
+
+\inmodule QxtSql
+
+\brief The QxtSqlPooledConnection class is a database connection borrowed from a QxtSqlConnectionPool
+
+The connection goes back to its pool when release() is called or the last
+copy is destroyed. Copies refer to the same borrowed connection. Queries
+obtained from it must not be used after that.
+
+\sa QxtSqlConnectionPool
+*/
+
+class QxtSqlPoolEntry
+{
+public:
+    QxtSqlPoolEntry() : cacheSize(0) {}
+
+    void finishStatements()
+    {
+        QHash<QString, QSqlQuery>::iterator it = statements.begin();
+        for (; it != statements.end(); ++it)
+            it.value().finish();
+    }
+
+    void close()
+    {
+        // the queries and our copy of the handle have to be gone before removeDatabase()
+        statements.clear();
+        recent.clear();
+        if (db.isOpen())
+            db.close();
+        db = QSqlDatabase();
+        QSqlDatabase::removeDatabase(name);
+    }
+
+    QString name;
+    QSqlDatabase db;
+    QHash<QString, QSqlQuery> statements;
+    QList<QString> recent;
+    int cacheSize;
+    QElapsedTimer idleSince;
+    QElapsedTimer checkedSince;
+};
+
+class QxtSqlConnectionPoolPrivate : public QSharedData
+{
+public:
+    QxtSqlConnectionPoolPrivate()
+        : port(-1), precision(QSql::LowPrecisionDouble), minimum(0), maximum(8), idleTimeout(60000),
+          healthCheckInterval(30000), statementCacheSize(32), total(0), serial(0), closed(false) {}
+
+    QxtSqlPoolEntry * create(const QString & name);
+    QString reserve();
+    void unreserve(int count);
+    bool check(QxtSqlPoolEntry * entry, int interval, const QString & query);
+    void checkin(QxtSqlPoolEntry * entry);
+    QList<QxtSqlPoolEntry *> takeExpired();
+    int discard(const QList<QxtSqlPoolEntry *> & entries);
+
+    // the master connection's settings, so connections can be opened in any thread
+    QString masterName;
+    QString driver;
+    QString database;
+    QString user;
+    QString password;
+    QString host;
+    QString options;
+    int port;
+    QSql::NumericalPrecisionPolicy precision;
+
+    int minimum;
+    int maximum;
+    int idleTimeout;
+    int healthCheckInterval;
+    QString healthCheckQuery;
+    int statementCacheSize;
+
+    mutable QMutex mutex;
+    QWaitCondition available;
+    // oldest release first
+    QList<QxtSqlPoolEntry *> idle;
+    // idle, borrowed and currently being opened
+    int total;
+    int serial;
+    bool closed;
+};
+
+class QxtSqlPooledConnectionPrivate : public QSharedData
+{
+public:
+    QxtSqlPooledConnectionPrivate(QxtSqlConnectionPoolPrivate * pool, QxtSqlPoolEntry * entry)
+        : pool(pool), entry(entry) {}
+    ~QxtSqlPooledConnectionPrivate()
+    {
+        release();
+    }
+
+    void release()
+    {
+        if (entry)
+            pool->checkin(entry);
+        entry = 0;
+    }
+
+    QExplicitlySharedDataPointer<QxtSqlConnectionPoolPrivate> pool;
+    QxtSqlPoolEntry * entry;
+};
+
+/*!
+\internal
+Opens a new clone of the master connection in the calling thread. Returns 0 on failure.
+*/
+QxtSqlPoolEntry * QxtSqlConnectionPoolPrivate::create(const QString & name)
+{
+    QxtSqlPoolEntry * entry = new QxtSqlPoolEntry;
+    entry->name = name;
+    entry->db = QSqlDatabase::addDatabase(driver, name);
+    entry->db.setDatabaseName(database);
+    entry->db.setUserName(user);
+    entry->db.setPassword(password);
+    entry->db.setHostName(host);
+    entry->db.setPort(port);
+    entry->db.setConnectOptions(options);
+    entry->db.setNumericalPrecisionPolicy(precision);
+    if (!entry->db.open())
+    {
+        qWarning() << Q_FUNC_INFO
+            << "Failed to open connection to database" << database
+            << ", error: " << entry->db.lastError().text();
+        entry->close();
+        delete entry;
+        return 0;
+    }
+    entry->checkedSince.start();
+    return entry;
+}
+
+/*!
+\internal
+Counts a connection that is about to be opened and returns its name. Must be called with the mutex held.
+*/
+QString QxtSqlConnectionPoolPrivate::reserve()
+{
+    total++;
+    return QString("$qxt$pool_%1$%2").arg(++serial).arg(masterName);
+}
+
+void QxtSqlConnectionPoolPrivate::unreserve(int count)
+{
+    if (count == 0)
+        return;
+    QMutexLocker locker(&mutex);
+    total -= count;
+    available.wakeAll();
+}
+
+/*!
+\internal
+Runs the health check on a connection that was not checked for \a interval msecs and tries to
+reopen it if the check fails.
+*/
+bool QxtSqlConnectionPoolPrivate::check(QxtSqlPoolEntry * entry, int interval, const QString & query)
+{
+    if (interval < 0 || entry->checkedSince.elapsed() < interval)
+        return true;
+
+    bool ok = entry->db.isOpen();
+    if (ok && !query.isEmpty())
+    {
+        QSqlQuery q(entry->db);
+        ok = q.exec(query);
+    }
+    if (!ok)
+    {
+        qWarning() << Q_FUNC_INFO << "Reopening connection" << entry->name
+            << ", error: " << entry->db.lastError().text();
+        entry->statements.clear();
+        entry->recent.clear();
+        entry->db.close();
+        ok = entry->db.open();
+    }
+    entry->checkedSince.restart();
+    return ok;
+}
+
+/*!
+\internal
+Takes a connection back. Called in the thread that used it.
+*/
+void QxtSqlConnectionPoolPrivate::checkin(QxtSqlPoolEntry * entry)
+{
+    entry->finishStatements();
+
+    mutex.lock();
+    if (closed)
+    {
+        mutex.unlock();
+        entry->close();
+        delete entry;
+        unreserve(1);
+        return;
+    }
+    // idle connections belong to no thread, the next borrower pulls the driver into its own
+    entry->db.driver()->moveToThread(0);
+    entry->idleSince.start();
+    idle.append(entry);
+    available.wakeOne();
+    mutex.unlock();
+}
+
+/*!
+\internal
+Removes the connections that stayed idle for too long, keeping the minimum. Must be called with the mutex held.
+*/
+QList<QxtSqlPoolEntry *> QxtSqlConnectionPoolPrivate::takeExpired()
+{
+    QList<QxtSqlPoolEntry *> expired;
+    if (idleTimeout < 0)
+        return expired;
+    while (!idle.isEmpty() && total - expired.count() > minimum && idle.first()->idleSince.elapsed() >= idleTimeout)
+        expired.append(idle.takeFirst());
+    return expired;
+}
+
+/*!
+\internal
+Closes \a entries outside of the mutex.
+*/
+int QxtSqlConnectionPoolPrivate::discard(const QList<QxtSqlPoolEntry *> & entries)
+{
+    foreach (QxtSqlPoolEntry * entry, entries)
+    {
+        entry->close();
+        delete entry;
+    }
+    unreserve(entries.count());
+    return entries.count();
+}
+
+/*!
+Constructs a pool of clones of the connection named \a masterName, which must already exist.
+The pool starts out empty. Construct it in the thread owning the master connection.
+*/
+QxtSqlConnectionPool::QxtSqlConnectionPool(const QString & masterName)
+    : qxt_d(new QxtSqlConnectionPoolPrivate)
+{
+    QSqlDatabase master = QSqlDatabase::database(masterName, false);
+    if (!master.isValid())
+        qWarning() << Q_FUNC_INFO << "No database connection named" << masterName;
+    qxt_d->masterName = masterName;
+    qxt_d->driver = master.driverName();
+    qxt_d->database = master.databaseName();
+    qxt_d->user = master.userName();
+    qxt_d->password = master.password();
+    qxt_d->host = master.hostName();
+    qxt_d->port = master.port();
+    qxt_d->options = master.connectOptions();
+    qxt_d->precision = master.numericalPrecisionPolicy();
+}
+
+/*!
+Destroys the pool and closes its idle connections. Borrowed connections are closed when they are released.
+*/
+QxtSqlConnectionPool::~QxtSqlConnectionPool()
+{
+    if (QxtSqlThreadManager::pool(qxt_d->masterName) == this)
+        QxtSqlThreadManager::setPool(0, qxt_d->masterName);
+
+    qxt_d->mutex.lock();
+    qxt_d->closed = true;
+    QList<QxtSqlPoolEntry *> idle = qxt_d->idle;
+    qxt_d->idle.clear();
+    qxt_d->mutex.unlock();
+    qxt_d->discard(idle);
+}
+
+/*!
+Returns the name of the connection the pool clones.
+*/
+QString QxtSqlConnectionPool::masterName() const
+{
+    return qxt_d->masterName;
+}
+
+/*!
+Returns the number of connections kept open even when idle. The default is 0.
+*/
+int QxtSqlConnectionPool::minimumConnections() const
+{
+    QMutexLocker locker(&qxt_d->mutex);
+    return qxt_d->minimum;
+}
+
+/*!
+Sets the number of connections kept open even when idle to \a count
+and opens the missing ones right away.
+*/
+void QxtSqlConnectionPool::setMinimumConnections(int count)
+{
+    QxtSqlConnectionPoolPrivate & d = *qxt_d;
+    d.mutex.lock();
+    d.minimum = qMax(0, count);
+    d.mutex.unlock();
+
+    forever
+    {
+        d.mutex.lock();
+        if (d.closed || d.total >= qMin(d.minimum, d.maximum))
+        {
+            d.mutex.unlock();
+            break;
+        }
+        const QString name = d.reserve();
+        d.mutex.unlock();
+
+        QxtSqlPoolEntry * entry = d.create(name);
+        if (!entry)
+        {
+            d.unreserve(1);
+            break;
+        }
+        d.checkin(entry);
+    }
+}
+
+/*!
+Returns the largest number of connections the pool opens. The default is 8.
+*/
+int QxtSqlConnectionPool::maximumConnections() const
+{
+    QMutexLocker locker(&qxt_d->mutex);
+    return qxt_d->maximum;
+}
+
+/*!
+Sets the largest number of connections the pool opens to \a count.
+*/
+void QxtSqlConnectionPool::setMaximumConnections(int count)
+{
+    QMutexLocker locker(&qxt_d->mutex);
+    qxt_d->maximum = qMax(1, count);
+    qxt_d->available.wakeAll();
+}
+
+/*!
+Returns the time in milliseconds after which an unused connection is closed. The default is one minute.
+*/
+int QxtSqlConnectionPool::idleTimeout() const
+{
+    QMutexLocker locker(&qxt_d->mutex);
+    return qxt_d->idleTimeout;
+}
+
+/*!
+Closes connections beyond minimumConnections() that were not used for \a msecs milliseconds.
+A negative value keeps them forever.
+*/
+void QxtSqlConnectionPool::setIdleTimeout(int msecs)
+{
+    QMutexLocker locker(&qxt_d->mutex);
+    qxt_d->idleTimeout = msecs;
+}
+
+/*!
+Returns the time in milliseconds after which a connection is checked again before it is lent out.
+The default is 30 seconds.
+*/
+int QxtSqlConnectionPool::healthCheckInterval() const
+{
+    QMutexLocker locker(&qxt_d->mutex);
+    return qxt_d->healthCheckInterval;
+}
+
+/*!
+Checks a connection before lending it out if it was not checked for \a msecs milliseconds.
+0 checks every time, a negative value never.
+*/
+void QxtSqlConnectionPool::setHealthCheckInterval(int msecs)
+{
+    QMutexLocker locker(&qxt_d->mutex);
+    qxt_d->healthCheckInterval = msecs;
+}
+
+/*!
+Returns the statement run to check a connection. Empty by default, which only checks that the connection is open.
+*/
+QString QxtSqlConnectionPool::healthCheckQuery() const
+{
+    QMutexLocker locker(&qxt_d->mutex);
+    return qxt_d->healthCheckQuery;
+}
+
+/*!
+Sets the statement run to check a connection to \a sql, for example \c {SELECT 1}.
+A connection on which it fails is reopened.
+*/
+void QxtSqlConnectionPool::setHealthCheckQuery(const QString & sql)
+{
+    QMutexLocker locker(&qxt_d->mutex);
+    qxt_d->healthCheckQuery = sql;
+}
+
+/*!
+Returns how many prepared queries each connection keeps. The default is 32.
+*/
+int QxtSqlConnectionPool::statementCacheSize() const
+{
+    QMutexLocker locker(&qxt_d->mutex);
+    return qxt_d->statementCacheSize;
+}
+
+/*!
+Keeps up to \a count prepared queries per connection, dropping the least recently used.
+0 disables the cache. Applies to connections acquired afterwards.
+*/
+void QxtSqlConnectionPool::setStatementCacheSize(int count)
+{
+    QMutexLocker locker(&qxt_d->mutex);
+    qxt_d->statementCacheSize = qMax(0, count);
+}
+
+/*!
+Borrows a connection for the calling thread. The most recently returned idle connection is
+preferred; if there is none and fewer than maximumConnections() are open, a new one is opened.
+Otherwise waits up to \a msecs milliseconds, or forever if \a msecs is negative, for one to come back.
+
+Returns an invalid QxtSqlPooledConnection on timeout or if no connection could be opened.
+*/
+QxtSqlPooledConnection QxtSqlConnectionPool::acquire(int msecs)
+{
+    QxtSqlConnectionPoolPrivate & d = *qxt_d;
+    QElapsedTimer waited;
+    waited.start();
+
+    QxtSqlPoolEntry * entry = 0;
+    QString name;
+
+    d.mutex.lock();
+    const QList<QxtSqlPoolEntry *> expired = d.takeExpired();
+    while (!d.closed)
+    {
+        if (!d.idle.isEmpty())
+        {
+            // the last one returned is the most likely to be alive and leaves the others to expire
+            entry = d.idle.takeLast();
+            break;
+        }
+        if (d.total < d.maximum)
+        {
+            name = d.reserve();
+            break;
+        }
+        if (msecs < 0)
+        {
+            d.available.wait(&d.mutex);
+        }
+        else
+        {
+            const qint64 left = msecs - waited.elapsed();
+            if (left <= 0 || !d.available.wait(&d.mutex, ulong(left)))
+                break;
+        }
+    }
+    const int interval = d.healthCheckInterval;
+    const QString query = d.healthCheckQuery;
+    const int cacheSize = d.statementCacheSize;
+    d.mutex.unlock();
+    d.discard(expired);
+
+    if (entry)
+    {
+        entry->db.driver()->moveToThread(QThread::currentThread());
+        if (!d.check(entry, interval, query))
+        {
+            d.discard(QList<QxtSqlPoolEntry *>() << entry);
+            return QxtSqlPooledConnection();
+        }
+    }
+    else if (!name.isEmpty())
+    {
+        entry = d.create(name);
+        if (!entry)
+        {
+            d.unreserve(1);
+            return QxtSqlPooledConnection();
+        }
+    }
+    else
+    {
+        return QxtSqlPooledConnection();
+    }
+
+    if (entry->cacheSize != cacheSize)
+    {
+        entry->statements.clear();
+        entry->recent.clear();
+        entry->cacheSize = cacheSize;
+    }
+
+    QxtSqlPooledConnection connection;
+    connection.qxt_d = new QxtSqlPooledConnectionPrivate(qxt_d.data(), entry);
+    return connection;
+}
+
+/*!
+Returns the number of open connections, idle and borrowed.
+*/
+int QxtSqlConnectionPool::connectionCount() const
+{
+    QMutexLocker locker(&qxt_d->mutex);
+    return qxt_d->total;
+}
+
+/*!
+Returns the number of open connections nobody borrowed.
+*/
+int QxtSqlConnectionPool::idleCount() const
+{
+    QMutexLocker locker(&qxt_d->mutex);
+    return qxt_d->idle.count();
+}
+
+/*!
+Closes the connections that exceeded idleTimeout(), keeping minimumConnections(),
+and returns how many were closed. acquire() does this as well, call it from a timer
+to shrink a pool that is not used at all.
+*/
+int QxtSqlConnectionPool::reapIdle()
+{
+    qxt_d->mutex.lock();
+    const QList<QxtSqlPoolEntry *> expired = qxt_d->takeExpired();
+    qxt_d->mutex.unlock();
+    return qxt_d->discard(expired);
+}
+
+/*!
+Constructs an invalid connection.
+*/
+QxtSqlPooledConnection::QxtSqlPooledConnection()
+{
+}
+
+/*!
+Constructs a copy of \a other, referring to the same borrowed connection.
+*/
+QxtSqlPooledConnection::QxtSqlPooledConnection(const QxtSqlPooledConnection & other) : qxt_d(other.qxt_d)
+{
+}
+
+/*!
+Destroys the handle. The connection goes back to the pool with its last handle.
+*/
+QxtSqlPooledConnection::~QxtSqlPooledConnection()
+{
+}
+
+/*!
+Makes this handle refer to the same borrowed connection as \a other.
+*/
+QxtSqlPooledConnection & QxtSqlPooledConnection::operator=(const QxtSqlPooledConnection & other)
+{
+    qxt_d = other.qxt_d;
+    return *this;
+}
+
+/*!
+Returns \c true if this handle holds a borrowed connection.
+*/
+bool QxtSqlPooledConnection::isValid() const
+{
+    return qxt_d && qxt_d->entry;
+}
+
+/*!
+Returns the name of the connection, as used by QSqlDatabase::database().
+*/
+QString QxtSqlPooledConnection::connectionName() const
+{
+    return isValid() ? qxt_d->entry->name : QString();
+}
+
+/*!
+Returns the connection, or an invalid QSqlDatabase.
+*/
+QSqlDatabase QxtSqlPooledConnection::database() const
+{
+    return isValid() ? qxt_d->entry->db : QSqlDatabase();
+}
+
+/*!
+Returns a query prepared with \a sql on this connection. If the same text was prepared on the
+connection before and is still in its statement cache, the cached query is returned with its
+previous result discarded, otherwise the query is prepared now and cached.
+
+If preparing fails, the returned query carries the error and is not cached.
+*/
+QSqlQuery QxtSqlPooledConnection::prepare(const QString & sql)
+{
+    if (!isValid())
+        return QSqlQuery();
+
+    QxtSqlPoolEntry * entry = qxt_d->entry;
+    QHash<QString, QSqlQuery>::iterator it = entry->statements.find(sql);
+    if (it != entry->statements.end())
+    {
+        if (entry->recent.first() != sql)
+        {
+            entry->recent.removeOne(sql);
+            entry->recent.prepend(sql);
+        }
+        it.value().finish();
+        return it.value();
+    }
+
+    QSqlQuery query(entry->db);
+    if (!query.prepare(sql) || entry->cacheSize <= 0)
+        return query;
+    while (entry->recent.count() >= entry->cacheSize)
+        entry->statements.remove(entry->recent.takeLast());
+    entry->statements.insert(sql, query);
+    entry->recent.prepend(sql);
+    return query;
+}
+
+/*!
+Gives the connection back to its pool. All copies of this handle become invalid.
+Must be called in the thread that acquired the connection.
+*/
+void QxtSqlPooledConnection::release()
+{
+    if (qxt_d)
+        qxt_d->release();
+}
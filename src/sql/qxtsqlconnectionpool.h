@@ -0,0 +1,97 @@
+/****************************************************************************
+** Copyright (c) 2006 - 2011, the LibQxt project.
+** See the Qxt AUTHORS file for a list of authors and copyright holders.
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**     * Redistributions of source code must retain the above copyright
+**       notice, this list of conditions and the following disclaimer.
+**     * Redistributions in binary form must reproduce the above copyright
+**       notice, this list of conditions and the following disclaimer in the
+**       documentation and/or other materials provided with the distribution.
+**     * Neither the name of the LibQxt project nor the
+**       names of its contributors may be used to endorse or promote products
+**       derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+** ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+** DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+** (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+** LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+** ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** <http://libqxt.org>  <foundation@libqxt.org>
+*****************************************************************************/
+
+#ifndef QXTSQLCONNECTIONPOOL_H
+#define QXTSQLCONNECTIONPOOL_H
+
+#include <QExplicitlySharedDataPointer>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+#include <qxtglobal.h>
+
+class QxtSqlConnectionPoolPrivate;
+class QxtSqlPooledConnectionPrivate;
+
+class QXT_SQL_EXPORT QxtSqlPooledConnection
+{
+public:
+    QxtSqlPooledConnection();
+    QxtSqlPooledConnection(const QxtSqlPooledConnection & other);
+    ~QxtSqlPooledConnection();
+    QxtSqlPooledConnection & operator=(const QxtSqlPooledConnection & other);
+
+    bool isValid() const;
+    QString connectionName() const;
+    QSqlDatabase database() const;
+    QSqlQuery prepare(const QString & sql);
+
+    void release();
+
+private:
+    friend class QxtSqlConnectionPool;
+    QExplicitlySharedDataPointer<QxtSqlPooledConnectionPrivate> qxt_d;
+};
+
+class QXT_SQL_EXPORT QxtSqlConnectionPool
+{
+    Q_DISABLE_COPY(QxtSqlConnectionPool)
+
+public:
+    explicit QxtSqlConnectionPool(const QString & masterName =
+            QLatin1String(QSqlDatabase::defaultConnection));
+    ~QxtSqlConnectionPool();
+
+    QString masterName() const;
+
+    int minimumConnections() const;
+    void setMinimumConnections(int count);
+    int maximumConnections() const;
+    void setMaximumConnections(int count);
+    int idleTimeout() const;
+    void setIdleTimeout(int msecs);
+    int healthCheckInterval() const;
+    void setHealthCheckInterval(int msecs);
+    QString healthCheckQuery() const;
+    void setHealthCheckQuery(const QString & sql);
+    int statementCacheSize() const;
+    void setStatementCacheSize(int count);
+
+    QxtSqlPooledConnection acquire(int msecs = -1);
+
+    int connectionCount() const;
+    int idleCount() const;
+    int reapIdle();
+
+private:
+    QExplicitlySharedDataPointer<QxtSqlConnectionPoolPrivate> qxt_d;
+};
+
+#endif // QXTSQLCONNECTIONPOOL_H
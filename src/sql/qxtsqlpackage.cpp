@@ -33,9 +33,12 @@
 #include <QBuffer>
 #include <QDataStream>
 #include <QSqlRecord>
+#include <QSqlField>
 #include <QVector>
 #include <QDebug>
 #include <QVariant>
+#include <QtEndian>
+#include <cstring>
 
 /*!
 \class QxtSqlPackage
@@ -48,16 +51,22 @@
 Sometimes you want to send sql results over network or store them into files.
 QxtSqlPackage can provide you a storage that is still valid after the actual QSqlQuery has been destroyed.
 for confidence the interface is similar to QSqlQuery.
+
+The result is stored column by column: integers and booleans as 64 bit integers, floating point numbers
+as doubles, binary data as bytes and everything else as UTF-8 text, each column with a bitmap of its
+NULL cells and the column names stored only once. data() writes this layout almost as is, so a
+package is compact in memory and on the wire and keeps the type of its values, see variant().
+Copies of a package share the stored result until one of them is changed.
 */
 
 
 /*!
-\fn  bool QxtSqlPackage::isValid()
+\fn  bool QxtSqlPackage::isValid() const
 \brief determinates if the package curently points to a valid row
 */
 
 /*!
-\fn int QxtSqlPackage::at()
+\fn int QxtSqlPackage::at() const
 \brief curent pointer position
 */
 
@@ -86,7 +95,7 @@ while (query.next())
 */
 
 /*!
-\fn QString QxtSqlPackage::value(const QString& key);
+\fn QString QxtSqlPackage::value(const QString& key) const;
 \brief return a column in current row
 in contrast to QSqlQuery you have to provide the name of the \a key.
 
@@ -96,6 +105,39 @@ QString name = query.value("name");
 \endcode
 */
 
+/*!
+\fn QVariant QxtSqlPackage::variant(const QString& key) const;
+\brief return the column \a key in current row with its type
+integer columns are returned as qlonglong, floating point columns as double,
+binary columns as QByteArray and all others as QString. A column holding unsigned values
+beyond the range of qlonglong is returned as QString. NULL is returned as an invalid QVariant.
+*/
+
+/*!
+\fn QVariant QxtSqlPackage::variant(int row, int column) const;
+\brief return the cell at \a row and \a column with its type
+*/
+
+/*!
+\fn bool QxtSqlPackage::isNull(int row, int column) const;
+\brief returns true if the cell at \a row and \a column is NULL
+*/
+
+/*!
+\fn int QxtSqlPackage::columnCount() const;
+\brief Returns the number of columns stored
+*/
+
+/*!
+\fn QString QxtSqlPackage::columnName(int column) const;
+\brief Returns the name of \a column
+*/
+
+/*!
+\fn int QxtSqlPackage::columnIndex(const QString& name) const;
+\brief Returns the index of the column called \a name, or -1
+*/
+
 /*!
 \fn void QxtSqlPackage::insert(QSqlQuery query);
 
@@ -108,6 +150,26 @@ QxSqlPackage::insert(QSqlQuery::exec("select name,foo,bar from table;"));
 \endcode
 */
 
+/*!
+\fn int QxtSqlPackage::insert(QSqlQuery& query, int maxRows);
+
+\brief read at most \a maxRows rows from \a query
+
+Like insert(QSqlQuery) but stops after \a maxRows rows, a negative \a maxRows reads all of them.
+The \a query is left on the first row that was not read, so calling this again reads the next rows.
+Returns the number of rows read.
+*/
+
+/*!
+\fn bool QxtSqlPackage::append(const QxtSqlPackage& other);
+
+\brief append the rows of \a other
+
+\a other must have the same columns as this package, for example a later batch of the same query.
+A column whose values do not fit its type any more is converted as in insert().
+Returns false if the number of columns differs. An empty package takes the columns of \a other.
+*/
+
 /*!
 \fn int QxtSqlPackage::count() const;
 \brief Returns the number of rows stored
@@ -116,20 +178,25 @@ QxSqlPackage::insert(QSqlQuery::exec("select name,foo,bar from table;"));
 /*!
 \fn QByteArray QxtSqlPackage::data() const;
 \brief Returns serialised data
+
+The columns are written one after the other in little endian byte order. Text and binary
+columns are a table of end offsets followed by the bytes of all cells.
 */
 
 /*!
 \fn void QxtSqlPackage::setData(const QByteArray& data);
 \brief Deserialise \a data
+
+Also reads the format written by QxtSqlPackage before 0.7, where every row was a QHash.
 */
 
 /*!
-\fn QHash<QString,QString> QxtSqlPackage::hash(int index);
+\fn QHash<QString,QString> QxtSqlPackage::hash(int index) const;
 \brief return a specific \a index as Hash
 */
 
 /*!
-\fn QHash<QString,QString> QxtSqlPackage::hash();
+\fn QHash<QString,QString> QxtSqlPackage::hash() const;
 \brief return the curent row as Hash
 */
 
@@ -138,10 +205,246 @@ QxSqlPackage::insert(QSqlQuery::exec("select name,foo,bar from table;"));
 \brief copy \a other
 */
 
+class QxtSqlPackageColumn
+{
+public:
+    enum Type { Int64 = 0, Double = 1, String = 2, Blob = 3 };
+
+    QxtSqlPackageColumn() : type(String), hasNulls(false) {}
+
+    static Type typeFor(QVariant::Type t)
+    {
+        switch (t)
+        {
+        case QVariant::Bool:
+        case QVariant::Int:
+        case QVariant::UInt:
+        case QVariant::LongLong:
+        case QVariant::ULongLong:
+            return Int64;
+        case QVariant::Double:
+            return Double;
+        case QVariant::ByteArray:
+            return Blob;
+        default:
+            return String;
+        }
+    }
+
+    void reserve(int rows)
+    {
+        if (type == Int64)
+            ints.reserve(rows);
+        else if (type == Double)
+            doubles.reserve(rows);
+        else
+            ends.reserve(rows);
+    }
+
+    void append(int row, const QVariant& v)
+    {
+        if (v.isNull())
+        {
+            setNull(row);
+            appendDefault();
+            return;
+        }
+        Type t = typeFor(v.type());
+        // an unsigned value that does not fit into qint64 would come back negative
+        if (v.type() == QVariant::ULongLong && v.toULongLong() > quint64(Q_INT64_C(0x7FFFFFFFFFFFFFFF)))
+            t = String;
+        if (type == Int64 && t != Int64)
+            demote(t == Double ? Double : String);
+        else if (type == Double && t != Int64 && t != Double)
+            demote(String);
+
+        switch (type)
+        {
+        case Int64:
+            ints.append(v.toLongLong());
+            break;
+        case Double:
+            doubles.append(v.toDouble());
+            break;
+        case String:
+            bytes.append(v.toString().toUtf8());
+            ends.append(bytes.size());
+            break;
+        case Blob:
+            bytes.append(v.toByteArray());
+            ends.append(bytes.size());
+            break;
+        }
+    }
+
+    bool isNull(int row) const
+    {
+        return hasNulls && row / 32 < nulls.size() && (nulls.at(row / 32) & (1u << (row % 32)));
+    }
+
+    QVariant value(int row) const
+    {
+        if (isNull(row))
+            return QVariant();
+        switch (type)
+        {
+        case Int64:
+            return QVariant(qlonglong(ints.at(row)));
+        case Double:
+            return QVariant(doubles.at(row));
+        case Blob:
+            return QVariant(cell(row));
+        default:
+            return QVariant(text(row));
+        }
+    }
+
+    QString text(int row) const
+    {
+        if (isNull(row))
+            return QString();
+        switch (type)
+        {
+        case Int64:
+            return QString::number(ints.at(row));
+        case Double:
+            return QVariant(doubles.at(row)).toString();
+        case Blob:
+            return QVariant(cell(row)).toString();
+        default:
+        {
+            const int begin = row ? ends.at(row - 1) : 0;
+            return QString::fromUtf8(bytes.constData() + begin, ends.at(row) - begin);
+        }
+        }
+    }
+
+    QByteArray cell(int row) const
+    {
+        const int begin = row ? ends.at(row - 1) : 0;
+        return bytes.mid(begin, ends.at(row) - begin);
+    }
+
+    void setNull(int row)
+    {
+        if (nulls.size() <= row / 32)
+            nulls.resize(row / 32 + 1);
+        nulls[row / 32] |= 1u << (row % 32);
+        hasNulls = true;
+    }
+
+    QString name;
+    Type type;
+    bool hasNulls;
+    QVector<qint64> ints;
+    QVector<double> doubles;
+    // text and binary cells back to back, ends[i] is the end of row i
+    QByteArray bytes;
+    QVector<int> ends;
+    // one bit per row, only allocated up to the last NULL
+    QVector<quint32> nulls;
+
+private:
+    void appendDefault()
+    {
+        if (type == Int64)
+            ints.append(0);
+        else if (type == Double)
+            doubles.append(0);
+        else
+            ends.append(bytes.size());
+    }
+
+    // a driver may return different types in one column, sqlite does. numbers stay numbers where possible
+    void demote(Type target)
+    {
+        const int rows = type == Int64 ? ints.count() : type == Double ? doubles.count() : ends.count();
+        if (target == Double)
+        {
+            for (int i = 0; i < rows; i++)
+                doubles.append(double(ints.at(i)));
+            ints.clear();
+            type = Double;
+            return;
+        }
+        QxtSqlPackageColumn text;
+        text.type = String;
+        for (int i = 0; i < rows; i++)
+        {
+            if (!isNull(i))
+                text.bytes.append(this->text(i).toUtf8());
+            text.ends.append(text.bytes.size());
+        }
+        ints.clear();
+        doubles.clear();
+        bytes = text.bytes;
+        ends = text.ends;
+        type = String;
+    }
+
+public:
+    void append(int rows, const QxtSqlPackageColumn& other, int otherRows)
+    {
+        QxtSqlPackageColumn tail = other;
+        if (type != tail.type)
+        {
+            const bool numbers = type <= Double && tail.type <= Double;
+            if (type != (numbers ? Double : String))
+                demote(numbers ? Double : String);
+            if (tail.type != type)
+                tail.demote(type);
+        }
+
+        for (int i = 0; tail.hasNulls && i < otherRows; i++)
+        {
+            if (tail.isNull(i))
+                setNull(rows + i);
+        }
+        switch (type)
+        {
+        case Int64:
+            ints += tail.ints;
+            break;
+        case Double:
+            doubles += tail.doubles;
+            break;
+        default:
+        {
+            const int offset = bytes.size();
+            bytes += tail.bytes;
+            ends.reserve(rows + otherRows);
+            for (int i = 0; i < otherRows; i++)
+                ends.append(tail.ends.at(i) + offset);
+            break;
+        }
+        }
+    }
+};
+
+class QxtSqlPackageData : public QSharedData
+{
+public:
+    QxtSqlPackageData() : rows(0) {}
+
+    int rows;
+    QVector<QxtSqlPackageColumn> columns;
+    QHash<QString, int> index;
+
+    void addColumn(const QString& name, QxtSqlPackageColumn::Type type)
+    {
+        QxtSqlPackageColumn column;
+        column.name = name;
+        column.type = type;
+        if (!index.contains(name))
+            index.insert(name, columns.count());
+        columns.append(column);
+    }
+};
+
 /*!
 Constructs a QxtSqlPackage with \a parent.
 */
-QxtSqlPackage::QxtSqlPackage(QObject *parent) : QObject(parent)
+QxtSqlPackage::QxtSqlPackage(QObject *parent) : QObject(parent), qxt_d(new QxtSqlPackageData)
 {
     record = -1;
 }
@@ -149,25 +452,30 @@ QxtSqlPackage::QxtSqlPackage(QObject *parent) : QObject(parent)
 /*!
 Constructs a copy of \a other with \a parent.
 */
-QxtSqlPackage::QxtSqlPackage(const QxtSqlPackage & other, QObject *parent) : QObject(parent)
+QxtSqlPackage::QxtSqlPackage(const QxtSqlPackage & other, QObject *parent) : QObject(parent), qxt_d(other.qxt_d)
 {
     record = -1;
+}
 
-    setData(other.data());
+/*!
+Destroys the package.
+*/
+QxtSqlPackage::~QxtSqlPackage()
+{
 }
 
 /*!
 Returns \c true if the package is valid, \c false otherwise.
 */
-bool QxtSqlPackage::isValid()
+bool QxtSqlPackage::isValid() const
 {
-    if ((record >= 0) && (record < map.count()))
+    if ((record >= 0) && (record < count()))
         return true;
     else
         return false;
 }
 
-int QxtSqlPackage::at()
+int QxtSqlPackage::at() const
 {
     return record;
 }
@@ -175,7 +483,7 @@ int QxtSqlPackage::at()
 bool QxtSqlPackage::next()
 {
     record++;
-    if (record > (map.count() - 1))
+    if (record > (count() - 1))
     {
         last();
         return false;
@@ -186,7 +494,7 @@ bool QxtSqlPackage::next()
 
 bool QxtSqlPackage::last()
 {
-    record = map.count() - 1;
+    record = count() - 1;
     if (record >= 0)
         return true;
     else
@@ -195,7 +503,7 @@ bool QxtSqlPackage::last()
 
 bool QxtSqlPackage::first()
 {
-    if (map.count())
+    if (count())
     {
         record = 0;
         return true;
@@ -207,73 +515,233 @@ bool QxtSqlPackage::first()
     }
 }
 
-QString QxtSqlPackage::value(const QString& key)
+QString QxtSqlPackage::value(const QString& key) const
+{
+    const int column = columnIndex(key);
+    if (!isValid() || column < 0) return QString();
+
+    return qxt_d->columns.at(column).text(record);
+}
+
+QVariant QxtSqlPackage::variant(const QString& key) const
+{
+    return variant(record, columnIndex(key));
+}
+
+QVariant QxtSqlPackage::variant(int row, int column) const
+{
+    if (row < 0 || row >= count() || column < 0 || column >= columnCount())
+        return QVariant();
+    return qxt_d->columns.at(column).value(row);
+}
+
+bool QxtSqlPackage::isNull(int row, int column) const
+{
+    if (row < 0 || row >= count() || column < 0 || column >= columnCount())
+        return true;
+    return qxt_d->columns.at(column).isNull(row);
+}
+
+int QxtSqlPackage::columnCount() const
 {
-    if ((record < 0) || !map.count()) return QString();
+    return qxt_d->columns.count();
+}
 
-    return map.at(record).value(key);
+QString QxtSqlPackage::columnName(int column) const
+{
+    if (column < 0 || column >= columnCount())
+        return QString();
+    return qxt_d->columns.at(column).name;
+}
+
+int QxtSqlPackage::columnIndex(const QString& name) const
+{
+    return qxt_d->index.value(name, -1);
 }
 
 void QxtSqlPackage::insert(QSqlQuery query)
 {
-    map.clear();
+    insert(query, -1);
+}
+
+int QxtSqlPackage::insert(QSqlQuery& query, int maxRows)
+{
+    qxt_d = new QxtSqlPackageData;
     record = -1;
+    QxtSqlPackageData& d = *qxt_d;
 
     /*query will be invalid if next is not called first*/
     if (!query.isValid())
         query.next();
 
+    /*first create one column per field, typed by what the driver reports*/
     QSqlRecord infoRecord = query.record();
     int iNumCols = infoRecord.count();
-    QVector<QString> tableMap = QVector<QString>(iNumCols);
-
-    /*first create a map of index->colname pairs*/
+    const int expected = maxRows < 0 ? query.size() : qMin(query.size(), maxRows);
     for (int iLoop = 0; iLoop < iNumCols; iLoop++)
     {
-        tableMap[iLoop] = infoRecord.fieldName(iLoop);
+        d.addColumn(infoRecord.fieldName(iLoop), QxtSqlPackageColumn::typeFor(infoRecord.field(iLoop).type()));
+        if (expected > 0)
+            d.columns[iLoop].reserve(expected);
     }
 
-    /*now use this created map to get column names
-     *this should be faster than querying the QSqlRecord every time
-     *but that depends on the databasetype and size of the table (number of rows and cols)
-     */
-    do
+    QxtSqlPackageColumn* columns = d.columns.data();
+    while (d.rows != maxRows && query.isValid())
     {
-        QHash<QString, QString> hash;
         for (int iColLoop = 0; iColLoop < iNumCols; iColLoop++)
-        {
-            hash[tableMap[iColLoop]] = query.value(iColLoop).toString();
-        }
-        map.append(hash);
+            columns[iColLoop].append(d.rows, query.value(iColLoop));
+        d.rows++;
+        query.next();
+    }
+    return d.rows;
+}
 
+bool QxtSqlPackage::append(const QxtSqlPackage& other)
+{
+    if (!columnCount())
+    {
+        qxt_d = other.qxt_d;
+        return true;
     }
-    while (query.next());
+    if (other.columnCount() != columnCount())
+        return false;
+
+    QxtSqlPackageData& d = *qxt_d;
+    const QxtSqlPackageData& tail = *other.qxt_d;
+    for (int column = 0; column < d.columns.count(); column++)
+        d.columns[column].append(d.rows, tail.columns.at(column), tail.rows);
+    d.rows += tail.rows;
+    return true;
 }
 
 int QxtSqlPackage::count() const
 {
-    return map.count();
+    return qxt_d->rows;
 }
 
-QByteArray QxtSqlPackage::data() const
-{
-    QBuffer buff;
-    buff.open(QBuffer::WriteOnly);
-    QDataStream stream(&buff);
+static const char qxt_sqlPackageMagic[4] = { 'Q', 'X', 'S', 'P' };
+static const quint8 qxt_sqlPackageVersion = 1;
 
-    stream << count();
-    for (int i = 0; i < count();i++)
-        stream << map.at(i);
+template<class T>
+static void qxt_sqlPackageWrite(QByteArray& out, T value)
+{
+    const int at = out.size();
+    out.resize(at + int(sizeof(T)));
+    qToLittleEndian<T>(value, reinterpret_cast<uchar*>(out.data() + at));
+}
 
-    buff.close();
-    return buff.data();
+template<class T>
+static void qxt_sqlPackageWriteArray(QByteArray& out, const T* values, int count)
+{
+    const int at = out.size();
+    out.resize(at + count * int(sizeof(T)));
+    uchar* p = reinterpret_cast<uchar*>(out.data() + at);
+    for (int i = 0; i < count; i++, p += sizeof(T))
+        qToLittleEndian<T>(values[i], p);
 }
 
-void QxtSqlPackage::setData(const QByteArray& data)
+class QxtSqlPackageReader
 {
-    map.clear();
-    record = -1;
+public:
+    QxtSqlPackageReader(const QByteArray& data) : p(data.constData()), end(data.constData() + data.size()), ok(true) {}
+
+    template<class T>
+    T read()
+    {
+        if (!take(sizeof(T)))
+            return T();
+        return qFromLittleEndian<T>(reinterpret_cast<const uchar*>(p - sizeof(T)));
+    }
 
+    template<class T>
+    void readArray(QVector<T>& values, int count)
+    {
+        if (count < 0 || (end - p) / qint64(sizeof(T)) < count || !take(count * sizeof(T)))
+        {
+            ok = false;
+            return;
+        }
+        values.resize(count);
+        const uchar* q = reinterpret_cast<const uchar*>(p - count * sizeof(T));
+        for (int i = 0; i < count; i++, q += sizeof(T))
+            values[i] = qFromLittleEndian<T>(q);
+    }
+
+    QByteArray readBytes(quint32 size)
+    {
+        if (!take(size))
+            return QByteArray();
+        return QByteArray(p - size, int(size));
+    }
+
+    const char* p;
+    const char* end;
+    bool ok;
+
+private:
+    bool take(quint64 size)
+    {
+        if (!ok || quint64(end - p) < size)
+        {
+            ok = false;
+            return false;
+        }
+        p += size;
+        return true;
+    }
+};
+
+QByteArray QxtSqlPackage::data() const
+{
+    const QxtSqlPackageData& d = *qxt_d;
+    QByteArray out;
+    out.append(qxt_sqlPackageMagic, 4);
+    qxt_sqlPackageWrite<quint8>(out, qxt_sqlPackageVersion);
+    qxt_sqlPackageWrite<quint32>(out, d.rows);
+    qxt_sqlPackageWrite<quint32>(out, d.columns.count());
+
+    const int words = (d.rows + 31) / 32;
+    foreach (const QxtSqlPackageColumn& column, d.columns)
+    {
+        const QByteArray name = column.name.toUtf8();
+        qxt_sqlPackageWrite<quint32>(out, name.size());
+        out.append(name);
+        qxt_sqlPackageWrite<quint8>(out, column.type);
+        qxt_sqlPackageWrite<quint8>(out, column.hasNulls);
+        if (column.hasNulls)
+        {
+            QVector<quint32> nulls = column.nulls;
+            nulls.resize(words);
+            qxt_sqlPackageWriteArray<quint32>(out, nulls.constData(), words);
+        }
+
+        switch (column.type)
+        {
+        case QxtSqlPackageColumn::Int64:
+            qxt_sqlPackageWriteArray<qint64>(out, column.ints.constData(), d.rows);
+            break;
+        case QxtSqlPackageColumn::Double:
+        {
+            QVector<quint64> bits(d.rows);
+            ::memcpy(bits.data(), column.doubles.constData(), d.rows * sizeof(double));
+            qxt_sqlPackageWriteArray<quint64>(out, bits.constData(), d.rows);
+            break;
+        }
+        default:
+            qxt_sqlPackageWriteArray<qint32>(out, column.ends.constData(), d.rows);
+            qxt_sqlPackageWrite<quint32>(out, column.bytes.size());
+            out.append(column.bytes);
+            break;
+        }
+    }
+    return out;
+}
+
+/*
+    reads the format of QxtSqlPackage 0.6, a row count followed by one QHash per row
+*/
+static void qxt_sqlPackageReadHashes(QxtSqlPackageData& d, const QByteArray& data)
+{
     QBuffer buff;
     buff.setData(data);
     buff.open(QBuffer::ReadOnly);
@@ -282,32 +750,115 @@ void QxtSqlPackage::setData(const QByteArray& data)
     int c;
     stream >> c;
 
-    for (int i = 0; i < c;i++)
+    for (int i = 0; i < c && stream.status() == QDataStream::Ok; i++)
     {
         QHash<QString, QString> hash;
         stream >> hash;
-        map.append(hash);
+        if (i == 0)
+        {
+            foreach (const QString& key, hash.keys())
+                d.addColumn(key, QxtSqlPackageColumn::String);
+        }
+        for (int column = 0; column < d.columns.count(); column++)
+            d.columns[column].append(d.rows, hash.value(d.columns.at(column).name));
+        d.rows++;
     }
 }
 
+void QxtSqlPackage::setData(const QByteArray& data)
+{
+    qxt_d = new QxtSqlPackageData;
+    record = -1;
+    QxtSqlPackageData& d = *qxt_d;
 
-QHash<QString, QString> QxtSqlPackage::hash(int index)
+    if (data.size() < 4 || ::memcmp(data.constData(), qxt_sqlPackageMagic, 4) != 0)
+    {
+        qxt_sqlPackageReadHashes(d, data);
+        return;
+    }
+
+    QxtSqlPackageReader in(data);
+    in.readBytes(4);
+    if (in.read<quint8>() != qxt_sqlPackageVersion)
+    {
+        qWarning() << Q_FUNC_INFO << "unknown package version";
+        return;
+    }
+    const quint32 rows = in.read<quint32>();
+    const quint32 columns = in.read<quint32>();
+    if (rows > 0x7fffffff)
+        in.ok = false;
+    const int words = (rows + 31) / 32;
+
+    for (quint32 i = 0; i < columns && in.ok; i++)
+    {
+        const QByteArray name = in.readBytes(in.read<quint32>());
+        const quint8 type = in.read<quint8>();
+        if (type > QxtSqlPackageColumn::Blob)
+            break;
+        d.addColumn(QString::fromUtf8(name), QxtSqlPackageColumn::Type(type));
+        QxtSqlPackageColumn& column = d.columns.last();
+        column.hasNulls = in.read<quint8>();
+        if (column.hasNulls)
+            in.readArray(column.nulls, words);
+
+        switch (column.type)
+        {
+        case QxtSqlPackageColumn::Int64:
+            in.readArray(column.ints, rows);
+            break;
+        case QxtSqlPackageColumn::Double:
+        {
+            QVector<quint64> bits;
+            in.readArray(bits, rows);
+            if (in.ok)
+            {
+                column.doubles.resize(rows);
+                ::memcpy(column.doubles.data(), bits.constData(), rows * sizeof(double));
+            }
+            break;
+        }
+        default:
+        {
+            in.readArray(column.ends, rows);
+            column.bytes = in.readBytes(in.read<quint32>());
+            // the offsets must stay inside the bytes and must not go backwards
+            for (quint32 row = 0; row < rows && in.ok; row++)
+                in.ok = column.ends.at(row) >= (row ? column.ends.at(row - 1) : 0) && column.ends.at(row) <= column.bytes.size();
+            break;
+        }
+        }
+    }
+
+    if (!in.ok || d.columns.count() != int(columns))
+    {
+        qWarning() << Q_FUNC_INFO << "truncated or corrupt package";
+        qxt_d = new QxtSqlPackageData;
+        return;
+    }
+    d.rows = rows;
+}
+
+
+QHash<QString, QString> QxtSqlPackage::hash(int index) const
 {
-    if (index > count()) return QHash<QString, QString>();
-    return map.at(index);
+    QHash<QString, QString> hash;
+    if (index < 0 || index >= count()) return hash;
+    foreach (const QxtSqlPackageColumn& column, qxt_d->columns)
+        hash.insert(column.name, column.text(index));
+    return hash;
 }
 
 
-QHash<QString, QString> QxtSqlPackage::hash()
+QHash<QString, QString> QxtSqlPackage::hash() const
 {
-    qDebug() << record;
-    return map.at(record);
+    return hash(record);
 }
 
 
 QxtSqlPackage& QxtSqlPackage::operator= (const QxtSqlPackage & other)
 {
-    setData(other.data());
+    qxt_d = other.qxt_d;
+    record = -1;
     return *this;
 }
-
@@ -35,8 +35,12 @@
 #include <QObject>
 #include <QHash>
 #include <QSqlQuery>
+#include <QSharedDataPointer>
+#include <QVariant>
 #include <qxtglobal.h>
 
+class QxtSqlPackageData;
+
 class QXT_SQL_EXPORT QxtSqlPackage : public  QObject
 {
     Q_OBJECT
@@ -44,23 +48,32 @@ class QXT_SQL_EXPORT QxtSqlPackage : public  QObject
 public:
     QxtSqlPackage(QObject *parent = 0);
     QxtSqlPackage(const QxtSqlPackage & other, QObject *parent = 0);
+    ~QxtSqlPackage();
 
-    bool isValid();
-    int at();
+    bool isValid() const;
+    int at() const;
     bool next();
     bool last();
     bool first();
-    QString value(const QString& key);
+    QString value(const QString& key) const;
+    QVariant variant(const QString& key) const;
+    QVariant variant(int row, int column) const;
+    bool isNull(int row, int column) const;
+    int columnCount() const;
+    QString columnName(int column) const;
+    int columnIndex(const QString& name) const;
     void insert(QSqlQuery query);
+    int insert(QSqlQuery& query, int maxRows);
+    bool append(const QxtSqlPackage& other);
     int count() const;
     QByteArray data() const;
     void setData(const QByteArray& data);
-    QHash<QString, QString> hash(int index);
-    QHash<QString, QString> hash();
+    QHash<QString, QString> hash(int index) const;
+    QHash<QString, QString> hash() const;
     QxtSqlPackage& operator= (const QxtSqlPackage& other);
 
 private:
-    QList<QHash<QString, QString> > map;
+    QSharedDataPointer<QxtSqlPackageData> qxt_d;
     int record;
 };
 
@@ -57,33 +57,73 @@ example usage:
     v.show();
 \endcode
 
+A model can also show the rows of a QxtSqlAsyncResult while they arrive.
+Like QSqlQueryModel it reports the rows it has received so far and grows
+when a view calls fetchMore().
+
+\code
+    QxtSqlAsyncExecutor e;
+    QxtSqlAsyncResult * r = e.exec("SELECT * FROM reports");
+    m.setQuery(r);
+\endcode
+
 */
 
 /*!
 \fn void QxtSqlPackageModel::setQuery(QxtSqlPackage package)
 \brief set the \a package for the model.
 
-\warning do this before any access.
+The model is reset and shows all rows of \a package at once.
+*/
+
+/*!
+\fn void QxtSqlPackageModel::setQuery(QxtSqlAsyncResult * result)
+\brief show the rows of \a result while they arrive.
+
+The model is reset. It does not take ownership of \a result, which has to
+stay alive until it has finished for the model to receive all rows.
 */
 
 /*!
     Creates a QxtSqlPackageModel with \a parent.
  */
-QxtSqlPackageModel::QxtSqlPackageModel(QObject * parent) : QAbstractTableModel(parent)
+QxtSqlPackageModel::QxtSqlPackageModel(QObject * parent) : QAbstractTableModel(parent), shown(0), waiting(false)
 {
 }
 
 void QxtSqlPackageModel::setQuery(QxtSqlPackage package)
 {
+    beginResetModel();
+    if (result)
+        disconnect(result, 0, this, 0);
+    result = 0;
     pack = package;
+    shown = pack.count();
+    waiting = false;
+    endResetModel();
+}
+
+void QxtSqlPackageModel::setQuery(QxtSqlAsyncResult * result)
+{
+    beginResetModel();
+    if (this->result)
+        disconnect(this->result, 0, this, 0);
+    this->result = result;
+    pack = QxtSqlPackage();
+    shown = 0;
+    // the first rows are shown as soon as they arrive
+    waiting = true;
+    if (result)
+        connect(result, SIGNAL(batchReady(QxtSqlPackage)), this, SLOT(appendBatch(QxtSqlPackage)));
+    endResetModel();
 }
 
 /*!
     \reimp
  */
-int QxtSqlPackageModel::rowCount(const QModelIndex &) const
+int QxtSqlPackageModel::rowCount(const QModelIndex & parent) const
 {
-    return pack.count();
+    return parent.isValid() ? 0 : shown;
 }
 
 /*!
@@ -91,8 +131,7 @@ int QxtSqlPackageModel::rowCount(const QModelIndex &) const
  */
 int QxtSqlPackageModel::columnCount(const QModelIndex &) const
 {
-    QxtSqlPackage p = pack;
-    return p.hash(0).count();
+    return pack.columnCount();
 }
 
 /*!
@@ -105,10 +144,8 @@ QVariant QxtSqlPackageModel::data(const QModelIndex  & index, int role) const
 
 
 
-    if ((index.row() < 0)  || (index.column() < 0)) return QVariant();
-    QxtSqlPackage p = pack;
-
-    return  p.hash(index.row()).values().at(index.column());
+    if (index.row() >= shown) return QVariant();
+    return pack.variant(index.row(), index.column());
 
 
 }
@@ -125,10 +162,62 @@ QVariant QxtSqlPackageModel::headerData(int section, Qt::Orientation orientation
 
     if (orientation == Qt::Horizontal && role == Qt::DisplayRole)
     {
-        QxtSqlPackage p = pack;
-        return p.hash(0).keys().at(section)    ;
+        return pack.columnName(section);
     }
 
     return QAbstractItemModel::headerData(section, orientation, role);
 
 }
+
+/*!
+    \reimp
+
+    Returns true while rows have been received that are not shown yet, or more rows are expected.
+ */
+bool QxtSqlPackageModel::canFetchMore(const QModelIndex & parent) const
+{
+    if (parent.isValid())
+        return false;
+    return shown < pack.count() || (result && !result->isFinished());
+}
+
+/*!
+    \reimp
+
+    Shows the rows received so far. If there are none, the next batch is shown when it arrives.
+ */
+void QxtSqlPackageModel::fetchMore(const QModelIndex & parent)
+{
+    if (parent.isValid())
+        return;
+    if (shown < pack.count())
+        reveal();
+    else
+        waiting = result && !result->isFinished();
+}
+
+void QxtSqlPackageModel::appendBatch(const QxtSqlPackage & batch)
+{
+    if (!pack.columnCount() && batch.columnCount())
+    {
+        beginInsertColumns(QModelIndex(), 0, batch.columnCount() - 1);
+        pack.append(batch);
+        endInsertColumns();
+    }
+    else
+    {
+        pack.append(batch);
+    }
+    if (waiting)
+        reveal();
+}
+
+void QxtSqlPackageModel::reveal()
+{
+    if (shown >= pack.count())
+        return;
+    beginInsertRows(QModelIndex(), shown, pack.count() - 1);
+    shown = pack.count();
+    endInsertRows();
+    waiting = false;
+}
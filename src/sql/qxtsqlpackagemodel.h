@@ -36,10 +36,13 @@
 #include <qxtsqlpackage.h>
 #include <qxtglobal.h>
 #include <QHash>
+#include <QPointer>
+#include <qxtsqlasyncexecutor.h>
 
 
 class QXT_SQL_EXPORT QxtSqlPackageModel : public  QAbstractTableModel
 {
+    Q_OBJECT
 public:
 /// \reimp
     QxtSqlPackageModel(QObject * parent = 0);
@@ -47,6 +50,7 @@ public:
 
 
     void setQuery(QxtSqlPackage a) ;
+    void setQuery(QxtSqlAsyncResult * result);
 
 
 /// \reimp
@@ -57,10 +61,21 @@ public:
     QVariant data(const QModelIndex & index, int role = Qt::DisplayRole) const;
 /// \reimp
     QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+/// \reimp
+    bool canFetchMore(const QModelIndex & parent = QModelIndex()) const;
+/// \reimp
+    void fetchMore(const QModelIndex & parent = QModelIndex());
+
+private Q_SLOTS:
+    void appendBatch(const QxtSqlPackage & batch);
 
 private:
+    void reveal();
 
     QxtSqlPackage pack;
+    QPointer<QxtSqlAsyncResult> result;
+    int shown;
+    bool waiting;
 };
 
 #endif // QXTSQLPACKAGEMODEL_H_INCLUDED
@@ -34,6 +34,8 @@
 #include <QSqlDriver>
 #include <QSqlQuery>
 #include <QSqlError>
+#include <QMutex>
+#include <QHash>
 #include <QDebug>
 
 /*!
@@ -78,6 +80,11 @@ regard.
 \warning Although you may specify a name for the primary thread's master
 connection, this class only manages a single set of connections and is
 typically used with the default connection (omitting the name).
+
+Every thread opens a connection of its own and closes it when it exits,
+which is costly when threads come and go. After setPool() the managers
+borrow their connections from a QxtSqlConnectionPool instead and give them
+back when the thread exits, so the next thread reuses an open connection.
 */
 
 /*!
@@ -88,6 +95,9 @@ will have global allocation scope.
 */
 QThreadStorage<QxtSqlThreadManager*> QxtSqlThreadManager::connections;
 
+static QMutex qxt_sqlPoolsMutex;
+static QHash<QString, QxtSqlConnectionPool *> qxt_sqlPools;
+
 /*!
 \internal
 
@@ -98,6 +108,16 @@ connection which is already open.
 */
 QxtSqlThreadManager::QxtSqlThreadManager(const QString &masterName)
 {
+    // Borrow an open connection if there is a pool for the master
+    if(QxtSqlConnectionPool * p = pool(masterName)){
+	pooled = p->acquire();
+	if(pooled.isValid()){
+	    this->name = pooled.connectionName();
+	    return;
+	}
+	qWarning() << Q_FUNC_INFO
+	    << "Failed to borrow a connection from the pool, opening one";
+    }
     // Build a name for the new connection
     this->name = QString("$qxt$tc_%1$%2")
 	.arg((unsigned long)(void*)QThread::currentThreadId(), 0, 36)
@@ -119,6 +139,11 @@ QxtSqlThreadManager::QxtSqlThreadManager(const QString &masterName)
 */
 QxtSqlThreadManager::~QxtSqlThreadManager()
 {
+    // Pooled connections stay open for the next thread
+    if(pooled.isValid()){
+	pooled.release();
+	return;
+    }
     // Close the database if it's currently open
     {
 	// Scoped so our local copy doesn't exist during removal
@@ -187,6 +212,29 @@ void QxtSqlThreadManager::selectDatabase(const QString &dbname)
 	    << ", error: " << conn.lastError().text();
 }
 
+/*! Makes the managers of threads that have no connection yet borrow one
+ *  from \a pool instead of opening their own. The pool must clone the
+ *  connection \a masterName. Passing 0 turns pooling off again; threads
+ *  keep the connection they have. The pool unregisters itself when it is
+ *  destroyed.
+ */
+void QxtSqlThreadManager::setPool(QxtSqlConnectionPool *pool, const QString &masterName)
+{
+    QMutexLocker locker(&qxt_sqlPoolsMutex);
+    if(pool)
+	qxt_sqlPools.insert(masterName, pool);
+    else
+	qxt_sqlPools.remove(masterName);
+}
+
+/*! Returns the pool set with setPool() for \a masterName, or \i null.
+ */
+QxtSqlConnectionPool * QxtSqlThreadManager::pool(const QString &masterName)
+{
+    QMutexLocker locker(&qxt_sqlPoolsMutex);
+    return qxt_sqlPools.value(masterName);
+}
+
 /*!
 \fn  QString QxtSqlThreadManager::connectionName() const
 \brief Returns the name of the managed QSqlDatabase connection.
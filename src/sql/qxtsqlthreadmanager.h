@@ -35,6 +35,7 @@
 #include <QThreadStorage>
 #include <QSqlDatabase>
 #include <qxtglobal.h>
+#include "qxtsqlconnectionpool.h"
 
 class QXT_SQL_EXPORT QxtSqlThreadManager
 {
@@ -58,12 +59,18 @@ public:
 	return manager(masterName)->database();
     }
 
+    static void setPool(QxtSqlConnectionPool * pool, const QString & masterName =
+	    QLatin1String(QSqlDatabase::defaultConnection));
+    static QxtSqlConnectionPool * pool(const QString & masterName =
+	    QLatin1String(QSqlDatabase::defaultConnection));
+
 protected:
     QxtSqlThreadManager(const QString &);
     QString name;
 
 private:
     static QThreadStorage<QxtSqlThreadManager *> connections;
+    QxtSqlPooledConnection pooled;
 };
 
 #endif // QXTSQLTHREADMANAGER_H
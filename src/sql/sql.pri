@@ -2,10 +2,15 @@ INCLUDEPATH += $$PWD
 DEPENDPATH += $$PWD
 
 HEADERS  += qxtsql.h
+HEADERS  += qxtsqlasyncexecutor.h
+HEADERS  += qxtsqlasyncexecutor_p.h
+HEADERS  += qxtsqlconnectionpool.h
 HEADERS  += qxtsqlpackage.h
 HEADERS  += qxtsqlpackagemodel.h
 HEADERS  += qxtsqlthreadmanager.h
 
+SOURCES  += qxtsqlasyncexecutor.cpp
+SOURCES  += qxtsqlconnectionpool.cpp
 SOURCES  += qxtsqlpackage.cpp
 SOURCES  += qxtsqlpackagemodel.cpp
 SOURCES  += qxtsqlthreadmanager.cpp
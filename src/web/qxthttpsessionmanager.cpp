@@ -58,6 +58,9 @@ posting events. It is reentrant for all other functionality.
 #include "qxtwebcontent.h"
 #include "qxtabstractwebservice.h"
 #include <qxtboundfunction.h>
+#include <qxttypedboundfunction.h>
+#include <QCoreApplication>
+#include <QPointer>
 #include <QMutex>
 #include <QList>
 #include <QUuid>
@@ -76,9 +79,17 @@ posting events. It is reentrant for all other functionality.
 class QxtHttpSessionManagerPrivate : public QxtPrivate<QxtHttpSessionManager>
 {
 public:
+    typedef QxtTypedBoundFunction<int, QObject*> Handler;
+
+    // The handlers are bound once per connection and only get new arguments for every
+    // following response, unless the response switches between chunked and block transfer.
     struct ConnectionState
     {
-        QxtBoundFunction *onBytesWritten, *onReadyRead, *onAboutToClose;
+        Handler *onBytesWritten, *onReadyRead;
+        // closeConnection(int) for block transfers, sendEmptyChunk(int, QObject*) for chunked ones
+        QxtTypedBoundFunctionBase* onAboutToClose;
+        QPointer<QObject> handlerSource;
+        bool chunkedHandlers;
         bool readyRead;
         bool finishedTransfer;
         bool keepAlive;
@@ -87,11 +98,49 @@ public:
         int httpMinorVersion;
         int sessionID;
 
-        void clearHandlers() {
+        void bindHandlers(QxtHttpSessionManager* manager, bool chunked, int requestID, QObject* source) {
+            if (!onBytesWritten || chunked != chunkedHandlers) {
+                deleteHandlers();
+                chunkedHandlers = chunked;
+                if (!chunked) {
+                    onBytesWritten = new Handler(manager, SLOT(sendNextBlock(int, QObject*)));
+                    onReadyRead = new Handler(manager, SLOT(blockReadyRead(int, QObject*)));
+                    onAboutToClose = new QxtTypedBoundFunction<int>(manager, SLOT(closeConnection(int)));
+                } else {
+                    onBytesWritten = new Handler(manager, SLOT(sendNextChunk(int, QObject*)));
+                    onReadyRead = new Handler(manager, SLOT(chunkReadyRead(int, QObject*)));
+                    onAboutToClose = new Handler(manager, SLOT(sendEmptyChunk(int, QObject*)));
+                }
+            }
+            onBytesWritten->setArguments(requestID, source);
+            onReadyRead->setArguments(requestID, source);
+            if (chunked)
+                static_cast<Handler*>(onAboutToClose)->setArguments(requestID, source);
+            else
+                static_cast<QxtTypedBoundFunction<int>*>(onAboutToClose)->setArguments(requestID);
+            handlerSource = source;
+        }
+
+        void clearHandlers(QIODevice* device) {
+            QxtBoundFunction* handlers[3] = { onBytesWritten, onReadyRead, onAboutToClose };
+            for (int i = 0; i < 3; i++) {
+                if (!handlers[i]) continue;
+                QObject::disconnect(device, 0, handlers[i], 0);
+                if (handlerSource)
+                    QObject::disconnect(handlerSource, 0, handlers[i], 0);
+                // queued calls left over from the previous response would run with the next response's arguments
+                QCoreApplication::removePostedEvents(handlers[i], QEvent::MetaCall);
+            }
+            handlerSource = 0;
+        }
+
+        void deleteHandlers() {
             delete onBytesWritten;
             delete onReadyRead;
             delete onAboutToClose;
-            onBytesWritten = onReadyRead = onAboutToClose = 0;
+            onBytesWritten = onReadyRead = 0;
+            onAboutToClose = 0;
+            handlerSource = 0;
         }
     };
 
@@ -485,7 +534,7 @@ void QxtHttpSessionManager::disconnected(QIODevice* device)
 {
     QMutexLocker locker(&qxt_d().sessionLock);
     if (qxt_d().connectionState.contains(device)) {
-        qxt_d().connectionState[device].clearHandlers();
+        qxt_d().connectionState[device].deleteHandlers();
     }
     qxt_d().connectionState.remove(device);
     device->deleteLater(); 
@@ -604,22 +653,13 @@ void QxtHttpSessionManager::processEvents()
         else
         {
             pe->dataSource = 0;     // so that it isn't destroyed when the event is deleted
-            state.clearHandlers();  // disconnect old handlers
+            state.clearHandlers(device);  // disconnect old handlers
 
             if (!pe->chunked)
-            {
                 state.keepAlive = false;
-                state.onBytesWritten = QxtMetaObject::bind(this, SLOT(sendNextBlock(int, QObject*)), Q_ARG(int, requestID), Q_ARG(QObject*, source));
-                state.onReadyRead = QxtMetaObject::bind(this, SLOT(blockReadyRead(int, QObject*)), Q_ARG(int, requestID), Q_ARG(QObject*, source));
-                state.onAboutToClose = QxtMetaObject::bind(this, SLOT(closeConnection(int)), Q_ARG(int, requestID));
-            }
             else
-            {
                 header.setValue("transfer-encoding", "chunked");
-                state.onBytesWritten = QxtMetaObject::bind(this, SLOT(sendNextChunk(int, QObject*)), Q_ARG(int, requestID), Q_ARG(QObject*, source));
-                state.onReadyRead = QxtMetaObject::bind(this, SLOT(chunkReadyRead(int, QObject*)), Q_ARG(int, requestID), Q_ARG(QObject*, source));
-                state.onAboutToClose = QxtMetaObject::bind(this, SLOT(sendEmptyChunk(int, QObject*)), Q_ARG(int, requestID), Q_ARG(QObject*, source));
-            }
+            state.bindHandlers(this, pe->chunked, requestID, source);
             QxtMetaObject::connect(device, SIGNAL(bytesWritten(qint64)), state.onBytesWritten, Qt::QueuedConnection);
             QxtMetaObject::connect(source, SIGNAL(readyRead()), state.onReadyRead, Qt::QueuedConnection);
             QxtMetaObject::connect(source, SIGNAL(aboutToClose()), state.onAboutToClose, Qt::QueuedConnection);
@@ -711,8 +751,8 @@ void QxtHttpSessionManager::sendEmptyChunk(int requestID, QObject* dataSource)
     dataSource->deleteLater();
     if (state.keepAlive)
     {
-        delete state.onBytesWritten;
-        state.onBytesWritten = 0;
+        if (state.onBytesWritten)
+            QObject::disconnect(device, SIGNAL(bytesWritten(qint64)), state.onBytesWritten, 0);
         connector()->incomingData(device);
     }
     else
@@ -775,6 +815,6 @@ void QxtHttpSessionManager::sendNextBlock(int requestID, QObject* dataSourceObje
     {
         closeConnection(requestID);
         dataSource->deleteLater();
-        state.clearHandlers();
+        state.clearHandlers(device);
     }
 }
@@ -3,7 +3,7 @@
 ######################################################################
 
 TEMPLATE = subdirs
-SUBDIRS += qxtbdbhash qxtbdbtree
+SUBDIRS += qxtbdbcache qxtbdbcodec qxtbdbenvironment qxtbdbhash qxtbdbscan qxtbdbthreads qxtbdbtree
 
 test.CONFIG += recursive
 QMAKE_EXTRA_TARGETS += test
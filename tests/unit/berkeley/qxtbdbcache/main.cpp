@@ -0,0 +1,202 @@
+#include <QxtBdbEnvironment>
+#include <QxtBdbHash>
+#include <QTest>
+#include <QThread>
+#include <QDir>
+
+typedef QxtBdbHash<int, QString> Names;
+
+class Reader : public QThread
+{
+public:
+    Reader(Names * db) : db(db), errors(0) {}
+
+    Names * db;
+    int errors;
+
+protected:
+    void run()
+    {
+        for (int i = 0; i < 20000; i++)
+        {
+            const int key = i % 100;
+            const QString value = db->value(key);
+            if (value != QString::number(key) && value != QString::number(-key))
+                errors++;
+        }
+    }
+};
+
+class Test: public QObject
+{
+Q_OBJECT
+private slots:
+    void initTestCase()
+    {
+        QVERIFY(db.open("cache.db"));
+        db.setCacheSize(1024 * 1024);
+        QCOMPARE(db.cacheSize(), 1024 * 1024);
+    }
+
+    void init()
+    {
+        db.clear();
+        db.setCacheSize(1024 * 1024);
+    }
+
+    void counters()
+    {
+        QVERIFY(db.insert(1, "one"));
+        QCOMPARE(db.value(1), QString("one"));
+        QCOMPARE(db.cacheHits(), quint64(0));
+        QCOMPARE(db.cacheMisses(), quint64(1));
+        QCOMPARE(db.value(1), QString("one"));
+        QCOMPARE(db[1], QString("one"));
+        QCOMPARE(db.cacheHits(), quint64(2));
+        QCOMPARE(db.cacheMisses(), quint64(1));
+
+        // missing keys are not cached
+        QCOMPARE(db.value(2), QString());
+        QCOMPARE(db.value(2), QString());
+        QCOMPARE(db.cacheMisses(), quint64(3));
+    }
+
+    void disabled()
+    {
+        Names plain("plain.db");
+        QCOMPARE(plain.cacheSize(), 0);
+        QVERIFY(plain.insert(1, "one"));
+        QCOMPARE(plain.value(1), QString("one"));
+        QCOMPARE(plain.cacheHits(), quint64(0));
+        QCOMPARE(plain.cacheMisses(), quint64(0));
+    }
+
+    void invalidation()
+    {
+        QVERIFY(db.insert(1, "one"));
+        QCOMPARE(db.value(1), QString("one"));
+        QVERIFY(db.insert(1, "uno"));
+        QCOMPARE(db.value(1), QString("uno"));
+        QVERIFY(db.remove(1));
+        QCOMPARE(db.value(1), QString());
+
+        QVERIFY(db.insert(2, "two"));
+        QCOMPARE(db.value(2), QString("two"));
+        db.clear();
+        QCOMPARE(db.value(2), QString());
+
+        QVERIFY(db.insert(3, "three"));
+        QCOMPARE(db.value(3), QString("three"));
+        QList<QPair<int, QString> > pairs;
+        pairs << qMakePair(3, QString("drei"));
+        QVERIFY(db.load(pairs));
+        QCOMPARE(db.value(3), QString("drei"));
+
+        QxtBdbHashIterator<int, QString> it = db.find(3);
+        QVERIFY(it.isValid());
+        it.erase();
+        QCOMPARE(db.value(3), QString());
+    }
+
+    void eviction()
+    {
+        db.setCacheSize(4096);
+        for (int i = 0; i < 1000; i++)
+            QVERIFY(db.insert(i, QString(100, QChar('a' + i % 26))));
+        for (int round = 0; round < 2; round++)
+            for (int i = 0; i < 1000; i++)
+                QCOMPARE(db.value(i), QString(100, QChar('a' + i % 26)));
+        // far more than fits, the second round misses as well
+        QVERIFY(db.cacheMisses() > 1900);
+    }
+
+    void transactions()
+    {
+        QDir dir("cacheenv");
+        foreach (const QString& file, dir.entryList(QDir::Files))
+            dir.remove(file);
+        QxtBdbEnvironment env;
+        QVERIFY(env.open("cacheenv", QxtBdbEnvironment::Transactions | QxtBdbEnvironment::NoSyncOnCommit));
+
+        Names shared(env, "cache.db");
+        shared.setCacheSize(1024 * 1024);
+        QVERIFY(shared.insert(1, "one"));
+        QCOMPARE(shared.value(1), QString("one"));
+
+        QVERIFY(shared.transaction());
+        QVERIFY(shared.insert(1, "uno"));
+        QCOMPARE(shared.value(1), QString("uno"));
+        QVERIFY(shared.rollback());
+        QCOMPARE(shared.value(1), QString("one"));
+
+        QVERIFY(shared.transaction());
+        QVERIFY(shared.insert(1, "eins"));
+        QVERIFY(shared.commit());
+        QCOMPARE(shared.value(1), QString("eins"));
+    }
+
+    void concurrentReaders()
+    {
+        for (int i = 0; i < 100; i++)
+            QVERIFY(db.insert(i, QString::number(i)));
+
+        QList<Reader *> readers;
+        for (int i = 0; i < 8; i++)
+            readers << new Reader(&db);
+        foreach (Reader * reader, readers)
+            reader->start();
+        for (int round = 0; round < 20; round++)
+            for (int i = 0; i < 100; i++)
+                db.insert(i, QString::number(round % 2 ? i : -i));
+        int errors = 0;
+        foreach (Reader * reader, readers)
+        {
+            reader->wait();
+            errors += reader->errors;
+        }
+        qDeleteAll(readers);
+        QCOMPARE(errors, 0);
+
+        // no stale value survived the writes
+        for (int i = 0; i < 100; i++)
+            QCOMPARE(db.value(i), QString::number(i));
+    }
+
+    void benchmarkHotKeys_data()
+    {
+        QTest::addColumn<int>("cacheSize");
+        QTest::newRow("no cache") << 0;
+        QTest::newRow("cache") << 1024 * 1024;
+    }
+    void benchmarkHotKeys()
+    {
+        QFETCH(int, cacheSize);
+        Names hot("hot.db");
+        hot.clear();
+        QList<QPair<int, QString> > pairs;
+        for (int i = 0; i < 10000; i++)
+            pairs << qMakePair(i, QString("value of %1").arg(i));
+        QVERIFY(hot.load(pairs));
+        hot.setCacheSize(cacheSize);
+
+        // nine out of ten lookups go to one percent of the keys
+        int total = 0;
+        QBENCHMARK {
+            for (int i = 0; i < 10000; i++)
+                total += hot.value(i % 10 ? (i * 7) % 100 : (i * 7919) % 10000).size();
+        }
+        QVERIFY(total > 0);
+        hot.clear();
+    }
+
+    void cleanupTestCase()
+    {
+        db.clear();
+    }
+
+private:
+    Names db;
+};
+
+QTEST_MAIN(Test)
+#include "main.moc"
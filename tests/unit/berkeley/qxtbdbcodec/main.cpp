@@ -0,0 +1,197 @@
+#include <QxtBdbCodec>
+#include <QxtBdbHash>
+#include <QTest>
+#include <QStringList>
+#include <QPoint>
+#include <cstring>
+
+class Test: public QObject
+{
+Q_OBJECT
+private:
+    template<class T>
+    static QByteArray encoded(const T& t)
+    {
+        QxtBdbData data;
+        QxtBdbCodec<T>::encode(t, data);
+        return QByteArray(data.constData(), data.size());
+    }
+
+    template<class T>
+    static T decoded(const QByteArray& bytes)
+    {
+        T t;
+        if (!QxtBdbCodec<T>::decode(bytes.constData(), bytes.size(), t))
+            return T();
+        return t;
+    }
+
+    // memcmp, the default btree ordering
+    static bool before(const QByteArray& a, const QByteArray& b)
+    {
+        const int c = ::memcmp(a.constData(), b.constData(), qMin(a.size(), b.size()));
+        return c < 0 || (c == 0 && a.size() < b.size());
+    }
+
+    template<class T>
+    static void checkOrder(const QList<T>& sorted)
+    {
+        for (int i = 0; i < sorted.count(); i++)
+        {
+            QCOMPARE(decoded<T>(encoded(sorted.at(i))), sorted.at(i));
+            if (i > 0)
+                QVERIFY(before(encoded(sorted.at(i - 1)), encoded(sorted.at(i))));
+        }
+    }
+
+private slots:
+    void integers()
+    {
+        checkOrder(QList<int>() << -2147483647 - 1 << -70000 << -1 << 0 << 1 << 255 << 256 << 2147483647);
+        checkOrder(QList<qlonglong>() << Q_INT64_C(-9000000000) << -1 << 0 << Q_INT64_C(9000000000));
+        checkOrder(QList<quint16>() << 0 << 1 << 255 << 256 << 65535);
+        checkOrder(QList<qint8>() << -128 << -1 << 0 << 127);
+        QCOMPARE(encoded(int(1)), QByteArray("\x80\x00\x00\x01", 4));
+    }
+    void floats()
+    {
+        checkOrder(QList<double>() << -1e300 << -454.332 << -1 << -0.25 << 0 << 0.25 << 234 << 235 << 454.332 << 1e300);
+        checkOrder(QList<float>() << -3.5f << -1 << 0 << 1e-20f << 1 << 2.5f);
+        QCOMPARE(encoded(1.0).size(), int(sizeof(double)));
+    }
+    void strings()
+    {
+        checkOrder(QList<QString>() << QString() << "a" << "ab" << "b" << QString::fromUtf8("\xC3\xA9") << QString::fromUtf8("\xE2\x82\xAC"));
+        checkOrder(QList<QByteArray>() << QByteArray() << QByteArray("\0", 1) << "a" << "ab" << "\xFF");
+        QCOMPARE(encoded(QString("key")), QByteArray("key"));
+        QCOMPARE(encoded(QString(300, QChar(0xE9))), QString(300, QChar(0xE9)).toUtf8());
+    }
+    void plain()
+    {
+        QCOMPARE(encoded(true).size(), 1);
+        QCOMPARE(decoded<bool>(encoded(true)), true);
+        QCOMPARE(decoded<char>(encoded('x')), 'x');
+    }
+    void fallback()
+    {
+        const QStringList list = QStringList() << "hello" << "how are you?";
+        QCOMPARE(encoded(list), QxtBdb::qxtMetaSave(list));
+        QCOMPARE(decoded<QStringList>(encoded(list)), list);
+        QCOMPARE(decoded<QPoint>(encoded(QPoint(3, -4))), QPoint(3, -4));
+    }
+    void append()
+    {
+        // records of QxtBdbTree are a level followed by the value
+        QxtBdbData data;
+        const quint64 level = 3;
+        data.append(reinterpret_cast<const char*>(&level), sizeof(quint64));
+        QxtBdbCodec<QStringList>::encode(QStringList() << "x", data);
+        QxtBdbCodec<QString>::encode(QString(200, 'y'), data);
+        QVERIFY(data.size() > QxtBdbData::InlineSize);
+        QCOMPARE(::memcmp(data.constData(), &level, sizeof(quint64)), 0);
+    }
+    void hashOrder()
+    {
+        QxtBdbHash<int, QString> db("codec.db");
+        db.clear();
+        QList<int> keys = QList<int>() << 300 << -5 << 0 << 42 << -70000 << 7;
+        foreach (int key, keys)
+            QVERIFY(db.insert(key, QString::number(key)));
+        qSort(keys);
+        QxtBdbHashIterator<int, QString> it = db.begin();
+        for (int i = 0; i < keys.count(); i++, ++it)
+        {
+            QVERIFY(it.isValid());
+            QCOMPARE(it.key(), keys.at(i));
+            QCOMPARE(it.value(), QString::number(keys.at(i)));
+        }
+        QVERIFY(!it.isValid());
+        QCOMPARE(db.value(-70000), QString("-70000"));
+        db.clear();
+    }
+
+    void benchmarkEncode_data()
+    {
+        QTest::addColumn<bool>("codec");
+        QTest::newRow("codec") << true;
+        QTest::newRow("qxtMetaSave") << false;
+    }
+    void benchmarkEncode()
+    {
+        QFETCH(bool, codec);
+        const QString text("some value");
+        int total = 0;
+        if (codec)
+        {
+            QBENCHMARK {
+                for (int i = 0; i < 10000; i++)
+                {
+                    QxtBdbData key, value;
+                    QxtBdbCodec<int>::encode(i, key);
+                    QxtBdbCodec<QString>::encode(text, value);
+                    total += key.size() + value.size();
+                }
+            }
+        }
+        else
+        {
+            QBENCHMARK {
+                for (int i = 0; i < 10000; i++)
+                    total += QxtBdb::qxtMetaSave(i).size() + QxtBdb::qxtMetaSave(text).size();
+            }
+        }
+        QVERIFY(total > 0);
+    }
+
+    void benchmarkDecode_data()
+    {
+        benchmarkEncode_data();
+    }
+    void benchmarkDecode()
+    {
+        QFETCH(bool, codec);
+        const QString text("some value");
+        int total = 0;
+        if (codec)
+        {
+            const QByteArray key = encoded(12345), value = encoded(text);
+            QBENCHMARK {
+                for (int i = 0; i < 10000; i++)
+                {
+                    int k;
+                    QString v;
+                    QxtBdbCodec<int>::decode(key.constData(), key.size(), k);
+                    QxtBdbCodec<QString>::decode(value.constData(), value.size(), v);
+                    total += k + v.size();
+                }
+            }
+        }
+        else
+        {
+            const QByteArray key = QxtBdb::qxtMetaSave(12345), value = QxtBdb::qxtMetaSave(text);
+            QBENCHMARK {
+                for (int i = 0; i < 10000; i++)
+                    total += QxtBdb::qxtMetaLoad<int>(key.constData(), key.size())
+                           + QxtBdb::qxtMetaLoad<QString>(value.constData(), value.size()).size();
+            }
+        }
+        QVERIFY(total > 0);
+    }
+
+    void benchmarkHash()
+    {
+        QxtBdbHash<int, QString> db("codec.db");
+        db.clear();
+        const QString text("some value");
+        QBENCHMARK {
+            for (int i = 0; i < 10000; i++)
+                db.insert(i, text);
+            for (int i = 0; i < 10000; i++)
+                db.value(i);
+        }
+        db.clear();
+    }
+};
+
+QTEST_MAIN(Test)
+#include "main.moc"
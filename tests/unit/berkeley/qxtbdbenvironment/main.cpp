@@ -0,0 +1,142 @@
+#include <QxtBdbEnvironment>
+#include <QxtBdbHash>
+#include <QTest>
+#include <QDir>
+#include <QPair>
+
+class Test: public QObject
+{
+Q_OBJECT
+private slots:
+    void initTestCase()
+    {
+        QDir dir("testenv");
+        foreach (const QString& file, dir.entryList(QDir::Files))
+            dir.remove(file);
+
+        env.setCacheSize(64 * 1024 * 1024);
+        QVERIFY(env.open("testenv", QxtBdbEnvironment::Transactions | QxtBdbEnvironment::NoSyncOnCommit));
+        QVERIFY(env.isOpen());
+        QCOMPARE(env.cacheSize(), qint64(64 * 1024 * 1024));
+        QVERIFY(env.openFlags() & QxtBdbEnvironment::Transactions);
+    }
+
+    void commit()
+    {
+        QxtBdbHash<int, QString> db(env, "commit.db");
+        db.clear();
+        QVERIFY(db.transaction());
+        QVERIFY(!db.transaction());
+        QVERIFY(db.insert(1, "one"));
+        QVERIFY(db.insert(2, "two"));
+        QCOMPARE(db.value(1), QString("one"));
+        QVERIFY(db.commit());
+        QVERIFY(!db.commit());
+        QCOMPARE(db.value(2), QString("two"));
+    }
+
+    void rollback()
+    {
+        QxtBdbHash<int, QString> db(env, "commit.db");
+        QVERIFY(db.contains(1));
+        QVERIFY(db.transaction());
+        QVERIFY(db.insert(3, "three"));
+        QVERIFY(db.remove(1));
+        QVERIFY(db.rollback());
+        QVERIFY(!db.contains(3));
+        QCOMPARE(db.value(1), QString("one"));
+    }
+
+    void autoCommit()
+    {
+        QxtBdbHash<int, QString> db(env, "commit.db");
+        QVERIFY(db.insert(4, "four"));
+        QVERIFY(db.contains(4));
+        QVERIFY(env.checkpoint());
+    }
+
+    void noEnvironment()
+    {
+        QxtBdbHash<int, QString> db("bare.db");
+        QVERIFY(!db.transaction());
+        QVERIFY(!db.commit());
+        QVERIFY(!db.rollback());
+    }
+
+    void load()
+    {
+        QxtBdbHash<int, QString> db(env, "load.db");
+        db.clear();
+        QList<QPair<int, QString> > pairs;
+        for (int i = 0; i < 50000; i++)
+            pairs << qMakePair((i * 7919) % 50000 - 25000, QString::number(i));
+        pairs << qMakePair(0, QString("last"));
+        QVERIFY(db.load(pairs));
+
+        QxtBdbHashIterator<int, QString> it = db.begin();
+        for (int key = -25000; key < 25000; key++, ++it)
+        {
+            QVERIFY(it.isValid());
+            QCOMPARE(it.key(), key);
+        }
+        QVERIFY(!it.isValid());
+        QCOMPARE(db.value(0), QString("last"));
+        QCOMPARE(db.value(-25000 + 7919), QString::number(1));
+    }
+
+    void loadInTransaction()
+    {
+        QxtBdbHash<QString, QByteArray> db(env, "load2.db");
+        db.clear();
+        QList<QPair<QString, QByteArray> > pairs;
+        pairs << qMakePair(QString("b"), QByteArray(10 * 1024 * 1024, 'x'));
+        pairs << qMakePair(QString("a"), QByteArray("small"));
+        QVERIFY(db.transaction());
+        QVERIFY(db.load(pairs));
+        QVERIFY(db.rollback());
+        QVERIFY(!db.contains("a"));
+        QVERIFY(db.load(pairs));
+        QCOMPARE(db.value("b").size(), 10 * 1024 * 1024);
+        QCOMPARE(db.value("a"), QByteArray("small"));
+    }
+
+    void benchmarkIngest_data()
+    {
+        QTest::addColumn<int>("mode");
+        QTest::newRow("per record") << 0;
+        QTest::newRow("one transaction") << 1;
+        QTest::newRow("load") << 2;
+    }
+    void benchmarkIngest()
+    {
+        QFETCH(int, mode);
+        QxtBdbHash<int, QString> db(env, "ingest.db");
+        QList<QPair<int, QString> > pairs;
+        for (int i = 0; i < 20000; i++)
+            pairs << qMakePair((i * 7919) % 20000, QString("value %1").arg(i));
+
+        QBENCHMARK {
+            db.clear();
+            if (mode == 2)
+            {
+                db.load(pairs);
+            }
+            else
+            {
+                if (mode == 1)
+                    db.transaction();
+                for (int i = 0; i < pairs.count(); i++)
+                    db.insert(pairs.at(i).first, pairs.at(i).second);
+                if (mode == 1)
+                    db.commit();
+            }
+        }
+        QVERIFY(db.contains(19999));
+    }
+
+private:
+    QxtBdbEnvironment env;
+};
+
+QTEST_MAIN(Test)
+#include "main.moc"
@@ -0,0 +1,160 @@
+#include <QxtBdbHash>
+#include <QTest>
+#include <QStringList>
+
+class Test: public QObject
+{
+Q_OBJECT
+private slots:
+    void initTestCase()
+    {
+        QVERIFY(numbers.open("scan.db"));
+        numbers.clear();
+        QList<QPair<int, QString> > pairs;
+        for (int i = -500; i < 500; i++)
+            pairs << qMakePair(i * 2, QString::number(i * 2));
+        QVERIFY(numbers.load(pairs));
+    }
+
+    void scanAll()
+    {
+        QxtBdbHashScan<int, QString> scan = numbers.scan();
+        QVERIFY(!scan.isValid());
+        int expected = -1000;
+        while (scan.next())
+        {
+            QVERIFY(scan.isValid());
+            QCOMPARE(scan.key(), expected);
+            QCOMPARE(scan.value(), QString::number(expected));
+            expected += 2;
+        }
+        QCOMPARE(expected, 1000);
+        QVERIFY(!scan.isValid());
+        QVERIFY(!scan.next());
+    }
+
+    void scanRange_data()
+    {
+        QTest::addColumn<int>("from");
+        QTest::addColumn<int>("to");
+        QTest::addColumn<int>("first");
+        QTest::addColumn<int>("count");
+
+        QTest::newRow("exact") << -10 << 10 << -10 << 10;
+        QTest::newRow("between") << -9 << 11 << -8 << 10;
+        QTest::newRow("before") << -5000 << -996 << -1000 << 2;
+        QTest::newRow("after") << 998 << 5000 << 998 << 1;
+        QTest::newRow("empty") << 3 << 4 << 0 << 0;
+        QTest::newRow("reversed") << 10 << -10 << 0 << 0;
+    }
+    void scanRange()
+    {
+        QFETCH(int, from);
+        QFETCH(int, to);
+        QFETCH(int, first);
+        QFETCH(int, count);
+
+        QxtBdbHashScan<int, QString> scan = numbers.scan(from, to);
+        int n = 0;
+        while (scan.next())
+        {
+            QCOMPARE(scan.key(), first + n * 2);
+            n++;
+        }
+        QCOMPARE(n, count);
+    }
+
+    void scanPrefix()
+    {
+        QxtBdbHash<QString, int> db("prefix.db");
+        db.clear();
+        QStringList keys = QStringList() << "user/bob" << "user/alice" << "group/admin" << "user" << "users/x" << "zzz";
+        for (int i = 0; i < keys.count(); i++)
+            QVERIFY(db.insert(keys.at(i), i));
+
+        QxtBdbHashScan<QString, int> scan = db.scanPrefix("user/");
+        QStringList found;
+        while (scan.next())
+            found << scan.key();
+        QCOMPARE(found, QStringList() << "user/alice" << "user/bob");
+
+        scan = db.scanPrefix("nothing");
+        QVERIFY(!scan.next());
+
+        QVERIFY(db.load(QList<QPair<QString, int> >()));
+        db.clear();
+        QVERIFY(!db.scan().next());
+    }
+
+    void bounds()
+    {
+        QxtBdbHashIterator<int, QString> it = numbers.lowerBound(3);
+        QVERIFY(it.isValid());
+        QCOMPARE(it.key(), 4);
+        it = numbers.lowerBound(4);
+        QCOMPARE(it.key(), 4);
+        it = numbers.upperBound(4);
+        QCOMPARE(it.key(), 6);
+        it = numbers.upperBound(3);
+        QCOMPARE(it.key(), 4);
+        QVERIFY(!numbers.upperBound(998).isValid());
+        QVERIFY(!numbers.lowerBound(999).isValid());
+        QCOMPARE(numbers.lowerBound(-5000).key(), -1000);
+    }
+
+    void largeValues()
+    {
+        QxtBdbHash<int, QByteArray> db("large.db");
+        db.clear();
+        for (int i = 0; i < 5; i++)
+            QVERIFY(db.insert(i, QByteArray(700 * 1024 * (i + 1), 'a' + i)));
+        QxtBdbHashScan<int, QByteArray> scan = db.scan();
+        for (int i = 0; i < 5; i++)
+        {
+            QVERIFY(scan.next());
+            QCOMPARE(scan.key(), i);
+            QCOMPARE(scan.value(), QByteArray(700 * 1024 * (i + 1), 'a' + i));
+        }
+        QVERIFY(!scan.next());
+        db.clear();
+    }
+
+    void benchmarkIterate_data()
+    {
+        QTest::addColumn<bool>("bulk");
+        QTest::newRow("iterator") << false;
+        QTest::newRow("scan") << true;
+    }
+    void benchmarkIterate()
+    {
+        QFETCH(bool, bulk);
+        qint64 total = 0;
+        if (bulk)
+        {
+            QBENCHMARK {
+                QxtBdbHashScan<int, QString> scan = numbers.scan();
+                while (scan.next())
+                    total += scan.key();
+            }
+        }
+        else
+        {
+            QBENCHMARK {
+                for (QxtBdbHashIterator<int, QString> it = numbers.begin(); it.isValid(); ++it)
+                    total += it.key();
+            }
+        }
+        QVERIFY(total < 0);
+    }
+
+    void cleanupTestCase()
+    {
+        numbers.clear();
+    }
+
+private:
+    QxtBdbHash<int, QString> numbers;
+};
+
+QTEST_MAIN(Test)
+#include "main.moc"
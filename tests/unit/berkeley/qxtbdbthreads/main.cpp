@@ -0,0 +1,221 @@
+#include <QxtBdbEnvironment>
+#include <QxtBdbHash>
+#include <QTest>
+#include <QThread>
+#include <QDir>
+#include <QList>
+
+typedef QxtBdbHash<int, int> Numbers;
+
+class Reader : public QThread
+{
+public:
+    Reader(Numbers * db, int first, int count, bool snapshot = false)
+        : db(db), first(first), count(count), snapshot(snapshot), errors(0) {}
+
+    Numbers * db;
+    int first;
+    int count;
+    bool snapshot;
+    int errors;
+
+protected:
+    void run()
+    {
+        if (snapshot && !db->snapshot())
+            errors++;
+        for (int i = 0; i < count; i++)
+        {
+            const int key = (first + i) % 10000;
+            if (db->value(key) != key * 3)
+                errors++;
+        }
+        if (snapshot && !db->commit())
+            errors++;
+    }
+};
+
+class Writer : public QThread
+{
+public:
+    Writer(Numbers * db, int key, int value) : db(db), key(key), value(value), ok(false) {}
+
+    Numbers * db;
+    int key;
+    int value;
+    bool ok;
+
+protected:
+    void run()
+    {
+        ok = db->insert(key, value);
+        // transactions belong to the thread that started them
+        ok = ok && !db->commit();
+    }
+};
+
+class Test: public QObject
+{
+Q_OBJECT
+private:
+    static bool fill(Numbers & db)
+    {
+        db.clear();
+        QList<QPair<int, int> > pairs;
+        for (int i = 0; i < 10000; i++)
+            pairs << qMakePair(i, i * 3);
+        return db.load(pairs);
+    }
+
+    static int runReaders(Numbers * db, int threads, int lookups, bool snapshot)
+    {
+        QList<Reader *> readers;
+        for (int i = 0; i < threads; i++)
+            readers << new Reader(db, i * 7919, lookups / threads, snapshot);
+        foreach (Reader * reader, readers)
+            reader->start();
+        int errors = 0;
+        foreach (Reader * reader, readers)
+        {
+            reader->wait();
+            errors += reader->errors;
+        }
+        qDeleteAll(readers);
+        return errors;
+    }
+
+private slots:
+    void initTestCase()
+    {
+        QDir dir("threadenv");
+        foreach (const QString& file, dir.entryList(QDir::Files))
+            dir.remove(file);
+
+        env.setCacheSize(64 * 1024 * 1024);
+        QVERIFY(env.open("threadenv", QxtBdbEnvironment::Transactions | QxtBdbEnvironment::MultiVersion
+                         | QxtBdbEnvironment::NoSyncOnCommit));
+        QVERIFY(env.openFlags() & QxtBdbEnvironment::MultiVersion);
+
+        QVERIFY(bare.open("threads.db"));
+        QVERIFY(fill(bare));
+        QVERIFY(shared.open(env, "mvcc.db"));
+        QVERIFY(fill(shared));
+    }
+
+    void lookups()
+    {
+        QCOMPARE(bare.value(42), 126);
+        QVERIFY(bare.contains(9999));
+        QVERIFY(!bare.contains(10000));
+        QCOMPARE(bare.value(10000), 0);
+        QCOMPARE(shared.value(42), 126);
+        QVERIFY(!shared.contains(-1));
+    }
+
+    void concurrentLookups()
+    {
+        QCOMPARE(runReaders(&bare, 8, 80000, false), 0);
+        QCOMPARE(runReaders(&shared, 8, 80000, false), 0);
+        // the cursors of finished threads are gone, the database is still usable
+        QCOMPARE(bare.value(7), 21);
+    }
+
+    void threadTransactions()
+    {
+        QVERIFY(shared.transaction());
+        Writer writer(&shared, 20001, 2);
+        writer.start();
+        QVERIFY(writer.wait(10000));
+        QVERIFY(writer.ok);
+        QVERIFY(shared.insert(20000, 1));
+        QVERIFY(shared.rollback());
+        QVERIFY(!shared.contains(20000));
+        // the other thread wrote outside of our transaction
+        QCOMPARE(shared.value(20001), 2);
+        QVERIFY(shared.remove(20001));
+    }
+
+    void snapshot()
+    {
+        QVERIFY(!bare.snapshot());
+        QVERIFY(shared.snapshot());
+        QVERIFY(!shared.snapshot());
+        QCOMPARE(shared.value(5), 15);
+
+        // a reader inside a snapshot does not block the writer
+        Writer writer(&shared, 5, -1);
+        writer.start();
+        QVERIFY(writer.wait(10000));
+        QVERIFY(writer.ok);
+
+        QCOMPARE(shared.value(5), 15);
+        QVERIFY(shared.commit());
+        QCOMPARE(shared.value(5), -1);
+        QVERIFY(shared.insert(5, 15));
+    }
+
+    void clearWithCursors()
+    {
+        Numbers db("clear.db");
+        QVERIFY(db.insert(1, 3));
+        QCOMPARE(db.value(1), 3);
+        db.clear();
+        QVERIFY(!db.contains(1));
+        QVERIFY(db.insert(1, 3));
+        QCOMPARE(db.value(1), 3);
+        db.clear();
+    }
+
+    void reopenAcrossThreads()
+    {
+        // every database leaves per thread state behind, a later one must not see it
+        for (int i = 0; i < 4; i++)
+        {
+            Numbers db("reopen.db");
+            QVERIFY(db.insert(i, i * 3));
+            QCOMPARE(db.value(i), i * 3);
+            QCOMPARE(runReaders(&bare, 2, 1000, false), 0);
+            Writer writer(&db, 100 + i, i);
+            writer.start();
+            QVERIFY(writer.wait(10000));
+            QVERIFY(writer.ok);
+            QCOMPARE(db.value(100 + i), i);
+        }
+        QCOMPARE(bare.value(7), 21);
+    }
+
+    void benchmarkLookups_data()
+    {
+        QTest::addColumn<int>("threads");
+        QTest::addColumn<bool>("snapshot");
+        for (int threads = 1; threads <= 32; threads *= 2)
+            QTest::newRow(qPrintable(QString("%1 threads").arg(threads))) << threads << false;
+        for (int threads = 1; threads <= 32; threads *= 2)
+            QTest::newRow(qPrintable(QString("%1 threads, snapshot").arg(threads))) << threads << true;
+    }
+    void benchmarkLookups()
+    {
+        QFETCH(int, threads);
+        QFETCH(bool, snapshot);
+        Numbers * db = snapshot ? &shared : &bare;
+        int errors = 0;
+        QBENCHMARK {
+            errors += runReaders(db, threads, 320000, snapshot);
+        }
+        QCOMPARE(errors, 0);
+    }
+
+    void cleanupTestCase()
+    {
+        bare.clear();
+        shared.clear();
+    }
+
+private:
+    QxtBdbEnvironment env;
+    Numbers bare;
+    Numbers shared;
+};
+
+QTEST_MAIN(Test)
+#include "main.moc"
@@ -2,6 +2,7 @@
 #include <QObject>
 #include <qxtmetaobject.h>
 #include <qxtboundcfunction.h>
+#include <qxttypedboundfunction.h>
 #include <QSignalSpy>
 
 void unaryVoidFunction(QObject* obj);
@@ -28,8 +29,21 @@ signals:
     void say(QString);
     void doit();
     void success();
+    void pair(int, QObject*);
+
+public slots:
+    int twice(int x)
+    {
+        return x * 2;
+    }
+    void count(int step, QObject*)
+    {
+        total += step;
+    }
 
 public:
+    int total;
+
     void unaryVoidFunctionSuccess() {
         emit success();
     }
@@ -81,6 +95,72 @@ private slots:
 
     }
 
+    void typed()
+    {
+        QxtTypedBoundFunction<QString>* sayHello = QxtMetaObject::bindTyped(this, SIGNAL(say(QString)), QString("hello"));
+        QVERIFY(sayHello != 0);
+        QVERIFY(QxtMetaObject::connect(this, SIGNAL(doit()), sayHello));
+        QSignalSpy spy(this, SIGNAL(say(QString)));
+        emit(doit());
+        QCOMPARE(spy.count(), 1);
+        QCOMPARE(spy.takeFirst().at(0).toString(), QString("hello"));
+
+        // the same binding is reused with new values
+        sayHello->setArguments(QString("again"));
+        emit(doit());
+        QCOMPARE(spy.count(), 1);
+        QCOMPARE(spy.takeFirst().at(0).toString(), QString("again"));
+        delete sayHello;
+
+        QxtTypedBoundFunction<int, QObject*>* pairFn = new QxtTypedBoundFunction<int, QObject*>(this, SIGNAL(pair(int, QObject*)));
+        QVERIFY(pairFn->isValid());
+        pairFn->setArguments(3, this);
+        QSignalSpy pairSpy(this, SIGNAL(pair(int, QObject*)));
+        QVERIFY(pairFn->invoke());
+        QCOMPARE(pairSpy.count(), 1);
+        QCOMPARE(pairSpy.at(0).at(0).toInt(), 3);
+        delete pairFn;
+
+        QxtTypedBoundFunction<int>* twiceFn = QxtMetaObject::bindTyped(this, SLOT(twice(int)), 21);
+        QVERIFY(twiceFn != 0);
+        QCOMPARE(twiceFn->invoke<int>().value(), 42);
+        delete twiceFn;
+
+        // types that do not match the method are rejected when binding
+        QVERIFY(QxtMetaObject::bindTyped(this, SLOT(twice(int)), QString("21")) == 0);
+        QVERIFY(QxtMetaObject::bindTyped(this, SLOT(twice(int)), 1, 2) == 0);
+        QVERIFY(QxtMetaObject::bindTyped(this, SLOT(nonexistent(int)), 1) == 0);
+    }
+
+    void benchmarkBind_data()
+    {
+        QTest::addColumn<bool>("typed");
+        QTest::newRow("QVariant") << false;
+        QTest::newRow("typed") << true;
+    }
+
+    void benchmarkBind()
+    {
+        QFETCH(bool, typed);
+        total = 0;
+        QxtBoundFunction* fn;
+        if (typed)
+            fn = new QxtTypedBoundFunction<int, QObject*>(this, SLOT(count(int, QObject*)));
+        else
+            fn = QxtMetaObject::bind(this, SLOT(count(int, QObject*)), Q_ARG(int, 1), Q_ARG(QObject*, this));
+        if (typed)
+            static_cast<QxtTypedBoundFunction<int, QObject*>*>(fn)->setArguments(1, this);
+        QxtMetaObject::connect(this, SIGNAL(doit()), fn);
+
+        QBENCHMARK
+        {
+            for (int i = 0; i < 10000; i++)
+                emit(doit());
+        }
+        QVERIFY(total >= 10000);
+        delete fn;
+    }
+
 };
 Q_DECLARE_METATYPE(QxtMetaObjectTest*)
 
@@ -1,5 +1,5 @@
 TEMPLATE = subdirs
-SUBDIRS += bind fifo json job modelserializer pipe sharedprivate slotmapper tempdir
+SUBDIRS += bind csvmodel currency fifo hmac json job linkedtree linesocket logger modelserializer pipe sharedprivate slotmapper tempdir
 SUBDIRS += filelock #permfail
 
 test.CONFIG += recursive
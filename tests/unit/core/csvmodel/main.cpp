@@ -0,0 +1,322 @@
+#include <QCoreApplication>
+#include <QxtCsvModel>
+#include <QxtCsvReader>
+#include <QxtCsvWriter>
+#include <QBuffer>
+#include <QTest>
+#include <QTemporaryFile>
+#include <QTextCodec>
+#include <QStringList>
+
+struct RowCounter
+{
+    RowCounter(int* count, int limit) : count(count), limit(limit) {}
+    bool operator()(const QStringList&)
+    {
+        return ++*count < limit;
+    }
+    int* count;
+    int limit;
+};
+
+class QxtCsvModelTest : public QObject
+{
+    Q_OBJECT
+private:
+    static void writeFile(QTemporaryFile& file, const QByteArray& content)
+    {
+        QVERIFY(file.open());
+        file.write(content);
+        file.close();
+    }
+
+    static void compare(const QxtCsvModel& mapped, const QxtCsvModel& loaded)
+    {
+        QCOMPARE(mapped.rowCount(), loaded.rowCount());
+        QCOMPARE(mapped.columnCount(), loaded.columnCount());
+        for (int col = 0; col < loaded.columnCount(); col++)
+            QCOMPARE(mapped.headerData(col, Qt::Horizontal), loaded.headerData(col, Qt::Horizontal));
+        for (int row = 0; row < loaded.rowCount(); row++)
+            for (int col = 0; col < loaded.columnCount(); col++)
+                QCOMPARE(mapped.text(row, col), loaded.text(row, col));
+    }
+
+private slots:
+    void mapped_data()
+    {
+        QTest::addColumn<QByteArray>("content");
+        QTest::addColumn<bool>("withHeader");
+        QTest::addColumn<int>("quoteMode");
+
+        QTest::newRow("plain") << QByteArray("a,b,c\n1,2,3\n4,5\n") << false << int(QxtCsvModel::DefaultQuoteMode);
+        QTest::newRow("header") << QByteArray("x,y\n1,2\n3,4") << true << int(QxtCsvModel::DefaultQuoteMode);
+        QTest::newRow("crlf") << QByteArray("a,b\r\n\r\nc,d\r\n") << false << int(QxtCsvModel::DefaultQuoteMode);
+        QTest::newRow("quoted") << QByteArray("\"a,b\",'c\nd',e\n\"x\\\"y\",z\n") << false << int(QxtCsvModel::DefaultQuoteMode);
+        QTest::newRow("twoquote") << QByteArray("\"a\"\"b\",c\n\"\"\"\",d\n") << false << int(QxtCsvModel::DoubleQuote | QxtCsvModel::TwoQuoteEscape);
+        QTest::newRow("noquotes") << QByteArray("\"a,b\"\n") << false << int(QxtCsvModel::NoQuotes);
+        QTest::newRow("utf8") << QByteArray("\xEF\xBB\xBF\xC3\xA9t\xC3\xA9,\xE2\x82\xAC\n") << false << int(QxtCsvModel::DefaultQuoteMode);
+    }
+
+    void mapped()
+    {
+        QFETCH(QByteArray, content);
+        QFETCH(bool, withHeader);
+        QFETCH(int, quoteMode);
+
+        QTemporaryFile file;
+        writeFile(file, content);
+
+        QxtCsvModel loaded;
+        loaded.setQuoteMode(QxtCsvModel::QuoteMode(quoteMode));
+        loaded.setSource(file.fileName(), withHeader, ',', QTextCodec::codecForName("UTF-8"));
+
+        QxtCsvModel mapped;
+        mapped.setQuoteMode(QxtCsvModel::QuoteMode(quoteMode));
+        QVERIFY(mapped.mapSource(file.fileName(), withHeader));
+        QVERIFY(mapped.isMapped());
+        compare(mapped, loaded);
+    }
+
+    void mappedChunks()
+    {
+        // over 8 MB, so the scan is split into chunks of at least 4 MB when there are two
+        // or more cores; nearly every line break lies inside a quoted multi-line cell, so
+        // the chunk boundaries do too
+        QByteArray cell;
+        for (int i = 0; i < 2000; i++)
+            cell += "line " + QByteArray::number(i) + ",with,commas\n";
+        QByteArray content;
+        for (int i = 0; content.size() <= 8 * 1024 * 1024 + 4096; i++)
+            content += QByteArray::number(i) + ",\"" + cell + QByteArray::number(i) + "\",end " + QByteArray::number(i) + "\n";
+        QTemporaryFile file;
+        writeFile(file, content);
+
+        QxtCsvModel loaded;
+        loaded.setSource(file.fileName(), false, ',', QTextCodec::codecForName("UTF-8"));
+        QCOMPARE(loaded.columnCount(), 3);
+
+        QxtCsvModel mapped;
+        QVERIFY(mapped.mapSource(file.fileName()));
+        QVERIFY(mapped.isMapped());
+        compare(mapped, loaded);
+    }
+
+    void rowCache()
+    {
+        QByteArray content;
+        for (int i = 0; i < 100; i++)
+            content += QByteArray::number(i) + ",\"row " + QByteArray::number(i) + "\"\n";
+        QTemporaryFile file;
+        writeFile(file, content);
+
+        QxtCsvModel model;
+        model.setRowCacheSize(10);
+        QCOMPARE(model.rowCacheSize(), 10);
+        QVERIFY(model.mapSource(file.fileName()));
+        QCOMPARE(model.rowCount(), 100);
+        for (int pass = 0; pass < 2; pass++)
+            for (int i = 99; i >= 0; i--)
+                QCOMPARE(model.text(i, 1), QString("row %1").arg(i));
+    }
+
+    void editMapped()
+    {
+        QTemporaryFile file;
+        writeFile(file, "a,b\nc,d\n");
+
+        QxtCsvModel model;
+        QVERIFY(model.mapSource(file.fileName()));
+        model.setText(1, 0, "e");
+        QVERIFY(!model.isMapped());
+        QCOMPARE(model.text(0, 1), QString("b"));
+        QCOMPARE(model.text(1, 0), QString("e"));
+        QVERIFY(model.removeRow(0));
+        QCOMPARE(model.rowCount(), 1);
+        QCOMPARE(model.text(0, 1), QString("d"));
+    }
+
+    void fallback()
+    {
+        QTemporaryFile file;
+        writeFile(file, QByteArray("\xFF\xFE" "a\0,\0b\0\n\0", 10));
+
+        QxtCsvModel model;
+        QVERIFY(!model.mapSource(file.fileName()));
+        QVERIFY(!model.isMapped());
+        QCOMPARE(model.rowCount(), 1);
+        QCOMPARE(model.text(0, 1), QString("b"));
+    }
+
+    void reader_data()
+    {
+        mapped_data();
+    }
+
+    void reader()
+    {
+        QFETCH(QByteArray, content);
+        QFETCH(bool, withHeader);
+        QFETCH(int, quoteMode);
+
+        QTemporaryFile file;
+        writeFile(file, content);
+        QxtCsvModel loaded;
+        loaded.setQuoteMode(QxtCsvModel::QuoteMode(quoteMode));
+        loaded.setSource(file.fileName(), withHeader, ',', QTextCodec::codecForName("UTF-8"));
+
+        QBuffer buffer(&content);
+        QxtCsvReader reader(&buffer, ',', QxtCsvModel::QuoteMode(quoteMode));
+        QStringList row;
+        // the reader has no notion of a header, it returns it as the first row
+        if (withHeader)
+        {
+            QVERIFY(reader.readRow(row));
+            for (int col = 0; col < row.count(); col++)
+                QCOMPARE(row.at(col), loaded.headerData(col, Qt::Horizontal).toString());
+        }
+        int count = 0;
+        while (reader.readRow(row))
+        {
+            for (int col = 0; col < row.count(); col++)
+                QCOMPARE(row.at(col), loaded.text(count, col));
+            count++;
+        }
+        QVERIFY(reader.atEnd());
+        QCOMPARE(count, loaded.rowCount());
+        QCOMPARE(reader.rowsRead(), qint64(count + (withHeader ? 1 : 0)));
+    }
+
+    void readerBlocks()
+    {
+        // fields and line breaks that straddle the reader's internal blocks
+        QByteArray content;
+        QList<QStringList> expected;
+        for (int i = 0; i < 40; i++)
+        {
+            const QByteArray big(20000 + i * 997, 'a' + i % 26);
+            content += "\"" + big + "\"\"x\n\"," + QByteArray::number(i) + "\r\n";
+            expected << (QStringList() << QString(big) + "\"x\n" << QString::number(i));
+        }
+        QBuffer buffer(&content);
+        QxtCsvReader reader(&buffer, ',', QxtCsvModel::DoubleQuote | QxtCsvModel::TwoQuoteEscape);
+        QStringList row;
+        for (int i = 0; i < expected.count(); i++)
+        {
+            QVERIFY(reader.readRow(row));
+            QCOMPARE(row, expected.at(i));
+        }
+        QVERIFY(!reader.readRow(row));
+    }
+
+    void readRows()
+    {
+        QByteArray content("1\n2\n3\n4\n");
+        QBuffer buffer(&content);
+        QxtCsvReader reader(&buffer);
+        int count = 0;
+        QCOMPARE(reader.readRows(RowCounter(&count, 2)), qint64(2));
+        QCOMPARE(count, 2);
+        QStringList row;
+        QVERIFY(reader.readRow(row));
+        QCOMPARE(row, QStringList() << "3");
+    }
+
+    void writer_data()
+    {
+        QTest::addColumn<int>("quoteMode");
+        QTest::addColumn<QByteArray>("expected");
+
+        QTest::newRow("default") << int(QxtCsvModel::DefaultQuoteMode)
+            << QByteArray("\"a\",\"b,c\",\"d\\\"e\",\"f\\\\g\"\n");
+        QTest::newRow("minimal") << int(QxtCsvModel::DoubleQuote | QxtCsvModel::TwoQuoteEscape)
+            << QByteArray("a,\"b,c\",\"d\"\"e\",f\\g\n");
+        QTest::newRow("single") << int(QxtCsvModel::SingleQuote | QxtCsvModel::BackslashEscape)
+            << QByteArray("a,'b,c','d\"e','f\\\\g'\n");
+    }
+
+    void writer()
+    {
+        QFETCH(int, quoteMode);
+        QFETCH(QByteArray, expected);
+
+        const QStringList fields = QStringList() << "a" << "b,c" << "d\"e" << "f\\g";
+        QByteArray output;
+        QBuffer buffer(&output);
+        buffer.open(QIODevice::WriteOnly);
+        {
+            QxtCsvWriter writer(&buffer, ',', QxtCsvModel::QuoteMode(quoteMode));
+            writer.writeRow(fields);
+            QCOMPARE(writer.rowsWritten(), qint64(1));
+        }
+        QCOMPARE(output, expected);
+
+        buffer.close();
+        buffer.open(QIODevice::ReadOnly);
+        QxtCsvReader reader(&buffer, ',', QxtCsvModel::QuoteMode(quoteMode));
+        QStringList row;
+        QVERIFY(reader.readRow(row));
+        QCOMPARE(row, fields);
+    }
+
+    void benchmarkReader()
+    {
+        QByteArray content;
+        for (int i = 0; i < 200000; i++)
+            content += "12345,\"some, quoted text\",67.89,plain text field\n";
+        QBENCHMARK {
+            QBuffer buffer(&content);
+            QxtCsvReader reader(&buffer);
+            QStringList row;
+            while (reader.readRow(row))
+                ;
+        }
+    }
+
+    void benchmarkWriter()
+    {
+        const QStringList row = QStringList() << "12345" << "some, quoted text" << "67.89" << "plain text field";
+        QBENCHMARK {
+            QByteArray output;
+            QBuffer buffer(&output);
+            buffer.open(QIODevice::WriteOnly);
+            QxtCsvWriter writer(&buffer, ',', QxtCsvModel::DoubleQuote | QxtCsvModel::TwoQuoteEscape);
+            for (int i = 0; i < 200000; i++)
+                writer.writeRow(row);
+        }
+    }
+
+    void benchmarkMap()
+    {
+        QByteArray content;
+        for (int i = 0; i < 200000; i++)
+            content += "12345,\"some, quoted text\",67.89,plain text field\n";
+        QTemporaryFile file;
+        writeFile(file, content);
+
+        QxtCsvModel model;
+        QBENCHMARK {
+            model.mapSource(file.fileName());
+            model.text(100000, 1);
+        }
+        QCOMPARE(model.rowCount(), 200000);
+    }
+
+    void benchmarkLoad()
+    {
+        QByteArray content;
+        for (int i = 0; i < 200000; i++)
+            content += "12345,\"some, quoted text\",67.89,plain text field\n";
+        QTemporaryFile file;
+        writeFile(file, content);
+
+        QxtCsvModel model;
+        QBENCHMARK {
+            model.setSource(file.fileName());
+            model.text(100000, 1);
+        }
+        QCOMPARE(model.rowCount(), 200000);
+    }
+};
+
+QTEST_MAIN(QxtCsvModelTest)
+#include "main.moc"
@@ -0,0 +1,351 @@
+#include <QxtCurrency>
+#include <QxtCurrencyVector>
+#include <QLocale>
+#include <QTest>
+#include <QStringList>
+#include <QVector>
+#include <cstring>
+
+class Test: public QObject
+{
+Q_OBJECT
+private:
+    static QVector<QxtCurrency> values(int count, int seed)
+    {
+        QVector<QxtCurrency> result(count);
+        qsrand(seed);
+        for (int i = 0; i < count; i++)
+        {
+            if (qrand() % 11 == 0)
+                result[i].setNull();
+            else
+                result[i] = QxtCurrency(qlonglong(qrand() - RAND_MAX / 2) * 1237);
+        }
+        return result;
+    }
+
+    static bool same(const QxtCurrency& a, const QxtCurrency& b)
+    {
+        return a.value == b.value;
+    }
+
+private slots:
+    void arithmetic_data()
+    {
+        QTest::addColumn<int>("count");
+        QTest::newRow("empty") << 0;
+        QTest::newRow("one") << 1;
+        QTest::newRow("odd") << 7;
+        QTest::newRow("many") << 1001;
+    }
+    void arithmetic()
+    {
+        QFETCH(int, count);
+        const QVector<QxtCurrency> a = values(count, 1);
+        const QVector<QxtCurrency> b = values(count, 2);
+        QVector<QxtCurrency> out(count);
+
+        QxtCurrencyVector::add(a.constData(), b.constData(), out.data(), count);
+        for (int i = 0; i < count; i++)
+            QVERIFY(same(out[i], a[i] + b[i]));
+        QxtCurrencyVector::subtract(a.constData(), b.constData(), out.data(), count);
+        for (int i = 0; i < count; i++)
+            QVERIFY(same(out[i], a[i] - b[i]));
+        QxtCurrencyVector::scale(a.constData(), -3, out.data(), count);
+        for (int i = 0; i < count; i++)
+            QVERIFY(same(out[i], a[i] * -3));
+        QxtCurrencyVector::scale(a.constData(), 1.0375, out.data(), count);
+        for (int i = 0; i < count; i++)
+            QVERIFY(same(out[i], a[i] * 1.0375));
+        for (int n = -2; n <= 4; n++)
+        {
+            QxtCurrencyVector::round(a.constData(), out.data(), count, n);
+            for (int i = 0; i < count; i++)
+                QVERIFY(same(out[i], a[i].round(n)));
+        }
+
+        QxtCurrency total;
+        foreach (const QxtCurrency& v, a)
+            total += v;
+        QVERIFY(same(QxtCurrencyVector::sum(a.constData(), count), total));
+
+        // in place
+        out = a;
+        QxtCurrencyVector::add(out.constData(), b.constData(), out.data(), count);
+        for (int i = 0; i < count; i++)
+            QVERIFY(same(out[i], a[i] + b[i]));
+    }
+
+    void amortization()
+    {
+        const int count = 200;
+        QVector<QxtCurrency> P(count), p(count), payments(count);
+        QVector<double> r(count);
+        QVector<int> n(count);
+        qsrand(3);
+        for (int i = 0; i < count; i++)
+        {
+            P[i] = QxtCurrency(1000 + qrand() % 500000);
+            r[i] = (qrand() % 1200) / 120000.0;
+            n[i] = qrand() % 400;
+            // every fourth payment is left to amortize()
+            p[i] = i % 4 ? QxtCurrency::amortizedPayment(P[i], r[i], n[i]).round() + (i % 3) : QxtCurrency(-1);
+        }
+
+        QxtCurrencyVector::amortizedPayment(P.constData(), r.constData(), n.constData(), payments.data(), count);
+        for (int i = 0; i < count; i++)
+            QVERIFY(same(payments[i], QxtCurrency::amortizedPayment(P[i], r[i], n[i])));
+
+        QVector<QxtCurrency::Pair> interest(count);
+        QVector<QxtCurrency> paid(count);
+        for (int i = 0; i < count; i++)
+            paid[i] = p[i] < 0 ? payments[i].round() : p[i];
+        QxtCurrencyVector::amortizedInterest(P.constData(), r.constData(), n.constData(), paid.constData(), interest.data(), count);
+        for (int i = 0; i < count; i++)
+        {
+            const QxtCurrency::Pair expected = QxtCurrency::amortizedInterest(P[i], r[i], n[i], paid[i]);
+            QVERIFY(same(interest[i].first, expected.first));
+            QVERIFY(same(interest[i].second, expected.second));
+        }
+
+        QVector<QxtCurrency::Pair> schedules(QxtCurrencyVector::scheduleSize(n.constData(), count));
+        QxtCurrencyVector::amortize(P.constData(), r.constData(), n.constData(), p.constData(), schedules.data(), count);
+        int at = 0;
+        for (int i = 0; i < count; i++)
+        {
+            const QList<QxtCurrency::Pair> expected = QxtCurrency::amortize(P[i], r[i], n[i], p[i]);
+            QCOMPARE(expected.count(), n[i]);
+            for (int k = 0; k < n[i]; k++, at++)
+            {
+                QVERIFY(same(schedules[at].first, expected[k].first));
+                QVERIFY(same(schedules[at].second, expected[k].second));
+            }
+        }
+        QCOMPARE(at, schedules.count());
+
+        // without payments every one is calculated
+        QxtCurrencyVector::amortize(P.constData(), r.constData(), n.constData(), 0, schedules.data(), 1);
+        const QList<QxtCurrency::Pair> first = QxtCurrency::amortize(P[0], r[0], n[0]);
+        for (int k = 0; k < n[0]; k++)
+            QVERIFY(same(schedules[k].first, first[k].first));
+    }
+
+    void text()
+    {
+        const QVector<QxtCurrency> a = values(1001, 6);
+        QByteArray expected;
+        for (int i = 0; i < a.count(); i++)
+        {
+            if (i)
+                expected += ',';
+            if (!a[i].isNull())
+                expected += a[i].toString();
+        }
+
+        QByteArray buffer(expected.size() + 64, '#');
+        int written = -1;
+        QCOMPARE(QxtCurrencyVector::format(a.constData(), a.count(), ',', buffer.data(), buffer.size(), &written), a.count());
+        QCOMPARE(buffer.left(written), expected);
+
+        QVector<QxtCurrency> parsed(a.count());
+        int consumed = -1;
+        QCOMPARE(QxtCurrencyVector::parse(expected.constData(), expected.size(), ',', parsed.data(), parsed.count(), &consumed), a.count());
+        QCOMPARE(consumed, expected.size());
+        for (int i = 0; i < a.count(); i++)
+            QVERIFY(same(parsed[i], a[i]));
+
+        // a full buffer never splits a value
+        const int partial = QxtCurrencyVector::format(a.constData(), a.count(), ',', buffer.data(), 30, &written);
+        QVERIFY(written <= 30);
+        QCOMPARE(buffer.left(written), expected.left(written));
+        QCOMPARE(partial, expected.left(written).count(',') + 1);
+        QCOMPARE(expected.at(written), ',');
+        const int next = expected.indexOf(',', written + 1);
+        QVERIFY(next == -1 || next > 30);
+
+        // fields are parsed as by the constructor, surrounding blanks are removed
+        const QByteArray fields(" 1.5 ,,-2\r\n0.00019\n12abc\n");
+        QCOMPARE(QxtCurrencyVector::parse(fields.constData(), fields.size(), ',', parsed.data(), 2, &consumed), 2);
+        QCOMPARE(consumed, 7);
+        QVERIFY(same(parsed[0], QxtCurrency("1.5")));
+        QVERIFY(parsed[1].isNull());
+        QCOMPARE(QxtCurrencyVector::parse(fields.constData() + consumed, fields.size() - consumed, '\n', parsed.data(), 10), 3);
+        QVERIFY(same(parsed[0], QxtCurrency(-2)));
+        QVERIFY(same(parsed[1], QxtCurrency("0.0001")));
+        QVERIFY(same(parsed[2], QxtCurrency(12)));
+    }
+
+    void locale()
+    {
+        const QLocale german(QLocale::German, QLocale::Germany);
+        const QxtCurrency values[] = { QxtCurrency("1234567.89"), QxtCurrency("-1000"), QxtCurrency("0.5") };
+        char buffer[64];
+        int written = 0;
+        QCOMPARE(QxtCurrencyVector::format(values, 3, ';', buffer, sizeof(buffer), german, &written), 3);
+        QCOMPARE(QByteArray(buffer, written), QByteArray("1.234.567,89;-1.000;0,5"));
+
+        QxtCurrency parsed[3];
+        QCOMPARE(QxtCurrencyVector::parse(buffer, written, ';', parsed, 3, german), 3);
+        for (int i = 0; i < 3; i++)
+            QVERIFY(same(parsed[i], values[i]));
+
+        QLocale plain = german;
+        plain.setNumberOptions(QLocale::OmitGroupSeparator);
+        QCOMPARE(QxtCurrencyVector::format(values, 1, ';', buffer, sizeof(buffer), plain, &written), 1);
+        QCOMPARE(QByteArray(buffer, written), QByteArray("1234567,89"));
+
+        // multibyte separators survive the round trip
+        const QLocale french(QLocale::French, QLocale::France);
+        QCOMPARE(QxtCurrencyVector::format(values, 3, ';', buffer, sizeof(buffer), french, &written), 3);
+        QCOMPARE(QxtCurrencyVector::parse(buffer, written, ';', parsed, 3, french), 3);
+        for (int i = 0; i < 3; i++)
+            QVERIFY(same(parsed[i], values[i]));
+    }
+
+    void strings()
+    {
+        const char *texts[] = { "0", "-0.0005", "12.34567", "1.2.3", "+-1", "99x" };
+        for (unsigned i = 0; i < sizeof(texts) / sizeof(*texts); i++)
+        {
+            QVERIFY(same(QxtCurrency(QString::fromLatin1(texts[i])), QxtCurrency(texts[i])));
+            QVERIFY(same(QxtCurrency::fromVariant(QString::fromLatin1(texts[i])), QxtCurrency(texts[i])));
+            QVERIFY(same(QxtCurrency::fromVariant(QByteArray(texts[i])), QxtCurrency(texts[i])));
+        }
+        QCOMPARE(QxtCurrency(-5).toString(), QByteArray("-5"));
+        QCOMPARE(QxtCurrency("0.05").toString(), QByteArray("0.05"));
+        QCOMPARE(QxtCurrency("-10.0005").toString(), QByteArray("-10.0005"));
+        QCOMPARE(QxtCurrency().toString(), QByteArray("0"));
+    }
+
+    void benchmarkParse_data()
+    {
+        QTest::addColumn<bool>("vector");
+        QTest::newRow("QxtCurrency(QString)") << false;
+        QTest::newRow("QxtCurrencyVector::parse") << true;
+    }
+    void benchmarkParse()
+    {
+        QFETCH(bool, vector);
+        const QVector<QxtCurrency> a = values(100000, 7);
+        QByteArray text(a.count() * 24, ' ');
+        int written = 0;
+        QxtCurrencyVector::format(a.constData(), a.count(), '\n', text.data(), text.size(), &written);
+        text.truncate(written);
+        const QStringList lines = QString::fromLatin1(text).split(QLatin1Char('\n'));
+        QVector<QxtCurrency> out(a.count());
+        QBENCHMARK {
+            if (vector)
+                QxtCurrencyVector::parse(text.constData(), text.size(), '\n', out.data(), out.count());
+            else
+            {
+                for (int i = 0; i < lines.count(); i++)
+                    out[i] = lines[i].isEmpty() ? QxtCurrency::null() : QxtCurrency(lines[i]);
+            }
+        }
+        for (int i = 0; i < a.count(); i++)
+            QVERIFY(same(out[i], a[i]));
+    }
+
+    void benchmarkFormat_data()
+    {
+        QTest::addColumn<bool>("vector");
+        QTest::newRow("QxtCurrency::toString") << false;
+        QTest::newRow("QxtCurrencyVector::format") << true;
+    }
+    void benchmarkFormat()
+    {
+        QFETCH(bool, vector);
+        const QVector<QxtCurrency> a = values(100000, 8);
+        QByteArray text(a.count() * 24, ' ');
+        int written = 0;
+        QBENCHMARK {
+            if (vector)
+                QxtCurrencyVector::format(a.constData(), a.count(), '\n', text.data(), text.size(), &written);
+            else
+            {
+                char *p = text.data();
+                for (int i = 0; i < a.count(); i++)
+                {
+                    if (i)
+                        *p++ = '\n';
+                    if (!a[i].isNull())
+                    {
+                        const QByteArray value = a[i].toString();
+                        ::memcpy(p, value.constData(), value.size());
+                        p += value.size();
+                    }
+                }
+                written = int(p - text.constData());
+            }
+        }
+        QVERIFY(written > 0);
+    }
+
+    void benchmarkSum_data()
+    {
+        QTest::addColumn<bool>("vector");
+        QTest::newRow("operator+=") << false;
+        QTest::newRow("QxtCurrencyVector") << true;
+    }
+    void benchmarkSum()
+    {
+        QFETCH(bool, vector);
+        const QVector<QxtCurrency> a = values(100000, 4);
+        const QVector<QxtCurrency> b = values(100000, 5);
+        QVector<QxtCurrency> out(a.count());
+        QxtCurrency total;
+        QBENCHMARK {
+            if (vector)
+            {
+                QxtCurrencyVector::add(a.constData(), b.constData(), out.data(), a.count());
+                total = QxtCurrencyVector::sum(out.constData(), out.count());
+            }
+            else
+            {
+                total = QxtCurrency();
+                for (int i = 0; i < a.count(); i++)
+                {
+                    out[i] = a[i] + b[i];
+                    total += out[i];
+                }
+            }
+        }
+        QVERIFY(!total.isNull());
+    }
+
+    void benchmarkAmortize_data()
+    {
+        QTest::addColumn<bool>("vector");
+        QTest::newRow("QxtCurrency::amortize") << false;
+        QTest::newRow("QxtCurrencyVector::amortize") << true;
+    }
+    void benchmarkAmortize()
+    {
+        // a thousand 30 year mortgages
+        QFETCH(bool, vector);
+        const int count = 1000;
+        QVector<QxtCurrency> P(count);
+        QVector<double> r(count, 0.005);
+        QVector<int> n(count, 360);
+        for (int i = 0; i < count; i++)
+            P[i] = QxtCurrency(100000 + i * 250);
+        QVector<QxtCurrency::Pair> schedules(QxtCurrencyVector::scheduleSize(n.constData(), count));
+        QxtCurrency last;
+        QBENCHMARK {
+            if (vector)
+            {
+                QxtCurrencyVector::amortize(P.constData(), r.constData(), n.constData(), 0, schedules.data(), count);
+                last = schedules.last().first;
+            }
+            else
+            {
+                for (int i = 0; i < count; i++)
+                    last = QxtCurrency::amortize(P[i], r[i], n[i]).last().first;
+            }
+        }
+        QVERIFY(last > 0);
+    }
+};
+
+QTEST_MAIN(Test)
+#include "main.moc"
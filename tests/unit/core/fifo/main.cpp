@@ -5,6 +5,35 @@
 #include <QDebug>
 #include <QByteArray>
 #include <QDataStream>
+#include <QThread>
+
+class FifoWriter : public QThread
+{
+public:
+    FifoWriter(QxtFifo* fifo, int total) : fifo(fifo), total(total) {}
+    void run()
+    {
+        char chunk[100];
+        int sent = 0;
+        while (sent < total)
+        {
+            int size = qMin(int(sizeof(chunk)), total - sent);
+            for (int i = 0; i < size; i++)
+                chunk[i] = char((sent + i) % 251);
+            int offset = 0;
+            while (offset < size)
+            {
+                qint64 written = fifo->write(chunk + offset, size - offset);
+                if (written == 0)
+                    yieldCurrentThread();
+                offset += int(written);
+            }
+            sent += size;
+        }
+    }
+    QxtFifo* fifo;
+    int total;
+};
 
 class QxtFifoPipeTest: public QObject
 {
@@ -49,6 +78,103 @@ class QxtFifoPipeTest: public QObject
     }
 
 
+    void partialRead()
+    {
+        QxtFifo fifo;
+        fifo.write("hello ");
+        fifo.write("world");
+        QCOMPARE(fifo.read(3), QByteArray("hel"));
+        QCOMPARE(fifo.read(5), QByteArray("lo wo"));
+        QCOMPARE(fifo.readAll(), QByteArray("rld"));
+    }
+
+    void coalescedNotifications()
+    {
+        QxtFifo fifo;
+        QSignalSpy spyr(&fifo, SIGNAL(readyRead()));
+        QSignalSpy spyw(&fifo, SIGNAL(bytesWritten(qint64)));
+        for (int i = 0; i < 10; i++)
+            fifo.write("0123456789");
+        QCoreApplication::processEvents();
+        QCOMPARE(spyr.count(), 1);
+        QCOMPARE(spyw.count(), 1);
+        QCOMPARE(spyw.at(0).at(0).toLongLong(), qint64(100));
+        fifo.write("more");
+        QCoreApplication::processEvents();
+        QCOMPARE(spyr.count(), 2);
+    }
+
+    void ringBuffer()
+    {
+        QxtFifo fifo;
+        QVERIFY(fifo.setRingBufferCapacity(10));
+        QCOMPARE(fifo.ringBufferCapacity(), 16);
+        QCOMPARE(fifo.bytesFree(), qint64(16));
+        QCOMPARE(fifo.write("0123456789"), qint64(10));
+        QCOMPARE(fifo.read(8), QByteArray("01234567"));
+        // wraps around the end of the buffer
+        QCOMPARE(fifo.write("abcdefghijklmnopq"), qint64(14));
+        QCOMPARE(fifo.bytesFree(), qint64(0));
+        QCOMPARE(fifo.write("x"), qint64(0));
+        QVERIFY(!fifo.setRingBufferCapacity(32));
+        QCOMPARE(fifo.readAll(), QByteArray("89abcdefghijklmn"));
+        QCOMPARE(fifo.bytesAvailable(), qint64(0));
+    }
+
+    void readPointer()
+    {
+        QxtFifo fifo;
+        fifo.write("abc");
+        fifo.write("def");
+        qint64 size;
+        const char* data = fifo.readPointer(&size);
+        QVERIFY(data);
+        QCOMPARE(QByteArray(data, size), QByteArray("abc"));
+        fifo.commitRead(2);
+        data = fifo.readPointer(&size);
+        QCOMPARE(QByteArray(data, size), QByteArray("c"));
+        fifo.commitRead(1);
+        data = fifo.readPointer(&size);
+        QCOMPARE(QByteArray(data, size), QByteArray("def"));
+        fifo.commitRead(3);
+        QVERIFY(!fifo.readPointer(&size));
+        QCOMPARE(size, qint64(0));
+
+        QVERIFY(fifo.setRingBufferCapacity(8));
+        fifo.write("123456");
+        fifo.read(5);
+        fifo.write("7890");
+        data = fifo.readPointer(&size);
+        QCOMPARE(QByteArray(data, size), QByteArray("678"));
+        fifo.commitRead(size);
+        data = fifo.readPointer(&size);
+        QCOMPARE(QByteArray(data, size), QByteArray("90"));
+    }
+
+    void ringBufferThreads()
+    {
+        const int total = 1000000;
+        QxtFifo fifo;
+        QVERIFY(fifo.setRingBufferCapacity(4096));
+        FifoWriter writer(&fifo, total);
+        writer.start();
+        int received = 0;
+        bool ordered = true;
+        char buffer[333];
+        while (received < total)
+        {
+            qint64 size = fifo.read(buffer, sizeof(buffer));
+            for (int i = 0; i < size; i++)
+                ordered &= (buffer[i] == char((received + i) % 251));
+            received += int(size);
+            if (size == 0)
+                QThread::yieldCurrentThread();
+        }
+        writer.wait();
+        QVERIFY(ordered);
+        QCOMPARE(fifo.bytesAvailable(), qint64(0));
+    }
+
     void cleanupTestCase()
     {
         delete(io);
@@ -0,0 +1,159 @@
+#include <QCoreApplication>
+#include <QxtHmac>
+#include <QTest>
+#include <QStringList>
+
+Q_DECLARE_METATYPE(QCryptographicHash::Algorithm)
+
+class QxtHmacTest : public QObject
+{
+    Q_OBJECT
+private slots:
+    void vectors_data()
+    {
+        QTest::addColumn<QCryptographicHash::Algorithm>("algorithm");
+        QTest::addColumn<QByteArray>("key");
+        QTest::addColumn<QByteArray>("data");
+        QTest::addColumn<QByteArray>("expected");
+
+        // RFC 2202 and RFC 4231
+        QTest::newRow("md5") << QCryptographicHash::Md5 << QByteArray(16, 0x0b) << QByteArray("Hi There")
+            << QByteArray("9294727a3638bb1c13f48ef8158bfc9d");
+        QTest::newRow("sha1") << QCryptographicHash::Sha1 << QByteArray(20, 0x0b) << QByteArray("Hi There")
+            << QByteArray("b617318655057264e28bc0b6fb378c8ef146be00");
+        QTest::newRow("sha1 long key") << QCryptographicHash::Sha1 << QByteArray(80, char(0xaa))
+            << QByteArray("Test Using Larger Than Block-Size Key - Hash Key First")
+            << QByteArray("aa4ae5e15272d00e95705637ce8a3b55ed402112");
+#if QT_VERSION >= 0x050000
+        QTest::newRow("sha256") << QCryptographicHash::Sha256 << QByteArray(20, 0x0b) << QByteArray("Hi There")
+            << QByteArray("b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7");
+        QTest::newRow("sha256 long key") << QCryptographicHash::Sha256 << QByteArray(131, char(0xaa))
+            << QByteArray("Test Using Larger Than Block-Size Key - Hash Key First")
+            << QByteArray("60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54");
+        QTest::newRow("sha512") << QCryptographicHash::Sha512 << QByteArray(20, 0x0b) << QByteArray("Hi There")
+            << QByteArray("87aa7cdea5ef619d4ff0b4241a1d6cb02379f4e2ce4ec2787ad0b30545e17cde"
+                          "daa833b7d6b8a702038b274eaea3f4e4be9d914eeb61f1702e696c203a126854");
+#endif
+    }
+
+    void vectors()
+    {
+        QFETCH(QCryptographicHash::Algorithm, algorithm);
+        QFETCH(QByteArray, key);
+        QFETCH(QByteArray, data);
+        QFETCH(QByteArray, expected);
+
+        QCOMPARE(QxtHmac::hash(key, data, algorithm).toHex(), expected);
+
+        QxtHmacKey prepared(key, algorithm);
+        QCOMPARE(prepared.sign(data).toHex(), expected);
+        QVERIFY(prepared.verify(data, QByteArray::fromHex(expected)));
+
+        QxtHmac hmac(prepared);
+        hmac.addData(data.left(3));
+        hmac.addData(data.mid(3));
+        QCOMPARE(hmac.result().toHex(), expected);
+        hmac.reset();
+        hmac.addData(data);
+        QCOMPARE(hmac.result().toHex(), expected);
+    }
+
+    void verify()
+    {
+        QxtHmacKey key("secret", QCryptographicHash::Sha1);
+        const QByteArray mac = key.sign("message");
+        QVERIFY(key.verify("message", mac));
+        QVERIFY(!key.verify("massage", mac));
+        QVERIFY(!key.verify("message", mac.left(mac.size() - 1)));
+        QByteArray forged = mac;
+        forged[forged.size() - 1] = forged.at(forged.size() - 1) ^ 1;
+        QVERIFY(!key.verify("message", forged));
+
+        QVERIFY(QxtHmac::compare(QByteArray(), QByteArray()));
+        QVERIFY(!QxtHmac::compare("abc", "abd"));
+        QVERIFY(!QxtHmac::compare("abc", "ab"));
+
+        QxtHmac hmac(QCryptographicHash::Sha1);
+        hmac.setKey(QByteArray("secret"));
+        hmac.addData("message");
+        QVERIFY(hmac.verify(hmac.innerHash()));
+        QVERIFY(QxtHmac::verify("secret", mac, hmac.innerHash(), QCryptographicHash::Sha1));
+    }
+
+    void nullKey()
+    {
+        QVERIFY(QxtHmacKey().isNull());
+        QVERIFY(!QxtHmacKey("", QCryptographicHash::Md5).isNull());
+        QxtHmacKey key("secret", QCryptographicHash::Md5);
+        QxtHmacKey copy;
+        copy = key;
+        QCOMPARE(copy.algorithm(), QCryptographicHash::Md5);
+        QCOMPARE(copy.sign("x"), key.sign("x"));
+    }
+
+    void signAll()
+    {
+        QxtHmacKey key("secret", QCryptographicHash::Sha1);
+        QList<QByteArray> messages;
+        for (int i = 0; i < 2000; i++)
+            messages << QByteArray(i * 97 % 4096, char(i));
+        const QList<QByteArray> macs = key.signAll(messages);
+        QCOMPARE(macs.count(), messages.count());
+        for (int i = 0; i < messages.count(); i++)
+            QCOMPARE(macs.at(i), key.sign(messages.at(i)));
+        QVERIFY(key.signAll(QList<QByteArray>()).isEmpty());
+    }
+
+    void benchmarkSign_data()
+    {
+        QTest::addColumn<int>("size");
+        QTest::addColumn<bool>("prepared");
+        const int sizes[] = { 64, 1024, 16 * 1024, 256 * 1024, 1024 * 1024 };
+        for (unsigned i = 0; i < sizeof(sizes) / sizeof(*sizes); i++)
+        {
+            const int size = sizes[i];
+            QTest::newRow(qPrintable(QString("%1 bytes, QxtHmac::hash").arg(size))) << size << false;
+            QTest::newRow(qPrintable(QString("%1 bytes, QxtHmacKey").arg(size))) << size << true;
+        }
+    }
+
+    void benchmarkSign()
+    {
+        QFETCH(int, size);
+        QFETCH(bool, prepared);
+
+        const QByteArray secret(32, 's');
+        const QByteArray message(size, 'm');
+        QxtHmacKey key(secret, QCryptographicHash::Sha1);
+        QBENCHMARK {
+            if (prepared)
+                key.sign(message);
+            else
+                QxtHmac::hash(secret, message, QCryptographicHash::Sha1);
+        }
+    }
+
+    void benchmarkSignAll_data()
+    {
+        QTest::addColumn<int>("size");
+        QTest::newRow("64 bytes") << 64;
+        QTest::newRow("4 KB") << 4096;
+        QTest::newRow("1 MB") << 1024 * 1024;
+    }
+
+    void benchmarkSignAll()
+    {
+        QFETCH(int, size);
+
+        QxtHmacKey key(QByteArray(32, 's'), QCryptographicHash::Sha1);
+        QList<QByteArray> messages;
+        for (int i = 0, total = 0; i < 10000 && total < 64 * 1024 * 1024; i++, total += size)
+            messages << QByteArray(size, char(i));
+        QBENCHMARK {
+            key.signAll(messages);
+        }
+    }
+};
+
+QTEST_MAIN(QxtHmacTest)
+#include "main.moc"
@@ -5,6 +5,9 @@ class Q43Thread : public QThread{public:void run(){exec();}}; /// qt < 4.3 backw
 
 #include <QSignalSpy>
 #include <QxtJob>
+#include <QxtJobExecutor>
+#include <QSemaphore>
+#include <QMutex>
 #include <qxtsignalwaiter.h>
 
 
@@ -24,6 +27,60 @@ public:
     }
 };
 
+// blocks its worker until the test releases the gate
+class GateJob : public QxtJob
+{
+public:
+    QSemaphore started;
+    QSemaphore gate;
+    virtual void run()
+    {
+        started.release();
+        gate.acquire();
+    }
+};
+
+// appends its tag to a shared list, to check the order in which jobs ran
+class OrderJob : public QxtJob
+{
+public:
+    OrderJob(QList<int>* order, QMutex* mutex, int tag) : order(order), mutex(mutex), tag(tag) {}
+    virtual void run()
+    {
+        QMutexLocker locker(mutex);
+        order->append(tag);
+    }
+    QList<int>* order;
+    QMutex* mutex;
+    int tag;
+};
+
+class CountJob : public QxtJob
+{
+public:
+    CountJob(QAtomicInt* counter) : counter(counter) {}
+    virtual void run()
+    {
+        counter->ref();
+    }
+    QAtomicInt* counter;
+};
+
+// waits on the job from a slot connected directly to its done() signal
+class WaitOnDone : public QObject
+{
+Q_OBJECT
+public:
+    WaitOnDone(QxtJob* job) : job(job), finished(false) {}
+    QxtJob* job;
+    bool finished;
+public slots:
+    void done()
+    {
+        finished = job->wait(1000);
+    }
+};
+
 class QxtJobTest : public QObject
 {
 Q_OBJECT
@@ -59,6 +116,175 @@ private slots:
         QVERIFY(l.b);
     }
 
+    void executor()
+    {
+        QxtJobExecutor executor(2);
+        QCOMPARE(executor.threadCount(), 2);
+
+        TestJob l;
+        QSignalSpy spy(&l, SIGNAL(done()));
+        l.exec(&executor);
+        QVERIFY(l.wait(1000));
+        QVERIFY(l.b);
+        QVERIFY(l.isFinished());
+        QCOMPARE(spy.count(), 1);
+
+        // a finished job can be submitted again
+        l.b = false;
+        QVERIFY(executor.submit(&l));
+        QVERIFY(executor.waitForDone(1000));
+        QVERIFY(l.b);
+        QCOMPARE(executor.activeJobCount(), 0);
+    }
+
+    void waitFromDone()
+    {
+        QxtJobExecutor executor(1);
+        TestJob l;
+        WaitOnDone waiter(&l);
+        connect(&l, SIGNAL(done()), &waiter, SLOT(done()), Qt::DirectConnection);
+        QxtSignalWaiter w(&l, SIGNAL(done()));
+        executor.submit(&l);
+        QVERIFY(w.wait(1000));
+        QVERIFY(waiter.finished);
+    }
+
+    void continuations()
+    {
+        QxtJobExecutor executor(4);
+        QList<int> order;
+        QMutex mutex;
+        OrderJob a(&order, &mutex, 1), b(&order, &mutex, 2), c(&order, &mutex, 3);
+        a.then(&b)->then(&c);
+        // nothing runs before the first job is submitted
+        QVERIFY(!b.wait(50));
+        QVERIFY(order.isEmpty());
+        executor.submit(&a);
+        QVERIFY(c.wait(1000));
+        QCOMPARE(order, QList<int>() << 1 << 2 << 3);
+
+        // a continuation of a job that has ended already runs right away
+        order.clear();
+        executor.submitAfter(&b, &a);
+        QVERIFY(b.wait(1000));
+        QCOMPARE(order, QList<int>() << 2);
+    }
+
+    void idleDependency()
+    {
+        TestJob after;
+        {
+            TestJob never;
+            never.then(&after);
+            QVERIFY(!after.wait(50));
+        }
+        // a dependency destroyed without having run cancels the jobs waiting on it
+        QVERIFY(after.wait(1000));
+        QVERIFY(after.isCanceled());
+        QVERIFY(!after.b);
+    }
+
+    void whenAll()
+    {
+        QxtJobExecutor executor(2);
+        GateJob first, second;
+        QAtomicInt count(0);
+        CountJob after(&count);
+        QList<QxtJob*> dependencies;
+        dependencies << &first << &second;
+        QVERIFY(executor.submitAfterAll(&after, dependencies));
+        executor.submit(&first);
+        executor.submit(&second);
+
+        first.gate.release();
+        QVERIFY(first.wait(1000));
+        QVERIFY(!after.wait(50));
+        second.gate.release();
+        QVERIFY(after.wait(1000));
+        QCOMPARE(count.fetchAndAddRelaxed(0), 1);
+    }
+
+    void whenAny()
+    {
+        QxtJobExecutor executor(2);
+        GateJob first, second;
+        QAtomicInt count(0);
+        CountJob after(&count);
+        QList<QxtJob*> dependencies;
+        dependencies << &first << &second;
+        QVERIFY(executor.submitAfterAny(&after, dependencies));
+        executor.submit(&first);
+        executor.submit(&second);
+
+        second.gate.release();
+        QVERIFY(after.wait(1000));
+        QCOMPARE(QxtJobExecutor::waitForAny(dependencies, 1000), 1);
+        first.gate.release();
+        QVERIFY(QxtJobExecutor::waitForAll(dependencies, 1000));
+        QCOMPARE(count.fetchAndAddRelaxed(0), 1);
+    }
+
+    void cancel()
+    {
+        QxtJobExecutor executor(1);
+        GateJob blocker;
+        TestJob queued, dependent;
+        QSignalSpy spy(&queued, SIGNAL(done()));
+        executor.submit(&blocker);
+        QVERIFY(blocker.started.tryAcquire(1, 1000));
+        executor.submit(&queued);
+        queued.then(&dependent);
+
+        // the queued job never runs, and the job depending on it is canceled too
+        QVERIFY(queued.cancel());
+        QVERIFY(queued.isCanceled());
+        QVERIFY(dependent.wait(1000));
+        QVERIFY(dependent.isCanceled());
+
+        // a running job only gets the request
+        QVERIFY(!blocker.cancel());
+        QVERIFY(blocker.isCanceled());
+        blocker.gate.release();
+        QVERIFY(executor.waitForDone(1000));
+        QVERIFY(!queued.b);
+        QVERIFY(!dependent.b);
+        QCOMPARE(spy.count(), 0);
+        QCOMPARE(QxtJobExecutor::waitForAny(QList<QxtJob*>() << &queued, 0), -1);
+    }
+
+    void waitTimeout()
+    {
+        QxtJobExecutor executor(1);
+        GateJob blocker;
+        executor.submit(&blocker);
+        QVERIFY(!executor.submit(&blocker));
+        QVERIFY(!blocker.wait(20));
+        QVERIFY(!executor.waitForDone(20));
+        QCOMPARE(QxtJobExecutor::waitForAny(QList<QxtJob*>() << &blocker, 20), -1);
+        blocker.gate.release();
+        QVERIFY(blocker.wait(1000));
+        QVERIFY(executor.waitForDone(1000));
+    }
+
+    void benchmarkExecutor()
+    {
+        QxtJobExecutor executor;
+        const int count = 10000;
+        QAtomicInt counter(0);
+        QList<CountJob*> jobs;
+        for (int i = 0; i < count; i++)
+            jobs << new CountJob(&counter);
+
+        QBENCHMARK
+        {
+            Q_FOREACH(CountJob* job, jobs)
+                executor.submit(job);
+            QVERIFY(executor.waitForDone(10000));
+        }
+        QVERIFY(counter.fetchAndAddRelaxed(0) >= count);
+        qDeleteAll(jobs);
+    }
+
     void cleanupTestCase()
     {
         t.quit();
@@ -0,0 +1,87 @@
+#include <QCoreApplication>
+#include <QxtLineSocket>
+#include <QxtFifo>
+#include <QTest>
+#include <QSignalSpy>
+
+#if QT_VERSION < 0x050000
+Q_DECLARE_METATYPE(QList<QByteArray>)
+#endif
+
+class QxtLineSocketTest: public QObject
+{
+Q_OBJECT
+private:
+    QxtFifo* fifo;
+    QxtLineSocket* socket;
+
+private slots:
+    void init()
+    {
+        fifo = new QxtFifo;
+        socket = new QxtLineSocket(fifo);
+    }
+    void cleanup()
+    {
+        delete socket;
+        delete fifo;
+    }
+
+    void batch()
+    {
+        QSignalSpy single(socket, SIGNAL(newLineReceived(QByteArray)));
+        QSignalSpy batch(socket, SIGNAL(newLinesReceived(QList<QByteArray>)));
+        fifo->write("one\ntwo\nthree\nfo");
+        QCoreApplication::processEvents();
+        QCOMPARE(single.count(), 3);
+        QCOMPARE(batch.count(), 1);
+        QList<QByteArray> lines = batch.at(0).at(0).value<QList<QByteArray> >();
+        QCOMPARE(lines, QList<QByteArray>() << "one" << "two" << "three");
+
+        fifo->write("ur\n\nfive\n");
+        QCoreApplication::processEvents();
+        QCOMPARE(batch.count(), 2);
+        lines = batch.at(1).at(0).value<QList<QByteArray> >();
+        QCOMPARE(lines, QList<QByteArray>() << "four" << "" << "five");
+    }
+
+    void maximumLineLength()
+    {
+        socket->setMaximumLineLength(4);
+        QSignalSpy single(socket, SIGNAL(newLineReceived(QByteArray)));
+        QSignalSpy tooLong(socket, SIGNAL(lineTooLong()));
+        fifo->write("ok\ntoolong\nabcd\nstill");
+        QCoreApplication::processEvents();
+        QCOMPARE(tooLong.count(), 2);
+        fifo->write("going\nend\n");
+        QCoreApplication::processEvents();
+        QCOMPARE(tooLong.count(), 2);
+        QCOMPARE(single.count(), 3);
+        QCOMPARE(single.at(0).at(0).toByteArray(), QByteArray("ok"));
+        QCOMPARE(single.at(1).at(0).toByteArray(), QByteArray("abcd"));
+        QCOMPARE(single.at(2).at(0).toByteArray(), QByteArray("end"));
+    }
+
+    void sendLines()
+    {
+        socket->sendLines(QList<QByteArray>() << "a" << "b\nc" << "d");
+        QCOMPARE(fifo->readAll(), QByteArray("a\nbc\nd\n"));
+    }
+
+    void benchmarkLines()
+    {
+        QByteArray data;
+        for (int i = 0; i < 100000; i++)
+            data += "PRIVMSG #qxt :line number " + QByteArray::number(i) + '\n';
+        QSignalSpy batch(socket, SIGNAL(newLinesReceived(QList<QByteArray>)));
+        QBENCHMARK
+        {
+            fifo->write(data);
+            QCoreApplication::processEvents();
+        }
+        QVERIFY(batch.count() > 0);
+    }
+};
+
+QTEST_MAIN(QxtLineSocketTest)
+#include "main.moc"
@@ -0,0 +1,173 @@
+#include <QCoreApplication>
+#include <QxtLinkedTree>
+#include <QTest>
+#include <QString>
+#include <QScopedPointer>
+
+typedef QxtLinkedTreeIterator<QString> Iterator;
+
+class QxtLinkedTreeTest : public QObject
+{
+    Q_OBJECT
+private:
+    static void build(Iterator it, int depth, int fanout, int& counter)
+    {
+        if (!depth)
+            return;
+        for (int i = 0; i < fanout; i++)
+            build(it.append(QString::number(counter++)), depth - 1, fanout, counter);
+    }
+
+    // serializes the tree into out and checks the links between the nodes on the way
+    static bool dump(Iterator it, QString& out)
+    {
+        out += *it + '(';
+        int children = 0;
+        for (Iterator c = it.child(); c.isValid(); ++c)
+        {
+            if (c.previous().isValid() && !(c.previous().next() == c))
+            {
+                qWarning("broken sibling link at %s", qPrintable(*c));
+                return false;
+            }
+            if (!(c.parent() == it))
+            {
+                qWarning("broken parent link at %s", qPrintable(*c));
+                return false;
+            }
+            if (!dump(c, out))
+                return false;
+            children++;
+        }
+        if (children != it.children())
+        {
+            qWarning("%s has %d children, counted %d", qPrintable(*it), it.children(), children);
+            return false;
+        }
+        out += ')';
+        return true;
+    }
+
+private slots:
+    void pooled_data()
+    {
+        QTest::addColumn<bool>("pooled");
+        QTest::newRow("heap") << false;
+        QTest::newRow("pooled") << true;
+    }
+
+    void pooled()
+    {
+        QFETCH(bool, pooled);
+        QScopedPointer<QxtLinkedTree<QString> > pointer(pooled ? new QxtLinkedTree<QString>("root", 5)
+                                                               : new QxtLinkedTree<QString>("root"));
+        QxtLinkedTree<QString>& tree = *pointer;
+        QCOMPARE(tree.isPooled(), pooled);
+
+        int counter = 0;
+        build(tree.root(), 4, 3, counter);
+        tree.root().child().next().child().erase();
+        tree.root().child().insert(1, "inserted");
+        QString before;
+        QVERIFY(dump(tree.root(), before));
+        QVERIFY(before.contains("inserted"));
+
+        tree.freeze();
+        QVERIFY(tree.isPooled());
+        QString frozen;
+        QVERIFY(dump(tree.root(), frozen));
+        QCOMPARE(frozen, before);
+
+        tree.root().child().erase();
+        tree.root().append("appended");
+        QString edited;
+        QVERIFY(dump(tree.root(), edited));
+        tree.freeze();
+        QString refrozen;
+        QVERIFY(dump(tree.root(), refrozen));
+        QCOMPARE(refrozen, edited);
+
+        tree.clear();
+        QVERIFY(!tree.root().child().isValid());
+        QCOMPARE(tree.root().children(), 0);
+        tree.root().append("again");
+        QCOMPARE(QString(tree.root().child()), QString("again"));
+    }
+
+    void freezeOrder()
+    {
+        QxtLinkedTree<int> tree(0);
+        QxtLinkedTreeIterator<int> a = tree.root().append(1);
+        QxtLinkedTreeIterator<int> b = tree.root().append(4);
+        a.append(2).append(3);
+        b.append(5);
+        tree.freeze();
+
+        // depth-first order is memory order
+        QxtLinkedTreeIterator<int> first = tree.root().child();
+        QCOMPARE(*first, 1);
+        QVERIFY(&*first.child() > &*first);
+        QVERIFY(&*first.child().child() > &*first.child());
+        QVERIFY(&*first.next() > &*first.child().child());
+        QVERIFY(&*first.next().child() > &*first.next());
+        QCOMPARE(*first.next().child(), 5);
+    }
+
+    void benchmarkBuild_data()
+    {
+        pooled_data();
+    }
+
+    void benchmarkBuild()
+    {
+        QFETCH(bool, pooled);
+        QBENCHMARK {
+            QScopedPointer<QxtLinkedTree<QString> > tree(pooled ? new QxtLinkedTree<QString>("root", 4096)
+                                                                 : new QxtLinkedTree<QString>("root"));
+            int counter = 0;
+            build(tree->root(), 6, 8, counter);
+        }
+    }
+
+    void benchmarkTraverse_data()
+    {
+        QTest::addColumn<bool>("frozen");
+        QTest::newRow("heap") << false;
+        QTest::newRow("frozen") << true;
+    }
+
+    void benchmarkTraverse()
+    {
+        QFETCH(bool, frozen);
+        QxtLinkedTree<QString> tree("root");
+        int counter = 0;
+        build(tree.root(), 6, 8, counter);
+        if (frozen)
+            tree.freeze();
+        QBENCHMARK {
+            int length = 0;
+            Iterator n = tree.root().child();
+            while (n.isValid())
+            {
+                length += n->size();
+                if (n.child().isValid())
+                {
+                    n = n.child();
+                    continue;
+                }
+                while (n.isValid() && !n.next().isValid())
+                {
+                    n = n.parent();
+                    if (n == tree.root())
+                        n = Iterator();
+                }
+                if (n.isValid())
+                    ++n;
+            }
+            QVERIFY(length > 0);
+        }
+    }
+};
+
+QTEST_MAIN(QxtLinkedTreeTest)
+#include "main.moc"
@@ -0,0 +1,296 @@
+/** ***** QxtLogger test ***** */
+#include <QxtLogger>
+#include <QxtLoggerEngine>
+#include <QxtBufferedFileLoggerEngine>
+#include <QxtBinaryLoggerEngine>
+#include <QTest>
+#include <QThread>
+#include <QAtomicInt>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QThreadPool>
+
+class CountingEngine : public QxtLoggerEngine
+{
+public:
+    CountingEngine() : records(0) {}
+    void initLoggerEngine() {}
+    void killLoggerEngine() {}
+    bool isInitialized() const { return true; }
+    void writeFormatted(QxtLogger::LogLevel, const QList<QVariant>&) { records.ref(); }
+    int count() { return records.fetchAndAddRelaxed(0); }
+    QAtomicInt records;
+};
+
+class LoggingThread : public QThread
+{
+public:
+    void run()
+    {
+        for (int i = 0; i < 1000; i++)
+            qxtLog->info("thread", i);
+    }
+};
+
+class QxtLoggerTest : public QObject
+{
+Q_OBJECT
+private:
+    CountingEngine* engine;
+
+private slots:
+    void initTestCase()
+    {
+        // the macros work before anything else has used the logger
+        int evaluated = 0;
+        qxtTrace("skipped", ++evaluated);
+        qxtInfo("first use", ++evaluated);
+        QCOMPARE(evaluated, 1);
+    }
+    void init()
+    {
+        qxtLog->disableLoggerEngine("DEFAULT");
+        engine = new CountingEngine;
+        qxtLog->addLoggerEngine("count", engine);
+        qxtLog->setMinimumLevel("count", QxtLogger::InfoLevel);
+    }
+    void cleanup()
+    {
+        qxtLog->disableAsynchronousLogging();
+        qxtLog->removeLoggerEngine("count");
+        qxtLog->enableLoggerEngine("DEFAULT");
+    }
+
+    void asynchronous()
+    {
+        qxtLog->enableAsynchronousLogging(64);
+        QVERIFY(qxtLog->isAsynchronousLoggingEnabled());
+        for (int i = 0; i < 1000; i++)
+            qxtLog->info("record", i);
+        qxtLog->trace("filtered out");
+        qxtLog->flush();
+        QCOMPARE(engine->count(), 1000);
+    }
+    void asynchronousThreads()
+    {
+        qxtLog->enableAsynchronousLogging(64);
+        LoggingThread threads[4];
+        for (int i = 0; i < 4; i++)
+            threads[i].start();
+        for (int i = 0; i < 4; i++)
+            threads[i].wait();
+        qxtLog->flush();
+        QCOMPARE(engine->count(), 4000);
+        QCOMPARE(qxtLog->droppedRecordCount(), 0);
+    }
+    void toggleWhileLogging()
+    {
+        LoggingThread threads[4];
+        for (int i = 0; i < 4; i++)
+            threads[i].start();
+        for (int i = 0; i < 50; i++)
+        {
+            qxtLog->enableAsynchronousLogging(64);
+            qxtLog->disableAsynchronousLogging();
+        }
+        for (int i = 0; i < 4; i++)
+            threads[i].wait();
+        // records logged while the writer was off were posted to this thread
+        QCoreApplication::sendPostedEvents(0, 0);
+        QCOMPARE(engine->count(), 4000);
+    }
+    void dropOnOverflow()
+    {
+        int before = qxtLog->droppedRecordCount();
+        qxtLog->enableAsynchronousLogging(2, QxtLogger::DropOnOverflow);
+        for (int i = 0; i < 10000; i++)
+            qxtLog->info("record", i);
+        qxtLog->flush();
+        qxtLog->disableAsynchronousLogging();
+        QVERIFY(engine->count() + qxtLog->droppedRecordCount() - before >= 10000);
+    }
+
+    void activeLevels()
+    {
+        QVERIFY(!QxtLogger::isLogLevelActive(QxtLogger::TraceLevel));
+        QVERIFY(QxtLogger::isLogLevelActive(QxtLogger::InfoLevel));
+        qxtLog->enableLogLevels("count", QxtLogger::TraceLevel);
+        QVERIFY(QxtLogger::isLogLevelActive(QxtLogger::TraceLevel));
+        qxtLog->disableLoggerEngine("count");
+        QVERIFY(!QxtLogger::isLogLevelActive(QxtLogger::InfoLevel));
+    }
+    void macrosSkipArguments()
+    {
+        int evaluated = 0;
+        qxtTrace("skipped", ++evaluated);
+        qxtTrace() << ++evaluated;
+        QCOMPARE(evaluated, 0);
+        qxtInfo("logged", ++evaluated);
+        qxtInfo() << ++evaluated;
+        QCOMPARE(evaluated, 2);
+        QCOMPARE(engine->count(), 2);
+    }
+
+    void bufferedFile()
+    {
+        const QString name = QDir::temp().filePath("qxtbufferedlog.log");
+        QFile::remove(name);
+        {
+            QxtBufferedFileLoggerEngine file(name);
+            file.setDateFormat("hh:mm:ss");
+            file.writeFormatted(QxtLogger::InfoLevel, QList<QVariant>() << "first" << "second");
+            QCOMPARE(QFileInfo(name).size(), qint64(0));
+            file.writeFormatted(QxtLogger::FatalLevel, QList<QVariant>() << "fatal");
+            QFile log(name);
+            QVERIFY(log.open(QIODevice::ReadOnly));
+            const QList<QByteArray> lines = log.readAll().split('\n');
+            QCOMPARE(lines.count(), 4);
+            QVERIFY(lines.at(0).endsWith("] [Info] first"));
+            QCOMPARE(lines.at(1), QByteArray(lines.at(0).size() - 5, ' ') + "second");
+            QVERIFY(lines.at(2).endsWith("] [Fatal] fatal"));
+        }
+        QFile::remove(name);
+    }
+
+    void bufferedFileRotation()
+    {
+        QDir dir(QDir::temp().filePath("qxtbufferedlogrotation"));
+        dir.mkpath(".");
+        Q_FOREACH(const QString& entry, dir.entryList(QDir::Files))
+            dir.remove(entry);
+
+        QxtBufferedFileLoggerEngine file(dir.filePath("rotated.log"));
+        file.setFlushThreshold(0);
+        file.setMaximumFileSize(1024);
+        file.setMaximumBackupCount(2);
+        for (int i = 0; i < 200; i++)
+            file.writeFormatted(QxtLogger::InfoLevel, QList<QVariant>() << "rotation test record" << i);
+        QThreadPool::globalInstance()->waitForDone();
+
+        const QStringList backups = dir.entryList(QStringList("rotated.log.*"), QDir::Files);
+        QCOMPARE(backups.count(), 2);
+        Q_FOREACH(const QString& backup, backups)
+        {
+            QVERIFY(backup.endsWith(".gz"));
+            QFile gz(dir.filePath(backup));
+            QVERIFY(gz.open(QIODevice::ReadOnly));
+            QCOMPARE(gz.read(2), QByteArray("\x1f\x8b"));
+        }
+        QVERIFY(QFileInfo(dir.filePath("rotated.log")).size() < 1024);
+    }
+
+    void bufferedFileBlockCompression()
+    {
+        QDir dir(QDir::temp().filePath("qxtbufferedlogblocks"));
+        dir.mkpath(".");
+        Q_FOREACH(const QString& entry, dir.entryList(QDir::Files))
+            dir.remove(entry);
+
+        {
+            QxtBufferedFileLoggerEngine file(dir.filePath("blocks.log"));
+            file.setMaximumFileSize(3 * 1024 * 1024 / 2);
+            const QString payload(100, 'x');
+            for (int i = 0; i < 20000; i++)
+                file.writeFormatted(QxtLogger::InfoLevel, QList<QVariant>() << payload << i);
+        }
+        QThreadPool::globalInstance()->waitForDone();
+
+        const QStringList backups = dir.entryList(QStringList("blocks.log.*"), QDir::Files);
+        QCOMPARE(backups.count(), 1);
+        QVERIFY(backups.first().endsWith(".gz"));
+        QFile gz(dir.filePath(backups.first()));
+        QVERIFY(gz.open(QIODevice::ReadOnly));
+        const QByteArray data = gz.readAll();
+        QCOMPARE(data.left(2), QByteArray("\x1f\x8b"));
+        // the second 1 MB block went into a gzip member of its own, which ends with its size
+        const uchar* trailer = reinterpret_cast<const uchar*>(data.constData() + data.size() - 4);
+        const quint32 last = trailer[0] | (trailer[1] << 8) | (trailer[2] << 16) | (quint32(trailer[3]) << 24);
+        QVERIFY(last > 0);
+        QVERIFY(last < 1024 * 1024);
+    }
+
+    void benchmarkBufferedFile()
+    {
+        const QString name = QDir::temp().filePath("qxtbufferedlogbench.log");
+        QxtBufferedFileLoggerEngine file(name);
+        const QList<QVariant> record = QList<QVariant>() << "benchmark" << 42;
+        QBENCHMARK { file.writeFormatted(QxtLogger::InfoLevel, record); }
+        file.killLoggerEngine();
+        QFile::remove(name);
+    }
+
+    void binarySegments()
+    {
+        QDir dir(QDir::temp().filePath("qxtbinarylog"));
+        dir.mkpath(".");
+        Q_FOREACH(const QString& entry, dir.entryList(QDir::Files))
+            dir.remove(entry);
+
+        {
+            QxtBinaryLoggerEngine binary(dir.filePath("binary.qlog"), 4096);
+            QVERIFY(binary.isInitialized());
+            for (int i = 0; i < 200; i++)
+                binary.writeFormatted(QxtLogger::InfoLevel, QList<QVariant>() << "record %1 of %2" << i << 200);
+            QVERIFY(binary.segmentIndex() > 0);
+            QCOMPARE(binary.droppedRecordCount(), quint64(0));
+        }
+
+        QFile first(dir.filePath("binary.qlog"));
+        QVERIFY(first.open(QIODevice::ReadOnly));
+        QVERIFY(first.size() <= 4096);
+        const QByteArray data = first.readAll();
+        QVERIFY(data.startsWith(QByteArray("QXTBLOG", 8)));
+        // the format is defined right after the header and records refer to it
+        QCOMPARE(int(data.at(32)), 1);
+        QVERIFY(data.contains("record %1 of %2"));
+        QCOMPARE(data.count("record %1 of %2"), 1);
+        QVERIFY(QFile::exists(dir.filePath("binary.qlog.1")));
+
+        // a new engine never overwrites existing segments
+        QxtBinaryLoggerEngine next(dir.filePath("binary.qlog"), 4096);
+        QVERIFY(next.segmentIndex() > 1);
+    }
+
+    void benchmarkBinary()
+    {
+        QDir dir(QDir::temp().filePath("qxtbinarylog"));
+        dir.mkpath(".");
+        QxtBinaryLoggerEngine binary(dir.filePath("bench.qlog"));
+        const QList<QVariant> record = QList<QVariant>() << "benchmark %1" << 42;
+        QBENCHMARK { binary.writeFormatted(QxtLogger::InfoLevel, record); }
+        binary.killLoggerEngine();
+        Q_FOREACH(const QString& entry, dir.entryList(QStringList("bench.qlog*"), QDir::Files))
+            dir.remove(entry);
+    }
+
+    void benchmarkDisabledLevel()
+    {
+        QBENCHMARK {
+            qxtLog->trace("disabled", 42);
+        }
+    }
+    void benchmarkDisabledMacro()
+    {
+        QBENCHMARK {
+            qxtTrace("disabled", 42);
+        }
+    }
+    void benchmarkEnabledSynchronous()
+    {
+        QBENCHMARK {
+            qxtLog->info("enabled", 42);
+        }
+    }
+    void benchmarkEnabledAsynchronous()
+    {
+        qxtLog->enableAsynchronousLogging(65536, QxtLogger::BlockOnOverflow);
+        QBENCHMARK {
+            qxtLog->info("enabled", 42);
+        }
+        qxtLog->flush();
+    }
+};
+
+QTEST_MAIN(QxtLoggerTest)
+#include "main.moc"
@@ -2,6 +2,7 @@
 #include <QtCore> //krazy:exclude=qxtincludes
 #include <QxtModelSerializer>
 #include <QStandardItemModel>
+#include <QSortFilterProxyModel>
 #include <QSqlTableModel>
 #include <QSqlDatabase>
 #include <QSqlQuery>
@@ -14,8 +15,15 @@ private slots:
     void initTestCase();
     void serializationTest();
     void sanityTest();
+    void streamingTest_data();
+    void streamingTest();
+    void legacyFormatTest();
+    void proxyTest();
+    void benchmarkSave();
+    void benchmarkRestore();
 
 private:
+    void fillModel(QStandardItemModel* model, int rows, int columns);
     bool copyModel(QAbstractItemModel* src, QAbstractItemModel* dst);
     bool compareModels(const QAbstractItemModel* a, const QAbstractItemModel* b, const QModelIndex& ai = QModelIndex(), const QModelIndex &bi = QModelIndex()) const;
 };
@@ -117,6 +125,153 @@ void tst_QxtModelSerializer::sanityTest()
     QCOMPARE(serializer.restoreModel(QByteArray()), false);
 }
 
+void tst_QxtModelSerializer::streamingTest_data()
+{
+    QTest::addColumn<int>("rows");
+    QTest::addColumn<int>("compression");
+    QTest::addColumn<bool>("displayOnly");
+
+    QTest::newRow("small") << 10 << 0 << false;
+    QTest::newRow("blocks") << 2500 << 0 << false;
+    QTest::newRow("compressed") << 2500 << 6 << false;
+    QTest::newRow("roles") << 2500 << 0 << true;
+}
+
+void tst_QxtModelSerializer::streamingTest()
+{
+    QFETCH(int, rows);
+    QFETCH(int, compression);
+    QFETCH(bool, displayOnly);
+
+    QStandardItemModel src;
+    fillModel(&src, rows, 3);
+    QStandardItem* parent = src.item(1, 2);
+    parent->appendRow(new QStandardItem("child"));
+    parent->child(0)->appendRow(new QStandardItem("grandchild"));
+
+    QxtModelSerializer serializer(&src);
+    serializer.setCompressionLevel(compression);
+    if (displayOnly)
+        serializer.setRoles(QList<int>() << Qt::DisplayRole);
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    QVERIFY(serializer.saveModel(&buffer));
+    buffer.close();
+    QCOMPARE(buffer.data(), serializer.saveModel());
+
+    QStandardItemModel dst;
+    serializer.setModel(&dst);
+    buffer.open(QIODevice::ReadOnly);
+    QVERIFY(serializer.restoreModel(&buffer));
+
+    QCOMPARE(dst.rowCount(), rows);
+    QCOMPARE(dst.columnCount(), 3);
+    for (int r = 0; r < rows; r += 97)
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            QCOMPARE(dst.item(r, c)->text(), src.item(r, c)->text());
+            QCOMPARE(dst.item(r, c)->toolTip(), displayOnly ? QString() : src.item(r, c)->toolTip());
+        }
+    }
+    QStandardItem* restored = dst.item(1, 2);
+    QCOMPARE(restored->rowCount(), 1);
+    QCOMPARE(restored->child(0)->text(), QString("child"));
+    QCOMPARE(restored->child(0)->child(0)->text(), QString("grandchild"));
+
+    if (compression)
+    {
+        serializer.setModel(&src);
+        serializer.setCompressionLevel(0);
+        QVERIFY(buffer.data().size() < serializer.saveModel().size());
+    }
+}
+
+void tst_QxtModelSerializer::legacyFormatTest()
+{
+    // root item, one row with one cell without children
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    QMap<int, QVariant> root, cell;
+    cell.insert(Qt::DisplayRole, QString("legacy"));
+    out << root << 1 << 1;
+    out << cell << 0 << 0;
+
+    QStandardItemModel dst;
+    QxtModelSerializer serializer(&dst);
+    QVERIFY(serializer.restoreModel(data));
+    QCOMPARE(dst.rowCount(), 1);
+    QCOMPARE(dst.item(0, 0)->text(), QString("legacy"));
+}
+
+void tst_QxtModelSerializer::proxyTest()
+{
+    QStandardItemModel src;
+    fillModel(&src, 50, 2);
+    QxtModelSerializer serializer(&src);
+    const QByteArray data = serializer.saveModel();
+
+    QStandardItemModel dst;
+    QSortFilterProxyModel proxy;
+    proxy.setDynamicSortFilter(true);
+    proxy.setSourceModel(&dst);
+    proxy.setFilterKeyColumn(0);
+    proxy.setFilterRegExp(QRegExp("^1"));
+    QCOMPARE(proxy.rowCount(), 0);
+
+    serializer.setModel(&dst);
+    QVERIFY(serializer.restoreModel(data));
+    QCOMPARE(dst.rowCount(), 50);
+    // rows 1 and 10 to 19 start with a 1
+    QCOMPARE(proxy.rowCount(), 11);
+    QCOMPARE(proxy.index(0, 1).data().toString(), QString("1/1"));
+}
+
+void tst_QxtModelSerializer::benchmarkSave()
+{
+    QStandardItemModel src;
+    fillModel(&src, 20000, 10);
+    QxtModelSerializer serializer(&src);
+    serializer.setRoles(QList<int>() << Qt::DisplayRole);
+    QBENCHMARK
+    {
+        QBuffer buffer;
+        buffer.open(QIODevice::WriteOnly);
+        QVERIFY(serializer.saveModel(&buffer));
+    }
+}
+
+void tst_QxtModelSerializer::benchmarkRestore()
+{
+    QStandardItemModel src;
+    fillModel(&src, 20000, 10);
+    QxtModelSerializer serializer(&src);
+    serializer.setRoles(QList<int>() << Qt::DisplayRole);
+    const QByteArray data = serializer.saveModel();
+    QBENCHMARK
+    {
+        QStandardItemModel dst;
+        serializer.setModel(&dst);
+        QVERIFY(serializer.restoreModel(data));
+    }
+}
+
+void tst_QxtModelSerializer::fillModel(QStandardItemModel* model, int rows, int columns)
+{
+    model->setRowCount(rows);
+    model->setColumnCount(columns);
+    for (int r = 0; r < rows; ++r)
+    {
+        for (int c = 0; c < columns; ++c)
+        {
+            QStandardItem* item = new QStandardItem(QString("%1/%2").arg(r).arg(c));
+            item->setToolTip(QString::number(r * columns + c));
+            model->setItem(r, c, item);
+        }
+    }
+}
+
 bool tst_QxtModelSerializer::copyModel(QAbstractItemModel* src, QAbstractItemModel* dst)
 {
     QxtModelSerializer serializer(src);
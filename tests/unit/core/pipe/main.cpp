@@ -1,4 +1,6 @@
 #include <QxtPipe>
+#include <QxtDeplex>
+#include <QBuffer>
 #include <QTest>
 #include <QDebug>
 #include <QByteArray>
@@ -68,6 +70,90 @@ private slots:
         QVERIFY(p1.bytesAvailable()==0);
         QVERIFY(p2.bytesAvailable()==0);
     }
+    void partialReads()
+    {
+        QxtPipe p1;
+        QxtPipe p2;
+        p1|p2;
+        p1.write("abc");
+        p1.write("defgh");
+        p1.write("ij");
+        QCOMPARE(p2.bytesAvailable(), qint64(10));
+        QCOMPARE(p2.read(2), QByteArray("ab"));
+        QCOMPARE(p2.read(4), QByteArray("cdef"));
+        QCOMPARE(p2.bytesAvailable(), qint64(4));
+        QCOMPARE(p2.readAll(), QByteArray("ghij"));
+        QCOMPARE(p2.bytesAvailable(), qint64(0));
+    }
+    void fanOut()
+    {
+        QxtPipe source;
+        QxtPipe targets[4];
+        for (int i = 0; i < 4; i++)
+            source.connect(&targets[i], QIODevice::WriteOnly);
+        source.write("fan");
+        for (int i = 0; i < 4; i++)
+            QCOMPARE(targets[i].readAll(), QByteArray("fan"));
+    }
+
+    void benchmarkChain_data()
+    {
+        QTest::addColumn<int>("chunkSize");
+        QTest::newRow("64 B") << 64;
+        QTest::newRow("4 KiB") << 4096;
+        QTest::newRow("64 KiB") << 65536;
+    }
+    void benchmarkChain()
+    {
+        QFETCH(int, chunkSize);
+        QxtPipe pipes[8];
+        for (int i = 0; i < 7; i++)
+            pipes[i].connect(&pipes[i + 1], QIODevice::WriteOnly);
+        const QByteArray chunk(chunkSize, 'x');
+        QBENCHMARK
+        {
+            pipes[0].write(chunk);
+            QCOMPARE(pipes[7].readAll().size(), chunkSize);
+        }
+    }
+    void benchmarkFanOut_data()
+    {
+        benchmarkChain_data();
+    }
+    void benchmarkFanOut()
+    {
+        QFETCH(int, chunkSize);
+        QxtPipe source;
+        QxtPipe targets[8];
+        for (int i = 0; i < 8; i++)
+            source.connect(&targets[i], QIODevice::WriteOnly);
+        const QByteArray chunk(chunkSize, 'x');
+        QBENCHMARK
+        {
+            source.write(chunk);
+            for (int i = 0; i < 8; i++)
+                targets[i].readAll();
+        }
+    }
+    void benchmarkDeplex_data()
+    {
+        benchmarkChain_data();
+    }
+    void benchmarkDeplex()
+    {
+        QFETCH(int, chunkSize);
+        QBuffer buffer;
+        buffer.open(QIODevice::WriteOnly);
+        QxtDeplex deplex(&buffer);
+        QxtPipe pipe;
+        pipe.connect(&deplex, QIODevice::WriteOnly);
+        const QByteArray chunk(chunkSize, 'x');
+        QBENCHMARK
+        {
+            pipe.write(chunk);
+            buffer.seek(0);
+        }
+    }
 };
 
 QTEST_MAIN(QxtPipeTest)
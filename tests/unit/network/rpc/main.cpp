@@ -1,5 +1,6 @@
 /** ***** QxtRPCPeer loopback test ******/
 #include <QxtRPCPeer>
+#include <QxtShardedConnectionManager>
 #include <qxtfifo.h>
 #include <QCoreApplication>
 #include <QTest>
@@ -166,6 +167,53 @@ private slots:
         QVERIFY(!client.isClient());
     }
 
+    void ShardedServerIo()
+    {
+        QxtShardedConnectionManager manager(2);
+        QVERIFY(manager.listen(QHostAddress::LocalHost, 23445));
+        QCOMPARE(manager.shardCount(), 2);
+        QVERIFY(manager.shardService(0) != 0);
+        QVERIFY(manager.shardService(1) != 0);
+
+        QxtRPCPeer client1;
+        QxtRPCPeer client2;
+        QVERIFY2(client1.attachSlot(SIGNAL(wave(QString)), this, SIGNAL(counterwave(QString))), "cannot attach slot");
+        QVERIFY2(client2.attachSlot(SIGNAL(wave(QString)), this, SIGNAL(counterwave(QString))), "cannot attach slot");
+        client1.connect(QHostAddress::LocalHost, 23445);
+        client2.connect(QHostAddress::LocalHost, 23445);
+        QVERIFY(qobject_cast<QTcpSocket*>(client1.device())->waitForConnected(30000));
+        QVERIFY(qobject_cast<QTcpSocket*>(client2.device())->waitForConnected(30000));
+
+        for (int i = 0; i < 100 && manager.clientCount() < 2; i++)
+            QTest::qWait(20);
+        QCOMPARE(manager.clientCount(), 2);
+
+        // Both shards are empty when the clients arrive, so they end up on different shards.
+        QList<quint64> ids = manager.clients();
+        QVERIFY(manager.shardOf(ids[0]) != manager.shardOf(ids[1]));
+        QCOMPARE(manager.shardClientCount(0), 1);
+        QCOMPARE(manager.shardClientCount(1), 1);
+
+        QSignalSpy spy(this, SIGNAL(counterwave(QString)));
+        manager.call(SIGNAL(wave(QString)), QString("world"));
+        for (int i = 0; i < 100 && spy.count() < 2; i++)
+            QTest::qWait(20);
+        QCOMPARE(spy.count(), 2);
+        QVERIFY2(spy.takeFirst().at(0).toString() == "world", "argument missmatch");
+
+        manager.disconnect(ids[0]);
+        for (int i = 0; i < 100 && manager.shardClientCount(manager.shardOf(ids[0])) > 0; i++)
+            QTest::qWait(20);
+        QCOMPARE(manager.clientCount(), 1);
+        QCOMPARE(manager.shardClientCount(manager.shardOf(ids[0])), 0);
+
+        // The ID still names an existing shard, but the call must not be queued there.
+        spy.clear();
+        manager.call(ids[0], SIGNAL(wave(QString)), QString("gone"));
+        QTest::qWait(100);
+        QCOMPARE(spy.count(), 0);
+    }
+
     void cleanupTestCase()
     {}
 };
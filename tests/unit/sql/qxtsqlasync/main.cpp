@@ -0,0 +1,250 @@
+#include <QxtSqlAsyncExecutor>
+#include <QxtSqlPackageModel>
+#include <QxtSignalWaiter>
+#include <QTest>
+#include <QPointer>
+#include <QFile>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QVariant>
+
+class Collector : public QObject
+{
+Q_OBJECT
+public:
+    Collector(QxtSqlAsyncResult * result) : batches(0), finished(0), cancelAfter(-1), deleteAfter(-1)
+    {
+        connect(result, SIGNAL(batchReady(QxtSqlPackage)), this, SLOT(batch(QxtSqlPackage)));
+        connect(result, SIGNAL(finished()), this, SLOT(done()));
+    }
+
+    QxtSqlPackage rows;
+    int batches;
+    int finished;
+    int cancelAfter;
+    int deleteAfter;
+
+public slots:
+    void batch(const QxtSqlPackage & batch)
+    {
+        batches++;
+        QVERIFY(rows.append(batch));
+        if (batches == cancelAfter)
+            static_cast<QxtSqlAsyncResult *>(sender())->cancel();
+        if (batches == deleteAfter)
+            delete sender();
+    }
+    void done()
+    {
+        finished++;
+    }
+};
+
+class Test: public QObject
+{
+Q_OBJECT
+private slots:
+    void initTestCase()
+    {
+        QFile::remove("async.sqlite");
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE");
+        db.setDatabaseName("async.sqlite");
+        QVERIFY(db.open());
+        QSqlQuery query(db);
+        QVERIFY(query.exec("CREATE TABLE items (id INTEGER, name TEXT)"));
+        QVERIFY(db.transaction());
+        QVERIFY(query.prepare("INSERT INTO items VALUES (?, ?)"));
+        for (int i = 0; i < 10000; i++)
+        {
+            query.addBindValue(i);
+            query.addBindValue(QString("item %1").arg(i));
+            QVERIFY2(query.exec(), qPrintable(query.lastError().text()));
+        }
+        QVERIFY(db.commit());
+    }
+
+    void batches()
+    {
+        QxtSqlAsyncExecutor executor;
+        executor.setBatchSize(1000);
+        QCOMPARE(executor.batchSize(), 1000);
+        QxtSqlAsyncResult * result = executor.exec("SELECT id, name FROM items ORDER BY id");
+        Collector collector(result);
+        QVERIFY(!result->isFinished());
+        QVERIFY(QxtSignalWaiter::wait(result, SIGNAL(finished()), 10000));
+
+        QVERIFY(result->isFinished());
+        QVERIFY(!result->lastError().isValid());
+        QCOMPARE(collector.batches, 10);
+        QCOMPARE(collector.finished, 1);
+        QCOMPARE(result->rowsFetched(), 10000);
+        QCOMPARE(collector.rows.count(), 10000);
+        QCOMPARE(collector.rows.variant(9999, 0).toInt(), 9999);
+        QCOMPARE(collector.rows.variant(1234, 1).toString(), QString("item 1234"));
+        delete result;
+    }
+
+    void bindValues()
+    {
+        QxtSqlAsyncExecutor executor;
+        QxtSqlAsyncResult * result = executor.exec("SELECT name FROM items WHERE id BETWEEN ? AND ?", QVariantList() << 10 << 19);
+        Collector collector(result);
+        QVERIFY(result->waitForFinished(10000));
+        QCOMPARE(collector.finished, 1);
+        QCOMPARE(collector.rows.count(), 10);
+        QCOMPARE(collector.rows.columnName(0), QString("name"));
+        delete result;
+    }
+
+    void empty()
+    {
+        QxtSqlAsyncExecutor executor;
+        QxtSqlAsyncResult * result = executor.exec("SELECT id, name FROM items WHERE id < 0");
+        Collector collector(result);
+        QVERIFY(result->waitForFinished(10000));
+        QCOMPARE(collector.batches, 1);
+        QCOMPARE(collector.rows.count(), 0);
+        QCOMPARE(collector.rows.columnCount(), 2);
+        delete result;
+    }
+
+    void error()
+    {
+        QxtSqlAsyncExecutor executor;
+        QxtSqlAsyncResult * result = executor.exec("SELECT * FROM missing");
+        Collector collector(result);
+        QVERIFY(result->waitForFinished(10000));
+        QVERIFY(result->lastError().isValid());
+        QCOMPARE(collector.batches, 0);
+        QCOMPARE(collector.finished, 1);
+        delete result;
+    }
+
+    void cancel()
+    {
+        QxtSqlAsyncExecutor executor;
+        executor.setBatchSize(10);
+        QxtSqlAsyncResult * result = executor.exec("SELECT id FROM items");
+        Collector collector(result);
+        collector.cancelAfter = 2;
+        QVERIFY(QxtSignalWaiter::wait(result, SIGNAL(finished()), 10000));
+        QVERIFY(result->isCanceled());
+        QCOMPARE(collector.batches, 2);
+        QCOMPARE(collector.finished, 1);
+        QCOMPARE(result->rowsFetched(), 20);
+        delete result;
+
+        // queued behind a busy thread, canceled before it starts
+        QxtSqlAsyncResult * busy = executor.exec("SELECT id FROM items");
+        QxtSqlAsyncResult * waiting = executor.exec("SELECT id FROM items");
+        Collector skipped(waiting);
+        waiting->cancel();
+        QVERIFY(waiting->waitForFinished(10000));
+        QCOMPARE(skipped.batches, 0);
+        QCOMPARE(skipped.finished, 1);
+        delete waiting;
+        // deleting a result cancels it as well
+        delete busy;
+    }
+
+    void deleteFromSlot()
+    {
+        QxtSqlAsyncExecutor executor;
+        executor.setBatchSize(10);
+        QPointer<QxtSqlAsyncResult> result = executor.exec("SELECT id FROM items");
+        Collector collector(result);
+        collector.deleteAfter = 1;
+        if (result)
+            QxtSignalWaiter::wait(result, SIGNAL(destroyed()), 10000);
+        QVERIFY(result.isNull());
+        // the worker's later batches must not reach the deleted result
+        QTest::qWait(200);
+        QCOMPARE(collector.batches, 1);
+        QCOMPARE(collector.finished, 0);
+    }
+
+    void concurrent()
+    {
+        QxtSqlAsyncExecutor executor(QLatin1String(QSqlDatabase::defaultConnection), 4);
+        QCOMPARE(executor.threadCount(), 4);
+        QList<QxtSqlAsyncResult *> results;
+        QList<Collector *> collectors;
+        for (int i = 0; i < 16; i++)
+        {
+            results << executor.exec("SELECT id FROM items WHERE id % 16 = ?", QVariantList() << i);
+            collectors << new Collector(results.last());
+        }
+        foreach (QxtSqlAsyncResult * result, results)
+            QVERIFY(result->waitForFinished(10000));
+        foreach (Collector * collector, collectors)
+            QCOMPARE(collector->rows.count(), 625);
+        qDeleteAll(collectors);
+        qDeleteAll(results);
+        QCOMPARE(executor.pendingCount(), 0);
+    }
+
+    void model()
+    {
+        QxtSqlAsyncExecutor executor;
+        executor.setBatchSize(100);
+        QxtSqlAsyncResult * result = executor.exec("SELECT id, name FROM items ORDER BY id");
+        QxtSqlPackageModel model;
+        model.setQuery(result);
+        QCOMPARE(model.rowCount(), 0);
+        QVERIFY(model.canFetchMore());
+
+        // the first batch is shown when it arrives, later ones on request
+        QVERIFY(QxtSignalWaiter::wait(&model, SIGNAL(rowsInserted(QModelIndex, int, int)), 10000));
+        QCOMPARE(model.rowCount(), 100);
+        QCOMPARE(model.columnCount(), 2);
+        QCOMPARE(model.headerData(1, Qt::Horizontal).toString(), QString("name"));
+        QCOMPARE(model.data(model.index(42, 1)).toString(), QString("item 42"));
+
+        QVERIFY(result->waitForFinished(10000));
+        QCOMPARE(model.rowCount(), 100);
+        QVERIFY(model.canFetchMore());
+        model.fetchMore();
+        QCOMPARE(model.rowCount(), 10000);
+        QVERIFY(!model.canFetchMore());
+        QCOMPARE(model.data(model.index(9999, 0)).toInt(), 9999);
+        delete result;
+    }
+
+    void benchmarkFirstRows_data()
+    {
+        QTest::addColumn<bool>("async");
+        QTest::newRow("QxtSqlPackage::insert") << false;
+        QTest::newRow("first batch") << true;
+    }
+    void benchmarkFirstRows()
+    {
+        // how long until the first rows of a large report can be shown
+        QFETCH(bool, async);
+        QxtSqlAsyncExecutor executor;
+        int rows = 0;
+        QBENCHMARK {
+            if (async)
+            {
+                QxtSqlAsyncResult * result = executor.exec("SELECT id, name FROM items");
+                QxtSqlPackageModel model;
+                model.setQuery(result);
+                QxtSignalWaiter::wait(&model, SIGNAL(rowsInserted(QModelIndex, int, int)), 10000);
+                rows = model.rowCount();
+                delete result;
+            }
+            else
+            {
+                QxtSqlPackage package;
+                package.insert(QSqlQuery("SELECT id, name FROM items"));
+                QxtSqlPackageModel model;
+                model.setQuery(package);
+                rows = model.rowCount();
+            }
+        }
+        QVERIFY(rows > 0);
+    }
+};
+
+QTEST_MAIN(Test)
+#include "main.moc"
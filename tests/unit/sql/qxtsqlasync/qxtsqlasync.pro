@@ -0,0 +1,9 @@
+TEMPLATE = app
+TARGET = 
+DEPENDPATH += .
+INCLUDEPATH += .
+QT = core sql
+QXT = core sql
+SOURCES += main.cpp
+QMAKE_CLEAN += async.sqlite
+include(../../unit.pri)
@@ -0,0 +1,241 @@
+#include <QxtSqlConnectionPool>
+#include <QxtSqlThreadManager>
+#include <QTest>
+#include <QThread>
+#include <QFile>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QStringList>
+#include <QVariant>
+
+class Worker : public QThread
+{
+public:
+    Worker(QxtSqlConnectionPool * pool) : pool(pool), ok(false) {}
+
+    QxtSqlConnectionPool * pool;
+    bool ok;
+
+protected:
+    void run()
+    {
+        QxtSqlPooledConnection conn = pool->acquire(5000);
+        QSqlQuery query = conn.prepare("SELECT COUNT(*) FROM items");
+        ok = conn.isValid() && query.exec() && query.next();
+    }
+};
+
+class ManagedWorker : public QThread
+{
+public:
+    QString name;
+    bool ok;
+
+protected:
+    void run()
+    {
+        name = QxtSqlThreadManager::manager()->connectionName();
+        QSqlQuery query(QxtSqlThreadManager::connection());
+        ok = query.exec("SELECT COUNT(*) FROM items") && query.next();
+    }
+};
+
+class Test: public QObject
+{
+Q_OBJECT
+private slots:
+    void initTestCase()
+    {
+        QFile::remove("pool.sqlite");
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE");
+        db.setDatabaseName("pool.sqlite");
+        QVERIFY(db.open());
+        QSqlQuery query(db);
+        QVERIFY(query.exec("CREATE TABLE items (id INTEGER PRIMARY KEY, name TEXT)"));
+    }
+
+    void reuse()
+    {
+        QxtSqlConnectionPool pool;
+        QCOMPARE(pool.connectionCount(), 0);
+        QxtSqlPooledConnection conn = pool.acquire();
+        QVERIFY(conn.isValid());
+        QVERIFY(conn.database().isOpen());
+        const QString name = conn.connectionName();
+        QCOMPARE(pool.connectionCount(), 1);
+        QCOMPARE(pool.idleCount(), 0);
+
+        QxtSqlPooledConnection copy = conn;
+        conn.release();
+        QVERIFY(!conn.isValid());
+        QVERIFY(!copy.isValid());
+        QCOMPARE(pool.idleCount(), 1);
+
+        conn = pool.acquire();
+        QCOMPARE(conn.connectionName(), name);
+        QCOMPARE(pool.connectionCount(), 1);
+    }
+
+    void maximum()
+    {
+        QxtSqlConnectionPool pool;
+        pool.setMaximumConnections(2);
+        QxtSqlPooledConnection a = pool.acquire();
+        QxtSqlPooledConnection b = pool.acquire();
+        QVERIFY(a.isValid() && b.isValid());
+        QVERIFY(a.connectionName() != b.connectionName());
+        QVERIFY(!pool.acquire(50).isValid());
+        b.release();
+        QVERIFY(pool.acquire(50).isValid());
+    }
+
+    void minimumAndReaping()
+    {
+        QxtSqlConnectionPool pool;
+        pool.setMinimumConnections(2);
+        QCOMPARE(pool.connectionCount(), 2);
+        QCOMPARE(pool.idleCount(), 2);
+
+        {
+            QxtSqlPooledConnection a = pool.acquire();
+            QxtSqlPooledConnection b = pool.acquire();
+            QxtSqlPooledConnection c = pool.acquire();
+            QCOMPARE(pool.connectionCount(), 3);
+        }
+        QCOMPARE(pool.idleCount(), 3);
+        pool.setIdleTimeout(0);
+        QCOMPARE(pool.reapIdle(), 1);
+        QCOMPARE(pool.connectionCount(), 2);
+        QCOMPARE(pool.reapIdle(), 0);
+    }
+
+    void statementCache()
+    {
+        QxtSqlConnectionPool pool;
+        pool.setStatementCacheSize(1);
+        QxtSqlPooledConnection conn = pool.acquire();
+        for (int i = 0; i < 10; i++)
+        {
+            QSqlQuery insert = conn.prepare("INSERT INTO items (name) VALUES (?)");
+            insert.addBindValue(QString::number(i));
+            QVERIFY2(insert.exec(), qPrintable(insert.lastError().text()));
+
+            // evicts the insert from the cache of one
+            QSqlQuery count = conn.prepare("SELECT COUNT(*) FROM items WHERE name = ?");
+            count.addBindValue(QString::number(i));
+            QVERIFY(count.exec() && count.next());
+            QCOMPARE(count.value(0).toInt(), 1);
+        }
+
+        pool.setStatementCacheSize(8);
+        conn = pool.acquire();
+        QSqlQuery first = conn.prepare("SELECT name FROM items WHERE id = ?");
+        first.addBindValue(1);
+        QVERIFY(first.exec() && first.next());
+        QSqlQuery again = conn.prepare("SELECT name FROM items WHERE id = ?");
+        again.addBindValue(2);
+        QVERIFY(again.exec() && again.next());
+        QCOMPARE(again.value(0).toString(), QString("1"));
+
+        QSqlQuery broken = conn.prepare("SELECT FROM");
+        QVERIFY(broken.lastError().isValid());
+    }
+
+    void healthCheck()
+    {
+        QxtSqlConnectionPool pool;
+        pool.setHealthCheckInterval(0);
+        pool.setHealthCheckQuery("SELECT 1");
+        QCOMPARE(pool.healthCheckQuery(), QString("SELECT 1"));
+        QVERIFY(pool.acquire().isValid());
+        QVERIFY(pool.acquire().isValid());
+
+        // a failing check reopens the connection
+        pool.setHealthCheckQuery("SELECT * FROM missing");
+        QxtSqlPooledConnection conn = pool.acquire();
+        QVERIFY(conn.isValid());
+        QVERIFY(conn.database().isOpen());
+    }
+
+    void threads()
+    {
+        QxtSqlConnectionPool pool;
+        pool.setMaximumConnections(3);
+        QList<Worker *> workers;
+        for (int i = 0; i < 16; i++)
+            workers << new Worker(&pool);
+        foreach (Worker * worker, workers)
+            worker->start();
+        foreach (Worker * worker, workers)
+        {
+            QVERIFY(worker->wait(10000));
+            QVERIFY(worker->ok);
+        }
+        qDeleteAll(workers);
+        QVERIFY(pool.connectionCount() <= 3);
+        QCOMPARE(pool.idleCount(), pool.connectionCount());
+    }
+
+    void threadManager()
+    {
+        QxtSqlConnectionPool pool;
+        QxtSqlThreadManager::setPool(&pool);
+        QCOMPARE(QxtSqlThreadManager::pool(), &pool);
+
+        // short lived threads one after another all get the same open connection
+        QStringList names;
+        for (int i = 0; i < 5; i++)
+        {
+            ManagedWorker worker;
+            worker.start();
+            QVERIFY(worker.wait(10000));
+            QVERIFY(worker.ok);
+            names << worker.name;
+        }
+        QCOMPARE(pool.connectionCount(), 1);
+        QCOMPARE(names.toSet().count(), 1);
+
+        QxtSqlThreadManager::setPool(0);
+        QVERIFY(!QxtSqlThreadManager::pool());
+    }
+
+    void benchmarkAcquire_data()
+    {
+        QTest::addColumn<bool>("pooled");
+        QTest::newRow("clone and open") << false;
+        QTest::newRow("pool") << true;
+    }
+    void benchmarkAcquire()
+    {
+        QFETCH(bool, pooled);
+        QxtSqlConnectionPool pool;
+        int rows = 0;
+        if (pooled)
+        {
+            QBENCHMARK {
+                QxtSqlPooledConnection conn = pool.acquire();
+                QSqlQuery query = conn.prepare("SELECT COUNT(*) FROM items");
+                if (query.exec() && query.next())
+                    rows += query.value(0).toInt();
+            }
+        }
+        else
+        {
+            QBENCHMARK {
+                {
+                    QSqlDatabase db = QSqlDatabase::cloneDatabase(QSqlDatabase::database(), "bench");
+                    db.open();
+                    QSqlQuery query(db);
+                    query.prepare("SELECT COUNT(*) FROM items");
+                    if (query.exec() && query.next())
+                        rows += query.value(0).toInt();
+                }
+                QSqlDatabase::removeDatabase("bench");
+            }
+        }
+        QVERIFY(rows > 0);
+    }
+};
+
+QTEST_MAIN(Test)
+#include "main.moc"
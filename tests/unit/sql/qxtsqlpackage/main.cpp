@@ -0,0 +1,207 @@
+#include <QxtSqlPackage>
+#include <QxtSqlPackageModel>
+#include <QTest>
+#include <QFile>
+#include <QBuffer>
+#include <QDataStream>
+#include <QDebug>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QVariant>
+
+class Test: public QObject
+{
+Q_OBJECT
+private slots:
+    void initTestCase()
+    {
+        QFile::remove("package.sqlite");
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE");
+        db.setDatabaseName("package.sqlite");
+        QVERIFY(db.open());
+        QSqlQuery query(db);
+        QVERIFY(query.exec("CREATE TABLE items (id INTEGER, price REAL, name TEXT, image BLOB)"));
+        QVERIFY(query.prepare("INSERT INTO items VALUES (?, ?, ?, ?)"));
+        for (int i = 0; i < 1000; i++)
+        {
+            query.addBindValue(i);
+            query.addBindValue(i % 7 ? QVariant(i * 0.5) : QVariant(QVariant::Double));
+            query.addBindValue(QString::fromUtf8("n\xc3\xa4me %1").arg(i));
+            query.addBindValue(QByteArray(i % 5, char(i)));
+            QVERIFY2(query.exec(), qPrintable(query.lastError().text()));
+        }
+    }
+
+    void empty()
+    {
+        QxtSqlPackage package;
+        package.insert(QSqlQuery("SELECT * FROM items WHERE id < 0"));
+        QCOMPARE(package.count(), 0);
+        QCOMPARE(package.columnCount(), 4);
+        QVERIFY(!package.next());
+        QCOMPARE(package.hash(), (QHash<QString, QString>()));
+
+        QxtSqlPackage copy;
+        copy.setData(package.data());
+        QCOMPARE(copy.count(), 0);
+        QCOMPARE(copy.columnName(3), QString("image"));
+    }
+
+    void values()
+    {
+        QxtSqlPackage package;
+        package.insert(QSqlQuery("SELECT * FROM items ORDER BY id"));
+        QCOMPARE(package.count(), 1000);
+        QCOMPARE(package.columnCount(), 4);
+        QCOMPARE(package.columnIndex("name"), 2);
+        QCOMPARE(package.columnIndex("missing"), -1);
+
+        QVERIFY(package.first());
+        QVERIFY(package.next());
+        QCOMPARE(package.value("id"), QString("1"));
+        QCOMPARE(package.value("price"), QString("0.5"));
+        QCOMPARE(package.value("name"), QString::fromUtf8("n\xc3\xa4me 1"));
+        QCOMPARE(package.variant("id").toLongLong(), qlonglong(1));
+        QCOMPARE(package.variant("price").toDouble(), 0.5);
+        QCOMPARE(package.variant("image").toByteArray(), QByteArray(1, char(1)));
+        QCOMPARE(package.value("missing"), QString());
+
+        QVERIFY(package.isNull(0, 1));
+        QVERIFY(!package.variant(0, 1).isValid());
+        QVERIFY(!package.isNull(1, 1));
+        QVERIFY(!package.variant(1000, 0).isValid());
+
+        QHash<QString, QString> row = package.hash(2);
+        QCOMPARE(row.count(), 4);
+        QCOMPARE(row.value("name"), QString::fromUtf8("n\xc3\xa4me 2"));
+        QCOMPARE(package.hash(), package.hash(1));
+        QCOMPARE(package.hash(1000), (QHash<QString, QString>()));
+    }
+
+    void roundTrip()
+    {
+        QxtSqlPackage package;
+        package.insert(QSqlQuery("SELECT * FROM items ORDER BY id"));
+        QxtSqlPackage copy;
+        copy.setData(package.data());
+        QCOMPARE(copy.count(), package.count());
+        QCOMPARE(copy.columnCount(), package.columnCount());
+        for (int row = 0; row < package.count(); row++)
+        {
+            for (int column = 0; column < package.columnCount(); column++)
+            {
+                QCOMPARE(copy.isNull(row, column), package.isNull(row, column));
+                QCOMPARE(copy.variant(row, column), package.variant(row, column));
+            }
+        }
+        QCOMPARE(copy.data(), package.data());
+
+        // assignment shares the result but not the position
+        QxtSqlPackage assigned;
+        QVERIFY(package.last());
+        assigned = package;
+        QCOMPARE(assigned.at(), -1);
+        QCOMPARE(assigned.count(), 1000);
+    }
+
+    void mixedTypes()
+    {
+        // sqlite does not enforce column types
+        QxtSqlPackage package;
+        package.insert(QSqlQuery("SELECT 1 AS v UNION ALL SELECT 2.5 UNION ALL SELECT 'x' UNION ALL SELECT NULL"));
+        QCOMPARE(package.count(), 4);
+        QCOMPARE(package.variant(0, 0).toString(), QString("1"));
+        QCOMPARE(package.variant(1, 0).toString(), QString("2.5"));
+        QCOMPARE(package.variant(2, 0).toString(), QString("x"));
+        QVERIFY(package.isNull(3, 0));
+    }
+
+    void corrupt()
+    {
+        QxtSqlPackage package;
+        package.insert(QSqlQuery("SELECT * FROM items ORDER BY id"));
+        const QByteArray data = package.data();
+        for (int size = 4; size < data.size(); size += data.size() / 50)
+        {
+            QxtSqlPackage broken;
+            broken.setData(data.left(size));
+            QCOMPARE(broken.count(), 0);
+            QCOMPARE(broken.columnCount(), 0);
+        }
+    }
+
+    void legacyFormat()
+    {
+        QBuffer buff;
+        buff.open(QBuffer::WriteOnly);
+        QDataStream stream(&buff);
+        stream << 2;
+        for (int i = 0; i < 2; i++)
+        {
+            QHash<QString, QString> hash;
+            hash["id"] = QString::number(i);
+            hash["name"] = QString("row %1").arg(i);
+            stream << hash;
+        }
+
+        QxtSqlPackage package;
+        package.setData(buff.data());
+        QCOMPARE(package.count(), 2);
+        QCOMPARE(package.columnCount(), 2);
+        QVERIFY(package.next());
+        QCOMPARE(package.value("name"), QString("row 0"));
+        QVERIFY(package.next());
+        QCOMPARE(package.value("id"), QString("1"));
+    }
+
+    void model()
+    {
+        QxtSqlPackage package;
+        package.insert(QSqlQuery("SELECT id, name FROM items ORDER BY id"));
+        QxtSqlPackageModel model;
+        model.setQuery(package);
+        QCOMPARE(model.rowCount(), 1000);
+        QCOMPARE(model.columnCount(), 2);
+        QCOMPARE(model.headerData(0, Qt::Horizontal).toString(), QString("id"));
+        QCOMPARE(model.headerData(1, Qt::Horizontal).toString(), QString("name"));
+        QCOMPARE(model.data(model.index(5, 0)).toInt(), 5);
+        QCOMPARE(model.data(model.index(5, 1)).toString(), QString::fromUtf8("n\xc3\xa4me 5"));
+    }
+
+    void benchmarkData_data()
+    {
+        QTest::addColumn<bool>("legacy");
+        QTest::newRow("hash per row") << true;
+        QTest::newRow("columns") << false;
+    }
+    void benchmarkData()
+    {
+        QFETCH(bool, legacy);
+        QxtSqlPackage package;
+        package.insert(QSqlQuery("SELECT * FROM items"));
+        QByteArray data;
+        QBENCHMARK {
+            if (legacy)
+            {
+                QBuffer buff;
+                buff.open(QBuffer::WriteOnly);
+                QDataStream stream(&buff);
+                stream << package.count();
+                for (int i = 0; i < package.count(); i++)
+                    stream << package.hash(i);
+                data = buff.data();
+            }
+            else
+            {
+                data = package.data();
+            }
+            QxtSqlPackage copy;
+            copy.setData(data);
+        }
+        qDebug() << data.size() << "bytes";
+    }
+};
+
+QTEST_MAIN(Test)
+#include "main.moc"
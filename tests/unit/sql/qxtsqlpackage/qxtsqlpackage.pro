@@ -0,0 +1,9 @@
+TEMPLATE = app
+TARGET = 
+DEPENDPATH += .
+INCLUDEPATH += .
+QT = core sql
+QXT = sql
+SOURCES += main.cpp
+QMAKE_CLEAN += package.sqlite
+include(../../unit.pri)
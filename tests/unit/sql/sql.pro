@@ -3,6 +3,7 @@
 ######################################################################
 
 TEMPLATE = subdirs
+SUBDIRS += qxtsqlasync qxtsqlconnectionpool qxtsqlpackage
 
 test.CONFIG += recursive
 QMAKE_EXTRA_TARGETS += test
@@ -0,0 +1,347 @@
+/****************************************************************************
+** Copyright (c) 2006 - 2011, the LibQxt project.
+** See the Qxt AUTHORS file for a list of authors and copyright holders.
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**     * Redistributions of source code must retain the above copyright
+**       notice, this list of conditions and the following disclaimer.
+**     * Redistributions in binary form must reproduce the above copyright
+**       notice, this list of conditions and the following disclaimer in the
+**       documentation and/or other materials provided with the distribution.
+**     * Neither the name of the LibQxt project nor the
+**       names of its contributors may be used to endorse or promote products
+**       derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+** ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+** DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+** (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+** LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+** ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+** SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+** <http://libqxt.org>  <foundation@libqxt.org>
+*****************************************************************************/
+
+// Renders the segment files written by QxtBinaryLoggerEngine as text or as JSON lines.
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+#include <QHash>
+#include <QStringList>
+#include <QTextStream>
+#include <QxtLogger>
+
+struct Argument
+{
+    Argument() : tag(0) {}
+    int tag;
+    QVariant value;
+};
+
+struct Event
+{
+    int level;
+    quint32 format;
+    qint64 timestamp;
+    quint64 thread;
+    QList<Argument> args;
+};
+
+static QString levelName(int level)
+{
+    switch (level)
+    {
+    case QxtLogger::TraceLevel:    return "Trace";
+    case QxtLogger::DebugLevel:    return "Debug";
+    case QxtLogger::InfoLevel:     return "Info";
+    case QxtLogger::WarningLevel:  return "Warning";
+    case QxtLogger::ErrorLevel:    return "Error";
+    case QxtLogger::CriticalLevel: return "Critical";
+    case QxtLogger::FatalLevel:    return "Fatal";
+    default:                       return QString();
+    }
+}
+
+static QString timeString(qint64 epoch, qint64 timestamp, bool iso)
+{
+    const QDateTime time = QDateTime::fromMSecsSinceEpoch(epoch + timestamp / 1000000);
+    const QString micros = QString::number(timestamp / 1000 % 1000).rightJustified(3, '0');
+    return time.toString(iso ? "yyyy-MM-ddThh:mm:ss.zzz" : "yyyy-MM-dd hh:mm:ss.zzz") + micros;
+}
+
+static QString argumentText(const Argument& arg)
+{
+    if (arg.tag == 8)
+        return QString::fromLatin1(arg.value.toByteArray().toHex());
+    return arg.value.toString();
+}
+
+// Replaces %1..%99 by the arguments; returns the number of arguments used.
+static int substitute(const QString& format, const QList<Argument>& args, QString* out)
+{
+    int used = 0;
+    out->reserve(format.size());
+    for (int i = 0; i < format.size(); i++)
+    {
+        const QChar c = format.at(i);
+        if (c == '%' && i + 1 < format.size() && format.at(i + 1).isDigit())
+        {
+            int n = format.at(++i).digitValue();
+            if (i + 1 < format.size() && format.at(i + 1).isDigit())
+                n = n * 10 + format.at(++i).digitValue();
+            if (n >= 1 && n <= args.count())
+            {
+                out->append(argumentText(args.at(n - 1)));
+                used = qMax(used, n);
+                continue;
+            }
+            out->append('%');
+            out->append(QString::number(n));
+            continue;
+        }
+        out->append(c);
+    }
+    return used;
+}
+
+static QString jsonString(const QString& text)
+{
+    QString out("\"");
+    for (int i = 0; i < text.size(); i++)
+    {
+        const ushort c = text.at(i).unicode();
+        switch (c)
+        {
+        case '"':  out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (c < 0x20)
+                out += "\\u" + QString::number(c, 16).rightJustified(4, '0');
+            else
+                out += text.at(i);
+        }
+    }
+    return out + '"';
+}
+
+static QString jsonValue(const Argument& arg)
+{
+    switch (arg.tag)
+    {
+    case 0:
+        return "null";
+    case 1:
+        return arg.value.toBool() ? "true" : "false";
+    case 2: case 3: case 4: case 5:
+        return arg.value.toString();
+    case 6:
+    {
+        const double d = arg.value.toDouble();
+        if (d != d || d - d != 0) return "null";
+        return QString::number(d, 'g', 17);
+    }
+    default:
+        return jsonString(argumentText(arg));
+    }
+}
+
+static bool readArgument(QDataStream& in, Argument* arg)
+{
+    quint8 tag;
+    in >> tag;
+    arg->tag = tag;
+    switch (tag)
+    {
+    case 0:
+        break;
+    case 1: { quint8 v; in >> v; arg->value = bool(v); break; }
+    case 2: { qint32 v; in >> v; arg->value = int(v); break; }
+    case 3: { quint32 v; in >> v; arg->value = uint(v); break; }
+    case 4: { qint64 v; in >> v; arg->value = qlonglong(v); break; }
+    case 5: { quint64 v; in >> v; arg->value = qulonglong(v); break; }
+    case 6: { double v; in >> v; arg->value = v; break; }
+    case 7:
+    {
+        quint32 size;
+        in >> size;
+        if (size > quint32(in.device()->bytesAvailable() / 2))
+            return false;
+        QString s;
+        s.resize(int(size));
+        for (quint32 i = 0; i < size && in.status() == QDataStream::Ok; i++)
+        {
+            quint16 c;
+            in >> c;
+            s[int(i)] = QChar(c);
+        }
+        arg->value = s;
+        break;
+    }
+    case 8:
+    case 9:
+    {
+        quint32 size;
+        in >> size;
+        if (size > quint32(in.device()->bytesAvailable()))
+            return false;
+        QByteArray bytes;
+        bytes.resize(int(size));
+        if (in.readRawData(bytes.data(), int(size)) != int(size))
+            return false;
+        if (tag == 8)
+        {
+            arg->value = bytes;
+        }
+        else
+        {
+            QDataStream variant(bytes);
+            variant.setVersion(QDataStream::Qt_4_6);
+            variant >> arg->value;
+        }
+        break;
+    }
+    default:
+        return false;
+    }
+    return in.status() == QDataStream::Ok;
+}
+
+static bool decode(const QString& fileName, bool json, QTextStream& out)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        QTextStream(stderr) << fileName << ": " << file.errorString() << "\n";
+        return false;
+    }
+    const QByteArray data = file.readAll();
+    if (data.size() < 32 || !data.startsWith(QByteArray("QXTBLOG", 8)) || data.at(8) != 1)
+    {
+        QTextStream(stderr) << fileName << ": not a binary log segment\n";
+        return false;
+    }
+
+    QDataStream in(data);
+    in.setByteOrder(data.at(9) ? QDataStream::LittleEndian : QDataStream::BigEndian);
+    in.skipRawData(16);
+    qint64 epoch;
+    in >> epoch;
+    in.skipRawData(8);
+
+    QHash<quint32, QString> formats;
+    for (;;)
+    {
+        quint8 type = 0;
+        in >> type;
+        if (in.status() != QDataStream::Ok || type == 0)
+            break;
+
+        if (type == 1)
+        {
+            quint32 id, size;
+            in.skipRawData(3);
+            in >> id >> size;
+            if (size > quint32(in.device()->bytesAvailable()))
+                break;
+            QByteArray text;
+            text.resize(int(size));
+            if (in.readRawData(text.data(), int(size)) != int(size))
+                break;
+            formats.insert(id, QString::fromUtf8(text.constData(), text.size()));
+            continue;
+        }
+        if (type != 2)
+        {
+            QTextStream(stderr) << fileName << ": unknown record type " << type << "\n";
+            return false;
+        }
+
+        Event event;
+        quint8 reserved8;
+        quint16 level, count, reserved16;
+        quint32 argBytes;
+        in >> reserved8 >> level >> count >> reserved16 >> event.format >> event.timestamp >> event.thread >> argBytes;
+        event.level = level;
+        if (argBytes > quint32(in.device()->bytesAvailable()))
+            break;
+        QByteArray argData;
+        argData.resize(int(argBytes));
+        if (in.readRawData(argData.data(), int(argBytes)) != int(argBytes))
+            break;
+        QDataStream args(argData);
+        args.setByteOrder(in.byteOrder());
+        for (int i = 0; i < count; i++)
+        {
+            Argument arg;
+            if (!readArgument(args, &arg))
+                break;
+            event.args.append(arg);
+        }
+
+        const QString format = formats.value(event.format);
+        QString message;
+        const int used = substitute(format, event.args, &message);
+        if (json)
+        {
+            out << "{\"time\":" << jsonString(timeString(epoch, event.timestamp, true))
+                << ",\"ns\":" << event.timestamp
+                << ",\"level\":" << jsonString(levelName(event.level))
+                << ",\"thread\":" << event.thread
+                << ",\"format\":" << (event.format ? jsonString(format) : QString("null"))
+                << ",\"message\":" << jsonString(message)
+                << ",\"args\":[";
+            for (int i = 0; i < event.args.count(); i++)
+                out << (i ? "," : "") << jsonValue(event.args.at(i));
+            out << "]}\n";
+        }
+        else
+        {
+            // the same layout as QxtBasicFileLoggerEngine, with the thread added to the header
+            const QString header = '[' + timeString(epoch, event.timestamp, false) + "] [" + levelName(event.level)
+                                   + "] [0x" + QString::number(event.thread, 16) + "] ";
+            const QString padding(header.size(), ' ');
+            QStringList lines;
+            if (event.format)
+                lines << message;
+            for (int i = used; i < event.args.count(); i++)
+            {
+                if (event.args.at(i).tag != 0)
+                    lines << argumentText(event.args.at(i));
+            }
+            out << header << lines.join("\n" + padding) << "\n";
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+    QStringList files = app.arguments().mid(1);
+    const bool json = files.removeAll("--json") > 0;
+    if (files.isEmpty() || files.contains("--help"))
+    {
+        QTextStream(stderr) << "usage: " << app.arguments().at(0) << " [--json] segment...\n";
+        return 1;
+    }
+
+    QTextStream out(stdout);
+    out.setCodec("UTF-8");
+    int result = 0;
+    Q_FOREACH(const QString& file, files)
+    {
+        if (!decode(file, json, out))
+            result = 2;
+    }
+    return result;
+}
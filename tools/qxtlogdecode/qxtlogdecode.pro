@@ -0,0 +1,12 @@
+TEMPLATE = app
+TARGET = qxtlogdecode
+DESTDIR = ../../bin
+DEPENDPATH += .
+INCLUDEPATH += .
+SOURCES += main.cpp
+CONFIG += console
+QT = core
+QXT = core
+include($$QXT_SOURCE_TREE/src/qxtlibs.pri)
+INSTALLS += target
+target.path = $${QXT_INSTALL_BINS}